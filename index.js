@@ -239,16 +239,11 @@ async function testDataStreaming(handle, device) {
       console.log(`   Starting native data logging test...`);
 
       const samplesPerSecond = 1000; // Test with 1000 Hz for higher performance
-      const bufferSize = 8192; // 8KB buffer
+      const bufferSize = 8192; // 8KB per read; the logging buffer is sized automatically
       const testDuration = 2000; // 2 seconds for faster testing
 
       // Start native streaming
-      iolink.startNativeStreaming(
-        handle,
-        device.port,
-        samplesPerSecond,
-        bufferSize
-      );
+      iolink.startNativeStreaming(handle, device.port, samplesPerSecond);
 
       let totalSamples = 0;
       let readCount = 0;
@@ -298,6 +293,10 @@ async function testDataStreaming(handle, device) {
               `   Status: running=${status.isRunning}, moreData=${status.hasMoreData}, overrun=${status.overrun}`
             );
 
+            if (status.overrun && !status.hasMoreData) {
+              console.log(`   Overrun: logging stopped until restarted`);
+            }
+
             // Show sample data (only for first successful read)
             if (result.samples.length > 0 && readCount === 1) {
               const firstSample = result.samples[0];
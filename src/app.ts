@@ -8,7 +8,7 @@ import express, { Application, Request, Response, NextFunction } from 'express';
 import cors from 'cors';
 import helmet from 'helmet';
 import morgan from 'morgan';
-import rateLimit from 'express-rate-limit';
+import rateLimit, { MemoryStore } from 'express-rate-limit';
 import { Server } from 'http';
 
 // Import custom middleware
@@ -27,13 +27,26 @@ import {
 import deviceRoutes from './routes/devices';
 import dataRoutes from './routes/data';
 import streamRoutes from './routes/stream';
+import historyRoutes from './routes/history';
+import rulesRoutes from './routes/rules';
 
 // Import utils
 import logger from './utils/logger';
+import { requestLatency } from './utils/diagnostics';
+import { requestTracing } from './utils/tracing';
+
+// Import controllers
+import { getMetrics } from './controllers/deviceController';
+import { recordingService } from './controllers/dataController';
 
 // Create Express application
 const app: Application = express();
 
+// Behind HTTP workers the client address arrives in X-Forwarded-For
+if (parseInt(process.env.HTTP_WORKERS || '0', 10) > 0) {
+  app.set('trust proxy', 'loopback');
+}
+
 // ============================================================================
 // SECURITY MIDDLEWARE
 // ============================================================================
@@ -76,6 +89,9 @@ app.use(addSecurityHeaders);
 // GENERAL MIDDLEWARE
 // ============================================================================
 
+// Per-route latency histograms
+app.use(requestLatency);
+
 // Request timeout (30 seconds)
 app.use(timeoutHandler(30000));
 
@@ -94,6 +110,10 @@ app.use(
   })
 );
 
+// Sampled request tracing (after body parsing, whose stream callbacks would
+// lose the trace context)
+app.use(requestTracing);
+
 // Request logging
 if (process.env.NODE_ENV !== 'test') {
   app.use(
@@ -112,9 +132,13 @@ app.use(logAuthenticatedRequest);
 // RATE LIMITING
 // ============================================================================
 
-// Global rate limiting
+// Global rate limiting. HTTP workers count the requests they answer
+// themselves in the same store (see serveRateLimitStore)
+export const globalLimiterStore = new MemoryStore();
+
 const globalLimiter = rateLimit({
   windowMs: 15 * 60 * 1000, // 15 minutes
+  store: globalLimiterStore,
   max: (req: Request) => {
     // Different limits based on user role (implemented in auth middleware)
     const userRole = req.headers['x-user-role'];
@@ -207,6 +231,7 @@ app.get('/api/v1/docs', (req: Request, res: Response) => {
         masters: {
           discover: 'GET /masters',
           connected: 'GET /masters/connected',
+          watcher: 'GET /masters/watcher',
           connect: 'POST /masters/connect',
           disconnect: 'DELETE /masters/:handle',
         },
@@ -222,11 +247,66 @@ app.get('/api/v1/docs', (req: Request, res: Response) => {
           processDataRead: 'GET /data/:master/:port/process',
           processDataWrite: 'POST /data/:master/:port/process',
           processDataStream: 'GET /data/:master/:port/process/stream',
+          processDataPeriod: 'GET|PUT /data/:master/:port/process/period',
+          processImage: 'GET /data/process-image',
+          mergedStream: 'GET /data/merged/stream?ports=1:1,2:3',
+          logging: 'GET|POST|DELETE /data/:master/logging',
+          loggedSamples: 'GET /data/:master/:port/logging?since=&limit=',
+          loggingStream: 'GET /data/:master/:port/logging/stream',
+          recording: 'POST|DELETE /data/:master/:port/recording',
+          recordings: 'GET /data/recordings',
+          recordedSamples: 'GET /data/recordings/:id/samples?from=&to=&limit=',
+          recordingExport: 'GET /data/recordings/:id/export?from=&to=',
+          deleteRecording: 'DELETE /data/recordings/:id',
           parameterRead: 'GET /data/:master/:port/parameters/:index',
           parameterWrite: 'POST /data/:master/:port/parameters/:index',
           parameterList: 'GET /data/:master/:port/parameters',
           standardParameters: 'GET /data/:master/:port/parameters/standard',
           batchOperations: 'POST /data/:master/:port/parameters/batch',
+          blobRead: 'GET /data/:master/:port/blob/:blobId',
+          blobWrite: 'PUT /data/:master/:port/blob/:blobId',
+          blobTransfers: 'GET /data/blob/transfers',
+          blobAbort: 'DELETE /data/blob/transfers/:transferId',
+        },
+        history: {
+          channels: 'GET /history',
+          query: 'GET /history/:master/:port?from=&to=&points=',
+          configure: 'PUT /history/:master/:port',
+          clear: 'DELETE /history/:master/:port',
+        },
+        rules: {
+          list: 'GET /rules',
+          create: 'POST /rules/:master/:port',
+          remove: 'DELETE /rules/:ruleId',
+          alarms: 'GET /rules/alarms?limit=',
+        },
+        firmware: {
+          uploadImage: 'POST /firmware/images',
+          images: 'GET /firmware/images',
+          removeImage: 'DELETE /firmware/images/:imageId',
+          startJobs: 'POST /firmware/jobs',
+          jobs: 'GET /firmware/jobs',
+          job: 'GET /firmware/jobs/:jobId',
+          abortJob: 'DELETE /firmware/jobs/:jobId',
+        },
+        diagnostics: {
+          linkQuality: 'GET /diagnostics/link-quality',
+          masterClocks: 'GET /diagnostics/clocks',
+          linkQualityPort: 'GET /diagnostics/link-quality/:master/:port',
+          linkQualityMetrics: 'GET /diagnostics/link-quality/metrics',
+          linkQualityExport: 'GET /diagnostics/link-quality/export',
+          eventsExport: 'GET /diagnostics/events/export?since=',
+          latency: 'GET /diagnostics/latency',
+          latencyReset: 'DELETE /diagnostics/latency',
+          tracing: 'GET /diagnostics/tracing',
+          tracingConfigure: 'PUT /diagnostics/tracing',
+          metrics: 'GET /metrics (outside /api/v1)',
+        },
+        dataStorage: {
+          backup: 'POST /datastorage/backups',
+          backups: 'GET /datastorage/backups',
+          backupManifest: 'GET /datastorage/backups/:backupId',
+          restore: 'POST /datastorage/backups/:backupId/restore',
         },
         streaming: {
           status: 'GET /stream/status',
@@ -244,10 +324,15 @@ app.get('/api/v1/docs', (req: Request, res: Response) => {
   });
 });
 
+// Prometheus scrape endpoint (latency histograms, link quality)
+app.get('/metrics', authenticateApiKey, getMetrics);
+
 // Main API routes
 app.use('/api/v1', deviceRoutes);
 app.use('/api/v1/data', dataRoutes);
 app.use('/api/v1/stream', streamRoutes);
+app.use('/api/v1/history', historyRoutes);
+app.use('/api/v1/rules', rulesRoutes);
 
 // Root redirect
 app.get('/', (req: Request, res: Response) => {
@@ -280,6 +365,11 @@ let server: Server | null = null;
 function gracefulShutdown(signal: string): void {
   logger.info(`Received ${signal}. Starting graceful shutdown...`);
 
+  // Write out the partly encoded block and final totals of every recording
+  const recordingsStopped = recordingService
+    .stopAll()
+    .catch((err: Error) => logger.error('Error stopping recordings:', err));
+
   if (server) {
     server.close((err?: Error) => {
       if (err) {
@@ -289,10 +379,7 @@ function gracefulShutdown(signal: string): void {
 
       logger.info('HTTP server closed.');
 
-      // Additional cleanup can be added here
-      // (database connections, active streams, etc.)
-
-      process.exit(0);
+      recordingsStopped.then(() => process.exit(0));
     });
 
     // Force close after timeout
@@ -301,7 +388,7 @@ function gracefulShutdown(signal: string): void {
       process.exit(1);
     }, 10000); // 10 seconds timeout
   } else {
-    process.exit(0);
+    recordingsStopped.then(() => process.exit(0));
   }
 }
 
@@ -0,0 +1,71 @@
+/**
+ * Recording Export CLI
+ * Writes a recording as an Arrow IPC stream without the server running
+ *
+ * Usage: npm run export -- <recordingId> [--from <epoch ms|ISO>] [--to <epoch ms|ISO>]
+ *                          [--out <file>] [--dir <recording dir>]
+ */
+
+import { createWriteStream, promises as fs } from 'fs';
+import * as path from 'path';
+import { Readable, Writable } from 'stream';
+import { pipeline } from 'stream/promises';
+import { readBlocks, scanBlockIndex } from '../utils/recordingFile';
+import { recordingArrowStream } from '../utils/captureExport';
+
+const USAGE =
+  'Usage: export <recordingId> [--from <epoch ms|ISO>] [--to <epoch ms|ISO>] [--out <file>] [--dir <recording dir>]';
+
+function parseTime(value: string): number {
+  const time = /^\d+$/.test(value) ? Number(value) : Date.parse(value);
+  if (Number.isNaN(time)) throw new Error(`Invalid time: ${value}`);
+  return time;
+}
+
+function parseArgs(argv: string[]) {
+  const options: Record<string, string> = {};
+  const positional: string[] = [];
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith('--')) {
+      if (i + 1 >= argv.length) throw new Error(`Missing value for ${argv[i]}`);
+      options[argv[i].slice(2)] = argv[++i];
+    } else {
+      positional.push(argv[i]);
+    }
+  }
+  if (positional.length !== 1) throw new Error(USAGE);
+  return {
+    id: positional[0],
+    from: options.from !== undefined ? parseTime(options.from) : 0,
+    to: options.to !== undefined ? parseTime(options.to) : Infinity,
+    out: options.out,
+    dir: options.dir || process.env.RECORDING_DIR || path.join(process.cwd(), 'data', 'recordings'),
+  };
+}
+
+async function main(): Promise<void> {
+  const { id, from, to, out, dir } = parseArgs(process.argv.slice(2));
+  const meta = JSON.parse(await fs.readFile(path.join(dir, `${id}.json`), 'utf8'));
+  const blockPath = path.join(dir, `${id}.iolr`);
+  const index = await scanBlockIndex(blockPath);
+
+  const output: Writable = out ? createWriteStream(out) : process.stdout;
+  let bytes = 0;
+  async function* counted() {
+    for await (const chunk of recordingArrowStream(readBlocks(blockPath, index, from, to), meta.decoding, from, to)) {
+      bytes += chunk.length;
+      yield chunk;
+    }
+  }
+  // Backpressure, and a closed pipe (e.g. `| head`) ends the block reader
+  // instead of leaving it waiting for 'drain'; stdout is left open
+  await pipeline(Readable.from(counted()), output, { end: out !== undefined });
+  if (out) {
+    console.error(`Exported ${id} (${index.length} blocks scanned) to ${out}: ${bytes} bytes`);
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
@@ -5,10 +5,37 @@
  */
 
 import { Request, Response } from 'express';
-import { deviceManager } from './deviceController';
+import { once } from 'events';
+import { Readable } from 'stream';
+import { pipeline } from 'stream/promises';
+import { deviceManager, masterClockService } from './deviceController';
+import BlobTransferService from '../services/BlobTransferService';
+import DataLoggingService, { LoggedSamples } from '../services/DataLoggingService';
+import HistoryService from '../services/HistoryService';
+import RecordingService from '../services/RecordingService';
+import RulesService from '../services/RulesService';
 import logger from '../utils/logger';
-import { asyncHandler } from '../middleware/errorHandler';
-import { PARAMETER_INDEX } from '../utils/constants';
+import { TimeOrderedMerge } from '../utils/timeMerge';
+import { LoggedSample } from '../utils/loggingRing';
+import { ARROW_STREAM_CONTENT_TYPE, recordingArrowStream } from '../utils/captureExport';
+import { asyncHandler, createApiError } from '../middleware/errorHandler';
+import { getUserRole, ROLES } from '../middleware/auth';
+import { PARAMETER_INDEX, LIMITS } from '../utils/constants';
+
+// BLOB transfers share the DeviceManager's DLL wrapper
+export const blobTransferService = new BlobTransferService(deviceManager);
+
+// Logging buffer drain loops, one per master
+export const dataLoggingService = new DataLoggingService(deviceManager);
+
+// Downsampling pyramids fed from the logging drain
+export const historyService = new HistoryService(dataLoggingService);
+
+// Compressed recordings of logged ports
+export const recordingService = new RecordingService(dataLoggingService, historyService);
+
+// Alarm rules evaluated on logged samples and the process image
+export const rulesService = new RulesService(dataLoggingService, historyService, deviceManager);
 
 // ============================================================================
 // PROCESS DATA ENDPOINTS
@@ -45,12 +72,13 @@ export const readProcessData = asyncHandler(async (req: Request, res: Response)
 
 /**
  * POST /api/v1/data/:masterHandle/:deviceId/process
- * Write process data to device
- * Body: { data: [1, 2, 3] } or { data: "hello" }
+ * Write process data to device; the latest value per port is written at
+ * the port's cycle rate
+ * Body: { data: [1, 2, 3], confirm?: boolean } or { data: "hello" }
  */
 export const writeProcessData = asyncHandler(async (req: Request, res: Response) => {
   const { masterHandle, deviceId } = req.params;
-  const { data } = req.body;
+  const { data, confirm } = req.body;
   const handle = parseInt(masterHandle);
   const port = parseInt(deviceId);
 
@@ -68,16 +96,20 @@ export const writeProcessData = asyncHandler(async (req: Request, res: Response)
     throw new Error('Invalid data format. Expected array, string, or buffer.');
   }
 
-  const result = await deviceManager.writeProcessData(handle, port, buffer);
+  const result = await deviceManager.writeProcessData(handle, port, buffer, confirm);
 
   res.json({
     success: true,
     data: {
       port: result.port,
       bytesWritten: result.bytesWritten,
+      sequence: result.sequence,
       timestamp: result.timestamp,
+      commit: result.commit,
     },
-    message: `Successfully wrote ${result.bytesWritten} bytes to port ${port}`,
+    message: result.commit
+      ? `Wrote ${result.bytesWritten} bytes to port ${port}`
+      : `Queued ${result.bytesWritten} bytes for port ${port}`,
   });
 });
 
@@ -147,6 +179,627 @@ export const streamProcessData = asyncHandler(async (req: Request, res: Response
   });
 });
 
+/**
+ * GET /api/v1/data/merged/stream
+ * One time-ordered process data stream across masters (Server-Sent Events)
+ * Query params: ?ports=1:1,2:3&interval=100&maxDelay=250
+ */
+export const streamMergedProcessData = asyncHandler(async (req: Request, res: Response) => {
+  const sources = String(req.query.ports || '')
+    .split(',')
+    .filter(Boolean)
+    .map((entry) => {
+      const [masterHandle, port] = entry.split(':').map((part) => parseInt(part, 10));
+      return { masterHandle, port, key: `${masterHandle}:${port}` };
+    });
+  if (
+    sources.length === 0 ||
+    sources.some(({ masterHandle, port }) => Number.isNaN(masterHandle) || Number.isNaN(port))
+  ) {
+    throw createApiError('ports must list master:port pairs, e.g. 1:1,2:3', 'INVALID_REQUEST', 400);
+  }
+  // Same port restriction as authorizeDeviceAccess
+  const restricted = sources.find(({ port }) => port > 4);
+  if (restricted && getUserRole(req) === ROLES.READ_ONLY) {
+    throw createApiError(
+      `Access denied to port ${restricted.port}. Read-only users can only access ports 1-4.`,
+      'DEVICE_ACCESS_DENIED',
+      403
+    );
+  }
+
+  const interval = Math.max(
+    parseInt(req.query.interval as string) || LIMITS.STREAM_INTERVAL_MIN,
+    LIMITS.PROCESS_DATA_PERIOD_MIN
+  );
+  const maxDelay = Math.min(
+    parseInt(req.query.maxDelay as string) || LIMITS.MERGE_MAX_DELAY_DEFAULT,
+    LIMITS.MERGE_MAX_DELAY_MAX
+  );
+
+  logger.info(`Starting merged process data stream for ${sources.length} ports (${interval}ms, maxDelay ${maxDelay}ms)`);
+
+  res.writeHead(200, {
+    'Content-Type': 'text/event-stream',
+    'Cache-Control': 'no-cache',
+    Connection: 'keep-alive',
+    'Access-Control-Allow-Origin': '*',
+    'Access-Control-Allow-Headers': 'Cache-Control',
+  });
+  res.write(
+    `data: ${JSON.stringify({ type: 'connected', ports: sources.map((s) => s.key), interval, maxDelay })}\n\n`
+  );
+
+  const merge = new TimeOrderedMerge<any>({
+    maxDelayMs: maxDelay,
+    emit: (source, sample) => res.write(`data: ${JSON.stringify(sample)}\n\n`),
+  });
+  const lastSeen = new Map<string, number>();
+  for (const source of sources) {
+    merge.addSource(source.key);
+  }
+
+  const streamInterval = setInterval(async () => {
+    await Promise.all(
+      sources.map(async ({ masterHandle, port, key }) => {
+        try {
+          const result = await deviceManager.readProcessData(masterHandle, port);
+          const readAt = new Date(result.timestamp).getTime();
+          if (lastSeen.get(key) === readAt) return;
+          lastSeen.set(key, readAt);
+
+          const { timestamp, aligned } = masterClockService.align(masterHandle, readAt);
+          merge.push(key, {
+            type: 'data',
+            masterHandle,
+            port,
+            dataHex: result.data.toString('hex').toUpperCase(),
+            status: result.status,
+            timestamp,
+            aligned,
+          });
+        } catch (error: any) {
+          logger.debug(`Merged stream read of ${key} failed: ${error.message}`);
+        }
+      })
+    );
+    merge.drain();
+  }, interval);
+
+  req.on('close', () => {
+    clearInterval(streamInterval);
+    logger.info(`Merged process data stream ended (${JSON.stringify(merge.getStatus())})`);
+  });
+});
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/process/period
+ * Cyclic process data period, device minimum and measured timing
+ */
+export const getProcessDataPeriod = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  res.json({
+    success: true,
+    data: {
+      port,
+      periodMs: deviceManager.getProcessDataPeriod(handle, port),
+      minCycleTimeMs: await deviceManager.getMinCycleTime(handle, port),
+      timing: deviceManager.getProcessDataSchedule(handle, port),
+    },
+  });
+});
+
+/**
+ * PUT /api/v1/data/:masterHandle/:deviceId/process/period
+ * Set the cyclic process data period; 409 without a master thread, 400
+ * below the device MinCycleTime
+ * Body: { periodMs: 2 }
+ */
+export const setProcessDataPeriod = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+  const { periodMs } = req.body;
+
+  const minCycleTimeMs = await deviceManager.setProcessDataPeriod(handle, port, periodMs);
+
+  res.json({
+    success: true,
+    data: { port, periodMs, minCycleTimeMs },
+    message: `Process data period set to ${periodMs}ms`,
+  });
+});
+
+/**
+ * GET /api/v1/data/process-image
+ * Snapshot of the shared process image (latest inputs and outputs per port)
+ */
+export const getProcessImage = asyncHandler(async (req: Request, res: Response) => {
+  const entries = deviceManager.getProcessImageSnapshot();
+
+  res.json({
+    success: true,
+    data: {
+      entries,
+      count: entries.length,
+      timestamp: new Date().toISOString(),
+    },
+  });
+});
+
+// ============================================================================
+// DATA LOGGING ENDPOINTS
+// ============================================================================
+
+function formatLoggedSample(sample: LoggedSample) {
+  if (sample.gap) {
+    return {
+      sequence: sample.sequence,
+      sampleIndex: sample.sampleIndex,
+      timestamp: sample.timestamp,
+      gap: sample.gap,
+    };
+  }
+  return {
+    sequence: sample.sequence,
+    sampleIndex: sample.sampleIndex,
+    timestamp: sample.timestamp,
+    timestampQuality: sample.timestampQuality,
+    inputValid: sample.inputValid,
+    dataHex: sample.inputData.toString('hex').toUpperCase(),
+    outputHex: sample.outputData.toString('hex').toUpperCase(),
+  };
+}
+
+/**
+ * POST /api/v1/data/:masterHandle/logging
+ * Start logging a set of ports in the master's logging buffer
+ * Body: { ports: [1, 2], sampleTimeUs: 1000, memorySize?: 65536 }
+ */
+export const startDataLogging = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const { ports, sampleTimeUs, memorySize } = req.body;
+
+  const status = await dataLoggingService.start(handle, ports, { sampleTimeUs, memorySize });
+
+  res.json({
+    success: true,
+    data: status,
+    message: `Data logging running on ports ${ports.join(', ')} of master ${handle}`,
+  });
+});
+
+/**
+ * DELETE /api/v1/data/:masterHandle/logging
+ * Stop logging of some ports or, without ?ports=, of all of them
+ */
+export const stopDataLogging = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const ports = req.query.ports
+    ? String(req.query.ports).split(',').map((port) => parseInt(port, 10))
+    : undefined;
+  if (ports && ports.some((port) => Number.isNaN(port))) {
+    throw createApiError('ports must be a comma-separated list of port numbers', 'INVALID_REQUEST', 400);
+  }
+
+  const status = await dataLoggingService.stop(handle, ports);
+
+  res.json({
+    success: true,
+    data: status,
+    message: ports
+      ? `Data logging stopped on ports ${ports.join(', ')} of master ${handle}`
+      : `Data logging stopped on master ${handle}`,
+  });
+});
+
+/**
+ * GET /api/v1/data/:masterHandle/logging
+ * Logging ports of a master with per-port sample and loss counters
+ */
+export const getDataLoggingStatus = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+
+  res.json({
+    success: true,
+    data: dataLoggingService.getStatus(handle),
+  });
+});
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/logging
+ * Logged samples of one port
+ * Query params: ?since=<nextSequence>&limit=1000
+ */
+export const getLoggedSamples = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+  const since = req.query.since !== undefined ? parseInt(req.query.since as string) : null;
+  const limit = Math.min(
+    parseInt(req.query.limit as string) || LIMITS.LOGGING_SAMPLES_MAX,
+    LIMITS.LOGGING_SAMPLES_MAX
+  );
+
+  const result = dataLoggingService.getSamples(
+    handle,
+    port,
+    since === null || Number.isNaN(since) ? null : since,
+    limit
+  );
+  if (!result) {
+    throw createApiError(
+      `Data logging is not running on master ${handle} port ${port}`,
+      'LOGGING_NOT_ACTIVE',
+      404
+    );
+  }
+
+  res.json({
+    success: true,
+    data: {
+      port,
+      samples: result.samples.map(formatLoggedSample),
+      count: result.samples.length,
+      nextSequence: result.nextSequence,
+      oldestSequence: result.oldestSequence,
+    },
+  });
+});
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/logging/stream
+ * Logged samples of one port as they are drained (Server-Sent Events)
+ */
+export const streamLoggedSamples = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  if (!dataLoggingService.isLogging(handle, port)) {
+    throw createApiError(
+      `Data logging is not running on master ${handle} port ${port}`,
+      'LOGGING_NOT_ACTIVE',
+      404
+    );
+  }
+
+  logger.info(`Starting logging stream for master ${handle} port ${port}`);
+
+  res.writeHead(200, {
+    'Content-Type': 'text/event-stream',
+    'Cache-Control': 'no-cache',
+    Connection: 'keep-alive',
+    'Access-Control-Allow-Origin': '*',
+    'Access-Control-Allow-Headers': 'Cache-Control',
+  });
+  res.write(`data: ${JSON.stringify({ type: 'connected', port })}\n\n`);
+
+  const onSamples = (batch: LoggedSamples) => {
+    if (batch.masterHandle !== handle || batch.port !== port) return;
+    res.write(
+      `data: ${JSON.stringify({ type: 'samples', port, samples: batch.samples.map(formatLoggedSample) })}\n\n`
+    );
+  };
+  dataLoggingService.on('samples', onSamples);
+
+  req.on('close', () => {
+    dataLoggingService.off('samples', onSamples);
+    logger.info(`Logging stream ended for master ${handle} port ${port}`);
+  });
+});
+
+// ============================================================================
+// HISTORY ENDPOINTS
+// ============================================================================
+
+// Validated from/to query values are numbers (epoch ms) or Dates
+const toEpochMs = (value: any): number => (value instanceof Date ? value.getTime() : Number(value));
+
+/**
+ * GET /api/v1/history
+ * Recorded ports with the span each pyramid level reaches back
+ */
+export const listHistoryChannels = asyncHandler(async (req: Request, res: Response) => {
+  const channels = historyService.getChannels();
+
+  res.json({
+    success: true,
+    data: {
+      ...historyService.getStatus(),
+      channels,
+    },
+  });
+});
+
+/**
+ * GET /api/v1/history/:masterHandle/:deviceId
+ * Min/max/mean of a port's value over a time range in at most `points` buckets
+ * Query params: ?from=<epoch ms|ISO>&to=<epoch ms|ISO>&points=1000
+ */
+export const queryHistory = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+  const to = req.query.to !== undefined ? toEpochMs(req.query.to) : Date.now();
+  const from = req.query.from !== undefined
+    ? toEpochMs(req.query.from)
+    : to - LIMITS.HISTORY_RANGE_DEFAULT;
+  const points = Number(req.query.points);
+  if (from > to) {
+    throw createApiError('from must not be after to', 'INVALID_REQUEST', 400);
+  }
+
+  const result = historyService.query(handle, port, from, to, points);
+  if (!result) {
+    throw createApiError(
+      `No history recorded for master ${handle} port ${port}`,
+      'HISTORY_NOT_FOUND',
+      404
+    );
+  }
+
+  res.json({
+    success: true,
+    data: {
+      port,
+      from,
+      to,
+      ...result,
+      points: result.timestamps.length,
+    },
+  });
+});
+
+/**
+ * PUT /api/v1/history/:masterHandle/:deviceId
+ * Set how a port's inputs are decoded into a value; drops its recorded history
+ * Body: { dataType?: 'int16', offset?: 0, scale?: 1, bias?: 0 }
+ */
+export const configureHistoryChannel = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  const decoding = historyService.setDecoding(handle, port, req.body);
+
+  res.json({
+    success: true,
+    data: { masterHandle: handle, port, decoding },
+    message: `History of master ${handle} port ${port} restarted with new decoding`,
+  });
+});
+
+/**
+ * DELETE /api/v1/history/:masterHandle/:deviceId
+ * Drop a port's recorded history
+ */
+export const clearHistoryChannel = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  if (!historyService.clear(handle, port)) {
+    throw createApiError(
+      `No history recorded for master ${handle} port ${port}`,
+      'HISTORY_NOT_FOUND',
+      404
+    );
+  }
+
+  res.json({
+    success: true,
+    message: `History of master ${handle} port ${port} cleared`,
+  });
+});
+
+// ============================================================================
+// RULE ENDPOINTS
+// ============================================================================
+
+/**
+ * GET /api/v1/rules
+ * Alarm rules with their current state
+ */
+export const listRules = asyncHandler(async (req: Request, res: Response) => {
+  const rules = rulesService.getRules();
+
+  res.json({
+    success: true,
+    data: {
+      ...rulesService.getStatus(),
+      rules,
+    },
+  });
+});
+
+/**
+ * POST /api/v1/rules/:masterHandle/:deviceId
+ * Add an alarm rule on a port
+ * Body: { type: 'threshold', limit: 80, hysteresis: 2, decoding?: { dataType: 'int16', scale: 0.1 } }
+ */
+export const createRule = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  const rule = rulesService.addRule({ ...req.body, masterHandle: handle, port });
+
+  res.status(201).json({
+    success: true,
+    data: rule,
+    message: `Rule ${rule.id} added on master ${handle} port ${port}`,
+  });
+});
+
+/**
+ * DELETE /api/v1/rules/:ruleId
+ * Remove an alarm rule; an active alarm of it is dropped without a clear
+ */
+export const deleteRule = asyncHandler(async (req: Request, res: Response) => {
+  const { ruleId } = req.params;
+
+  rulesService.removeRule(ruleId);
+
+  res.json({
+    success: true,
+    message: `Rule ${ruleId} removed`,
+  });
+});
+
+/**
+ * GET /api/v1/rules/alarms
+ * Active alarms and recent alarm transitions, newest first
+ * Query params: ?limit=100
+ */
+export const getAlarms = asyncHandler(async (req: Request, res: Response) => {
+  const limit = req.query.limit !== undefined ? parseInt(req.query.limit as string) : LIMITS.ALARM_LOG_SIZE;
+  if (!Number.isInteger(limit) || limit < 1) {
+    throw createApiError('limit must be a positive integer', 'INVALID_REQUEST', 400);
+  }
+
+  res.json({
+    success: true,
+    data: rulesService.getAlarms(limit),
+  });
+});
+
+// ============================================================================
+// RECORDING ENDPOINTS
+// ============================================================================
+
+/**
+ * POST /api/v1/data/:masterHandle/:deviceId/recording
+ * Record a logging port to disk in compressed blocks
+ */
+export const startRecording = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  const recording = await recordingService.start(handle, port);
+
+  res.json({
+    success: true,
+    data: recording,
+    message: `Recording master ${handle} port ${port} as ${recording.id}`,
+  });
+});
+
+/**
+ * DELETE /api/v1/data/:masterHandle/:deviceId/recording
+ * Stop recording a port
+ */
+export const stopRecording = asyncHandler(async (req: Request, res: Response) => {
+  const handle = parseInt(req.params.masterHandle);
+  const port = parseInt(req.params.deviceId);
+
+  const recording = await recordingService.stop(handle, port);
+  if (!recording) {
+    throw createApiError(
+      `Master ${handle} port ${port} is not being recorded`,
+      'RECORDING_NOT_ACTIVE',
+      404
+    );
+  }
+
+  res.json({
+    success: true,
+    data: recording,
+    message: `Recording ${recording.id} stopped`,
+  });
+});
+
+/**
+ * GET /api/v1/data/recordings
+ * Recordings on disk, newest first, with their compression
+ */
+export const listRecordings = asyncHandler(async (req: Request, res: Response) => {
+  const recordings = await recordingService.listRecordings();
+
+  res.json({
+    success: true,
+    data: {
+      ...recordingService.getStatus(),
+      recordings: recordings.map((recording) => ({
+        ...recording,
+        compressionRatio:
+          recording.storedBytes > 0 ? recording.rawBytes / recording.storedBytes : null,
+      })),
+    },
+  });
+});
+
+/**
+ * GET /api/v1/data/recordings/:recordingId/samples
+ * Samples of a recording, decoded from the blocks of the requested range
+ * Query params: ?from=<epoch ms|ISO>&to=<epoch ms|ISO>&limit=10000
+ */
+export const getRecordedSamples = asyncHandler(async (req: Request, res: Response) => {
+  const { recordingId } = req.params;
+  const from = req.query.from !== undefined ? toEpochMs(req.query.from) : 0;
+  const to = req.query.to !== undefined ? toEpochMs(req.query.to) : Infinity;
+  const limit = Number(req.query.limit);
+
+  const { samples, truncated } = await recordingService.readSamples(recordingId, from, to, limit);
+
+  res.json({
+    success: true,
+    data: {
+      recordingId,
+      samples,
+      count: samples.length,
+      truncated,
+    },
+  });
+});
+
+/**
+ * GET /api/v1/data/recordings/:recordingId/export
+ * Recording as an Arrow IPC stream, one record batch per block
+ * Query params: ?from=<epoch ms|ISO>&to=<epoch ms|ISO>
+ */
+export const exportRecording = asyncHandler(async (req: Request, res: Response) => {
+  const { recordingId } = req.params;
+  const from = req.query.from !== undefined ? toEpochMs(req.query.from) : 0;
+  const to = req.query.to !== undefined ? toEpochMs(req.query.to) : Infinity;
+
+  const recording = await recordingService.getRecording(recordingId);
+
+  res.status(200);
+  res.setHeader('Content-Type', ARROW_STREAM_CONTENT_TYPE);
+  res.setHeader('Content-Disposition', `attachment; filename="${recordingId}.arrows"`);
+
+  // pipeline applies backpressure and, if either side fails or the client
+  // goes away, destroys the response and returns the block generator so its
+  // file handle is closed. A failure after the headers cuts the stream,
+  // which tells the reader it is incomplete.
+  const chunks = recordingArrowStream(
+    recordingService.readBlocks(recordingId, from, to),
+    recording.decoding,
+    from,
+    to
+  );
+  try {
+    await pipeline(Readable.from(chunks, { objectMode: false }), res);
+  } catch (error: any) {
+    if (error.code === 'ERR_STREAM_PREMATURE_CLOSE') {
+      logger.debug(`Export of recording ${recordingId} aborted by the client`);
+    } else {
+      logger.error(`Export of recording ${recordingId} failed: ${error.message}`);
+    }
+  }
+});
+
+/**
+ * DELETE /api/v1/data/recordings/:recordingId
+ * Delete a stopped recording
+ */
+export const deleteRecording = asyncHandler(async (req: Request, res: Response) => {
+  const { recordingId } = req.params;
+
+  await recordingService.deleteRecording(recordingId);
+
+  res.json({
+    success: true,
+    message: `Recording ${recordingId} deleted`,
+  });
+});
+
 // ============================================================================
 // PARAMETER ENDPOINTS
 // ============================================================================
@@ -379,15 +1032,9 @@ export const getDeviceInformation = asyncHandler(async (req: Request, res: Respo
     }
 
     // Read capability parameters
-    try {
-      const minCycleResult = await deviceManager.readDeviceParameter(
-        deviceKey,
-        PARAMETER_INDEX.MIN_CYCLE_TIME
-      );
-      deviceInfo.capabilities.minCycleTime =
-        minCycleResult.data.readUInt8(0) * 0.1; // Convert to ms
-    } catch (error: any) {
-      logger.debug(`Could not read min cycle time: ${error.message}`);
+    const minCycleTime = await deviceManager.getMinCycleTime(handle, port);
+    if (minCycleTime !== null) {
+      deviceInfo.capabilities.minCycleTime = minCycleTime;
     }
   } catch (error: any) {
     logger.error(
@@ -412,24 +1059,29 @@ interface BatchOperation {
   subIndex?: number;
   value?: any;
   dataType?: string;
+  port?: number;
 }
 
 /**
  * POST /api/v1/data/:masterHandle/:deviceId/parameters/batch
  * Read or write multiple parameters in one request
+ * Operations may target other ports of the same master via "port"; ports are
+ * processed concurrently, writes keep their order within a port, duplicate
+ * reads are merged and subindices of known records come from one record read.
  * Body: {
  *   operations: [
  *     { type: "read", index: 15, subIndex: 0 },
+ *     { type: "read", index: 0, subIndex: 5, port: 2 },
  *     { type: "write", index: 18, subIndex: 0, value: "New Name", dataType: "string" }
- *   ]
+ *   ],
+ *   recordLayouts: { "64": [{ subIndex: 1, bitOffset: 8, bitLength: 8 }] }
  * }
  */
 export const batchParameterOperations = asyncHandler(async (req: Request, res: Response) => {
   const { masterHandle, deviceId } = req.params;
-  const { operations } = req.body;
+  const { operations, recordLayouts } = req.body;
   const handle = parseInt(masterHandle);
   const port = parseInt(deviceId);
-  const deviceKey = `${handle}:${port}`;
 
   if (!Array.isArray(operations) || operations.length === 0) {
     throw new Error('Operations array is required and cannot be empty');
@@ -438,67 +1090,53 @@ export const batchParameterOperations = asyncHandler(async (req: Request, res: R
   const results: any[] = [];
   const errors: any[] = [];
 
-  // Process each operation
-  for (let i = 0; i < operations.length; i++) {
+  const { outcomes, transactions } = await deviceManager.executeParameterBatch(
+    handle,
+    port,
+    operations as BatchOperation[],
+    recordLayouts || {}
+  );
+
+  outcomes.forEach((outcome, i) => {
     const operation: BatchOperation = operations[i];
     const opId = `${operation.type}_${operation.index}_${
       operation.subIndex || 0
     }`;
 
-    try {
-      if (operation.type === 'read') {
-        const result = await deviceManager.readDeviceParameter(
-          deviceKey,
-          operation.index,
-          operation.subIndex || 0
-        );
-        results.push({
-          operationId: opId,
-          type: 'read',
-          index: operation.index,
-          subIndex: operation.subIndex || 0,
-          success: true,
-          data: {
-            rawData: Array.from(result.data),
-            rawDataHex: result.data.toString('hex').toUpperCase(),
-            length: result.length,
-            timestamp: result.timestamp,
-          },
-        });
-      } else if (operation.type === 'write') {
-        if (operation.value === undefined) {
-          throw new Error('Value is required for write operations');
-        }
-
-        const result = await deviceManager.writeDeviceParameter(
-          deviceKey,
-          operation.index,
-          operation.subIndex || 0,
-          operation.value
-        );
-        results.push({
-          operationId: opId,
-          type: 'write',
-          index: operation.index,
-          subIndex: operation.subIndex || 0,
-          success: true,
-          data: {
-            timestamp: result.timestamp,
-          },
-        });
-      } else {
-        throw new Error(`Unknown operation type: ${operation.type}`);
-      }
-    } catch (error: any) {
+    if (!outcome.success) {
       errors.push({
         operationId: opId,
         type: operation.type,
+        port: outcome.port,
         index: operation.index,
         subIndex: operation.subIndex || 0,
-        error: error.message,
+        error: outcome.error,
       });
+      return;
     }
-  }
+
+    const result = outcome.result;
+    results.push({
+      operationId: opId,
+      type: operation.type,
+      port: outcome.port,
+      index: operation.index,
+      subIndex: operation.subIndex || 0,
+      success: true,
+      data:
+        operation.type === 'read'
+          ? {
+              rawData: Array.from(result.data),
+              rawDataHex: result.data.toString('hex').toUpperCase(),
+              length: result.length,
+              timestamp: result.timestamp,
+              source: outcome.source,
+            }
+          : {
+              timestamp: result.timestamp,
+            },
+    });
+  });
 
   res.json({
     success: errors.length === 0,
@@ -509,7 +1147,195 @@ export const batchParameterOperations = asyncHandler(async (req: Request, res: R
         total: operations.length,
         successful: results.length,
         failed: errors.length,
+        transactions: transactions,
       },
     },
   });
 });
+
+// ============================================================================
+// BLOB TRANSFER
+// ============================================================================
+
+/**
+ * Wait until a response takes more data. A client that went away never
+ * drains, so the wait also ends on 'close'.
+ */
+async function drained(res: Response): Promise<void> {
+  if (res.destroyed) return;
+  const done = new AbortController();
+  try {
+    await Promise.race([
+      once(res, 'drain', { signal: done.signal }),
+      once(res, 'close', { signal: done.signal }),
+    ]);
+  } finally {
+    done.abort();
+  }
+}
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/blob/:blobId
+ * Read a BLOB from the device, streamed as application/octet-stream
+ * Query params: ?maxSize=65536 (default LIMITS.MAX_BLOB_SIZE)
+ * Progress is broadcast over WebSocket as "blob:progress"
+ */
+export const readBlob = asyncHandler(async (req: Request, res: Response) => {
+  const { masterHandle, deviceId, blobId } = req.params;
+  const handle = parseInt(masterHandle);
+  const port = parseInt(deviceId);
+  const id = parseInt(blobId);
+  const maxSize = Math.min(
+    parseInt(req.query.maxSize as string) || LIMITS.MAX_BLOB_SIZE,
+    LIMITS.MAX_BLOB_SIZE
+  );
+
+  if (!Number.isInteger(id)) {
+    throw createApiError('BLOB ID must be an integer', 'INVALID_REQUEST', 400);
+  }
+
+  await deviceManager.validateDeviceConnection(handle, port);
+
+  let transferId: string | null = null;
+  req.on('close', () => {
+    if (transferId && !res.writableFinished) {
+      blobTransferService.abort(transferId);
+    }
+  });
+
+  try {
+    await blobTransferService.upload(
+      handle,
+      port,
+      id,
+      maxSize,
+      async (chunk: Buffer) => {
+        if (!res.headersSent) {
+          res.status(200);
+          res.setHeader('Content-Type', 'application/octet-stream');
+        }
+        if (!res.write(chunk)) {
+          await drained(res);
+        }
+        if (res.destroyed && transferId) {
+          blobTransferService.abort(transferId);
+        }
+      },
+      {
+        onStart: (transfer) => {
+          transferId = transfer.id;
+          res.setHeader('X-Blob-Transfer-Id', transfer.id);
+        },
+      }
+    );
+  } catch (error: any) {
+    // Once data has been sent the status can no longer change; cut the
+    // response so the client sees a truncated body rather than a short BLOB
+    if (res.headersSent) {
+      res.destroy(error);
+      return;
+    }
+    throw error;
+  }
+
+  if (!res.headersSent) {
+    res.status(200);
+    res.setHeader('Content-Type', 'application/octet-stream');
+  }
+  res.end();
+});
+
+/**
+ * PUT /api/v1/data/:masterHandle/:deviceId/blob/:blobId
+ * Write a BLOB to the device
+ * Body: raw bytes (application/octet-stream), Content-Length required
+ */
+export const writeBlob = asyncHandler(async (req: Request, res: Response) => {
+  const { masterHandle, deviceId, blobId } = req.params;
+  const handle = parseInt(masterHandle);
+  const port = parseInt(deviceId);
+  const id = parseInt(blobId);
+  const length = parseInt(req.headers['content-length'] || '');
+
+  if (!Number.isInteger(id)) {
+    throw createApiError('BLOB ID must be an integer', 'INVALID_REQUEST', 400);
+  }
+  if (!length || length <= 0) {
+    throw createApiError('Content-Length is required', 'INVALID_REQUEST', 411);
+  }
+  if (length > LIMITS.MAX_BLOB_SIZE) {
+    throw createApiError(
+      `BLOB exceeds maximum size of ${LIMITS.MAX_BLOB_SIZE} bytes`,
+      'INVALID_REQUEST',
+      413
+    );
+  }
+
+  await deviceManager.validateDeviceConnection(handle, port);
+
+  // BLOB_downloadBLOB takes the whole content, so collect it into a buffer
+  // sized from Content-Length instead of concatenating chunks
+  const data = Buffer.allocUnsafe(length);
+  let offset = 0;
+  for await (const chunk of req) {
+    const piece = chunk as Buffer;
+    if (offset + piece.length > length) {
+      throw createApiError('Body longer than Content-Length', 'INVALID_REQUEST', 400);
+    }
+    piece.copy(data, offset);
+    offset += piece.length;
+  }
+  if (offset !== length) {
+    throw createApiError('Body shorter than Content-Length', 'INVALID_REQUEST', 400);
+  }
+
+  const transfer = await blobTransferService.download(handle, port, id, data);
+
+  res.json({
+    success: true,
+    data: {
+      transferId: transfer.id,
+      blobId: transfer.blobId,
+      port: transfer.port,
+      bytesWritten: transfer.position,
+      durationMs:
+        (transfer.finishedAt || new Date()).getTime() -
+        transfer.startedAt.getTime(),
+    },
+  });
+});
+
+/**
+ * GET /api/v1/data/blob/transfers
+ * List running and recent BLOB transfers
+ */
+export const listBlobTransfers = asyncHandler(async (req: Request, res: Response) => {
+  const transfers = blobTransferService.getTransfers();
+
+  res.json({
+    success: true,
+    data: transfers,
+    count: transfers.length,
+  });
+});
+
+/**
+ * DELETE /api/v1/data/blob/transfers/:transferId
+ * Abort a running BLOB transfer (BLOB_Abort after the current step)
+ */
+export const abortBlobTransfer = asyncHandler(async (req: Request, res: Response) => {
+  const { transferId } = req.params;
+
+  if (!blobTransferService.abort(transferId)) {
+    throw createApiError(
+      `No running BLOB transfer: ${transferId}`,
+      'BLOB_TRANSFER_NOT_FOUND',
+      404
+    );
+  }
+
+  res.json({
+    success: true,
+    message: `Abort requested for BLOB transfer ${transferId}`,
+  });
+});
@@ -6,12 +6,44 @@
 
 import { Request, Response } from "express";
 import DeviceManager from "../services/DeviceManager";
+import MasterWatcher from "../services/MasterWatcher";
+import FirmwareUpdateService from "../services/FirmwareUpdateService";
+import DataStorageService from "../services/DataStorageService";
+import LinkQualityService from "../services/LinkQualityService";
+import MasterClockService from "../services/MasterClockService";
 import logger from "../utils/logger";
-import { asyncHandler } from "../middleware/errorHandler";
+import { asyncHandler, createApiError } from "../middleware/errorHandler";
+import { LIMITS } from "../utils/constants";
+import {
+  formatPrometheus,
+  latencyRegistry,
+  PROMETHEUS_CONTENT_TYPE,
+} from "../utils/diagnostics";
+import { tracer } from "../utils/tracing";
+import {
+  ARROW_STREAM_CONTENT_TYPE,
+  eventsArrow,
+  linkStatisticsArrow,
+} from "../utils/captureExport";
 
 // Singleton DeviceManager instance
 export const deviceManager = new DeviceManager();
 
+// USB hot-plug watcher for the shared DeviceManager (started by the server)
+export const masterWatcher = new MasterWatcher(deviceManager);
+
+// Fleet firmware updates share the DeviceManager's DLL wrapper
+export const firmwareUpdateService = new FirmwareUpdateService(deviceManager);
+
+// Content-addressed data storage backups (DS_STORE_DIR)
+export const dataStorageService = new DataStorageService(deviceManager);
+
+// Statistic counter / power sampler (started by the server)
+export const linkQualityService = new LinkQualityService(deviceManager);
+
+// Cycle counter / host clock correlation per master (started by the server)
+export const masterClockService = new MasterClockService(deviceManager);
+
 // ============================================================================
 // MASTER MANAGEMENT ENDPOINTS
 // ============================================================================
@@ -51,6 +83,19 @@ export const getConnectedMasters = asyncHandler(
   }
 );
 
+/**
+ * GET /api/v1/masters/watcher
+ * Get hot-plug watcher status and attach/detach latency metrics
+ */
+export const getMasterWatcherStatus = asyncHandler(
+  async (req: Request, res: Response) => {
+    res.json({
+      success: true,
+      data: masterWatcher.getStatus(),
+    });
+  }
+);
+
 /**
  * POST /api/v1/masters/connect
  * Connect to a specific master
@@ -342,6 +387,11 @@ export const getSystemHealth = asyncHandler(
         connected: connectedDevices.length,
         uptimes: deviceUptimes,
       },
+      portMonitor: deviceManager.getPortMonitorStats(),
+      isdu: deviceManager.getIsduStats(),
+      outputs: deviceManager.getOutputStats(),
+      firmwareUpdates: firmwareUpdateService.getStatus(),
+      logging: logger.getStats(),
     };
 
     res.json({
@@ -350,3 +400,466 @@ export const getSystemHealth = asyncHandler(
     });
   }
 );
+
+// ============================================================================
+// FIRMWARE UPDATE ENDPOINTS
+// ============================================================================
+
+/**
+ * POST /api/v1/firmware/images
+ * Load a firmware image once for use by any number of update jobs
+ * Body: raw image (application/octet-stream), Content-Length required
+ * Query params: ?vendorId=310&hwKey=ABC&passwordRequired=false
+ */
+export const uploadFirmwareImage = asyncHandler(
+  async (req: Request, res: Response) => {
+    const vendorId = parseInt(String(req.query.vendorId || ""));
+    const hwKey = String(req.query.hwKey || "");
+    const length = parseInt(req.headers["content-length"] || "");
+
+    if (!Number.isInteger(vendorId) || vendorId < 0 || vendorId > 0xffff) {
+      throw createApiError("vendorId must be 0-65535", "INVALID_REQUEST", 400);
+    }
+    if (hwKey.length > 64) {
+      throw createApiError("hwKey too long (max 64 characters)", "INVALID_REQUEST", 400);
+    }
+    if (!length || length <= 0) {
+      throw createApiError("Content-Length is required", "INVALID_REQUEST", 411);
+    }
+    if (length > LIMITS.MAX_FIRMWARE_SIZE) {
+      throw createApiError(
+        `Firmware exceeds maximum size of ${LIMITS.MAX_FIRMWARE_SIZE} bytes`,
+        "INVALID_REQUEST",
+        413
+      );
+    }
+
+    // The DLL needs the image as one consecutive block
+    const firmware = Buffer.allocUnsafe(length);
+    let offset = 0;
+    for await (const chunk of req) {
+      const piece = chunk as Buffer;
+      if (offset + piece.length > length) {
+        throw createApiError("Body longer than Content-Length", "INVALID_REQUEST", 400);
+      }
+      piece.copy(firmware, offset);
+      offset += piece.length;
+    }
+    if (offset !== length) {
+      throw createApiError("Body shorter than Content-Length", "INVALID_REQUEST", 400);
+    }
+
+    const image = firmwareUpdateService.registerImage(firmware, {
+      vendorId: vendorId,
+      hwKey: hwKey,
+      passwordRequired: req.query.passwordRequired === "true",
+    });
+
+    res.status(201).json({
+      success: true,
+      data: {
+        imageId: image.id,
+        size: image.size,
+        vendorId: image.vendorId,
+        loadedAt: image.loadedAt,
+      },
+    });
+  }
+);
+
+/**
+ * GET /api/v1/firmware/images
+ * List loaded firmware images
+ */
+export const listFirmwareImages = asyncHandler(
+  async (req: Request, res: Response) => {
+    const images = firmwareUpdateService.getImages();
+
+    res.json({
+      success: true,
+      data: images,
+      count: images.length,
+    });
+  }
+);
+
+/**
+ * DELETE /api/v1/firmware/images/:imageId
+ * Release a firmware image that no running job uses
+ */
+export const removeFirmwareImage = asyncHandler(
+  async (req: Request, res: Response) => {
+    const { imageId } = req.params;
+
+    if (!firmwareUpdateService.removeImage(imageId)) {
+      throw createApiError(
+        `Firmware image not found: ${imageId}`,
+        "FIRMWARE_IMAGE_NOT_FOUND",
+        404
+      );
+    }
+
+    res.json({
+      success: true,
+      message: `Firmware image ${imageId} released`,
+    });
+  }
+);
+
+/**
+ * POST /api/v1/firmware/jobs
+ * Start firmware updates on several ports at once
+ * Body: { targets: [{ masterHandle, port }], imageId | metafile, password? }
+ */
+export const startFirmwareUpdate = asyncHandler(
+  async (req: Request, res: Response) => {
+    const campaign = await firmwareUpdateService.startCampaign(req.body);
+
+    logger.info(
+      `Firmware campaign ${campaign.campaignId} accepted for ${campaign.jobs.length} port(s)`
+    );
+
+    res.status(202).json({
+      success: true,
+      data: {
+        campaignId: campaign.campaignId,
+        jobs: campaign.jobs.map((job) => ({
+          id: job.id,
+          deviceKey: job.deviceKey,
+          state: job.state,
+        })),
+      },
+      message: `Firmware update started on ${campaign.jobs.length} port(s)`,
+    });
+  }
+);
+
+/**
+ * GET /api/v1/firmware/jobs
+ * List running and recent firmware update jobs
+ * Query params: ?campaignId=...
+ */
+export const listFirmwareJobs = asyncHandler(
+  async (req: Request, res: Response) => {
+    const campaignId = req.query.campaignId
+      ? String(req.query.campaignId)
+      : undefined;
+    const jobs = firmwareUpdateService.getJobs(campaignId);
+
+    res.json({
+      success: true,
+      data: jobs,
+      count: jobs.length,
+    });
+  }
+);
+
+/**
+ * GET /api/v1/firmware/jobs/:jobId
+ * Get progress of a firmware update job
+ */
+export const getFirmwareJob = asyncHandler(
+  async (req: Request, res: Response) => {
+    const { jobId } = req.params;
+    const job = firmwareUpdateService.getJob(jobId);
+
+    if (!job) {
+      throw createApiError(
+        `Firmware job not found: ${jobId}`,
+        "FIRMWARE_JOB_NOT_FOUND",
+        404
+      );
+    }
+
+    res.json({
+      success: true,
+      data: job,
+    });
+  }
+);
+
+/**
+ * DELETE /api/v1/firmware/jobs/:jobId
+ * Abort a running firmware update (IOL_FwUpdateAbort after the current step)
+ */
+export const abortFirmwareJob = asyncHandler(
+  async (req: Request, res: Response) => {
+    const { jobId } = req.params;
+
+    if (!firmwareUpdateService.abort(jobId)) {
+      throw createApiError(
+        `No running firmware job: ${jobId}`,
+        "FIRMWARE_JOB_NOT_FOUND",
+        404
+      );
+    }
+
+    res.json({
+      success: true,
+      message: `Abort requested for firmware job ${jobId}`,
+    });
+  }
+);
+
+// ============================================================================
+// DATA STORAGE ENDPOINTS
+// ============================================================================
+
+/**
+ * POST /api/v1/datastorage/backups
+ * Back up the data storage of all (or the given) ports in parallel
+ * Body: { targets?: [{ masterHandle, port }], refresh?: false }
+ */
+export const createDataStorageBackup = asyncHandler(
+  async (req: Request, res: Response) => {
+    const { targets, refresh } = req.body;
+
+    const manifest = await dataStorageService.backup(targets, { refresh });
+
+    res.status(201).json({
+      success: manifest.failures.length === 0,
+      data: manifest,
+      message: `Backed up ${manifest.entries.length} of ${manifest.stats.ports} port(s)`,
+    });
+  }
+);
+
+/**
+ * GET /api/v1/datastorage/backups
+ * List data storage backups and store usage
+ */
+export const listDataStorageBackups = asyncHandler(
+  async (req: Request, res: Response) => {
+    const backups = await dataStorageService.listBackups();
+
+    res.json({
+      success: true,
+      data: backups,
+      count: backups.length,
+      store: await dataStorageService.getStoreStats(),
+    });
+  }
+);
+
+/**
+ * GET /api/v1/datastorage/backups/:backupId
+ * Get a backup manifest
+ */
+export const getDataStorageBackup = asyncHandler(
+  async (req: Request, res: Response) => {
+    const manifest = await dataStorageService.getBackup(req.params.backupId);
+
+    res.json({
+      success: true,
+      data: manifest,
+    });
+  }
+);
+
+/**
+ * POST /api/v1/datastorage/backups/:backupId/restore
+ * Restore a backup; ports whose content already matches are left alone
+ * Body: { targets?: [{ masterHandle, port, sourcePort?, sourceMaster? }], refresh?: false }
+ */
+export const restoreDataStorageBackup = asyncHandler(
+  async (req: Request, res: Response) => {
+    const { backupId } = req.params;
+    const { targets, refresh } = req.body;
+
+    const result = await dataStorageService.restore(backupId, targets, {
+      refresh,
+    });
+    const failed = result.outcomes.filter((o) => o.status === "failed").length;
+
+    res.json({
+      success: failed === 0,
+      data: result,
+      summary: {
+        restored: result.outcomes.filter((o) => o.status === "restored").length,
+        unchanged: result.outcomes.filter((o) => o.status === "unchanged").length,
+        skipped: result.outcomes.filter((o) => o.status === "skipped").length,
+        failed: failed,
+      },
+    });
+  }
+);
+
+// ============================================================================
+// LINK QUALITY ENDPOINTS
+// ============================================================================
+
+/**
+ * GET /api/v1/diagnostics/link-quality
+ * Per-port retry/abort rates and master power over the recent window
+ * Query params: ?window=30 (samples)
+ */
+export const getLinkQuality = asyncHandler(
+  async (req: Request, res: Response) => {
+    const window = parseInt(String(req.query.window || ""), 10) || undefined;
+
+    res.json({
+      success: true,
+      data: linkQualityService.getSummary(window),
+      sampler: linkQualityService.getStatus(),
+    });
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/clocks
+ * Per-master cycle duration, drift and latency from cycle counter correlation
+ */
+export const getMasterClocks = asyncHandler(
+  async (req: Request, res: Response) => {
+    res.json({
+      success: true,
+      data: masterClockService.getClocks(),
+      sampler: masterClockService.getStatus(),
+    });
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/link-quality/:masterHandle/:deviceId
+ * Sample history of one port
+ * Query params: ?limit=100
+ */
+export const getPortLinkQuality = asyncHandler(
+  async (req: Request, res: Response) => {
+    const handle = parseInt(req.params.masterHandle);
+    const port = parseInt(req.params.deviceId);
+    const limit = parseInt(String(req.query.limit || ""), 10) || undefined;
+
+    const samples = linkQualityService.getPortHistory(handle, port, limit);
+    if (!samples) {
+      throw createApiError(
+        `No link quality samples for master ${handle} port ${port}`,
+        "DEVICE_NOT_FOUND",
+        404
+      );
+    }
+
+    res.json({
+      success: true,
+      data: {
+        masterHandle: handle,
+        port: port,
+        samples: samples,
+        power: linkQualityService.getMasterHistory(handle, limit),
+      },
+      count: samples.length,
+    });
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/link-quality/metrics
+ * Link quality in Prometheus text format
+ */
+export const getLinkQualityMetrics = asyncHandler(
+  async (req: Request, res: Response) => {
+    res.type(PROMETHEUS_CONTENT_TYPE);
+    res.send(formatPrometheus(linkQualityService.getPrometheusMetrics()));
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/link-quality/export
+ * All retained link quality samples as an Arrow IPC stream
+ */
+export const exportLinkQuality = asyncHandler(
+  async (req: Request, res: Response) => {
+    res.type(ARROW_STREAM_CONTENT_TYPE);
+    res.setHeader("Content-Disposition", 'attachment; filename="link-quality.arrows"');
+    res.send(Buffer.concat(linkStatisticsArrow(linkQualityService.getAllPortSamples())));
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/events/export
+ * Master events as an Arrow IPC stream
+ * Query params: ?since=<epoch ms>
+ */
+export const exportEvents = asyncHandler(
+  async (req: Request, res: Response) => {
+    const since = parseInt(String(req.query.since || ""), 10) || 0;
+
+    res.type(ARROW_STREAM_CONTENT_TYPE);
+    res.setHeader("Content-Disposition", 'attachment; filename="events.arrows"');
+    res.send(Buffer.concat(eventsArrow(deviceManager.getEventLog(since))));
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/latency
+ * Latency percentiles per DLL function, route and socket event
+ * Query params: ?family=iolink_dll_call_duration_seconds
+ */
+export const getLatency = asyncHandler(async (req: Request, res: Response) => {
+  const family =
+    typeof req.query.family === "string" ? req.query.family : undefined;
+
+  res.json({
+    success: true,
+    data: latencyRegistry.toJSON(family),
+  });
+});
+
+/**
+ * DELETE /api/v1/diagnostics/latency
+ * Reset all latency histograms
+ */
+export const resetLatency = asyncHandler(
+  async (req: Request, res: Response) => {
+    latencyRegistry.reset();
+    logger.info("Latency histograms reset");
+
+    res.json({
+      success: true,
+      message: "Latency histograms reset",
+    });
+  }
+);
+
+/**
+ * GET /api/v1/diagnostics/tracing
+ * Tracing status (sample rate, trace file, span counts)
+ */
+export const getTracing = asyncHandler(async (req: Request, res: Response) => {
+  res.json({
+    success: true,
+    data: tracer.getStatus(),
+  });
+});
+
+/**
+ * PUT /api/v1/diagnostics/tracing
+ * Enable or disable sampled request tracing
+ */
+export const configureTracing = asyncHandler(
+  async (req: Request, res: Response) => {
+    const { enabled, sampleRate } = req.body;
+
+    await tracer.configure({ enabled, sampleRate });
+
+    res.json({
+      success: true,
+      data: tracer.getStatus(),
+      message: enabled ? "Tracing enabled" : "Tracing disabled",
+    });
+  }
+);
+
+/**
+ * GET /metrics
+ * Prometheus scrape endpoint (latency histograms and link quality)
+ */
+export const getMetrics = asyncHandler(async (req: Request, res: Response) => {
+  res.type(PROMETHEUS_CONTENT_TYPE);
+  res.send(
+    formatPrometheus([
+      ...latencyRegistry.toPrometheus(),
+      ...linkQualityService.getPrometheusMetrics(),
+    ])
+  );
+});
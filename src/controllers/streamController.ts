@@ -6,8 +6,10 @@
 
 import { Socket, Server as SocketIOServer } from 'socket.io';
 import { deviceManager } from './deviceController';
+import ParameterSubscriptionManager from '../services/ParameterSubscriptionManager';
 import logger from '../utils/logger';
 import { LIMITS } from '../utils/constants';
+import { timedSocketHandler } from '../utils/diagnostics';
 
 // ============================================================================
 // TYPE DEFINITIONS
@@ -29,17 +31,31 @@ interface SubscriptionData {
   masterHandle?: number;
   deviceId?: number;
   interval?: number;
+  minInterval?: number;
+  maxInterval?: number;
   parameterIndex?: number;
   subIndex?: number;
   type?: string;
   deviceKey?: string;
 }
 
+interface ProcessDataWriteData {
+  masterHandle?: number;
+  deviceId?: number;
+  data?: number[];
+  confirm?: boolean;
+}
+
 // Active streams tracking
 export const activeStreams = new Map<string, StreamInfo>();
 export const deviceStreams = new Map<string, Set<string>>();
 export const streamIntervals = new Map<string, NodeJS.Timeout>();
 
+// One shared poller per subscribed parameter
+export const parameterSubscriptions = new ParameterSubscriptionManager(
+  deviceManager
+);
+
 // ============================================================================
 // WEBSOCKET EVENT HANDLERS
 // ============================================================================
@@ -50,6 +66,10 @@ export const streamIntervals = new Map<string, NodeJS.Timeout>();
 export function handleConnection(socket: Socket, io: SocketIOServer): void {
   logger.info(`WebSocket client connected: ${socket.id}`);
 
+  parameterSubscriptions.setPublisher((room, event, payload) =>
+    io.to(room).emit(event, payload)
+  );
+
   // Send welcome message
   socket.emit('connected', {
     socketId: socket.id,
@@ -58,34 +78,50 @@ export function handleConnection(socket: Socket, io: SocketIOServer): void {
   });
 
   // Handle device data subscription
-  socket.on('subscribe:device', (data: SubscriptionData) => {
-    handleDeviceSubscription(socket, io, data);
-  });
+  socket.on(
+    'subscribe:device',
+    timedSocketHandler('subscribe:device', (data: SubscriptionData) => handleDeviceSubscription(socket, io, data))
+  );
 
   // Handle parameter subscription
-  socket.on('subscribe:parameter', (data: SubscriptionData) => {
-    handleParameterSubscription(socket, io, data);
-  });
+  socket.on(
+    'subscribe:parameter',
+    timedSocketHandler('subscribe:parameter', (data: SubscriptionData) => handleParameterSubscription(socket, io, data))
+  );
 
   // Handle process data subscription
-  socket.on('subscribe:process-data', (data: SubscriptionData) => {
-    handleProcessDataSubscription(socket, io, data);
-  });
+  socket.on(
+    'subscribe:process-data',
+    timedSocketHandler('subscribe:process-data', (data: SubscriptionData) => handleProcessDataSubscription(socket, io, data))
+  );
+
+  // Handle process data writes
+  socket.on(
+    'write:process-data',
+    timedSocketHandler(
+      'write:process-data',
+      (data: ProcessDataWriteData, ack?: (result: any) => void) =>
+        handleProcessDataWrite(socket, data, ack)
+    )
+  );
 
   // Handle unsubscription
-  socket.on('unsubscribe', (data: SubscriptionData) => {
-    handleUnsubscription(socket, data);
-  });
+  socket.on(
+    'unsubscribe',
+    timedSocketHandler('unsubscribe', (data: SubscriptionData) => handleUnsubscription(socket, data))
+  );
 
   // Handle unsubscribe all
-  socket.on('unsubscribe:all', () => {
-    handleUnsubscribeAll(socket);
-  });
+  socket.on(
+    'unsubscribe:all',
+    timedSocketHandler('unsubscribe:all', () => handleUnsubscribeAll(socket))
+  );
 
   // Handle get active subscriptions
-  socket.on('get:subscriptions', () => {
-    handleGetSubscriptions(socket);
-  });
+  socket.on(
+    'get:subscriptions',
+    timedSocketHandler('get:subscriptions', () => handleGetSubscriptions(socket))
+  );
 
   // Handle disconnection
   socket.on('disconnect', () => {
@@ -220,9 +256,19 @@ function handleParameterSubscription(socket: Socket, io: SocketIOServer, data: S
       return;
     }
 
-    const validInterval = Math.max(
-      LIMITS.STREAM_INTERVAL_MIN,
-      Math.min(interval, LIMITS.STREAM_INTERVAL_MAX)
+    // "interval" is the staleness bound; unchanged values are polled less
+    // often, down to maxInterval, and changing ones up to minInterval
+    const clampInterval = (value: number) =>
+      Math.max(
+        LIMITS.STREAM_INTERVAL_MIN,
+        Math.min(value, LIMITS.STREAM_INTERVAL_MAX)
+      );
+    const validInterval = clampInterval(interval);
+    const minInterval = clampInterval(
+      Math.min(data.minInterval ?? validInterval, validInterval)
+    );
+    const maxInterval = clampInterval(
+      Math.max(data.maxInterval ?? validInterval * 10, validInterval)
     );
 
     // Join parameter room
@@ -244,19 +290,15 @@ function handleParameterSubscription(socket: Socket, io: SocketIOServer, data: S
 
     activeStreams.set(streamId, streamInfo);
 
-    // Start parameter streaming
-    if (!streamIntervals.has(roomName)) {
-      startParameterStreaming(
-        deviceKey,
-        handle,
-        port,
-        index,
-        sub,
-        validInterval,
-        io,
-        roomName
-      );
-    }
+    // Attach to the shared poller for this parameter
+    const lastValue = parameterSubscriptions.subscribe(
+      roomName,
+      deviceKey,
+      index,
+      sub,
+      socket.id,
+      { minInterval, maxInterval }
+    );
 
     socket.emit('subscribed', {
       type: 'parameter',
@@ -264,9 +306,16 @@ function handleParameterSubscription(socket: Socket, io: SocketIOServer, data: S
       parameterIndex: index,
       subIndex: sub,
       interval: validInterval,
+      minInterval: minInterval,
+      maxInterval: maxInterval,
       timestamp: new Date().toISOString(),
     });
 
+    // New subscribers get the current value without waiting for a change
+    if (lastValue) {
+      socket.emit('parameter:value', lastValue);
+    }
+
     logger.info(
       `WebSocket ${socket.id} subscribed to parameter ${index}.${sub} on device ${deviceKey}`
     );
@@ -430,66 +479,6 @@ function startDeviceStreaming(deviceKey: string, handle: number, port: number, i
   logger.info(`Started device streaming for ${deviceKey} (${interval}ms)`);
 }
 
-function startParameterStreaming(
-  deviceKey: string,
-  handle: number,
-  port: number,
-  index: number,
-  subIndex: number,
-  interval: number,
-  io: SocketIOServer,
-  roomName: string
-): void {
-  const intervalId = setInterval(async () => {
-    try {
-      const result = await deviceManager.readDeviceParameter(
-        deviceKey,
-        index,
-        subIndex
-      );
-
-      // Try to parse the value
-      let parsedValue: any = result.data;
-      try {
-        const parameterMap = deviceManager.parameters.get(deviceKey);
-        const parameter = parameterMap?.get(`${index}.${subIndex}`);
-        if (parameter) {
-          parsedValue = parameter.parseValue(result.data);
-        }
-      } catch (error: any) {
-        logger.debug(`Could not parse parameter value: ${error.message}`);
-      }
-
-      io.to(roomName).emit('parameter:value', {
-        deviceKey: deviceKey,
-        index: index,
-        subIndex: subIndex,
-        rawData: Array.from(result.data),
-        rawDataHex: result.data.toString('hex').toUpperCase(),
-        parsedValue: parsedValue,
-        timestamp: result.timestamp,
-      });
-    } catch (error: any) {
-      logger.error(
-        `Parameter streaming error for ${deviceKey} param ${index}.${subIndex}:`,
-        error.message
-      );
-      io.to(roomName).emit('parameter:error', {
-        deviceKey: deviceKey,
-        index: index,
-        subIndex: subIndex,
-        error: error.message,
-        timestamp: new Date().toISOString(),
-      });
-    }
-  }, interval);
-
-  streamIntervals.set(roomName, intervalId);
-  logger.info(
-    `Started parameter streaming for ${deviceKey} param ${index}.${subIndex} (${interval}ms)`
-  );
-}
-
 function startProcessDataStreaming(
   deviceKey: string,
   handle: number,
@@ -533,6 +522,56 @@ function startProcessDataStreaming(
 // UNSUBSCRIPTION HANDLERS
 // ============================================================================
 
+/**
+ * Post outputs to a port. Writes share the port's output slot with the
+ * REST endpoint, so a client sending every slider position only has the
+ * newest one written each cycle. The result goes to the ack callback if
+ * the client passed one; errors go to 'error' otherwise.
+ */
+async function handleProcessDataWrite(
+  socket: Socket,
+  data: ProcessDataWriteData,
+  ack?: (result: any) => void
+): Promise<void> {
+  const fail = (message: string) => {
+    const payload = { success: false, message, timestamp: new Date().toISOString() };
+    if (ack) ack(payload);
+    else socket.emit('error', payload);
+  };
+
+  const { masterHandle, deviceId, data: bytes, confirm = false } = data || {};
+  if (
+    !masterHandle ||
+    !deviceId ||
+    !Array.isArray(bytes) ||
+    bytes.length > LIMITS.MAX_PROCESS_DATA_LENGTH ||
+    bytes.some((byte) => !Number.isInteger(byte) || byte < 0 || byte > 255)
+  ) {
+    fail('masterHandle, deviceId and data (up to 32 bytes) are required');
+    return;
+  }
+
+  try {
+    const result = await deviceManager.writeProcessData(
+      parseInt(masterHandle.toString()),
+      parseInt(deviceId.toString()),
+      bytes,
+      confirm === true
+    );
+    if (ack) {
+      ack({
+        success: true,
+        port: result.port,
+        sequence: result.sequence,
+        timestamp: result.timestamp,
+        commit: result.commit,
+      });
+    }
+  } catch (error: any) {
+    fail(error.message);
+  }
+}
+
 function handleUnsubscription(socket: Socket, data: SubscriptionData): void {
   const { type, deviceKey, parameterIndex, subIndex } = data;
 
@@ -606,6 +645,8 @@ function unsubscribeStream(socket: Socket, streamId: string, roomOrDeviceKey: st
         }
       }
     }
+  } else if (streamInfo.type === 'parameter') {
+    parameterSubscriptions.unsubscribe(roomOrDeviceKey, socket.id);
   } else {
     // Check if there are other subscribers to this room
     const room = (socket as any).adapter.rooms.get(roomOrDeviceKey);
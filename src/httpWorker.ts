@@ -0,0 +1,233 @@
+/**
+ * HTTP Worker Entry Point
+ * Stateless API worker serving reads from the owner's process image
+ *
+ */
+
+import http from 'http';
+import net from 'net';
+import express, { Application, Request, Response, NextFunction } from 'express';
+import cors from 'cors';
+import helmet from 'helmet';
+import rateLimit from 'express-rate-limit';
+import { errorHandler } from './middleware/errorHandler';
+import {
+  authenticateApiKey,
+  requireReadAccess,
+  authorizeDeviceAccess,
+  addSecurityHeaders,
+} from './middleware/auth';
+import { validateMasterHandle, validateDeviceId } from './middleware/validation';
+import { requestLatency } from './utils/diagnostics';
+import { LIMITS } from './utils/constants';
+import { OwnerRateLimitStore } from './utils/rateLimitStore';
+import logger from './utils/logger';
+import type { ProcessImageBatch, ProcessImageEntry } from './services/ProcessImagePublisher';
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+// This process never loads the DLL: everything it cannot answer from the
+// process image is forwarded to the owner process on the loopback interface
+const PORT = parseInt(process.env.PORT || '3000', 10);
+const HOST = process.env.HOST || '0.0.0.0';
+const OWNER_HOST = '127.0.0.1';
+const OWNER_PORT = parseInt(process.env.OWNER_PORT || String(PORT + 1), 10);
+
+// ============================================================================
+// PROCESS IMAGE REPLICA
+// ============================================================================
+
+const processImage = new Map<string, ProcessImageEntry>();
+let imageSeq = 0;
+let imageReceivedAt = 0;
+let imageIntervalMs: number = LIMITS.PROCESS_IMAGE_INTERVAL_DEFAULT;
+
+process.on('message', (message: any) => {
+  if (message?.type !== 'process-image') return;
+
+  const batch = message as ProcessImageBatch;
+  if (batch.seq <= imageSeq) return;
+
+  processImage.clear();
+  for (const entry of batch.entries) {
+    processImage.set(`${entry.masterHandle}:${entry.port}`, entry);
+  }
+  imageSeq = batch.seq;
+  imageIntervalMs = batch.intervalMs;
+  imageReceivedAt = Date.now();
+});
+
+function isImageFresh(): boolean {
+  return (
+    imageSeq > 0 &&
+    Date.now() - imageReceivedAt <= imageIntervalMs * LIMITS.PROCESS_IMAGE_STALE_FACTOR
+  );
+}
+
+// ============================================================================
+// OWNER PROXY
+// ============================================================================
+
+/**
+ * Forward a request unchanged to the owner process
+ */
+function proxyToOwner(req: Request, res: Response): void {
+  const forwardedFor = req.headers['x-forwarded-for']
+    ? `${req.headers['x-forwarded-for']}, ${req.socket.remoteAddress}`
+    : req.socket.remoteAddress || '';
+
+  const upstream = http.request(
+    {
+      host: OWNER_HOST,
+      port: OWNER_PORT,
+      method: req.method,
+      path: req.originalUrl,
+      headers: { ...req.headers, 'x-forwarded-for': forwardedFor },
+    },
+    (ownerRes) => {
+      res.writeHead(ownerRes.statusCode || 502, ownerRes.headers);
+      ownerRes.pipe(res);
+    }
+  );
+
+  upstream.on('error', (error) => {
+    logger.error(`Owner request failed: ${error.message}`);
+    if (!res.headersSent) {
+      res.status(502).json({
+        success: false,
+        error: 'OWNER_UNAVAILABLE',
+        message: 'Device owner process is not reachable',
+      });
+    } else {
+      res.destroy();
+    }
+  });
+
+  req.pipe(upstream);
+}
+
+/**
+ * Forward WebSocket upgrades (Socket.IO) to the owner as a raw TCP tunnel
+ */
+function proxyUpgrade(req: http.IncomingMessage, socket: net.Socket, head: Buffer): void {
+  const upstream = net.connect(OWNER_PORT, OWNER_HOST, () => {
+    const headers = Object.entries(req.headers)
+      .map(([name, value]) => `${name}: ${Array.isArray(value) ? value.join(', ') : value}`)
+      .join('\r\n');
+    upstream.write(`${req.method} ${req.url} HTTP/${req.httpVersion}\r\n${headers}\r\n\r\n`);
+    if (head.length > 0) upstream.write(head);
+    socket.pipe(upstream).pipe(socket);
+  });
+
+  upstream.on('error', () => socket.destroy());
+  socket.on('error', () => upstream.destroy());
+}
+
+// ============================================================================
+// APPLICATION
+// ============================================================================
+
+const app: Application = express();
+
+app.use(helmet({ contentSecurityPolicy: false, crossOriginEmbedderPolicy: false }));
+app.use(
+  cors({
+    origin: process.env.CORS_ORIGIN || '*',
+    methods: ['GET', 'POST', 'PUT', 'DELETE', 'OPTIONS'],
+    allowedHeaders: ['Content-Type', 'Authorization', 'X-API-Key', 'X-User-Role'],
+    credentials: true,
+  })
+);
+app.use(addSecurityHeaders);
+app.use(requestLatency);
+
+// Rate limit for requests answered here. The hits are counted in the owner's
+// global limiter store, so a client has one budget across all workers and
+// the owner; proxied requests are limited by the owner itself, which sees
+// the client address through X-Forwarded-For
+const replicaLimiter = rateLimit({
+  windowMs: 15 * 60 * 1000,
+  store: new OwnerRateLimitStore(),
+  // Keep serving reads if the owner cannot be asked
+  passOnStoreError: true,
+  max: (req: Request) => {
+    switch (req.headers['x-user-role']) {
+      case 'admin':
+        return 1000;
+      case 'operator':
+        return 500;
+      default:
+        return 200;
+    }
+  },
+  message: {
+    success: false,
+    error: 'TOO_MANY_REQUESTS',
+    message: 'Too many requests, please try again later',
+    retryAfter: '15 minutes',
+  },
+  standardHeaders: true,
+  legacyHeaders: false,
+});
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/process
+ * Read process data from the process image (owner fallback when stale)
+ */
+app.get(
+  '/api/v1/data/:masterHandle/:deviceId/process',
+  (req: Request, res: Response, next: NextFunction) => {
+    const entry = isImageFresh()
+      ? processImage.get(`${req.params.masterHandle}:${req.params.deviceId}`)
+      : undefined;
+    if (!entry) return proxyToOwner(req, res);
+    res.locals.processImageEntry = entry;
+    next();
+  },
+  replicaLimiter,
+  authenticateApiKey,
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  (req: Request, res: Response) => {
+    const entry: ProcessImageEntry = res.locals.processImageEntry;
+    // Buffers arrive as plain Uint8Arrays over IPC
+    const data = Buffer.from(entry.data.buffer, entry.data.byteOffset, entry.data.length);
+
+    res.json({
+      success: true,
+      data: {
+        port: entry.port,
+        data: Array.from(data),
+        dataHex: data.toString('hex').toUpperCase(),
+        length: data.length,
+        status: entry.status,
+        timestamp: entry.timestamp,
+      },
+    });
+  }
+);
+
+// Everything else is answered by the owner
+app.use(proxyToOwner);
+
+app.use(errorHandler);
+
+// ============================================================================
+// SERVER STARTUP
+// ============================================================================
+
+const server = http.createServer(app);
+server.on('upgrade', proxyUpgrade);
+
+server.listen(PORT, HOST, () => {
+  logger.info(`HTTP worker ${process.pid} listening on ${HOST}:${PORT} (owner ${OWNER_HOST}:${OWNER_PORT})`);
+});
+
+process.on('SIGTERM', () => {
+  server.close(() => process.exit(0));
+  setTimeout(() => process.exit(0), 5000).unref();
+});
@@ -7,6 +7,7 @@
 import { Request, Response, NextFunction } from 'express';
 import logger from '../utils/logger';
 import { API_ERROR_CODES, RETURN_CODES } from '../utils/constants';
+import { traceAsync } from '../utils/tracing';
 
 interface CustomError extends Error {
   code?: number;
@@ -20,7 +21,7 @@ interface CustomError extends Error {
  * Async wrapper to catch errors in async route handlers
  */
 export const asyncHandler = (fn: Function) => (req: Request, res: Response, next: NextFunction) => {
-  Promise.resolve(fn(req, res, next)).catch(next);
+  traceAsync('handler', 'controller', async () => fn(req, res, next)).catch(next);
 };
 
 /**
@@ -168,6 +169,8 @@ export function mapDllErrorToHttpStatus(dllCode: number): number {
       return 404;
     case RETURN_CODES.RETURN_UNKNOWN_HANDLE:
       return 404;
+    case RETURN_CODES.RETURN_CONNECTION_LOST:
+      return 503;
     case RETURN_CODES.RETURN_WRONG_PARAMETER:
       return 400;
     case RETURN_CODES.RETURN_INTERNAL_ERROR:
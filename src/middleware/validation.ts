@@ -6,7 +6,9 @@
 
 import Joi from "joi";
 import { Request, Response, NextFunction } from "express";
-import { isValidPort } from "../utils/constants";
+import { performance } from "perf_hooks";
+import { isValidPort, LIMITS } from "../utils/constants";
+import { tracer } from "../utils/tracing";
 
 // ============================================================================
 // TYPE DEFINITIONS
@@ -36,6 +38,15 @@ declare global {
 // VALIDATION SCHEMAS
 // ============================================================================
 
+// Optional point in time given as epoch milliseconds or an ISO 8601 date
+const timeQuery = (name: string) =>
+  Joi.alternatives()
+    .try(Joi.number().min(0), Joi.date().iso())
+    .optional()
+    .messages({
+      "alternatives.match": `${name} must be epoch milliseconds or an ISO 8601 date`,
+    });
+
 const schemas = {
   // Device ID validation (port number)
   deviceId: Joi.object({
@@ -130,6 +141,8 @@ const schemas = {
           "Data must be a byte array or string (max 32 bytes)",
         "any.required": "Process data is required",
       }),
+    // Wait until the value has been written to the master
+    confirm: Joi.boolean().default(false),
   }),
 
   // Master connection validation
@@ -198,6 +211,231 @@ const schemas = {
         "array.base": "Parameters must be an array",
       }),
   }),
+
+  // Data storage backup validation
+  dataStorageBackup: Joi.object({
+    targets: Joi.array()
+      .items(
+        Joi.object({
+          masterHandle: Joi.number().integer().min(0).required(),
+          port: Joi.number().integer().min(1).max(8).required(),
+        })
+      )
+      .optional()
+      .messages({
+        "array.base": "Targets must be an array",
+      }),
+    refresh: Joi.boolean().optional().default(false),
+  }),
+
+  // Data storage restore validation
+  dataStorageRestore: Joi.object({
+    targets: Joi.array()
+      .items(
+        Joi.object({
+          masterHandle: Joi.number().integer().min(0).required(),
+          port: Joi.number().integer().min(1).max(8).required(),
+          sourcePort: Joi.number().integer().min(1).max(8).optional(),
+          sourceMaster: Joi.string().min(1).max(100).optional(),
+        })
+      )
+      .optional()
+      .messages({
+        "array.base": "Targets must be an array",
+      }),
+    refresh: Joi.boolean().optional().default(false),
+  }),
+
+  // Tracing configuration validation
+  tracingConfig: Joi.object({
+    enabled: Joi.boolean().required().messages({
+      "any.required": "enabled is required",
+    }),
+    sampleRate: Joi.number().min(0).max(1).optional().messages({
+      "number.min": "Sample rate must be between 0 and 1",
+      "number.max": "Sample rate must be between 0 and 1",
+    }),
+  }),
+
+  // Cyclic process data period validation
+  processDataPeriod: Joi.object({
+    periodMs: Joi.number()
+      .min(LIMITS.PROCESS_DATA_PERIOD_MIN)
+      .max(LIMITS.PROCESS_DATA_PERIOD_MAX)
+      .required()
+      .messages({
+        "number.base": "periodMs must be a number",
+        "number.min": `periodMs must be at least ${LIMITS.PROCESS_DATA_PERIOD_MIN}`,
+        "number.max": `periodMs must not exceed ${LIMITS.PROCESS_DATA_PERIOD_MAX}`,
+        "any.required": "periodMs is required",
+      }),
+  }),
+
+  // Process data logging start validation
+  dataLogging: Joi.object({
+    ports: Joi.array()
+      .items(Joi.number().integer().min(1).max(8))
+      .min(1)
+      .unique()
+      .required()
+      .messages({
+        "array.base": "Ports must be an array",
+        "array.min": "At least one port is required",
+        "array.unique": "Ports must not repeat",
+        "any.required": "Ports are required",
+      }),
+    sampleTimeUs: Joi.number()
+      .integer()
+      .min(LIMITS.LOGGING_SAMPLE_TIME_MIN)
+      .max(LIMITS.LOGGING_SAMPLE_TIME_MAX)
+      .optional()
+      .default(LIMITS.LOGGING_SAMPLE_TIME_DEFAULT)
+      .messages({
+        "number.min": `sampleTimeUs must be at least ${LIMITS.LOGGING_SAMPLE_TIME_MIN}`,
+        "number.max": `sampleTimeUs must not exceed ${LIMITS.LOGGING_SAMPLE_TIME_MAX}`,
+      }),
+    memorySize: Joi.number()
+      .integer()
+      .min(LIMITS.LOGGING_MEMORY_MIN)
+      .max(LIMITS.LOGGING_MEMORY_MAX)
+      .optional()
+      .messages({
+        "number.min": `memorySize must be at least ${LIMITS.LOGGING_MEMORY_MIN} bytes`,
+        "number.max": `memorySize must not exceed ${LIMITS.LOGGING_MEMORY_MAX} bytes`,
+      }),
+  }),
+
+  // Process data history query validation; from/to are epoch ms or ISO 8601
+  historyQuery: Joi.object({
+    from: timeQuery("from"),
+    to: timeQuery("to"),
+    points: Joi.number()
+      .integer()
+      .min(1)
+      .max(LIMITS.HISTORY_POINTS_MAX)
+      .optional()
+      .default(LIMITS.HISTORY_POINTS_DEFAULT)
+      .messages({
+        "number.min": "points must be at least 1",
+        "number.max": `points must not exceed ${LIMITS.HISTORY_POINTS_MAX}`,
+      }),
+  }),
+
+  // Recorded samples query validation
+  recordingQuery: Joi.object({
+    from: timeQuery("from"),
+    to: timeQuery("to"),
+    limit: Joi.number()
+      .integer()
+      .min(1)
+      .max(LIMITS.RECORDING_SAMPLES_MAX)
+      .optional()
+      .default(LIMITS.RECORDING_SAMPLES_MAX)
+      .messages({
+        "number.max": `limit must not exceed ${LIMITS.RECORDING_SAMPLES_MAX}`,
+      }),
+  }),
+
+  // Process data history channel decoding validation
+  historyChannel: Joi.object({
+    dataType: Joi.string()
+      .valid("uint8", "uint16", "uint32", "int8", "int16", "int32", "float32", "float64", "boolean")
+      .optional()
+      .messages({
+        "any.only": "dataType must be a numeric data type",
+      }),
+    offset: Joi.number()
+      .integer()
+      .min(0)
+      .max(31)
+      .optional()
+      .default(0)
+      .messages({
+        "number.max": "offset must lie within the 32 bytes of process data",
+      }),
+    scale: Joi.number().optional().default(1),
+    bias: Joi.number().optional().default(0),
+  }),
+
+  // Alarm rule validation; the decoding defaults to the port's history decoding
+  rule: Joi.object({
+    type: Joi.string()
+      .valid("threshold", "edge", "rate", "stuck")
+      .required()
+      .messages({
+        "any.only": "type must be threshold, edge, rate or stuck",
+        "any.required": "type is required",
+      }),
+    name: Joi.string().max(100).optional(),
+    decoding: Joi.object({
+      dataType: Joi.string()
+        .valid("uint8", "uint16", "uint32", "int8", "int16", "int32", "float32", "float64", "boolean")
+        .optional()
+        .messages({
+          "any.only": "dataType must be a numeric data type",
+        }),
+      offset: Joi.number().integer().min(0).max(31).optional(),
+      scale: Joi.number().optional(),
+      bias: Joi.number().optional(),
+    }).optional(),
+    direction: Joi.string().valid("above", "below").optional().default("above"),
+    limit: Joi.number()
+      .when("type", { is: Joi.valid("threshold", "rate"), then: Joi.required() })
+      .messages({
+        "any.required": "limit is required for threshold and rate rules",
+      }),
+    hysteresis: Joi.number().min(0).optional().default(0),
+    edge: Joi.string().valid("rising", "falling", "both").optional().default("both"),
+    level: Joi.number().optional().default(0.5),
+    windowMs: Joi.number().integer().min(1).max(3600000).optional().default(100),
+    durationMs: Joi.number()
+      .integer()
+      .min(1)
+      .when("type", { is: "stuck", then: Joi.required() })
+      .messages({
+        "any.required": "durationMs is required for stuck rules",
+      }),
+    tolerance: Joi.number().min(0).optional().default(0),
+  }),
+
+  // Firmware update campaign validation
+  firmwareCampaign: Joi.object({
+    targets: Joi.array()
+      .items(
+        Joi.object({
+          masterHandle: Joi.number().integer().min(0).required(),
+          port: Joi.number().integer().min(1).max(8).required(),
+        })
+      )
+      .min(1)
+      .required()
+      .messages({
+        "array.base": "Targets must be an array",
+        "array.min": "At least one target is required",
+        "any.required": "Targets are required",
+      }),
+    imageId: Joi.string().hex().length(64).optional().messages({
+      "string.hex": "Image ID must be a SHA-256 hex digest",
+      "string.length": "Image ID must be a SHA-256 hex digest",
+    }),
+    // Relative to the server's firmware directory
+    metafile: Joi.string()
+      .min(1)
+      .max(260)
+      .pattern(/^[\\/]|^[A-Za-z]:|(^|[\\/])\.\.([\\/]|$)/, { invert: true })
+      .optional()
+      .messages({
+        "string.max": "Metafile path too long (max 260 characters)",
+        "string.pattern.invert.base":
+          "Metafile must be a relative path inside the firmware directory",
+      }),
+    password: Joi.string().max(64).optional(),
+  })
+    .xor("imageId", "metafile")
+    .messages({
+      "object.xor": "Specify exactly one of imageId or metafile",
+      "object.missing": "Specify exactly one of imageId or metafile",
+    }),
 };
 
 // ============================================================================
@@ -205,10 +443,13 @@ const schemas = {
 // ============================================================================
 
 /**
- * Generic validation middleware factory
+ * Generic validation middleware factory. In sampled requests the schema
+ * check is a "validate" span, ahead of the handler span.
  */
 function validate(schema: Joi.ObjectSchema, property: string = "body") {
   return (req: Request, res: Response, next: NextFunction): void => {
+    const context = tracer.current();
+    const start = context ? performance.now() : 0;
     const dataToValidate =
       property === "params"
         ? req.params
@@ -224,6 +465,13 @@ function validate(schema: Joi.ObjectSchema, property: string = "body") {
       convert: true, // Convert strings to numbers where appropriate
     });
 
+    if (context) {
+      tracer.span(context, "validate", "validation", start, performance.now(), {
+        property,
+        valid: !error,
+      });
+    }
+
     if (error) {
       const validationError: ValidationError = new Error(
         "Validation failed"
@@ -263,6 +511,16 @@ const validateProcessDataWrite = validate(schemas.processDataWrite, "body");
 const validateMasterConnection = validate(schemas.masterConnection, "body");
 const validateQueryParams = validate(schemas.queryParams, "query");
 const validateStreamParams = validate(schemas.streamParams, "body");
+const validateFirmwareCampaign = validate(schemas.firmwareCampaign, "body");
+const validateDataStorageBackup = validate(schemas.dataStorageBackup, "body");
+const validateDataStorageRestore = validate(schemas.dataStorageRestore, "body");
+const validateTracingConfig = validate(schemas.tracingConfig, "body");
+const validateProcessDataPeriod = validate(schemas.processDataPeriod, "body");
+const validateDataLogging = validate(schemas.dataLogging, "body");
+const validateHistoryQuery = validate(schemas.historyQuery, "query");
+const validateHistoryChannel = validate(schemas.historyChannel, "body");
+const validateRecordingQuery = validate(schemas.recordingQuery, "query");
+const validateRule = validate(schemas.rule, "body");
 
 // ============================================================================
 // CUSTOM VALIDATION FUNCTIONS
@@ -387,6 +645,16 @@ export {
   validateMasterConnection,
   validateQueryParams,
   validateStreamParams,
+  validateFirmwareCampaign,
+  validateDataStorageBackup,
+  validateDataStorageRestore,
+  validateTracingConfig,
+  validateProcessDataPeriod,
+  validateDataLogging,
+  validateHistoryQuery,
+  validateHistoryChannel,
+  validateRecordingQuery,
+  validateRule,
   // Custom validation middleware
   validatePortNumber,
   validateMasterExists,
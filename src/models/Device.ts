@@ -177,6 +177,13 @@ class Device {
     this.lastParameterRead = new Date();
   }
 
+  /**
+   * Drop a cached parameter value, e.g. when it is being written
+   */
+  invalidateParameter(index: number, subIndex: number): void {
+    this.parameterCache.delete(`${index}.${subIndex}`);
+  }
+
   /**
    * Get cached parameter value
    */
@@ -6,6 +6,7 @@
  */
 
 import * as ffi from 'ffi-napi';
+import { performance } from 'perf_hooks';
 import * as ref from 'ref-napi';
 import StructType from 'ref-struct-napi';
 import ArrayType from 'ref-array-napi';
@@ -27,6 +28,16 @@ import {
   ParameterOptions,
   StreamingConfig
 } from '../types/iolink';
+import { getMaxMasters, LOGGING_MODES, LOGGING_STATUS } from '../utils/constants';
+import { SampleClock, TimestampQuality } from '../utils/sampleClock';
+import {
+  LoggingEntry,
+  parseLoggingEntries,
+  loggingBufferSize,
+} from '../utils/loggingEntries';
+import { PROCESS_DATA_MAX_LENGTH } from '../utils/processImage';
+import logger from '../utils/logger';
+import { instrumentLibrary, IOLINK_DLL_INSTRUMENTATION } from '../utils/diagnostics';
 
 // ============================================================================
 // TYPE DEFINITIONS
@@ -129,6 +140,9 @@ const iolinkDll = ffi.Library(
   }
 ) as any;
 
+// Per-call latency histograms (function, return code, master, port)
+instrumentLibrary(iolinkDll, IOLINK_DLL_INSTRUMENTATION);
+
 // ============================================================================
 // CONSTANTS
 // ============================================================================
@@ -270,9 +284,8 @@ export interface MasterDeviceInfo {
   viewName: string;
 }
 
-export function discoverMasters(): MasterDeviceInfo[] {
-  const maxDevices = 5;
-  console.log('Searching for IO-Link Master devices...');
+export function discoverMasters(maxDevices: number = getMaxMasters()): MasterDeviceInfo[] {
+  logger.info('Searching for IO-Link Master devices...');
 
   try {
     const structSize = (TDeviceIdentificationStruct as any).size;
@@ -280,7 +293,7 @@ export function discoverMasters(): MasterDeviceInfo[] {
     const deviceBuffer = Buffer.alloc(bufferSize);
 
     const numDevices = iolinkDll.IOL_GetUSBDevices(deviceBuffer, maxDevices);
-    console.log(`Found ${numDevices} devices`);
+    logger.info(`Found ${numDevices} devices`);
 
     if (numDevices <= 0) {
       return [];
@@ -301,13 +314,13 @@ export function discoverMasters(): MasterDeviceInfo[] {
           viewName: extractString(device.ViewName),
         });
       } catch (err: any) {
-        console.error(`Error processing device ${i}:`, err.message);
+        logger.error(`Error processing device ${i}:`, err.message);
       }
     }
 
     return devices;
   } catch (error: any) {
-    console.error('Error in discoverMasters:', error.message);
+    logger.error('Error in discoverMasters:', error.message);
     return [];
   }
 }
@@ -325,13 +338,13 @@ export function connect(deviceName: string): number {
 export function disconnect(handle: number): void {
   try {
     if (!handle || handle <= 0) {
-      console.log(`Skipping disconnect - invalid handle: ${handle}`);
+      logger.debug(`Skipping disconnect - invalid handle: ${handle}`);
       return;
     }
 
     const masterState = masterStates.get(handle);
     if (masterState && masterState.ports) {
-      console.log(`Clearing port configurations for master handle ${handle}...`);
+      logger.debug(`Clearing port configurations for master handle ${handle}...`);
 
       for (const [portNumber, portState] of masterState.ports) {
         if (portState.configured) {
@@ -360,10 +373,10 @@ export function disconnect(handle: number): void {
             );
 
             if (clearResult === RETURN_CODES.RETURN_OK) {
-              console.log(`Port ${portNumber}: Configuration cleared successfully`);
+              logger.debug(`Port ${portNumber}: Configuration cleared successfully`);
             }
           } catch (clearError: any) {
-            console.log(`Port ${portNumber}: Error clearing configuration - ${clearError.message}`);
+            logger.debug(`Port ${portNumber}: Error clearing configuration - ${clearError.message}`);
           }
         }
       }
@@ -373,7 +386,7 @@ export function disconnect(handle: number): void {
     const result = iolinkDll.IOL_Destroy(handle);
     checkReturnCode(result, 'Disconnect');
   } catch (error: any) {
-    console.error(`Error during disconnect:`, error.message);
+    logger.error(`Error during disconnect:`, error.message);
     if (handle && handle > 0) {
       masterStates.delete(handle);
     }
@@ -381,7 +394,7 @@ export function disconnect(handle: number): void {
 }
 
 function resetMaster(handle: number): boolean {
-  console.log(`Resetting master state for handle ${handle}...`);
+  logger.info(`Resetting master state for handle ${handle}...`);
 
   try {
     for (let port = 0; port < 2; port++) {
@@ -408,16 +421,16 @@ function resetMaster(handle: number): boolean {
           port,
           clearConfig.ref()
         );
-        console.log(`Port ${port + 1}: Reset result = ${clearResult}`);
+        logger.debug(`Port ${port + 1}: Reset result = ${clearResult}`);
       } catch (portError: any) {
-        console.log(`Port ${port + 1}: Reset failed - ${portError.message}`);
+        logger.debug(`Port ${port + 1}: Reset failed - ${portError.message}`);
       }
     }
 
-    console.log(`Master reset complete, waiting for stabilization...`);
+    logger.info(`Master reset complete, waiting for stabilization...`);
     return true;
   } catch (error: any) {
-    console.error(`Master reset failed: ${error.message}`);
+    logger.error(`Master reset failed: ${error.message}`);
     return false;
   }
 }
@@ -431,7 +444,7 @@ export async function initializeMaster(
   deviceName: string,
   maxPorts: number = 2
 ): Promise<MasterState> {
-  console.log(`Initializing IO-Link Master: ${deviceName}`);
+  logger.info(`Initializing IO-Link Master: ${deviceName}`);
 
   const registryEntry = globalMasterRegistry.get(deviceName);
   const wasRecentlyConfigured =
@@ -441,7 +454,7 @@ export async function initializeMaster(
   masterStates.set(handle, masterState);
 
   if (wasRecentlyConfigured) {
-    console.log(`Master ${deviceName} was recently configured, skipping port configuration...`);
+    logger.info(`Master ${deviceName} was recently configured, skipping port configuration...`);
 
     for (let port = 1; port <= maxPorts; port++) {
       const portState = new PortState(port);
@@ -453,11 +466,11 @@ export async function initializeMaster(
 
     masterState.initialized = true;
     masterState.configurationComplete = true;
-    console.log(`Master ${deviceName} initialization complete (using existing configuration)`);
+    logger.info(`Master ${deviceName} initialization complete (using existing configuration)`);
     return masterState;
   }
 
-  console.log(`Configuring ${maxPorts} ports for IO-Link operation...`);
+  logger.info(`Configuring ${maxPorts} ports for IO-Link operation...`);
 
   for (let port = 1; port <= maxPorts; port++) {
     const portState = new PortState(port);
@@ -470,12 +483,12 @@ export async function initializeMaster(
           0x11,
           VALIDATION_MODES.SM_VALIDATION_MODE_NONE
         );
-        console.log(`Port ${port}: Configured for IO-Link operation`);
+        logger.debug(`Port ${port}: Configured for IO-Link operation`);
       } else {
-        console.log(`Port ${port}: Configuration failed or port does not exist`);
+        logger.debug(`Port ${port}: Configuration failed or port does not exist`);
       }
     } catch (error: any) {
-      console.error(`Port ${port}: Configuration error:`, error.message);
+      logger.error(`Port ${port}: Configuration error:`, error.message);
     }
 
     masterState.ports.set(port, portState);
@@ -489,15 +502,15 @@ export async function initializeMaster(
   masterState.initialized = true;
   masterState.configurationComplete = true;
 
-  console.log('Waiting for port stabilization (IO-Link timing requirements)...');
-  console.log(`Stabilization: 5 seconds`);
+  logger.debug('Waiting for port stabilization (IO-Link timing requirements)...');
+  logger.debug(`Stabilization: 5 seconds`);
 
   await new Promise((resolve) => setTimeout(resolve, 5000));
 
-  console.log('Additional device detection wait...');
+  logger.debug('Additional device detection wait...');
   await new Promise((resolve) => setTimeout(resolve, 7000));
 
-  console.log(`Master ${deviceName} initialization complete`);
+  logger.info(`Master ${deviceName} initialization complete`);
   return masterState;
 }
 
@@ -505,7 +518,7 @@ async function configurePortForIOLink(handle: number, port: number): Promise<boo
   try {
     const zeroBasedPort = port - 1;
 
-    console.log(`Port ${port}: Checking current configuration state...`);
+    logger.debug(`Port ${port}: Checking current configuration state...`);
 
     const currentInfo = new (TInfoExStruct as any)();
     const currentModeResult = iolinkDll.IOL_GetModeEx(
@@ -516,15 +529,15 @@ async function configurePortForIOLink(handle: number, port: number): Promise<boo
     );
 
     if (currentModeResult === RETURN_CODES.RETURN_OK) {
-      console.log(`Port ${port}: Current mode = ${currentInfo.ActualMode}, target mode = ${PORT_MODES.IOLINK_OPERATE}`);
+      logger.debug(`Port ${port}: Current mode = ${currentInfo.ActualMode}, target mode = ${PORT_MODES.IOLINK_OPERATE}`);
 
       if (currentInfo.ActualMode === PORT_MODES.IOLINK_OPERATE) {
-        console.log(`Port ${port}: Already in IO-Link operate mode, skipping reconfiguration`);
+        logger.debug(`Port ${port}: Already in IO-Link operate mode, skipping reconfiguration`);
         return true;
       }
 
       if (currentInfo.ActualMode === PORT_MODES.IOLINK_AUTOSTART) {
-        console.log(`Port ${port}: In preoperate mode, waiting before reconfiguration...`);
+        logger.debug(`Port ${port}: In preoperate mode, waiting before reconfiguration...`);
         await new Promise((resolve) => setTimeout(resolve, 2000));
       }
     }
@@ -540,7 +553,7 @@ async function configurePortForIOLink(handle: number, port: number): Promise<boo
         return false;
       }
 
-      console.log(`Port ${port}: Current config - TargetMode=${currentConfig.TargetMode}, CRID=0x${currentConfig.CRID.toString(16)}`);
+      logger.debug(`Port ${port}: Current config - TargetMode=${currentConfig.TargetMode}, CRID=0x${currentConfig.CRID.toString(16)}`);
     } catch (e) {
       return false;
     }
@@ -572,23 +585,23 @@ async function configurePortForIOLink(handle: number, port: number): Promise<boo
           portConfig.InspectionLevel
         )
       ) {
-        console.log(`Port ${port}: Configuration unchanged, skipping reconfiguration`);
+        logger.debug(`Port ${port}: Configuration unchanged, skipping reconfiguration`);
         return true;
       }
     }
 
-    console.log(`Port ${port}: Setting config - CRID=0x${portConfig.CRID.toString(16)}, TargetMode=${portConfig.TargetMode}, InspectionLevel=${portConfig.InspectionLevel}`);
+    logger.debug(`Port ${port}: Setting config - CRID=0x${portConfig.CRID.toString(16)}, TargetMode=${portConfig.TargetMode}, InspectionLevel=${portConfig.InspectionLevel}`);
 
     const result = iolinkDll.IOL_SetPortConfig(
       handle,
       zeroBasedPort,
       portConfig.ref()
     );
-    console.log(`Port ${port}: IOL_SetPortConfig result = ${result} (${result === RETURN_CODES.RETURN_OK ? 'SUCCESS' : 'FAILED'})`);
+    logger.debug(`Port ${port}: IOL_SetPortConfig result = ${result} (${result === RETURN_CODES.RETURN_OK ? 'SUCCESS' : 'FAILED'})`);
 
     return result === RETURN_CODES.RETURN_OK;
   } catch (error: any) {
-    console.error(`Port ${port} configuration error:`, error.message);
+    logger.error(`Port ${port} configuration error:`, error.message);
     return false;
   }
 }
@@ -672,7 +685,7 @@ export function checkPortStatus(handle: number, port: number): PortStatus {
 
     return status;
   } catch (error: any) {
-    console.error(`Error checking port ${port} status:`, error.message);
+    logger.error(`Error checking port ${port} status:`, error.message);
     return {
       port: port,
       connected: false,
@@ -709,7 +722,7 @@ function parseDeviceInfoFromDPP(dpp: Buffer, port: number): any {
       vendorSpecific: vendorSpecific,
     };
   } catch (error: any) {
-    console.error(`Error parsing device info from DPP:`, error.message);
+    logger.error(`Error parsing device info from DPP:`, error.message);
     return null;
   }
 }
@@ -729,7 +742,7 @@ export interface ConnectedDevice {
 }
 
 export function scanMasterPorts(handle: number): ConnectedDevice[] {
-  console.log('Scanning configured ports for connected devices...');
+  logger.info('Scanning configured ports for connected devices...');
 
   const masterState = masterStates.get(handle);
   if (!masterState || !masterState.initialized) {
@@ -740,15 +753,15 @@ export function scanMasterPorts(handle: number): ConnectedDevice[] {
 
   for (const [portNumber, portState] of masterState.ports) {
     if (!portState.configured) {
-      console.log(`Port ${portNumber}: Not configured, skipping`);
+      logger.debug(`Port ${portNumber}: Not configured, skipping`);
       continue;
     }
 
-    console.log(`Checking port ${portNumber} for connected devices...`);
+    logger.debug(`Checking port ${portNumber} for connected devices...`);
 
     try {
       const status = checkPortStatus(handle, portNumber);
-      console.log(`Port ${portNumber}: ${status.mode} (connected: ${status.connected})`);
+      logger.debug(`Port ${portNumber}: ${status.mode} (connected: ${status.connected})`);
 
       if (status.connected && portState.deviceInfo) {
         let actualVendorName = 'Unknown Vendor';
@@ -760,7 +773,7 @@ export function scanMasterPorts(handle: number): ConnectedDevice[] {
             actualVendorName = `Vendor_${portState.deviceInfo.vendorId}`;
           }
         } catch (e: any) {
-          console.log(`   Debug: Could not read vendor name for port ${portNumber}: ${e.message}`);
+          logger.debug(`Could not read vendor name for port ${portNumber}: ${e.message}`);
           actualVendorName = `Vendor_${portState.deviceInfo.vendorId}`;
         }
 
@@ -770,14 +783,14 @@ export function scanMasterPorts(handle: number): ConnectedDevice[] {
             actualDeviceName = `Device_${portState.deviceInfo.deviceId}`;
           }
         } catch (e: any) {
-          console.log(`   Debug: Could not read device name for port ${portNumber}: ${e.message}`);
+          logger.debug(`Could not read device name for port ${portNumber}: ${e.message}`);
           actualDeviceName = `Device_${portState.deviceInfo.deviceId}`;
         }
 
         portState.deviceInfo.vendorName = actualVendorName;
         portState.deviceInfo.deviceName = actualDeviceName;
 
-        console.log(`Port ${portNumber}: Found ${actualVendorName} ${actualDeviceName}`);
+        logger.debug(`Port ${portNumber}: Found ${actualVendorName} ${actualDeviceName}`);
 
         connectedDevices.push({
           ...portState.deviceInfo,
@@ -785,11 +798,11 @@ export function scanMasterPorts(handle: number): ConnectedDevice[] {
         });
       }
     } catch (error: any) {
-      console.error(`Error checking port ${portNumber}:`, error.message);
+      logger.error(`Error checking port ${portNumber}:`, error.message);
     }
   }
 
-  console.log(`Scan complete: Found ${connectedDevices.length} connected devices`);
+  logger.info(`Scan complete: Found ${connectedDevices.length} connected devices`);
   return connectedDevices;
 }
 
@@ -983,7 +996,7 @@ export function readDeviceName(handle: number, port: number): string {
     const result = param.data.toString('ascii').replace(/\0/g, '').trim();
     return result && result.length > 0 ? result : 'Unknown Device';
   } catch (error: any) {
-    console.log(`   Debug: APPLICATION_SPECIFIC_NAME not available for port ${port}: ${error.message}`);
+    logger.debug(`APPLICATION_SPECIFIC_NAME not available for port ${port}: ${error.message}`);
     return 'Unknown Device';
   }
 }
@@ -994,7 +1007,7 @@ export function readVendorName(handle: number, port: number): string {
     const result = param.data.toString('ascii').replace(/\0/g, '').trim();
     return result && result.length > 0 ? result : 'Unknown Vendor';
   } catch (error: any) {
-    console.log(`   Debug: VENDOR_NAME not available for port ${port}: ${error.message}`);
+    logger.debug(`VENDOR_NAME not available for port ${port}: ${error.message}`);
     return 'Unknown Vendor';
   }
 }
@@ -1005,7 +1018,7 @@ export function readProductName(handle: number, port: number): string {
     const result = param.data.toString('ascii').replace(/\0/g, '').trim();
     return result && result.length > 0 ? result : 'Unknown Product';
   } catch (error: any) {
-    console.log(`   Debug: PRODUCT_NAME not available for port ${port}: ${error.message}`);
+    logger.debug(`PRODUCT_NAME not available for port ${port}: ${error.message}`);
     return 'Unknown Product';
   }
 }
@@ -1016,7 +1029,7 @@ export function readSerialNumber(handle: number, port: number): string {
     const result = param.data.toString('ascii').replace(/\0/g, '').trim();
     return result && result.length > 0 ? result : '';
   } catch (error: any) {
-    console.log(`   Debug: SERIAL_NUMBER not available for port ${port}: ${error.message}`);
+    logger.debug(`SERIAL_NUMBER not available for port ${port}: ${error.message}`);
     return '';
   }
 }
@@ -1135,25 +1148,25 @@ export interface DiscoveryTopology {
 }
 
 export async function discoverAllDevices(): Promise<DiscoveryTopology> {
-  console.log('=== IO-Link Discovery ===');
+  logger.info('=== IO-Link Discovery ===');
 
   const masters = discoverMasters();
   if (masters.length === 0) {
-    console.log('No IO-Link Masters found.');
+    logger.info('No IO-Link Masters found.');
     return { masters: [] };
   }
 
-  console.log(`Found ${masters.length} IO-Link Master(s)`);
+  logger.info(`Found ${masters.length} IO-Link Master(s)`);
 
   const topology: DiscoveryTopology = { masters: [] };
 
   for (const [index, master] of masters.entries()) {
-    console.log(`\n--- Initializing IO-Link Master ${index + 1}: ${master.name} ---`);
+    logger.info(`--- Initializing IO-Link Master ${index + 1}: ${master.name} ---`);
 
     let handle: number | null = null;
     try {
       handle = connect(master.name);
-      console.log(`Connected to IO-Link Master: ${master.name}`);
+      logger.info(`Connected to IO-Link Master: ${master.name}`);
 
       const masterState = await initializeMaster(handle, master.name);
       const connectedDevices = scanMasterPorts(handle);
@@ -1167,7 +1180,7 @@ export async function discoverAllDevices(): Promise<DiscoveryTopology> {
         ports: Array.from(masterState.ports.keys()),
       });
     } catch (error: any) {
-      console.error(`Failed to initialize IO-Link Master ${master.name}:`, error.message);
+      logger.error(`Failed to initialize IO-Link Master ${master.name}:`, error.message);
       topology.masters.push({
         ...master,
         handle: handle || 0,
@@ -1180,25 +1193,25 @@ export async function discoverAllDevices(): Promise<DiscoveryTopology> {
   }
 
   const totalDevices = topology.masters.reduce((sum, master) => sum + master.totalDevices, 0);
-  console.log(`\n=== Discovery Complete ===`);
-  console.log(`IO-Link Masters found: ${topology.masters.length}`);
-  console.log(`Total IO-Link Devices found: ${totalDevices}`);
+  logger.info(`=== Discovery Complete ===`);
+  logger.info(`IO-Link Masters found: ${topology.masters.length}`);
+  logger.info(`Total IO-Link Devices found: ${totalDevices}`);
 
   return topology;
 }
 
 export function disconnectAllMasters(topology: DiscoveryTopology): void {
-  console.log('Disconnecting from all IO-Link Masters...');
+  logger.info('Disconnecting from all IO-Link Masters...');
   topology.masters.forEach((master) => {
     if (master.handle && master.handle > 0) {
       try {
         disconnect(master.handle);
-        console.log(`Disconnected from IO-Link Master: ${master.name}`);
+        logger.info(`Disconnected from IO-Link Master: ${master.name}`);
       } catch (error: any) {
-        console.error(`Error disconnecting from IO-Link Master ${master.name}:`, error.message);
+        logger.error(`Error disconnecting from IO-Link Master ${master.name}:`, error.message);
       }
     } else {
-      console.log(`Skipping ${master.name} - no valid connection (handle: ${master.handle})`);
+      logger.info(`Skipping ${master.name} - no valid connection (handle: ${master.handle})`);
     }
   });
 }
@@ -1207,41 +1220,88 @@ export function disconnectAllMasters(topology: DiscoveryTopology): void {
 // NATIVE STREAMING FUNCTIONS
 // ============================================================================
 
-export function startNativeStreaming(
-  handle: number,
-  port: number,
-  samplesPerSecond: number,
-  bufferSizeBytes: number
-): number {
-  const intervalMicroseconds = Math.floor(1000000 / samplesPerSecond);
-  const loggingMode = 0;
-  const sampleTimeRef = ref.alloc(DWORD, intervalMicroseconds) as any;
+export type { LoggingEntry };
+export { parseLoggingEntries };
+
+interface LoggingSession {
+  port: number;
+  requestedSampleTimeUs: number;
+  sampleTimeUs: number;
+  bufferSizeBytes: number;
+  clock: SampleClock;
+}
 
-  console.log(`Starting native data logging on port ${port}: ${samplesPerSecond} Hz (${intervalMicroseconds}μs interval), buffer: ${bufferSizeBytes} bytes`);
+// Per master handle, the logging ports. Entries carry their port, so all
+// ports of a master share one buffer and are split when read.
+const loggingSessions = new Map<number, Map<number, LoggingSession>>();
+
+function startLoggingPort(handle: number, session: LoggingSession): void {
+  const sampleTimeRef = ref.alloc(DWORD, session.requestedSampleTimeUs) as any;
 
   const result = iolinkDll.IOL_StartDataLoggingInBuffer(
     handle,
-    port - 1,
-    bufferSizeBytes,
-    loggingMode,
+    session.port - 1,
+    session.bufferSizeBytes,
+    LOGGING_MODES.TIME,
     sampleTimeRef
   );
 
   if (result !== RETURN_CODES.RETURN_OK) {
-    throw new Error(`Failed to start native data logging: ${result}`);
+    throw new Error(`Failed to start native data logging on port ${session.port}: ${result}`);
   }
 
+  // The master rounds the interval; timestamps follow the granted one
   const actualSampleTime = sampleTimeRef.deref();
-  const actualSampleRate = actualSampleTime > 0 ? 1000000 / actualSampleTime : 0;
+  session.sampleTimeUs = actualSampleTime > 0 ? actualSampleTime : session.requestedSampleTimeUs;
+  session.clock = new SampleClock(session.sampleTimeUs);
+}
 
-  console.log(`Native data logging started successfully on port ${port}`);
-  console.log(`Requested: ${intervalMicroseconds}μs (${samplesPerSecond} Hz)`);
-  console.log(`Actual: ${actualSampleTime}μs (${actualSampleRate.toFixed(1)} Hz)`);
-  return result;
+/**
+ * Start logging a port. Without bufferSizeBytes the buffer is sized to hold
+ * LOGGING_BUFFER_HEADROOM_MS of samples at the largest process data length.
+ */
+export function startNativeStreaming(
+  handle: number,
+  port: number,
+  samplesPerSecond: number,
+  bufferSizeBytes?: number
+): number {
+  const intervalMicroseconds = Math.floor(1000000 / samplesPerSecond);
+  if (!bufferSizeBytes) {
+    bufferSizeBytes = loggingBufferSize(intervalMicroseconds, PROCESS_DATA_MAX_LENGTH, PROCESS_DATA_MAX_LENGTH);
+  }
+
+  logger.info(`Starting native data logging on port ${port}: ${samplesPerSecond} Hz (${intervalMicroseconds}μs interval), buffer: ${bufferSizeBytes} bytes`);
+
+  let sessions = loggingSessions.get(handle);
+  if (!sessions) {
+    sessions = new Map();
+    loggingSessions.set(handle, sessions);
+  }
+
+  const session: LoggingSession = {
+    port,
+    requestedSampleTimeUs: intervalMicroseconds,
+    sampleTimeUs: intervalMicroseconds,
+    bufferSizeBytes,
+    clock: new SampleClock(intervalMicroseconds),
+  };
+  startLoggingPort(handle, session);
+  sessions.set(port, session);
+
+  logger.info(`Native data logging started successfully on port ${port}`);
+  logger.info(`Requested: ${intervalMicroseconds}μs (${samplesPerSecond} Hz)`);
+  logger.info(`Actual: ${session.sampleTimeUs}μs (${(1000000 / session.sampleTimeUs).toFixed(1)} Hz)`);
+  return RETURN_CODES.RETURN_OK;
 }
 
+/**
+ * Stop logging of one port. IOL_StopDataLogging stops the whole master, so
+ * the other logging ports are started again (their clocks re-anchor);
+ * read the buffer first to keep what they logged so far.
+ */
 export function stopNativeStreaming(handle: number, port: number): number {
-  console.log(`Stopping native data logging on port ${port}`);
+  logger.info(`Stopping native data logging on port ${port}`);
 
   const result = iolinkDll.IOL_StopDataLogging(handle);
 
@@ -1249,24 +1309,35 @@ export function stopNativeStreaming(handle: number, port: number): number {
     throw new Error(`Failed to stop native data logging: ${result}`);
   }
 
-  console.log(`Native data logging stopped successfully on port ${port}`);
+  const sessions = loggingSessions.get(handle);
+  sessions?.delete(port);
+  if (!sessions || sessions.size === 0) {
+    loggingSessions.delete(handle);
+  } else {
+    for (const session of sessions.values()) {
+      startLoggingPort(handle, session);
+    }
+  }
+
+  logger.info(`Native data logging stopped successfully on port ${port}`);
   return result;
 }
 
-export interface StreamingSample {
+export interface StreamingSample extends LoggingEntry {
+  sampleIndex: number;
+  // Reconstructed acquisition time, epoch ms
   timestamp: number;
-  inputData: Buffer;
-  outputData: Buffer;
+  timestampQuality: TimestampQuality;
   inputLength: number;
   outputLength: number;
-  inputValid: boolean;
-  rawBuffer: Buffer;
 }
 
 export interface StreamingBufferRead {
   data: Buffer | null;
   bytesRead: number;
   samples: StreamingSample[];
+  // Bytes at the end that did not form a complete entry
+  trailingBytes: number;
   status: {
     isRunning: boolean;
     hasMoreData: boolean;
@@ -1274,7 +1345,19 @@ export interface StreamingBufferRead {
   };
 }
 
+/**
+ * Read the master's logging buffer. Samples of every logging port are
+ * returned in time order, each stamped on its own port's clock. port is
+ * kept for compatibility and does not filter. After an overrun the master
+ * logs nothing until the caller restarts it; DataLoggingService is the
+ * one that restarts and records the gap.
+ */
 export function readNativeLoggingBuffer(handle: number, port: number, bufferSize: number = 8192): StreamingBufferRead {
+  const sessions = loggingSessions.get(handle);
+  if (!sessions) {
+    throw new Error(`Native data logging is not running on master ${handle}`);
+  }
+
   const buffer = Buffer.alloc(bufferSize);
   const bufferSizeRef = ref.alloc(LONG, bufferSize) as any;
   const statusRef = ref.alloc(DWORD) as any;
@@ -1285,6 +1368,7 @@ export function readNativeLoggingBuffer(handle: number, port: number, bufferSize
     buffer,
     statusRef
   );
+  const readAt = performance.now();
 
   if (result !== RETURN_CODES.RETURN_OK) {
     throw new Error(`Failed to read logging buffer: ${result}`);
@@ -1293,80 +1377,62 @@ export function readNativeLoggingBuffer(handle: number, port: number, bufferSize
   const actualBytesRead = bufferSizeRef.deref();
   const status = statusRef.deref();
 
-  const isRunning = (status & 1) !== 0;
-  const hasMoreData = (status & 2) !== 0;
-  const overrun = (status & 4) !== 0;
+  const isRunning = (status & LOGGING_STATUS.RUNNING) !== 0;
+  const hasMoreData = (status & LOGGING_STATUS.AVAILABLE) !== 0;
+  const overrun = (status & LOGGING_STATUS.OVERRUN) !== 0;
 
-  if (actualBytesRead === 0) {
-    return {
-      data: null,
-      bytesRead: 0,
-      samples: [],
-      status: { isRunning, hasMoreData, overrun },
-    };
-  }
+  const { entries, consumed } = parseLoggingEntries(buffer, actualBytesRead);
 
-  console.log(`   Raw buffer (${actualBytesRead} bytes): ${buffer.slice(0, Math.min(actualBytesRead, 32)).toString('hex')}`);
+  // Data still buffered was logged before the overrun
+  const overrunReached = overrun && !hasMoreData;
 
   const samples: StreamingSample[] = [];
+  for (const session of sessions.values()) {
+    const portEntries = entries.filter((entry) => entry.port === session.port);
+    if (portEntries.length === 0) continue;
+
+    const stamped = session.clock.stamp(portEntries.length, readAt, !hasMoreData, overrunReached);
+    portEntries.forEach((entry, i) => samples.push({
+      ...entry,
+      sampleIndex: stamped.firstIndex + i,
+      timestamp: stamped.timestamps[i],
+      timestampQuality: stamped.quality,
+      inputLength: entry.inputData.length,
+      outputLength: entry.outputData.length,
+    }));
+  }
+  samples.sort((a, b) => a.timestamp - b.timestamp);
 
-  if (actualBytesRead === 11) {
-    console.log(`   Analyzing 11-byte structure:`);
-    console.log(`   Bytes 0-1: ${buffer.slice(0, 2).toString('hex')} (header)`);
-    console.log(`   Bytes 2-7: ${buffer.slice(2, 8).toString('hex')} (sensor data)`);
-    console.log(`   Bytes 8-10: ${buffer.slice(8, 11).toString('hex')} (status)`);
-
-    const sensorData = buffer.slice(2, 8);
-    const timestamp = Date.now();
-
-    samples.push({
-      timestamp: timestamp,
-      inputData: sensorData,
-      outputData: Buffer.alloc(0),
-      inputLength: sensorData.length,
-      outputLength: 0,
-      inputValid: true,
-      rawBuffer: buffer.slice(0, actualBytesRead),
-    });
-
-    console.log(`   Extracted sample: ${sensorData.toString('hex')}`);
-  } else {
-    console.log(`   Searching for sensor data in ${actualBytesRead} bytes`);
-
-    let offset = 0;
-    while (offset < actualBytesRead - 5) {
-      if (offset + 6 <= actualBytesRead) {
-        const potentialData = buffer.slice(offset, offset + 6);
-
-        if (potentialData[0] === 0x7f || offset === 0 || actualBytesRead - offset === 6) {
-          const timestamp = Date.now();
-
-          samples.push({
-            timestamp: timestamp,
-            inputData: potentialData,
-            outputData: Buffer.alloc(0),
-            inputLength: potentialData.length,
-            outputLength: 0,
-            inputValid: true,
-            rawBuffer: buffer.slice(0, actualBytesRead),
-          });
-
-          console.log(`   Found sample at offset ${offset}: ${potentialData.toString('hex')}`);
-          break;
-        }
-      }
-      offset++;
-    }
+  if (consumed < actualBytesRead) {
+    logger.warn(`Logging buffer on master ${handle}: ${actualBytesRead - consumed} bytes without a complete entry`);
+  }
+  if (logger.isLevelEnabled('debug') && actualBytesRead > 0) {
+    logger.debug(`Logging buffer (${actualBytesRead} bytes, ${samples.length} entries): ${buffer.subarray(0, Math.min(actualBytesRead, 32)).toString('hex')}`);
   }
 
   return {
-    data: buffer.slice(0, actualBytesRead),
+    data: actualBytesRead > 0 ? buffer.subarray(0, actualBytesRead) : null,
     bytesRead: actualBytesRead,
-    samples: samples,
+    samples,
+    trailingBytes: actualBytesRead - consumed,
     status: { isRunning, hasMoreData, overrun },
   };
 }
 
+/**
+ * Sample period and clock state of each logging port on a master
+ */
+export function getNativeStreamingClock(handle: number) {
+  const sessions = loggingSessions.get(handle);
+  return sessions
+    ? Array.from(sessions.values()).map((session) => ({
+      port: session.port,
+      sampleTimeUs: session.sampleTimeUs,
+      ...session.clock.getStatus(),
+    }))
+    : null;
+}
+
 // ============================================================================
 // UTILITY AND VALIDATION FUNCTIONS
 // ============================================================================
@@ -1442,19 +1508,19 @@ export function getConnectedDeviceInfo(handle: number, port: number): ConnectedD
     try {
       serialNumber = readSerialNumber(handle, port);
     } catch (e) {
-      console.log(`   Debug: Serial number not available for port ${port}`);
+      logger.debug(`Serial number not available for port ${port}`);
     }
 
     try {
       deviceName = readDeviceName(handle, port);
     } catch (e) {
-      console.log(`   Debug: Device name not available for port ${port}`);
+      logger.debug(`Device name not available for port ${port}`);
     }
 
     try {
       vendorName = readVendorName(handle, port);
     } catch (e) {
-      console.log(`   Debug: Vendor name not available for port ${port}`);
+      logger.debug(`Vendor name not available for port ${port}`);
     }
 
     const finalVendorName =
@@ -1481,7 +1547,7 @@ export function getConnectedDeviceInfo(handle: number, port: number): ConnectedD
       status: portStatus,
     };
   } catch (error: any) {
-    console.error(`Error reading IO-Link Device/Sensor info from port ${port}:`, error.message);
+    logger.error(`Error reading IO-Link Device/Sensor info from port ${port}:`, error.message);
     return null;
   }
 }
@@ -18,6 +18,9 @@ import {
   validateProcessDataWrite,
   validateParameterValue,
   validateProcessDataLength,
+  validateProcessDataPeriod,
+  validateDataLogging,
+  validateRecordingQuery,
 } from '../middleware/validation';
 import {
   requireReadAccess,
@@ -75,6 +78,192 @@ router.get(
   dataController.streamProcessData
 );
 
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/process/period
+ * Get the cyclic process data period and its measured timing
+ */
+router.get(
+  '/:masterHandle/:deviceId/process/period',
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.getProcessDataPeriod
+);
+
+/**
+ * PUT /api/v1/data/:masterHandle/:deviceId/process/period
+ * Set the cyclic process data period
+ * Body: { periodMs: 2 }
+ */
+router.put(
+  '/:masterHandle/:deviceId/process/period',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  validateProcessDataPeriod,
+  authorizeDeviceAccess,
+  dataController.setProcessDataPeriod
+);
+
+/**
+ * GET /api/v1/data/merged/stream
+ * Time-ordered process data of several ports across masters (SSE)
+ * Query params: ?ports=1:1,2:3&interval=100&maxDelay=250
+ */
+router.get(
+  '/merged/stream',
+  requireReadAccess,
+  dataController.streamMergedProcessData
+);
+
+/**
+ * GET /api/v1/data/process-image
+ * Snapshot of the shared process image
+ */
+router.get(
+  '/process-image',
+  requireReadAccess,
+  dataController.getProcessImage
+);
+
+// ============================================================================
+// DATA LOGGING ROUTES
+// ============================================================================
+
+/**
+ * POST /api/v1/data/:masterHandle/logging
+ * Start logging ports in the master's logging buffer
+ * Body: { ports: [1, 2], sampleTimeUs: 1000, memorySize?: 65536 }
+ */
+router.post(
+  '/:masterHandle/logging',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDataLogging,
+  dataController.startDataLogging
+);
+
+/**
+ * DELETE /api/v1/data/:masterHandle/logging
+ * Stop logging of some or all ports
+ * Query params: ?ports=1,2
+ */
+router.delete(
+  '/:masterHandle/logging',
+  requireOperatorAccess,
+  validateMasterHandle,
+  dataController.stopDataLogging
+);
+
+/**
+ * GET /api/v1/data/:masterHandle/logging
+ * Logging ports with per-port counters
+ */
+router.get(
+  '/:masterHandle/logging',
+  requireReadAccess,
+  validateMasterHandle,
+  dataController.getDataLoggingStatus
+);
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/logging
+ * Logged samples of one port
+ * Query params: ?since=0&limit=1000
+ */
+router.get(
+  '/:masterHandle/:deviceId/logging',
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.getLoggedSamples
+);
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/logging/stream
+ * Logged samples of one port as they arrive (Server-Sent Events)
+ */
+router.get(
+  '/:masterHandle/:deviceId/logging/stream',
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.streamLoggedSamples
+);
+
+// ============================================================================
+// RECORDING ROUTES
+// ============================================================================
+
+/**
+ * GET /api/v1/data/recordings
+ * List recordings with their compression
+ */
+router.get('/recordings', requireReadAccess, dataController.listRecordings);
+
+/**
+ * GET /api/v1/data/recordings/:recordingId/samples
+ * Decoded samples of a recording
+ * Query params: ?from=<epoch ms|ISO>&to=<epoch ms|ISO>&limit=10000
+ */
+router.get(
+  '/recordings/:recordingId/samples',
+  requireReadAccess,
+  validateRecordingQuery,
+  dataController.getRecordedSamples
+);
+
+/**
+ * GET /api/v1/data/recordings/:recordingId/export
+ * Recording as an Arrow IPC stream
+ * Query params: ?from=<epoch ms|ISO>&to=<epoch ms|ISO>
+ */
+router.get(
+  '/recordings/:recordingId/export',
+  requireReadAccess,
+  validateRecordingQuery,
+  dataController.exportRecording
+);
+
+/**
+ * DELETE /api/v1/data/recordings/:recordingId
+ * Delete a stopped recording
+ */
+router.delete(
+  '/recordings/:recordingId',
+  requireWriteAccess,
+  dataController.deleteRecording
+);
+
+/**
+ * POST /api/v1/data/:masterHandle/:deviceId/recording
+ * Record a logging port to disk
+ */
+router.post(
+  '/:masterHandle/:deviceId/recording',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.startRecording
+);
+
+/**
+ * DELETE /api/v1/data/:masterHandle/:deviceId/recording
+ * Stop recording a port
+ */
+router.delete(
+  '/:masterHandle/:deviceId/recording',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.stopRecording
+);
+
 // ============================================================================
 // PARAMETER MANAGEMENT ROUTES
 // ============================================================================
@@ -177,6 +366,57 @@ router.get(
   dataController.getDeviceInformation
 );
 
+// ============================================================================
+// BLOB TRANSFER ROUTES
+// ============================================================================
+
+/**
+ * GET /api/v1/data/blob/transfers
+ * List running and recent BLOB transfers
+ */
+router.get(
+  '/blob/transfers',
+  requireReadAccess,
+  dataController.listBlobTransfers
+);
+
+/**
+ * DELETE /api/v1/data/blob/transfers/:transferId
+ * Abort a running BLOB transfer
+ */
+router.delete(
+  '/blob/transfers/:transferId',
+  requireWriteAccess,
+  dataController.abortBlobTransfer
+);
+
+/**
+ * GET /api/v1/data/:masterHandle/:deviceId/blob/:blobId
+ * Stream a BLOB from the device
+ * Query params: ?maxSize=65536
+ */
+router.get(
+  '/:masterHandle/:deviceId/blob/:blobId',
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.readBlob
+);
+
+/**
+ * PUT /api/v1/data/:masterHandle/:deviceId/blob/:blobId
+ * Write a BLOB to the device (application/octet-stream body)
+ */
+router.put(
+  '/:masterHandle/:deviceId/blob/:blobId',
+  requireWriteAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.writeBlob
+);
+
 // ============================================================================
 // EXPORTS
 // ============================================================================
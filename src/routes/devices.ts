@@ -15,6 +15,10 @@ import {
   validateMasterHandle,
   validateDeviceId,
   validateQueryParams,
+  validateFirmwareCampaign,
+  validateDataStorageBackup,
+  validateDataStorageRestore,
+  validateTracingConfig,
 } from "../middleware/validation";
 import {
   requireReadAccess,
@@ -44,6 +48,16 @@ router.get(
   deviceController.getConnectedMasters
 );
 
+/**
+ * GET /api/v1/masters/watcher
+ * Get hot-plug watcher status and attach/detach latency metrics
+ */
+router.get(
+  "/masters/watcher",
+  requireReadAccess,
+  deviceController.getMasterWatcherStatus
+);
+
 /**
  * POST /api/v1/masters/connect
  * Connect to a specific master
@@ -147,6 +161,244 @@ router.get(
   deviceController.getDeviceInfo
 );
 
+// ============================================================================
+// FIRMWARE UPDATE ROUTES
+// ============================================================================
+
+/**
+ * POST /api/v1/firmware/images
+ * Load a firmware image (application/octet-stream body)
+ * Query params: ?vendorId=310&hwKey=ABC&passwordRequired=false
+ */
+router.post(
+  "/firmware/images",
+  requireAdminAccess,
+  deviceController.uploadFirmwareImage
+);
+
+/**
+ * GET /api/v1/firmware/images
+ * List loaded firmware images
+ */
+router.get(
+  "/firmware/images",
+  requireReadAccess,
+  deviceController.listFirmwareImages
+);
+
+/**
+ * DELETE /api/v1/firmware/images/:imageId
+ * Release a loaded firmware image
+ */
+router.delete(
+  "/firmware/images/:imageId",
+  requireAdminAccess,
+  deviceController.removeFirmwareImage
+);
+
+/**
+ * POST /api/v1/firmware/jobs
+ * Start firmware updates on several ports concurrently
+ * Body: { targets: [{ masterHandle: 1, port: 2 }], imageId: "..." }
+ */
+router.post(
+  "/firmware/jobs",
+  requireAdminAccess,
+  validateFirmwareCampaign,
+  deviceController.startFirmwareUpdate
+);
+
+/**
+ * GET /api/v1/firmware/jobs
+ * List firmware update jobs
+ * Query params: ?campaignId=...
+ */
+router.get(
+  "/firmware/jobs",
+  requireReadAccess,
+  deviceController.listFirmwareJobs
+);
+
+/**
+ * GET /api/v1/firmware/jobs/:jobId
+ * Get firmware update job progress
+ */
+router.get(
+  "/firmware/jobs/:jobId",
+  requireReadAccess,
+  deviceController.getFirmwareJob
+);
+
+/**
+ * DELETE /api/v1/firmware/jobs/:jobId
+ * Abort a running firmware update job
+ */
+router.delete(
+  "/firmware/jobs/:jobId",
+  requireAdminAccess,
+  deviceController.abortFirmwareJob
+);
+
+// ============================================================================
+// DATA STORAGE ROUTES
+// ============================================================================
+
+/**
+ * POST /api/v1/datastorage/backups
+ * Back up data storage of all (or the given) ports
+ * Body: { targets?: [{ masterHandle: 1, port: 2 }], refresh?: false }
+ */
+router.post(
+  "/datastorage/backups",
+  requireAdminAccess,
+  validateDataStorageBackup,
+  deviceController.createDataStorageBackup
+);
+
+/**
+ * GET /api/v1/datastorage/backups
+ * List data storage backups
+ */
+router.get(
+  "/datastorage/backups",
+  requireReadAccess,
+  deviceController.listDataStorageBackups
+);
+
+/**
+ * GET /api/v1/datastorage/backups/:backupId
+ * Get a data storage backup manifest
+ */
+router.get(
+  "/datastorage/backups/:backupId",
+  requireReadAccess,
+  deviceController.getDataStorageBackup
+);
+
+/**
+ * POST /api/v1/datastorage/backups/:backupId/restore
+ * Restore a data storage backup
+ * Body: { targets?: [{ masterHandle: 1, port: 2, sourcePort?: 3 }], refresh?: true }
+ */
+router.post(
+  "/datastorage/backups/:backupId/restore",
+  requireAdminAccess,
+  validateDataStorageRestore,
+  deviceController.restoreDataStorageBackup
+);
+
+// ============================================================================
+// DIAGNOSTICS ROUTES
+// ============================================================================
+
+/**
+ * GET /api/v1/diagnostics/link-quality
+ * Link quality summary for all masters and ports
+ * Query params: ?window=30
+ */
+router.get(
+  "/diagnostics/link-quality",
+  requireReadAccess,
+  deviceController.getLinkQuality
+);
+
+/**
+ * GET /api/v1/diagnostics/clocks
+ * Master clock correlation (cycle duration, drift, latency)
+ */
+router.get(
+  "/diagnostics/clocks",
+  requireReadAccess,
+  deviceController.getMasterClocks
+);
+
+/**
+ * GET /api/v1/diagnostics/link-quality/metrics
+ * Link quality in Prometheus text format
+ */
+router.get(
+  "/diagnostics/link-quality/metrics",
+  requireReadAccess,
+  deviceController.getLinkQualityMetrics
+);
+
+/**
+ * GET /api/v1/diagnostics/link-quality/export
+ * Link quality samples as an Arrow IPC stream
+ */
+router.get(
+  "/diagnostics/link-quality/export",
+  requireReadAccess,
+  deviceController.exportLinkQuality
+);
+
+/**
+ * GET /api/v1/diagnostics/events/export
+ * Master events as an Arrow IPC stream
+ * Query params: ?since=<epoch ms>
+ */
+router.get(
+  "/diagnostics/events/export",
+  requireReadAccess,
+  deviceController.exportEvents
+);
+
+/**
+ * GET /api/v1/diagnostics/latency
+ * Latency percentiles per DLL function, route and socket event
+ * Query params: ?family=iolink_dll_call_duration_seconds
+ */
+router.get(
+  "/diagnostics/latency",
+  requireReadAccess,
+  deviceController.getLatency
+);
+
+/**
+ * DELETE /api/v1/diagnostics/latency
+ * Reset all latency histograms
+ */
+router.delete(
+  "/diagnostics/latency",
+  requireAdminAccess,
+  deviceController.resetLatency
+);
+
+/**
+ * GET /api/v1/diagnostics/tracing
+ * Tracing status (sample rate, trace file, span counts)
+ */
+router.get(
+  "/diagnostics/tracing",
+  requireAdminAccess,
+  deviceController.getTracing
+);
+
+/**
+ * PUT /api/v1/diagnostics/tracing
+ * Enable or disable sampled request tracing
+ * Body: { enabled: boolean, sampleRate?: 0..1 }
+ */
+router.put(
+  "/diagnostics/tracing",
+  requireAdminAccess,
+  validateTracingConfig,
+  deviceController.configureTracing
+);
+
+/**
+ * GET /api/v1/diagnostics/link-quality/:masterHandle/:deviceId
+ * Link quality sample history of one port
+ * Query params: ?limit=100
+ */
+router.get(
+  "/diagnostics/link-quality/:masterHandle/:deviceId",
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  deviceController.getPortLinkQuality
+);
+
 // ============================================================================
 // EXPORTS
 // ============================================================================
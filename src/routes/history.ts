@@ -0,0 +1,84 @@
+/**
+ * History Routes
+ * Express routes for downsampled process data history
+ *
+ */
+
+import express, { Router } from 'express';
+
+// Import controllers
+import * as dataController from '../controllers/dataController';
+
+// Import middleware
+import {
+  validateMasterHandle,
+  validateDeviceId,
+  validateHistoryQuery,
+  validateHistoryChannel,
+} from '../middleware/validation';
+import {
+  requireReadAccess,
+  requireOperatorAccess,
+  authorizeDeviceAccess,
+} from '../middleware/auth';
+
+const router: Router = express.Router();
+
+// ============================================================================
+// HISTORY ROUTES
+// ============================================================================
+
+/**
+ * GET /api/v1/history
+ * Recorded ports and their coverage
+ */
+router.get('/', requireReadAccess, dataController.listHistoryChannels);
+
+/**
+ * GET /api/v1/history/:masterHandle/:deviceId
+ * Downsampled history of a port
+ * Query params: ?from=2024-01-01T00:00:00Z&to=1704153600000&points=1000
+ */
+router.get(
+  '/:masterHandle/:deviceId',
+  requireReadAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  validateHistoryQuery,
+  dataController.queryHistory
+);
+
+/**
+ * PUT /api/v1/history/:masterHandle/:deviceId
+ * Set the decoding of a port's inputs
+ * Body: { dataType: 'int16', offset: 0, scale: 0.1, bias: 0 }
+ */
+router.put(
+  '/:masterHandle/:deviceId',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  validateHistoryChannel,
+  dataController.configureHistoryChannel
+);
+
+/**
+ * DELETE /api/v1/history/:masterHandle/:deviceId
+ * Drop the recorded history of a port
+ */
+router.delete(
+  '/:masterHandle/:deviceId',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  dataController.clearHistoryChannel
+);
+
+// ============================================================================
+// EXPORTS
+// ============================================================================
+
+export default router;
@@ -0,0 +1,68 @@
+/**
+ * Rules Routes
+ * Express routes for process data alarm rules
+ *
+ */
+
+import express, { Router } from 'express';
+
+// Import controllers
+import * as dataController from '../controllers/dataController';
+
+// Import middleware
+import {
+  validateMasterHandle,
+  validateDeviceId,
+  validateRule,
+} from '../middleware/validation';
+import {
+  requireReadAccess,
+  requireOperatorAccess,
+  authorizeDeviceAccess,
+} from '../middleware/auth';
+
+const router: Router = express.Router();
+
+// ============================================================================
+// RULE ROUTES
+// ============================================================================
+
+/**
+ * GET /api/v1/rules
+ * Alarm rules and engine status
+ */
+router.get('/', requireReadAccess, dataController.listRules);
+
+/**
+ * GET /api/v1/rules/alarms
+ * Active alarms and recent transitions
+ * Query params: ?limit=100
+ */
+router.get('/alarms', requireReadAccess, dataController.getAlarms);
+
+/**
+ * POST /api/v1/rules/:masterHandle/:deviceId
+ * Add an alarm rule on a port
+ * Body: { type: 'edge', edge: 'rising', level: 0.5 }
+ */
+router.post(
+  '/:masterHandle/:deviceId',
+  requireOperatorAccess,
+  validateMasterHandle,
+  validateDeviceId,
+  authorizeDeviceAccess,
+  validateRule,
+  dataController.createRule
+);
+
+/**
+ * DELETE /api/v1/rules/:ruleId
+ * Remove an alarm rule
+ */
+router.delete('/:ruleId', requireOperatorAccess, dataController.deleteRule);
+
+// ============================================================================
+// EXPORTS
+// ============================================================================
+
+export default router;
@@ -50,6 +50,7 @@ router.get('/status', requireReadAccess, (req: Request, res: Response) => {
       deviceStreams: deviceStreamCount,
       activeIntervals: intervalCount,
       streamsByType: streamsByType,
+      parameterPollers: streamController.parameterSubscriptions.getStatus(),
       timestamp: new Date().toISOString(),
     },
   });
@@ -189,6 +190,7 @@ router.get(
           subscribe: 'subscribe:parameter',
           unsubscribe: 'unsubscribe',
           dataEvent: 'parameter:value',
+          keepaliveEvent: 'parameter:keepalive',
           errorEvent: 'parameter:error',
         },
         subscriptionPayload: {
@@ -197,6 +199,8 @@ router.get(
           parameterIndex: parseInt(index),
           subIndex: parseInt(subIndex as string),
           interval: 5000, // optional, default 5000ms for parameters
+          minInterval: 1000, // optional, fastest poll while the value changes
+          maxInterval: 50000, // optional, slowest poll while it is static
         },
         instructions:
           'Connect to WebSocket and emit "subscribe:parameter" with the subscription payload',
@@ -251,13 +255,36 @@ router.get('/documentation', (req: Request, res: Response) => {
         parameterSubscription: {
           description: 'Subscribe to specific parameter updates',
           clientEmits: 'subscribe:parameter',
-          serverEmits: ['parameter:value', 'parameter:error', 'subscribed'],
+          serverEmits: [
+            'parameter:value',
+            'parameter:keepalive',
+            'parameter:error',
+            'subscribed',
+          ],
+          notes:
+            'parameter:value is sent only when the value changes; parameter:keepalive is sent when nothing changed for 15s',
           payload: {
             masterHandle: 'number (required)',
             deviceId: 'number (required)',
             parameterIndex: 'number (required)',
             subIndex: 'number (optional, default 0)',
             interval: 'number (optional, default 5000ms)',
+            minInterval: 'number (optional, default interval)',
+            maxInterval: 'number (optional, default 10x interval)',
+          },
+        },
+        processDataWrite: {
+          description:
+            'Write process data; the newest value per port is written at the port cycle rate',
+          clientEmits: 'write:process-data',
+          serverEmits: 'error (without ack callback)',
+          notes:
+            'Pass an ack callback to receive { success, sequence, commit }; with confirm it is called once the value, or a newer one that replaced it, reached the master',
+          payload: {
+            masterHandle: 'number (required)',
+            deviceId: 'number (required)',
+            data: 'number[] (required, up to 32 bytes)',
+            confirm: 'boolean (optional, default false)',
           },
         },
         unsubscription: {
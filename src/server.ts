@@ -4,11 +4,29 @@
  * 
  */
 
+import './utils/threadpool';
 import http from 'http';
+import cluster from 'cluster';
+import path from 'path';
 import { Server as SocketIOServer } from 'socket.io';
-import { app, setServer } from './app';
+import { app, globalLimiterStore, setServer } from './app';
 import * as streamController from './controllers/streamController';
+import {
+  masterWatcher,
+  firmwareUpdateService,
+  linkQualityService,
+  masterClockService,
+  deviceManager,
+} from './controllers/deviceController';
+import ProcessImagePublisher from './services/ProcessImagePublisher';
+import {
+  blobTransferService,
+  dataLoggingService,
+  historyService,
+  rulesService,
+} from './controllers/dataController';
 import logger from './utils/logger';
+import { serveRateLimitStore } from './utils/rateLimitStore';
 
 // ============================================================================
 // SERVER CONFIGURATION
@@ -17,6 +35,13 @@ import logger from './utils/logger';
 const PORT = parseInt(process.env.PORT || '3000', 10);
 const HOST = process.env.HOST || '0.0.0.0';
 
+// With HTTP_WORKERS > 0 this process only owns the masters: it listens on
+// loopback and the workers serve the public port (see httpWorker.ts)
+const HTTP_WORKERS = parseInt(process.env.HTTP_WORKERS || '0', 10);
+const OWNER_PORT = parseInt(process.env.OWNER_PORT || String(PORT + 1), 10);
+const LISTEN_PORT = HTTP_WORKERS > 0 ? OWNER_PORT : PORT;
+const LISTEN_HOST = HTTP_WORKERS > 0 ? '127.0.0.1' : HOST;
+
 // Create HTTP server
 const server = http.createServer(app);
 
@@ -75,14 +100,84 @@ io.on('connection', (socket) => {
   streamController.handleConnection(socket, io);
 });
 
+// Broadcast master hot-plug events to all clients
+masterWatcher.on('master:attached', (event) => io.emit('master:attached', event));
+masterWatcher.on('master:detached', (event) => io.emit('master:detached', event));
+masterWatcher.on('master:error', (event) => io.emit('master:error', event));
+
+// Broadcast BLOB transfer progress
+blobTransferService.on('progress', (event) => io.emit('blob:progress', event));
+blobTransferService.on('completed', (event) => io.emit('blob:completed', event));
+blobTransferService.on('failed', (event) => io.emit('blob:failed', event));
+
+// Broadcast samples lost to logging overruns and restarts
+dataLoggingService.on('gap', (event) => io.emit('logging:gap', event));
+
+// Broadcast alarm rule transitions
+rulesService.on('alarm', (event) => io.emit('rule:alarm', event));
+
+// Broadcast firmware update progress
+firmwareUpdateService.on('progress', (event) => io.emit('firmware:progress', event));
+firmwareUpdateService.on('completed', (event) => io.emit('firmware:completed', event));
+firmwareUpdateService.on('failed', (event) => io.emit('firmware:failed', event));
+
+// ============================================================================
+// HTTP WORKERS
+// ============================================================================
+
+let shuttingDown = false;
+
+const processImagePublisher = new ProcessImagePublisher(deviceManager, (batch) => {
+  for (const worker of Object.values(cluster.workers || {})) {
+    if (worker && worker.isConnected()) {
+      worker.send(batch);
+    }
+  }
+});
+
+function startHttpWorkers(): void {
+  cluster.setupPrimary({
+    exec: path.join(__dirname, `httpWorker${path.extname(__filename)}`),
+    serialization: 'advanced',
+  });
+
+  for (let i = 0; i < HTTP_WORKERS; i++) {
+    cluster.fork({ OWNER_PORT: String(OWNER_PORT) });
+  }
+
+  cluster.on('exit', (worker, code, signal) => {
+    if (shuttingDown) return;
+    logger.warn(
+      `HTTP worker ${worker.process.pid} exited (${signal || code}), restarting`
+    );
+    cluster.fork({ OWNER_PORT: String(OWNER_PORT) });
+  });
+
+  processImagePublisher.start();
+  serveRateLimitStore(globalLimiterStore);
+}
+
+process.once('SIGTERM', () => {
+  shuttingDown = true;
+});
+process.once('SIGINT', () => {
+  shuttingDown = true;
+});
+
 // ============================================================================
 // SERVER STARTUP
 // ============================================================================
 
 // Start server
-server.listen(PORT, HOST, () => {
+server.listen(LISTEN_PORT, LISTEN_HOST, () => {
   logger.info(`IO-Link Backend Server started`);
   logger.info(`HTTP Server: http://${HOST}:${PORT}`);
+  if (HTTP_WORKERS > 0) {
+    logger.info(
+      `Device owner on ${LISTEN_HOST}:${LISTEN_PORT}, ${HTTP_WORKERS} HTTP workers on port ${PORT}`
+    );
+    startHttpWorkers();
+  }
   logger.info(`WebSocket Server: ws://${HOST}:${PORT}/socket.io`);
   logger.info(`API Documentation: http://${HOST}:${PORT}/api/v1/docs`);
   logger.info(`Health Check: http://${HOST}:${PORT}/api/v1/health`);
@@ -93,12 +188,39 @@ server.listen(PORT, HOST, () => {
     logger.info(`Test the API with: curl http://${HOST}:${PORT}/api/v1/health`);
   }
 
+  // Start USB hot-plug detection for masters
+  if (process.env.MASTER_WATCHER !== 'false') {
+    masterWatcher.start();
+  }
+
+  // Start link quality sampling (statistic counters, master power)
+  if (process.env.LINK_QUALITY_SAMPLER !== 'false') {
+    linkQualityService.start();
+  }
+
+  // Start master clock correlation (cycle counters vs host clock)
+  if (process.env.MASTER_CLOCK !== 'false') {
+    masterClockService.start();
+  }
+
+  // Record logged process data into downsampling pyramids
+  if (process.env.HISTORY !== 'false') {
+    historyService.start();
+  }
+
+  // Evaluate alarm rules on logged samples and the process image
+  if (process.env.RULES !== 'false') {
+    rulesService.start();
+  }
+
   // Log available endpoints
   logger.info('Available API endpoints:');
   logger.info('   GET  /api/v1/health                     - Health check');
   logger.info('   GET  /api/v1/docs                       - API documentation');
   logger.info('   GET  /api/v1/masters                    - Discover masters');
   logger.info('   POST /api/v1/masters/connect            - Connect to master');
+  logger.info('   GET  /api/v1/masters/watcher            - Hot-plug watcher status');
+  logger.info('   GET  /api/v1/diagnostics/link-quality   - Link quality telemetry');
   logger.info('   GET  /api/v1/devices                    - List devices');
   logger.info('   GET  /api/v1/devices/summary            - Device summary');
   logger.info('   GET  /api/v1/data/:master/:port/process - Read process data');
@@ -110,7 +232,7 @@ server.listen(PORT, HOST, () => {
 // Handle server errors
 server.on('error', (err: NodeJS.ErrnoException) => {
   if (err.code === 'EADDRINUSE') {
-    logger.error(`Port ${PORT} is already in use`);
+    logger.error(`Port ${LISTEN_PORT} is already in use`);
     process.exit(1);
   } else {
     logger.error('Server error:', err);
@@ -177,4 +299,4 @@ if (process.env.NODE_ENV === 'development') {
 // EXPORTS
 // ============================================================================
 
-export { server, io, app };
+export { server, io, app, processImagePublisher };
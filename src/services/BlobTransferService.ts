@@ -0,0 +1,341 @@
+/**
+ * BLOB Transfer Service
+ * Stepwise, non-blocking BLOB upload/download with progress and abort
+ *
+ */
+
+import { EventEmitter } from "events";
+import { randomUUID } from "crypto";
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import {
+  BLOB_STATES,
+  BLOB_RETURN_CODES,
+  BLOB_RETURN_MESSAGES,
+  RETURN_CODES,
+} from "../utils/constants";
+
+type BlobDirection = "upload" | "download";
+
+interface BlobTransfer {
+  id: string;
+  direction: BlobDirection;
+  masterHandle: number;
+  port: number;
+  deviceKey: string;
+  blobId: number;
+  size: number;
+  position: number;
+  percentComplete: number;
+  state: "running" | "completed" | "failed" | "aborted";
+  error: string | null;
+  abortRequested: boolean;
+  startedAt: Date;
+  finishedAt: Date | null;
+}
+
+interface TransferOptions {
+  onStart?: (transfer: BlobTransfer) => void;
+}
+
+// ============================================================================
+// BLOB TRANSFER SERVICE CLASS
+// ============================================================================
+
+/**
+ * Drives the DLL's BLOB state machine one BLOB_Continue step at a time. Each
+ * step runs on the thread pool, so the event loop stays free and other
+ * ports keep working during long transfers. Uploaded data is handed to the
+ * caller as the transfer position advances instead of after completion.
+ *
+ * Emits "progress", "completed" and "failed" with the transfer summary.
+ */
+class BlobTransferService extends EventEmitter {
+  private deviceManager: DeviceManager;
+  private transfers: Map<string, BlobTransfer>;
+  private activePorts: Map<string, string>;
+
+  constructor(deviceManager: DeviceManager) {
+    super();
+    this.deviceManager = deviceManager;
+    this.transfers = new Map();
+    this.activePorts = new Map();
+  }
+
+  // ============================================================================
+  // TRANSFERS
+  // ============================================================================
+
+  /**
+   * Read a BLOB from the device. `sink` receives the data in order as it
+   * arrives and may return a promise to apply backpressure.
+   */
+  async upload(
+    masterHandle: number,
+    port: number,
+    blobId: number,
+    maxSize: number,
+    sink: (chunk: Buffer) => void | Promise<void>,
+    options: TransferOptions = {}
+  ): Promise<BlobTransfer> {
+    const transfer = this.createTransfer(
+      "upload",
+      masterHandle,
+      port,
+      blobId,
+      maxSize
+    );
+    options.onStart?.(transfer);
+
+    const iolinkService = this.deviceManager.getIOLinkService();
+    // The DLL writes into one buffer for the whole session, so it cannot
+    // grow. Left uninitialized, its pages are only committed as the BLOB
+    // fills them; bytes past the length read are never sent.
+    const buffer = Buffer.allocUnsafeSlow(maxSize);
+    let sent = 0;
+
+    const flush = async (upTo: number) => {
+      const end = Math.min(upTo, buffer.length);
+      if (end > sent) {
+        const chunk = buffer.slice(sent, end);
+        sent = end;
+        await sink(chunk);
+      }
+    };
+
+    return this.run(transfer, async () => {
+      const { session, step } = await iolinkService.startBlobUpload(
+        masterHandle,
+        port,
+        blobId,
+        buffer
+      );
+
+      await this.drive(transfer, session, step, async (current) => {
+        if (current.executedState === BLOB_STATES.BLOB_STATE_UPLOAD) {
+          await flush(current.position);
+        }
+      });
+
+      const length = iolinkService.getBlobLengthRead(session);
+      await flush(length);
+      transfer.size = length;
+      transfer.position = length;
+    });
+  }
+
+  /**
+   * Write a BLOB to the device. The DLL takes the complete content up front.
+   */
+  async download(
+    masterHandle: number,
+    port: number,
+    blobId: number,
+    data: Buffer,
+    options: TransferOptions = {}
+  ): Promise<BlobTransfer> {
+    const transfer = this.createTransfer(
+      "download",
+      masterHandle,
+      port,
+      blobId,
+      data.length
+    );
+    options.onStart?.(transfer);
+
+    const iolinkService = this.deviceManager.getIOLinkService();
+
+    return this.run(transfer, async () => {
+      const { session, step } = await iolinkService.startBlobDownload(
+        masterHandle,
+        port,
+        blobId,
+        data
+      );
+      await this.drive(transfer, session, step);
+      transfer.position = data.length;
+    });
+  }
+
+  abort(transferId: string): boolean {
+    const transfer = this.transfers.get(transferId);
+    if (!transfer || transfer.state !== "running") {
+      return false;
+    }
+    transfer.abortRequested = true;
+    logger.info(`Abort requested for BLOB transfer ${transferId}`);
+    return true;
+  }
+
+  getTransfer(transferId: string): BlobTransfer | undefined {
+    return this.transfers.get(transferId);
+  }
+
+  getTransfers(): BlobTransfer[] {
+    return Array.from(this.transfers.values());
+  }
+
+  // ============================================================================
+  // STATE MACHINE
+  // ============================================================================
+
+  private createTransfer(
+    direction: BlobDirection,
+    masterHandle: number,
+    port: number,
+    blobId: number,
+    size: number
+  ): BlobTransfer {
+    const deviceKey = `${masterHandle}:${port}`;
+    if (this.activePorts.has(deviceKey)) {
+      const error: any = new Error(
+        `BLOB transfer ${this.activePorts.get(deviceKey)} already running on ${deviceKey}`
+      );
+      error.statusCode = 409;
+      error.apiErrorCode = "BLOB_TRANSFER_BUSY";
+      throw error;
+    }
+
+    const transfer: BlobTransfer = {
+      id: randomUUID(),
+      direction,
+      masterHandle,
+      port,
+      deviceKey,
+      blobId,
+      size,
+      position: 0,
+      percentComplete: 0,
+      state: "running",
+      error: null,
+      abortRequested: false,
+      startedAt: new Date(),
+      finishedAt: null,
+    };
+
+    this.transfers.set(transfer.id, transfer);
+    this.activePorts.set(deviceKey, transfer.id);
+    this.pruneFinished();
+    return transfer;
+  }
+
+  private async run(
+    transfer: BlobTransfer,
+    body: () => Promise<void>
+  ): Promise<BlobTransfer> {
+    try {
+      await body();
+      transfer.state = "completed";
+      transfer.percentComplete = 100;
+      this.emit("completed", { ...transfer });
+      logger.info(
+        `BLOB ${transfer.direction} ${transfer.blobId} on ${transfer.deviceKey} completed (${transfer.position} bytes)`
+      );
+      return transfer;
+    } catch (error: any) {
+      transfer.state = transfer.abortRequested ? "aborted" : "failed";
+      transfer.error = error.message;
+      this.emit("failed", { ...transfer });
+      logger.error(
+        `BLOB ${transfer.direction} ${transfer.blobId} on ${transfer.deviceKey} ${transfer.state}:`,
+        error.message
+      );
+
+      // The DLL state machine only leaves the error state through an abort
+      try {
+        await this.deviceManager
+          .getIOLinkService()
+          .abortBlob(transfer.masterHandle, transfer.port);
+      } catch (abortError: any) {
+        logger.debug(`BLOB_Abort after failure: ${abortError.message}`);
+      }
+      throw error;
+    } finally {
+      transfer.finishedAt = new Date();
+      this.activePorts.delete(transfer.deviceKey);
+    }
+  }
+
+  private async drive(
+    transfer: BlobTransfer,
+    session: any,
+    firstStep: any,
+    onStep?: (step: any) => Promise<void>
+  ): Promise<void> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+    let step = firstStep;
+
+    for (;;) {
+      this.checkStep(step);
+      this.updateProgress(transfer, step);
+
+      if (onStep) {
+        await onStep(step);
+      }
+      if (step.nextState === BLOB_STATES.BLOB_STATE_IDLE) {
+        return;
+      }
+      if (transfer.abortRequested) {
+        throw new Error("BLOB transfer aborted");
+      }
+
+      step = await iolinkService.continueBlob(
+        transfer.masterHandle,
+        transfer.port,
+        session
+      );
+    }
+  }
+
+  private checkStep(step: any): void {
+    if (step.result < RETURN_CODES.RETURN_OK) {
+      const error: any = new Error(`BLOB step failed with DLL code: ${step.result}`);
+      error.code = step.result;
+      throw error;
+    }
+    if (step.result !== BLOB_RETURN_CODES.BLOB_RET_OK) {
+      throw new Error(
+        BLOB_RETURN_MESSAGES[step.result] || `BLOB error: ${step.result}`
+      );
+    }
+    if (step.nextState === BLOB_STATES.BLOB_STATE_ERROR) {
+      throw new Error(
+        `BLOB state machine error: Code=${step.errorCode}, Additional=${step.additionalCode}`
+      );
+    }
+  }
+
+  private updateProgress(transfer: BlobTransfer, step: any): void {
+    const percent = step.percentComplete;
+    const changed =
+      percent !== transfer.percentComplete ||
+      step.position !== transfer.position;
+
+    transfer.position = step.position;
+    transfer.percentComplete = percent;
+
+    if (changed) {
+      this.emit("progress", {
+        id: transfer.id,
+        direction: transfer.direction,
+        deviceKey: transfer.deviceKey,
+        blobId: transfer.blobId,
+        position: step.position,
+        percentComplete: percent,
+        timestamp: new Date(),
+      });
+    }
+  }
+
+  private pruneFinished(maxEntries: number = 100): void {
+    if (this.transfers.size <= maxEntries) return;
+    for (const [id, transfer] of this.transfers) {
+      if (transfer.state !== "running") {
+        this.transfers.delete(id);
+        if (this.transfers.size <= maxEntries) return;
+      }
+    }
+  }
+}
+
+export default BlobTransferService;
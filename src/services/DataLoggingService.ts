@@ -0,0 +1,660 @@
+/**
+ * Data Logging Service
+ * Multi-port logging through the master's logging buffer, one drain loop per master
+ *
+ */
+
+import { EventEmitter } from "events";
+import { performance } from "perf_hooks";
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import { SampleClock } from "../utils/sampleClock";
+import { LoggingRing, LoggedSample } from "../utils/loggingRing";
+import {
+  LoggingEntry,
+  parseLoggingEntries,
+  loggingBufferSize,
+  estimateLostSamples,
+} from "../utils/loggingEntries";
+import { PROCESS_DATA_MAX_LENGTH } from "../utils/processImage";
+import {
+  LIMITS,
+  LOGGING_MODES,
+  LOGGING_STATUS,
+  RETURN_CODES,
+} from "../utils/constants";
+
+interface LoggingOptions {
+  sampleTimeUs?: number;
+  // Fixed buffer size per port; sized from sample time and PD length if omitted
+  memorySize?: number;
+}
+
+// Weight of the newest drain in the ingest rate estimate
+const RATE_GAIN = 0.2;
+
+interface PortLog {
+  port: number;
+  requestedSampleTimeUs: number;
+  sampleTimeUs: number;
+  memorySize: number;
+  autoSize: boolean;
+  clock: SampleClock;
+  ring: LoggingRing;
+  startedAt: Date;
+  // Added to clock indexes so sample indexes keep counting across restarts
+  indexOffset: number;
+  // Last delivered (or accounted) sample, for gap estimates on restart
+  last: { index: number; timestamp: number; periodMs: number } | null;
+  counters: {
+    samples: number;
+    invalid: number;
+    overruns: number;
+    gaps: number;
+    lostSamples: number;
+  };
+}
+
+interface MasterLog {
+  masterHandle: number;
+  ports: Map<number, PortLog>;
+  // Reused by every read; entries are copied out before the next one
+  buffer: Buffer;
+  state: "running" | "overrun";
+  timer: NodeJS.Timeout | null;
+  // Serializes drains with start/stop so the buffer has one user
+  pending: Promise<void>;
+  drainIntervalMs: number;
+  lastDrainAt: number;
+  // Logged bytes per ms, fast up and slow down
+  ingestRate: number;
+  stats: {
+    reads: number;
+    bytes: number;
+    unknownPortEntries: number;
+    discardedBytes: number;
+    lastDrainMs: number;
+    maxDrainMs: number;
+    lastFill: number;
+    maxFill: number;
+    overruns: number;
+    restarts: number;
+  };
+}
+
+export interface LoggedSamples {
+  masterHandle: number;
+  port: number;
+  samples: LoggedSample[];
+}
+
+// ============================================================================
+// DATA LOGGING SERVICE
+// ============================================================================
+
+/**
+ * The master logs every port into one buffer and tags each entry with its
+ * port. One loop per master drains that buffer, splits the entries by port
+ * and stamps each port on its own sample clock, so several ports at
+ * different sample times are captured with a single read stream. Samples
+ * land in a fixed-size ring per port and are emitted as "samples"
+ * (LoggedSamples) for streaming subscribers.
+ *
+ * IOL_StopDataLogging only stops the whole master. Stopping some ports, or
+ * changing the settings of a running one, drains the buffer, stops the
+ * master and starts the remaining ports again; their clocks re-anchor.
+ *
+ * Ports whose logging ends, on request or because the master was lost,
+ * are emitted as "stopped" ({ masterHandle, port }) after their last
+ * samples.
+ *
+ * Overruns are avoided and survived rather than reported:
+ *
+ * - each port's buffer is sized to hold LOGGING_BUFFER_HEADROOM_MS of its
+ *   entries (sample time and PD length) unless a size is given
+ * - the drain interval follows the measured ingest rate so a drain finds
+ *   the buffer about LOGGING_DRAIN_TARGET_FILL full
+ * - after an overrun logging restarts at once, auto-sized buffers double,
+ *   and every port gets a gap record with the estimated lost samples
+ *   (also emitted as "gap"); sample indexes skip the lost ones
+ */
+class DataLoggingService extends EventEmitter {
+  private deviceManager: DeviceManager;
+  private masters: Map<number, MasterLog>;
+
+  constructor(deviceManager: DeviceManager) {
+    super();
+    this.deviceManager = deviceManager;
+    this.masters = new Map();
+  }
+
+  // ============================================================================
+  // START / STOP
+  // ============================================================================
+
+  async start(
+    masterHandle: number,
+    ports: number[],
+    options: LoggingOptions = {}
+  ): Promise<any> {
+    const connected = this.deviceManager
+      .getConnectedMasters()
+      .some((master) => master.handle === masterHandle);
+    if (!connected) {
+      const error: any = new Error(`Master ${masterHandle} not connected`);
+      error.statusCode = 404;
+      error.apiErrorCode = "MASTER_NOT_FOUND";
+      throw error;
+    }
+
+    const sampleTimeUs = options.sampleTimeUs || LIMITS.LOGGING_SAMPLE_TIME_DEFAULT;
+
+    let log = this.masters.get(masterHandle);
+    if (!log) {
+      log = this.createMasterLog(masterHandle);
+      this.masters.set(masterHandle, log);
+    }
+    const master = log;
+
+    await this.exclusive(master, async () => {
+      // A running port can only be re-timed by restarting the master
+      let restart = master.state === "overrun";
+      const added: PortLog[] = [];
+      for (const port of ports) {
+        const memorySize = options.memorySize || this.bufferSizeFor(masterHandle, port, sampleTimeUs);
+        const existing = master.ports.get(port);
+        if (existing) {
+          if (
+            existing.requestedSampleTimeUs !== sampleTimeUs ||
+            (options.memorySize !== undefined && existing.memorySize !== memorySize)
+          ) {
+            existing.requestedSampleTimeUs = sampleTimeUs;
+            existing.memorySize = memorySize;
+            existing.autoSize = options.memorySize === undefined;
+            restart = true;
+          }
+          continue;
+        }
+        const portLog = this.createPortLog(port, sampleTimeUs, memorySize);
+        portLog.autoSize = options.memorySize === undefined;
+        master.ports.set(port, portLog);
+        added.push(portLog);
+      }
+
+      try {
+        if (restart) {
+          await this.drain(master);
+          this.restartPorts(master);
+        } else {
+          for (const portLog of added) {
+            this.startPort(master, portLog);
+          }
+        }
+      } catch (error) {
+        for (const portLog of added) {
+          master.ports.delete(portLog.port);
+        }
+        if (master.ports.size === 0) {
+          this.release(master);
+        }
+        throw error;
+      }
+    });
+
+    this.scheduleDrain(master);
+    return this.getStatus(masterHandle);
+  }
+
+  /**
+   * Stop the given ports, or all of them
+   */
+  async stop(masterHandle: number, ports?: number[]): Promise<any> {
+    const log = this.masters.get(masterHandle);
+    if (!log) {
+      return this.getStatus(masterHandle);
+    }
+
+    const stopped: number[] = [];
+    await this.exclusive(log, async () => {
+      // Restarting the master for ports that are not logged would only
+      // record a gap on every port that is
+      const requested = Array.from(log.ports.keys()).filter(
+        (port) => ports === undefined || ports.includes(port)
+      );
+      if (requested.length === 0) return;
+
+      // Deliver what the stopped ports logged so far
+      await this.drain(log).catch((error: any) =>
+        logger.debug(`Final logging drain on master ${masterHandle} failed: ${error.message}`)
+      );
+
+      const remaining = Array.from(log.ports.keys()).filter(
+        (port) => !requested.includes(port)
+      );
+      for (const port of Array.from(log.ports.keys())) {
+        if (!remaining.includes(port)) {
+          log.ports.delete(port);
+          stopped.push(port);
+        }
+      }
+
+      if (remaining.length === 0) {
+        this.release(log);
+        this.deviceManager.getIOLinkService().stopDataLogging(masterHandle);
+        logger.info(`Data logging stopped on master ${masterHandle}`);
+      } else {
+        this.restartPorts(log);
+      }
+    });
+
+    for (const port of stopped) {
+      this.emit("stopped", { masterHandle, port });
+    }
+    this.scheduleDrain(log);
+    return this.getStatus(masterHandle);
+  }
+
+  private startPort(log: MasterLog, portLog: PortLog): void {
+    const sampleTimeUs = this.deviceManager
+      .getIOLinkService()
+      .startDataLogging(
+        log.masterHandle,
+        portLog.port,
+        portLog.memorySize,
+        LOGGING_MODES.TIME,
+        portLog.requestedSampleTimeUs
+      );
+    // Keep the drift estimate when the period is unchanged
+    if (sampleTimeUs === portLog.sampleTimeUs) {
+      portLog.clock.restart();
+    } else {
+      portLog.clock = new SampleClock(sampleTimeUs);
+    }
+    portLog.sampleTimeUs = sampleTimeUs;
+    portLog.startedAt = new Date();
+
+    logger.info(
+      `Data logging on master ${log.masterHandle} port ${portLog.port}: ${portLog.sampleTimeUs}µs (requested ${portLog.requestedSampleTimeUs}µs), ${portLog.memorySize} bytes`
+    );
+  }
+
+  /**
+   * Stop the master and start all its ports again. Whatever the ports would
+   * have logged in between is recorded as a gap.
+   */
+  private restartPorts(log: MasterLog): void {
+    this.deviceManager.getIOLinkService().stopDataLogging(log.masterHandle);
+    for (const portLog of log.ports.values()) {
+      this.startPort(log, portLog);
+    }
+    const restartedAt = performance.timeOrigin + performance.now();
+    log.state = "running";
+    log.stats.restarts++;
+
+    for (const portLog of log.ports.values()) {
+      this.recordGap(log, portLog, restartedAt);
+    }
+  }
+
+  private recordGap(log: MasterLog, portLog: PortLog, restartedAt: number): void {
+    const { last } = portLog;
+    if (!last) return;
+
+    const lostSamples = estimateLostSamples(last.timestamp, last.periodMs, restartedAt);
+    const record = portLog.ring.pushGap(last.index + 1, last.timestamp + last.periodMs, {
+      lostSamples,
+      until: restartedAt,
+    });
+    portLog.indexOffset = last.index + 1 + lostSamples;
+    portLog.counters.gaps++;
+    portLog.counters.lostSamples += lostSamples;
+
+    // Until new samples arrive, the restart itself is the last accounted point
+    const periodMs = portLog.sampleTimeUs / 1000;
+    portLog.last = {
+      index: portLog.indexOffset - 1,
+      timestamp: restartedAt - periodMs,
+      periodMs,
+    };
+
+    logger.warn(
+      `Data logging gap on master ${log.masterHandle} port ${portLog.port}: ~${lostSamples} samples lost`
+    );
+    this.emit("gap", {
+      masterHandle: log.masterHandle,
+      port: portLog.port,
+      sampleIndex: record.sampleIndex,
+      from: new Date(record.timestamp).toISOString(),
+      until: new Date(restartedAt).toISOString(),
+      lostSamples,
+    });
+    this.emit("samples", {
+      masterHandle: log.masterHandle,
+      port: portLog.port,
+      samples: [record],
+    } as LoggedSamples);
+  }
+
+  /**
+   * Buffer for LOGGING_BUFFER_HEADROOM_MS of a port's entries
+   */
+  private bufferSizeFor(masterHandle: number, port: number, sampleTimeUs: number): number {
+    let inputLength = PROCESS_DATA_MAX_LENGTH;
+    let outputLength = PROCESS_DATA_MAX_LENGTH;
+    try {
+      const device = this.deviceManager.getDevice(masterHandle, port);
+      inputLength = device.processDataInputLength || inputLength;
+      outputLength = device.processDataOutputLength || outputLength;
+    } catch {
+      // No device information yet: assume the largest process data
+    }
+    return loggingBufferSize(sampleTimeUs, inputLength, outputLength);
+  }
+
+  private release(log: MasterLog): void {
+    if (log.timer) {
+      clearTimeout(log.timer);
+      log.timer = null;
+    }
+    this.masters.delete(log.masterHandle);
+  }
+
+  private exclusive(log: MasterLog, fn: () => Promise<void>): Promise<void> {
+    const next = log.pending.then(fn);
+    log.pending = next.catch(() => undefined);
+    return next;
+  }
+
+  private createMasterLog(masterHandle: number): MasterLog {
+    return {
+      masterHandle,
+      ports: new Map(),
+      buffer: Buffer.alloc(LIMITS.LOGGING_READ_BUFFER),
+      state: "running",
+      timer: null,
+      pending: Promise.resolve(),
+      drainIntervalMs: LIMITS.LOGGING_DRAIN_INTERVAL,
+      lastDrainAt: performance.now(),
+      ingestRate: 0,
+      stats: {
+        reads: 0,
+        bytes: 0,
+        unknownPortEntries: 0,
+        discardedBytes: 0,
+        lastDrainMs: 0,
+        maxDrainMs: 0,
+        lastFill: 0,
+        maxFill: 0,
+        overruns: 0,
+        restarts: 0,
+      },
+    };
+  }
+
+  private createPortLog(port: number, sampleTimeUs: number, memorySize: number): PortLog {
+    return {
+      port,
+      requestedSampleTimeUs: sampleTimeUs,
+      sampleTimeUs,
+      memorySize,
+      autoSize: true,
+      clock: new SampleClock(sampleTimeUs),
+      ring: new LoggingRing(LIMITS.LOGGING_RING_SIZE),
+      startedAt: new Date(),
+      indexOffset: 0,
+      last: null,
+      counters: { samples: 0, invalid: 0, overruns: 0, gaps: 0, lostSamples: 0 },
+    };
+  }
+
+  // ============================================================================
+  // DRAIN LOOP
+  // ============================================================================
+
+  private scheduleDrain(log: MasterLog): void {
+    if (log.timer || this.masters.get(log.masterHandle) !== log) return;
+
+    log.timer = setTimeout(() => {
+      log.timer = null;
+      this.exclusive(log, async () => {
+        if (this.masters.get(log.masterHandle) === log) await this.drain(log);
+      })
+        .then(() => {
+          // A failed restart after an overrun leaves the master stopped
+          if (log.state === "running") this.scheduleDrain(log);
+        })
+        .catch((error: any) => {
+          if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+            logger.warn(`Master ${log.masterHandle} lost, data logging ended`);
+            this.release(log);
+            for (const port of log.ports.keys()) {
+              this.emit("stopped", { masterHandle: log.masterHandle, port });
+            }
+            return;
+          }
+          logger.error(
+            `Data logging drain on master ${log.masterHandle} failed: ${error.message}`
+          );
+          this.scheduleDrain(log);
+        });
+    }, log.drainIntervalMs);
+  }
+
+  /**
+   * Read until the master reports no more data, restart after an overrun
+   * and pick the next drain interval
+   */
+  private async drain(log: MasterLog): Promise<void> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+    const started = performance.now();
+    let status: number;
+    let bytesRead: number;
+    let drainedBytes = 0;
+    let overrun = false;
+
+    do {
+      const read = await iolinkService.readLoggingBuffer(log.masterHandle, log.buffer);
+      status = read.status;
+      bytesRead = read.bytesRead;
+      drainedBytes += bytesRead;
+      log.stats.reads++;
+      log.stats.bytes += bytesRead;
+      const drained = (status & LOGGING_STATUS.AVAILABLE) === 0 || bytesRead === 0;
+      // The overrun sits after the buffered data, i.e. after the last read
+      overrun = (status & LOGGING_STATUS.OVERRUN) !== 0 && drained;
+      this.dispatch(log, bytesRead, read.readAt, drained, overrun);
+    } while ((status & LOGGING_STATUS.AVAILABLE) !== 0 && bytesRead > 0);
+
+    const finished = performance.now();
+    log.stats.lastDrainMs = finished - started;
+    log.stats.maxDrainMs = Math.max(log.stats.maxDrainMs, log.stats.lastDrainMs);
+    this.adaptDrainInterval(log, drainedBytes, finished);
+
+    if (overrun) {
+      this.recoverOverrun(log);
+    }
+  }
+
+  /**
+   * Next interval so that, at the current ingest rate, a drain finds the
+   * buffer LOGGING_DRAIN_TARGET_FILL full. A burst shortens it at once;
+   * a quieter phase lengthens it gradually.
+   */
+  private adaptDrainInterval(log: MasterLog, bytes: number, now: number): void {
+    const elapsed = now - log.lastDrainAt;
+    log.lastDrainAt = now;
+    if (elapsed <= 0) return;
+
+    let capacity = 0;
+    for (const portLog of log.ports.values()) {
+      capacity += portLog.memorySize;
+    }
+    if (capacity === 0) return;
+
+    const rate = bytes / elapsed;
+    log.ingestRate = Math.max(rate, log.ingestRate + RATE_GAIN * (rate - log.ingestRate));
+    log.stats.lastFill = bytes / capacity;
+    log.stats.maxFill = Math.max(log.stats.maxFill, log.stats.lastFill);
+
+    const intervalMs =
+      log.ingestRate > 0
+        ? (capacity * LIMITS.LOGGING_DRAIN_TARGET_FILL) / log.ingestRate
+        : LIMITS.LOGGING_DRAIN_INTERVAL_MAX;
+    log.drainIntervalMs = Math.min(
+      LIMITS.LOGGING_DRAIN_INTERVAL_MAX,
+      Math.max(LIMITS.LOGGING_DRAIN_INTERVAL_MIN, intervalMs)
+    );
+  }
+
+  private recoverOverrun(log: MasterLog): void {
+    log.stats.overruns++;
+    for (const portLog of log.ports.values()) {
+      portLog.counters.overruns++;
+      if (portLog.autoSize) {
+        portLog.memorySize = Math.min(LIMITS.LOGGING_MEMORY_MAX, portLog.memorySize * 2);
+      }
+    }
+    logger.warn(`Logging buffer overrun on master ${log.masterHandle}, restarting logging`);
+
+    try {
+      this.restartPorts(log);
+    } catch (error: any) {
+      log.state = "overrun";
+      logger.error(
+        `Restarting data logging on master ${log.masterHandle} failed: ${error.message}`
+      );
+    }
+  }
+
+  private dispatch(
+    log: MasterLog,
+    length: number,
+    readAt: number,
+    drained: boolean,
+    overrun: boolean
+  ): void {
+    const { entries, consumed } = parseLoggingEntries(log.buffer, length);
+    log.stats.discardedBytes += length - consumed;
+
+    const byPort = new Map<number, LoggingEntry[]>();
+    for (const entry of entries) {
+      if (!log.ports.has(entry.port)) {
+        log.stats.unknownPortEntries++;
+        continue;
+      }
+      const portEntries = byPort.get(entry.port);
+      if (portEntries) {
+        portEntries.push(entry);
+      } else {
+        byPort.set(entry.port, [entry]);
+      }
+    }
+
+    const streaming = this.listenerCount("samples") > 0;
+    for (const portLog of log.ports.values()) {
+      const portEntries = byPort.get(portLog.port);
+      if (!portEntries) continue;
+
+      const stamped = portLog.clock.stamp(portEntries.length, readAt, drained, overrun);
+      const firstIndex = portLog.indexOffset + stamped.firstIndex;
+      const firstSequence = portLog.ring.head;
+      for (let i = 0; i < portEntries.length; i++) {
+        const entry = portEntries[i];
+        portLog.ring.push(
+          firstIndex + i,
+          stamped.timestamps[i],
+          stamped.quality,
+          entry.inputValid,
+          entry.inputData,
+          entry.outputData
+        );
+        if (!entry.inputValid) portLog.counters.invalid++;
+      }
+      portLog.counters.samples += portEntries.length;
+      portLog.last = {
+        index: firstIndex + portEntries.length - 1,
+        timestamp: stamped.timestamps[portEntries.length - 1],
+        periodMs: portLog.clock.getStatus().periodUs / 1000,
+      };
+
+      if (streaming) {
+        const batch: LoggedSamples = {
+          masterHandle: log.masterHandle,
+          port: portLog.port,
+          samples: portEntries.map((entry, i) => ({
+            sequence: firstSequence + i,
+            sampleIndex: firstIndex + i,
+            timestamp: stamped.timestamps[i],
+            timestampQuality: stamped.quality,
+            inputValid: entry.inputValid,
+            inputData: Buffer.from(entry.inputData),
+            outputData: Buffer.from(entry.outputData),
+          })),
+        };
+        this.emit("samples", batch);
+      }
+    }
+  }
+
+  // ============================================================================
+  // QUERIES
+  // ============================================================================
+
+  isLogging(masterHandle: number, port: number): boolean {
+    return this.masters.get(masterHandle)?.ports.has(port) ?? false;
+  }
+
+  /**
+   * Samples held for a port, oldest first. since is a sequence cursor
+   * (nextSequence of the previous call); without it the newest are returned.
+   */
+  getSamples(
+    masterHandle: number,
+    port: number,
+    since: number | null,
+    limit: number
+  ): { samples: LoggedSample[]; nextSequence: number; oldestSequence: number } | null {
+    const portLog = this.masters.get(masterHandle)?.ports.get(port);
+    if (!portLog) return null;
+
+    const samples = portLog.ring.read(since, limit);
+    const nextSequence =
+      samples.length > 0
+        ? samples[samples.length - 1].sequence + 1
+        : Math.max(since ?? portLog.ring.head, portLog.ring.tail);
+    return { samples, nextSequence, oldestSequence: portLog.ring.tail };
+  }
+
+  getStatus(masterHandle: number) {
+    const log = this.masters.get(masterHandle);
+    if (!log) {
+      return { masterHandle, state: "stopped", ports: [], stats: null };
+    }
+
+    return {
+      masterHandle,
+      state: log.state,
+      ports: Array.from(log.ports.values()).map((portLog) => ({
+        port: portLog.port,
+        sampleTimeUs: portLog.sampleTimeUs,
+        requestedSampleTimeUs: portLog.requestedSampleTimeUs,
+        memorySize: portLog.memorySize,
+        autoSize: portLog.autoSize,
+        startedAt: portLog.startedAt.toISOString(),
+        buffered: portLog.ring.size,
+        nextSequence: portLog.ring.head,
+        ...portLog.counters,
+        clock: portLog.clock.getStatus(),
+      })),
+      drainIntervalMs: log.drainIntervalMs,
+      ingestBytesPerSecond: Math.round(log.ingestRate * 1000),
+      stats: { ...log.stats },
+    };
+  }
+
+  getAllStatus() {
+    return Array.from(this.masters.keys()).map((handle) => this.getStatus(handle));
+  }
+}
+
+export default DataLoggingService;
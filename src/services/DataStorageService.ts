@@ -0,0 +1,482 @@
+/**
+ * Data Storage Service
+ * Fleet backup and restore of device data storage with content-addressed dedup
+ *
+ */
+
+import { createHash, randomUUID } from "crypto";
+import { promises as fs } from "fs";
+import * as path from "path";
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import {
+  DS_COMMANDS,
+  EVENT_CODES,
+  EVENT_CODE_NAMES,
+  LIMITS,
+} from "../utils/constants";
+
+interface PortTarget {
+  masterHandle: number;
+  port: number;
+}
+
+interface RestoreTarget extends PortTarget {
+  // Port (and master) of the backup entry to restore; defaults to the target
+  sourcePort?: number;
+  sourceMaster?: string;
+}
+
+interface BackupEntry {
+  masterName: string;
+  port: number;
+  vendorId: string | null;
+  deviceId: string | null;
+  deviceName: string | null;
+  serialNumber: string | null;
+  hash: string;
+  size: number;
+}
+
+interface BackupManifest {
+  id: string;
+  createdAt: string;
+  durationMs: number;
+  entries: BackupEntry[];
+  failures: Array<{ masterName: string; port: number; error: string }>;
+  stats: {
+    ports: number;
+    newObjects: number;
+    dedupedObjects: number;
+    bytesStored: number;
+    bytesTotal: number;
+  };
+}
+
+interface RestoreOutcome {
+  masterHandle: number;
+  port: number;
+  hash: string | null;
+  status: "restored" | "unchanged" | "skipped" | "failed";
+  error?: string;
+}
+
+// ============================================================================
+// DATA STORAGE SERVICE CLASS
+// ============================================================================
+
+/**
+ * Reads the master's data storage copy of every port in parallel and keeps
+ * each distinct content once, named by its SHA-256. A backup is a small
+ * manifest of (master, port) -> hash, so a line of identically configured
+ * sensors costs one object. Restores write the stored content back with
+ * IOL_DS_ContentSet and a download command, skipping ports whose current
+ * content already has the same hash.
+ *
+ * Layout below the store directory: objects/<hash>.ds, backups/<id>.json
+ */
+class DataStorageService {
+  private deviceManager: DeviceManager;
+  private storeDir: string;
+  private knownObjects: Set<string> | null;
+
+  constructor(deviceManager: DeviceManager, storeDir?: string) {
+    this.deviceManager = deviceManager;
+    this.storeDir =
+      storeDir ||
+      process.env.DS_STORE_DIR ||
+      path.join(process.cwd(), "data", "datastorage");
+    this.knownObjects = null;
+  }
+
+  // ============================================================================
+  // BACKUP
+  // ============================================================================
+
+  /**
+   * Back up the given ports, or every communicating device when none are
+   * given. With `refresh`, each device first uploads its current parameters
+   * into the master (DS_CMD_UPLOAD); otherwise the master's copy is used.
+   */
+  async backup(
+    targets?: PortTarget[],
+    options: { refresh?: boolean } = {}
+  ): Promise<BackupManifest> {
+    const started = Date.now();
+    const ports = targets && targets.length > 0 ? targets : this.listDevicePorts();
+    await this.loadIndex();
+
+    const manifest: BackupManifest = {
+      id: randomUUID(),
+      createdAt: new Date(started).toISOString(),
+      durationMs: 0,
+      entries: [],
+      failures: [],
+      stats: {
+        ports: ports.length,
+        newObjects: 0,
+        dedupedObjects: 0,
+        bytesStored: 0,
+        bytesTotal: 0,
+      },
+    };
+
+    const results = await Promise.all(
+      ports.map((target) =>
+        this.backupPort(target, options.refresh === true).then(
+          (result) => ({ target, result, error: null as any }),
+          (error) => ({ target, result: null, error })
+        )
+      )
+    );
+
+    for (const { target, result, error } of results) {
+      if (error || !result) {
+        manifest.failures.push({
+          masterName: this.getMasterName(target.masterHandle),
+          port: target.port,
+          error: error ? error.message : "No content",
+        });
+        continue;
+      }
+      manifest.entries.push(result.entry);
+      manifest.stats.bytesTotal += result.entry.size;
+      if (result.stored) {
+        manifest.stats.newObjects++;
+        manifest.stats.bytesStored += result.entry.size;
+      } else {
+        manifest.stats.dedupedObjects++;
+      }
+    }
+
+    manifest.durationMs = Date.now() - started;
+    await this.writeManifest(manifest);
+
+    logger.info(
+      `Data storage backup ${manifest.id}: ${manifest.entries.length}/${ports.length} ports, ` +
+        `${manifest.stats.newObjects} new object(s), ${manifest.stats.bytesStored} bytes stored (${manifest.durationMs}ms)`
+    );
+    return manifest;
+  }
+
+  private async backupPort(
+    target: PortTarget,
+    refresh: boolean
+  ): Promise<{ entry: BackupEntry; stored: boolean }> {
+    const content = await this.readContent(target, refresh);
+    if (content.length === 0) {
+      throw new Error("Data storage is empty (is data storage enabled on the port?)");
+    }
+
+    const hash = this.hash(content);
+    const stored = await this.storeObject(hash, content);
+    const device = this.findDevice(target);
+
+    return {
+      entry: {
+        masterName: this.getMasterName(target.masterHandle),
+        port: target.port,
+        vendorId: device ? device.vendorId : null,
+        deviceId: device ? device.deviceId : null,
+        deviceName: device ? device.deviceName : null,
+        serialNumber: device ? device.serialNumber : null,
+        hash,
+        size: content.length,
+      },
+      stored,
+    };
+  }
+
+  // ============================================================================
+  // RESTORE
+  // ============================================================================
+
+  /**
+   * Restore a backup onto the given ports (all of its entries whose master
+   * is connected when none are given). Ports are restored in parallel.
+   * The unchanged check compares against the master's data storage copy;
+   * with `refresh`, each device first uploads its current parameters.
+   */
+  async restore(
+    backupId: string,
+    targets?: RestoreTarget[],
+    options: { refresh?: boolean } = {}
+  ): Promise<{ backupId: string; durationMs: number; outcomes: RestoreOutcome[] }> {
+    const started = Date.now();
+    const manifest = await this.getBackup(backupId);
+    const refresh = options.refresh === true;
+
+    const plan: Array<{ target: PortTarget; entry: BackupEntry | undefined }> = [];
+    if (targets && targets.length > 0) {
+      for (const target of targets) {
+        const sourceMaster =
+          target.sourceMaster || this.getMasterName(target.masterHandle);
+        const sourcePort = target.sourcePort || target.port;
+        plan.push({
+          target,
+          entry: manifest.entries.find(
+            (e) => e.masterName === sourceMaster && e.port === sourcePort
+          ),
+        });
+      }
+    } else {
+      for (const entry of manifest.entries) {
+        const masterHandle = this.deviceManager.getMasterHandleByName(entry.masterName);
+        if (masterHandle === undefined) continue;
+        plan.push({ target: { masterHandle, port: entry.port }, entry });
+      }
+    }
+
+    const outcomes = await Promise.all(
+      plan.map(({ target, entry }) => this.restorePort(target, entry, refresh))
+    );
+
+    const durationMs = Date.now() - started;
+    const restored = outcomes.filter((o) => o.status === "restored").length;
+    logger.info(
+      `Data storage restore from ${backupId}: ${restored} restored, ` +
+        `${outcomes.length - restored} unchanged/skipped/failed (${durationMs}ms)`
+    );
+    return { backupId, durationMs, outcomes };
+  }
+
+  private async restorePort(
+    target: PortTarget,
+    entry: BackupEntry | undefined,
+    refresh: boolean
+  ): Promise<RestoreOutcome> {
+    const outcome: RestoreOutcome = {
+      masterHandle: target.masterHandle,
+      port: target.port,
+      hash: entry ? entry.hash : null,
+      status: "skipped",
+    };
+    if (!entry) {
+      outcome.error = "No matching entry in backup";
+      return outcome;
+    }
+
+    try {
+      const content = await this.readObject(entry.hash);
+
+      let current: Buffer | null = null;
+      try {
+        current = await this.readContent(target, refresh);
+      } catch (error: any) {
+        logger.debug(
+          `Could not read current data storage of ${target.masterHandle}:${target.port}: ${error.message}`
+        );
+      }
+      if (current && current.length > 0 && this.hash(current) === entry.hash) {
+        outcome.status = "unchanged";
+        return outcome;
+      }
+
+      const iolinkService = this.deviceManager.getIOLinkService();
+      await iolinkService.setDataStorageContent(target.masterHandle, target.port, content);
+      await this.runCommand(target, DS_COMMANDS.DS_CMD_DOWNLOAD);
+
+      outcome.status = "restored";
+    } catch (error: any) {
+      outcome.status = "failed";
+      outcome.error = error.message;
+      logger.error(
+        `Data storage restore on ${target.masterHandle}:${target.port} failed:`,
+        error.message
+      );
+    }
+    return outcome;
+  }
+
+  // ============================================================================
+  // DEVICE ACCESS
+  // ============================================================================
+
+  private async readContent(target: PortTarget, refresh: boolean): Promise<Buffer> {
+    if (refresh) {
+      await this.runCommand(target, DS_COMMANDS.DS_CMD_UPLOAD);
+    }
+    return this.deviceManager
+      .getIOLinkService()
+      .getDataStorageContent(target.masterHandle, target.port);
+  }
+
+  /**
+   * Issue a DS command and wait for the port's completion event.
+   */
+  private async runCommand(target: PortTarget, command: number): Promise<void> {
+    const completion = this.deviceManager.waitForDataStorageEvent(
+      target.masterHandle,
+      target.port
+    );
+    // Avoid an unhandled rejection if the command itself fails first
+    completion.catch(() => undefined);
+
+    await this.deviceManager
+      .getIOLinkService()
+      .dataStorageCommand(target.masterHandle, target.port, command);
+
+    const event = await completion;
+    if (
+      event.eventCode !== EVENT_CODES.EVNT_CODE_DSREADY_UPLOAD &&
+      event.eventCode !== EVENT_CODES.EVNT_CODE_DSREADY_DOWNLOAD &&
+      event.eventCode !== EVENT_CODES.EVNT_CODE_DSREADY_NOACTION
+    ) {
+      const error: any = new Error(
+        `Data storage ${EVENT_CODE_NAMES[event.eventCode] || `event ${event.eventCode}`}`
+      );
+      error.statusCode = 409;
+      error.apiErrorCode = "DATA_STORAGE_FAULT";
+      throw error;
+    }
+  }
+
+  private listDevicePorts(): PortTarget[] {
+    const targets: PortTarget[] = [];
+    for (const master of this.deviceManager.getConnectedMasters()) {
+      for (let port = LIMITS.MIN_PORT; port <= LIMITS.MAX_PORTS; port++) {
+        const device = this.findDevice({ masterHandle: master.handle, port });
+        if (device && device.isInCommunication()) {
+          targets.push({ masterHandle: master.handle, port });
+        }
+      }
+    }
+    return targets;
+  }
+
+  private findDevice(target: PortTarget): any {
+    try {
+      return this.deviceManager.getDevice(target.masterHandle, target.port);
+    } catch (error) {
+      return null;
+    }
+  }
+
+  private getMasterName(masterHandle: number): string {
+    const master = this.deviceManager
+      .getConnectedMasters()
+      .find((m) => m.handle === masterHandle);
+    return master ? master.deviceName : String(masterHandle);
+  }
+
+  // ============================================================================
+  // CONTENT-ADDRESSED STORE
+  // ============================================================================
+
+  private hash(content: Buffer): string {
+    return createHash("sha256").update(content).digest("hex");
+  }
+
+  private objectPath(hash: string): string {
+    return path.join(this.storeDir, "objects", `${hash}.ds`);
+  }
+
+  private async loadIndex(): Promise<Set<string>> {
+    if (this.knownObjects) return this.knownObjects;
+
+    await fs.mkdir(path.join(this.storeDir, "objects"), { recursive: true });
+    await fs.mkdir(path.join(this.storeDir, "backups"), { recursive: true });
+
+    const files = await fs.readdir(path.join(this.storeDir, "objects"));
+    this.knownObjects = new Set(
+      files.filter((f) => f.endsWith(".ds")).map((f) => f.slice(0, -3))
+    );
+    return this.knownObjects;
+  }
+
+  /**
+   * Returns true if the content was new and has been written.
+   */
+  private async storeObject(hash: string, content: Buffer): Promise<boolean> {
+    const known = await this.loadIndex();
+    if (known.has(hash)) return false;
+
+    // Claim the hash first so parallel ports with the same content write once
+    known.add(hash);
+    try {
+      await fs.writeFile(this.objectPath(hash), content, { flag: "wx" });
+      return true;
+    } catch (error: any) {
+      if (error.code === "EEXIST") return false;
+      known.delete(hash);
+      throw error;
+    }
+  }
+
+  private async readObject(hash: string): Promise<Buffer> {
+    try {
+      return await fs.readFile(this.objectPath(hash));
+    } catch (error: any) {
+      throw new Error(`Data storage object ${hash} missing from store`);
+    }
+  }
+
+  private async writeManifest(manifest: BackupManifest): Promise<void> {
+    await fs.writeFile(
+      path.join(this.storeDir, "backups", `${manifest.id}.json`),
+      JSON.stringify(manifest, null, 2)
+    );
+  }
+
+  async getBackup(backupId: string): Promise<BackupManifest> {
+    if (!/^[0-9a-f-]{36}$/i.test(backupId)) {
+      throw this.notFound(backupId);
+    }
+    try {
+      const raw = await fs.readFile(
+        path.join(this.storeDir, "backups", `${backupId}.json`),
+        "utf8"
+      );
+      return JSON.parse(raw);
+    } catch (error) {
+      throw this.notFound(backupId);
+    }
+  }
+
+  async listBackups(): Promise<any[]> {
+    await this.loadIndex();
+    const files = await fs.readdir(path.join(this.storeDir, "backups"));
+    const backups = await Promise.all(
+      files
+        .filter((f) => f.endsWith(".json"))
+        .map((f) => this.getBackup(f.slice(0, -5)).catch(() => null))
+    );
+    return backups
+      .filter((b): b is BackupManifest => b !== null)
+      .map((b) => ({
+        id: b.id,
+        createdAt: b.createdAt,
+        durationMs: b.durationMs,
+        ports: b.entries.length,
+        failures: b.failures.length,
+        stats: b.stats,
+      }))
+      .sort((a, b) => b.createdAt.localeCompare(a.createdAt));
+  }
+
+  async getStoreStats(): Promise<any> {
+    const known = await this.loadIndex();
+    let bytes = 0;
+    for (const hash of known) {
+      try {
+        bytes += (await fs.stat(this.objectPath(hash))).size;
+      } catch (error) {
+        // Removed behind our back; ignore
+      }
+    }
+    return {
+      directory: this.storeDir,
+      objects: known.size,
+      bytes,
+    };
+  }
+
+  private notFound(backupId: string): Error {
+    const error: any = new Error(`Data storage backup not found: ${backupId}`);
+    error.statusCode = 404;
+    error.apiErrorCode = "BACKUP_NOT_FOUND";
+    return error;
+  }
+}
+
+export default DataStorageService;
@@ -5,16 +5,34 @@
  */
 
 import IOLinkService from "./IOLinkService";
+import MasterThread from "./MasterThread";
 import Device from "../models/Device";
 import Parameter from "../models/Parameter";
 import logger from "../utils/logger";
+import { traceAsync, traceInstant } from "../utils/tracing";
 import {
   CONNECTION_STATES,
   PARAMETER_INDEX,
   STANDARD_PARAMETERS,
   LIMITS,
+  RETURN_CODES,
+  SENSOR_STATUS,
+  SENSOR_STATE_MASK,
+  EVENT_CODES,
+  DS_COMPLETION_EVENTS,
+  DIRECT_PARAMETER_SUBINDEX,
+  PORT_MODES,
+  RECORD_LAYOUTS,
+  RecordItemLayout,
   isValidPort,
+  getMaxMasters,
+  decodeCycleTime,
 } from "../utils/constants";
+import { ProcessImage, ProcessImageSample } from "../utils/processImage";
+import type {
+  AcquisitionCycle,
+  ProcessDataSchedule,
+} from "../workers/masterAcquisition";
 
 interface MasterInfo {
   handle: number;
@@ -23,6 +41,23 @@ interface MasterInfo {
   ports: Map<number, any>;
 }
 
+interface BatchOperation {
+  type: "read" | "write";
+  index: number;
+  subIndex?: number;
+  value?: any;
+  dataType?: string;
+  port?: number;
+}
+
+interface BatchOutcome {
+  port: number;
+  success: boolean;
+  result?: any;
+  error?: string;
+  source?: "device" | "record" | "coalesced";
+}
+
 interface PortStatus {
   connected: boolean;
   mode: string;
@@ -33,23 +68,109 @@ interface PortStatus {
   timestamp: Date;
 }
 
+// Master event as kept in the event log
+export interface PortEventRecord {
+  // Epoch ms when the event was read from the master
+  timestamp: number;
+  masterHandle: number;
+  port: number;
+  eventCode: number;
+  instance: number;
+  mode: number;
+  type: number;
+  localGenerated: boolean;
+}
+
 class DeviceManager {
   private iolinkService: IOLinkService;
   private connectedMasters: Map<number, MasterInfo>;
+  private pendingConnections: Map<string, Promise<number>>;
   private devices: Map<string, Device>;
   private deviceSubscriptions: Map<string, any>;
   public parameters: Map<string, Map<string, Parameter>>;
   private scanIntervals: Map<number, NodeJS.Timeout>;
+  private statusMonitors: Map<number, NodeJS.Timeout>;
+  private monitoredPorts: Map<number, number[]>;
+  private portStates: Map<string, number>;
+  private statusPollsInFlight: Set<number>;
+  private masterThreads: Map<number, MasterThread>;
+  private pendingRefreshes: Map<number, Set<number>>;
+  private useMasterThreads: boolean;
+  private processImage: ProcessImage;
+  private processImageRows: Map<number, number>;
+  private processDataPeriods: Map<string, number>;
+  private inflightReads: Map<string, Promise<any>>;
+  private maintenancePorts: Map<string, string>;
+  private dsEventWaiters: Map<string, (event: any) => void>;
+  private eventLog: PortEventRecord[];
+  // Main-thread output writer: pending commit and last commit per port
+  private outputTimers: Map<string, NodeJS.Timeout>;
+  private outputCommittedAt: Map<string, number>;
+  private outputStats: {
+    writes: number;
+    commits: number;
+    failedCommits: number;
+  };
+  private isduStats: {
+    reads: number;
+    coalescedReads: number;
+    cacheHits: number;
+  };
+  private portMonitorStats: {
+    polls: number;
+    statusReads: number;
+    fullReads: number;
+    eventsRead: number;
+    changesDetected: number;
+    lastPollDurationMs: number;
+    maxPollDurationMs: number;
+  };
   private monitoringEnabled: boolean;
   private monitoringInterval: NodeJS.Timeout | null;
 
   constructor() {
     this.iolinkService = new IOLinkService();
     this.connectedMasters = new Map();
+    this.pendingConnections = new Map();
     this.devices = new Map();
     this.deviceSubscriptions = new Map();
     this.parameters = new Map();
     this.scanIntervals = new Map();
+    this.statusMonitors = new Map();
+    this.monitoredPorts = new Map();
+    this.portStates = new Map();
+    this.statusPollsInFlight = new Set();
+    this.masterThreads = new Map();
+    this.pendingRefreshes = new Map();
+    this.useMasterThreads = process.env.MASTER_THREADS === "true";
+    this.processImage = new ProcessImage(getMaxMasters(), LIMITS.MAX_PORTS);
+    this.processImageRows = new Map();
+    this.processDataPeriods = new Map();
+    this.inflightReads = new Map();
+    this.maintenancePorts = new Map();
+    this.dsEventWaiters = new Map();
+    this.eventLog = [];
+    this.outputTimers = new Map();
+    this.outputCommittedAt = new Map();
+    this.outputStats = {
+      writes: 0,
+      commits: 0,
+      failedCommits: 0,
+    };
+    this.isduStats = {
+      reads: 0,
+      coalescedReads: 0,
+      cacheHits: 0,
+    };
+    this.portMonitorStats = {
+      polls: 0,
+      statusReads: 0,
+      fullReads: 0,
+      eventsRead: 0,
+      changesDetected: 0,
+      lastPollDurationMs: 0,
+      maxPollDurationMs: 0,
+    };
     this.monitoringEnabled = false;
     this.monitoringInterval = null;
   }
@@ -70,19 +191,44 @@ class DeviceManager {
     }
   }
 
+  /**
+   * List the masters currently enumerated on USB without the discovery
+   * logging, for callers that poll (the hot-plug watcher).
+   */
+  async listUsbMasters(maxMasters?: number): Promise<any[]> {
+    return this.iolinkService.discoverMasters(maxMasters);
+  }
+
   async connectMaster(deviceName: string): Promise<number> {
+    // Check if already connected
+    const existingHandle = this.getMasterHandleByName(deviceName);
+    if (existingHandle !== undefined) {
+      logger.warn(
+        `Master ${deviceName} already connected with handle ${existingHandle}`
+      );
+      return existingHandle;
+    }
+
+    // Join a connection that is already in progress (REST call racing the
+    // hot-plug watcher) instead of creating a second handle
+    const pending = this.pendingConnections.get(deviceName);
+    if (pending) {
+      logger.debug(`Joining pending connection for master ${deviceName}`);
+      return pending;
+    }
+
+    const connection = this.establishMasterConnection(deviceName);
+    this.pendingConnections.set(deviceName, connection);
     try {
-      logger.info(`Connecting to master: ${deviceName}`);
+      return await connection;
+    } finally {
+      this.pendingConnections.delete(deviceName);
+    }
+  }
 
-      // Check if already connected
-      for (const [handle, master] of this.connectedMasters) {
-        if (master.deviceName === deviceName) {
-          logger.warn(
-            `Master ${deviceName} already connected with handle ${handle}`
-          );
-          return handle;
-        }
-      }
+  private async establishMasterConnection(deviceName: string): Promise<number> {
+    try {
+      logger.info(`Connecting to master: ${deviceName}`);
 
       const handle = await this.iolinkService.connectToMaster(deviceName);
 
@@ -131,11 +277,13 @@ class DeviceManager {
       for (const deviceKey of devicesToRemove) {
         this.devices.delete(deviceKey);
         this.parameters.delete(deviceKey);
+        this.processDataPeriods.delete(deviceKey);
       }
 
       // Disconnect from master
       await this.iolinkService.disconnectFromMaster(handle);
       this.connectedMasters.delete(handle);
+      this.releaseProcessImageRow(handle);
 
       logger.info(`Master ${masterInfo.deviceName} disconnected successfully`);
       return true;
@@ -145,6 +293,53 @@ class DeviceManager {
     }
   }
 
+  /**
+   * Tear down a master whose USB link dropped. Unlike disconnectMaster this
+   * never touches the port configuration, since the DLL would only answer
+   * with RETURN_CONNECTION_LOST.
+   */
+  handleMasterConnectionLost(handle: number): boolean {
+    const masterInfo = this.connectedMasters.get(handle);
+    if (!masterInfo) {
+      return false;
+    }
+
+    logger.warn(`Connection lost to master ${masterInfo.deviceName}`);
+
+    this.stopDeviceScanning(handle);
+
+    for (const [deviceKey, device] of this.devices) {
+      if (device.masterHandle === handle) {
+        device.connected = false;
+        device.connectionState = CONNECTION_STATES.DISCONNECTED;
+        device.clearCache();
+        this.devices.delete(deviceKey);
+        this.parameters.delete(deviceKey);
+        this.processDataPeriods.delete(deviceKey);
+      }
+    }
+
+    this.iolinkService.releaseMaster(handle);
+    this.connectedMasters.delete(handle);
+    this.releaseProcessImageRow(handle);
+
+    logger.info(`Master ${masterInfo.deviceName} removed after connection loss`);
+    return true;
+  }
+
+  getMasterHandleByName(deviceName: string): number | undefined {
+    for (const [handle, master] of this.connectedMasters) {
+      if (master.deviceName === deviceName) {
+        return handle;
+      }
+    }
+    return undefined;
+  }
+
+  isMasterConnecting(deviceName: string): boolean {
+    return this.pendingConnections.has(deviceName);
+  }
+
   getConnectedMasters(): any[] {
     const masters: any[] = [];
     for (const [handle, masterInfo] of this.connectedMasters) {
@@ -164,9 +359,16 @@ class DeviceManager {
   // DEVICE DISCOVERY AND MANAGEMENT
   // ============================================================================
 
+  /**
+   * Start port change detection for a master. A short-cadence poll reads only
+   * the status byte of each port and drains the event FIFO when a port flags
+   * BIT_EVENTAVAILABLE; full IOL_GetModeEx reads are limited to ports whose
+   * state changed. The full scan still runs on a long interval to reconcile.
+   */
   async startDeviceScanning(
     masterHandle: number,
-    intervalMs: number = 10000
+    intervalMs: number = LIMITS.PORT_RECONCILE_INTERVAL,
+    statusIntervalMs: number = LIMITS.PORT_STATUS_POLL_INTERVAL
   ): Promise<void> {
     // Stop existing scanning
     this.stopDeviceScanning(masterHandle);
@@ -174,6 +376,7 @@ class DeviceManager {
     const scanDevices = async () => {
       try {
         await this.scanDevicesOnMaster(masterHandle);
+        this.configureMasterThread(masterHandle);
       } catch (error: any) {
         logger.error(
           `Device scanning error for master ${masterHandle}:`,
@@ -185,22 +388,64 @@ class DeviceManager {
     // Initial scan
     await scanDevices();
 
-    // Schedule periodic scanning
+    // Master may have been lost during the initial scan
+    if (!this.connectedMasters.has(masterHandle)) {
+      return;
+    }
+
+    // Schedule periodic reconciliation scanning
     const intervalId = setInterval(scanDevices, intervalMs);
     this.scanIntervals.set(masterHandle, intervalId);
 
+    // Fast status-byte change detection, optionally on the master's own thread
+    if (this.useMasterThreads) {
+      this.startMasterThread(masterHandle, statusIntervalMs);
+      logger.info(
+        `Started device scanning for master ${masterHandle} (thread: ${statusIntervalMs}ms, reconcile: ${intervalMs}ms)`
+      );
+      return;
+    }
+
+    const monitorId = setInterval(() => {
+      this.pollPortStatus(masterHandle).catch((error: any) =>
+        logger.error(
+          `Port status poll error for master ${masterHandle}:`,
+          error.message
+        )
+      );
+    }, statusIntervalMs);
+    this.statusMonitors.set(masterHandle, monitorId);
+
     logger.info(
-      `Started device scanning for master ${masterHandle} (interval: ${intervalMs}ms)`
+      `Started device scanning for master ${masterHandle} (status: ${statusIntervalMs}ms, reconcile: ${intervalMs}ms)`
     );
   }
 
   stopDeviceScanning(masterHandle: number): void {
     const intervalId = this.scanIntervals.get(masterHandle);
+    const monitorId = this.statusMonitors.get(masterHandle);
+    const thread = this.masterThreads.get(masterHandle);
+    if (thread) {
+      thread.stop();
+      this.masterThreads.delete(masterHandle);
+      this.pendingRefreshes.delete(masterHandle);
+    }
+    if (monitorId) {
+      clearInterval(monitorId);
+      this.statusMonitors.delete(masterHandle);
+    }
     if (intervalId) {
       clearInterval(intervalId);
       this.scanIntervals.delete(masterHandle);
       logger.info(`Stopped device scanning for master ${masterHandle}`);
     }
+
+    this.monitoredPorts.delete(masterHandle);
+    for (const key of Array.from(this.portStates.keys())) {
+      if (key.startsWith(`${masterHandle}:`)) {
+        this.portStates.delete(key);
+      }
+    }
   }
 
   async scanDevicesOnMaster(masterHandle: number): Promise<void> {
@@ -211,39 +456,499 @@ class DeviceManager {
 
     logger.debug(`Scanning devices on master ${masterInfo.deviceName}`);
 
+    const ports: number[] = [];
     for (let port = 1; port <= LIMITS.MAX_PORTS; port++) {
       try {
-        const status = await this.iolinkService.checkPortStatus(
-          masterHandle,
-          port
+        await this.refreshPortStatus(masterHandle, port);
+        if (this.canPortStateChange(masterHandle, port)) {
+          ports.push(port);
+        }
+      } catch (error: any) {
+        if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+          this.handleMasterConnectionLost(masterHandle);
+          return;
+        }
+        // Ports the master does not have are left out of status polling
+        if (error.code !== RETURN_CODES.RETURN_WRONG_PARAMETER) {
+          ports.push(port);
+        }
+        logger.debug(
+          `Error checking port ${port} on master ${masterHandle}:`,
+          error.message
         );
-        const deviceKey = `${masterHandle}:${port}`;
-        const existingDevice = this.devices.get(deviceKey);
-
-        if (status.connected) {
-          if (!existingDevice) {
-            // New device detected
-            await this.handleNewDeviceDetected(masterHandle, port, status);
-          } else {
-            // Update existing device status
-            existingDevice.updateConnectionStatus(status);
-            logger.debug(
-              `Updated device status for port ${port}: ${status.mode}`
-            );
+      }
+    }
+
+    this.monitoredPorts.set(masterHandle, ports);
+  }
+
+  /**
+   * Only ports configured for IO-Link get or lose devices. Deactivated and
+   * SIO ports change state only through a reconfiguration, which the
+   * reconcile scan picks up, so the status poll leaves them out.
+   */
+  private canPortStateChange(masterHandle: number, port: number): boolean {
+    try {
+      const mode = this.iolinkService.getPortTargetMode(masterHandle, port);
+      return (
+        mode !== PORT_MODES.SM_MODE_RESET &&
+        mode !== PORT_MODES.SM_MODE_SIO_INPUT &&
+        mode !== PORT_MODES.SM_MODE_SIO_OUTPUT
+      );
+    } catch {
+      return true;
+    }
+  }
+
+  /**
+   * Full status read (IOL_GetModeEx + DPP) for one port and the resulting
+   * device registration or disconnect handling.
+   */
+  private async refreshPortStatus(
+    masterHandle: number,
+    port: number
+  ): Promise<void> {
+    const status = await this.iolinkService.checkPortStatus(masterHandle, port);
+    this.portMonitorStats.fullReads++;
+
+    const deviceKey = `${masterHandle}:${port}`;
+    const existingDevice = this.devices.get(deviceKey);
+    this.portStates.set(deviceKey, status.sensorStatus & SENSOR_STATE_MASK);
+
+    // The device reboots and changes identity during maintenance; it is
+    // registered again once the maintenance owner releases the port
+    if (this.maintenancePorts.has(deviceKey)) {
+      return;
+    }
+
+    if (status.connected) {
+      if (!existingDevice) {
+        // New device detected
+        await this.handleNewDeviceDetected(masterHandle, port, status);
+      } else {
+        // Update existing device status
+        existingDevice.updateConnectionStatus(status);
+        logger.debug(`Updated device status for port ${port}: ${status.mode}`);
+      }
+    } else {
+      if (existingDevice && existingDevice.connected) {
+        // Device disconnected
+        await this.handleDeviceDisconnected(deviceKey, existingDevice);
+      }
+    }
+  }
+
+  /**
+   * Cheap change detection: compare each port's status byte with the last
+   * known state and drain pending events. Only changed ports get a full read.
+   */
+  async pollPortStatus(masterHandle: number): Promise<void> {
+    const ports = this.monitoredPorts.get(masterHandle);
+    if (!ports || this.statusPollsInFlight.has(masterHandle)) {
+      return;
+    }
+
+    this.statusPollsInFlight.add(masterHandle);
+    const started = Date.now();
+
+    try {
+      const changedPorts = new Set<number>();
+      let eventPending = false;
+
+      for (const port of ports) {
+        let status: number;
+        try {
+          status = this.iolinkService.getSensorStatus(masterHandle, port);
+          this.portMonitorStats.statusReads++;
+        } catch (error: any) {
+          if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+            this.handleMasterConnectionLost(masterHandle);
+            return;
           }
-        } else {
-          if (existingDevice) {
-            // Device disconnected
-            await this.handleDeviceDisconnected(deviceKey, existingDevice);
+          continue;
+        }
+
+        if (status & SENSOR_STATUS.BIT_EVENTAVAILABLE) {
+          eventPending = true;
+        }
+
+        const previous = this.portStates.get(`${masterHandle}:${port}`);
+        if (previous !== (status & SENSOR_STATE_MASK)) {
+          changedPorts.add(port);
+        }
+      }
+
+      if (eventPending) {
+        for (const port of this.drainPortEvents(masterHandle)) {
+          changedPorts.add(port);
+        }
+      }
+
+      for (const port of changedPorts) {
+        if (!this.connectedMasters.has(masterHandle)) break;
+        this.portMonitorStats.changesDetected++;
+        try {
+          await this.refreshPortStatus(masterHandle, port);
+        } catch (error: any) {
+          if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+            this.handleMasterConnectionLost(masterHandle);
+            return;
           }
+          logger.debug(
+            `Error refreshing port ${port} on master ${masterHandle}:`,
+            error.message
+          );
         }
+      }
+    } finally {
+      const duration = Date.now() - started;
+      this.portMonitorStats.polls++;
+      this.portMonitorStats.lastPollDurationMs = duration;
+      this.portMonitorStats.maxPollDurationMs = Math.max(
+        this.portMonitorStats.maxPollDurationMs,
+        duration
+      );
+      this.statusPollsInFlight.delete(masterHandle);
+    }
+  }
+
+  /**
+   * Empty the master's event FIFO and return the ports that reported a
+   * device loss or a (re)start of communication.
+   */
+  private drainPortEvents(masterHandle: number): number[] {
+    const ports: number[] = [];
+
+    // FIFO holds 10 events; the bound only guards against a misbehaving DLL
+    for (let i = 0; i < 32; i++) {
+      let event: any;
+      try {
+        event = this.iolinkService.readEvent(masterHandle);
       } catch (error: any) {
         logger.debug(
-          `Error checking port ${port} on master ${masterHandle}:`,
+          `Error reading events on master ${masterHandle}:`,
           error.message
         );
+        break;
+      }
+      if (!event) break;
+
+      if (this.handlePortEvent(masterHandle, event)) {
+        ports.push(event.port);
       }
     }
+
+    return ports;
+  }
+
+  /**
+   * Dispatch one master event. Returns true when the port needs a full
+   * status read (device lost or communication (re)started).
+   */
+  private handlePortEvent(masterHandle: number, event: any): boolean {
+    this.portMonitorStats.eventsRead++;
+    this.eventLog.push({
+      timestamp: Date.now(),
+      masterHandle,
+      port: event.port,
+      eventCode: event.eventCode,
+      instance: event.instance,
+      mode: event.mode,
+      type: event.type,
+      localGenerated: event.localGenerated,
+    });
+    if (this.eventLog.length > LIMITS.EVENT_LOG_SIZE) {
+      this.eventLog.shift();
+    }
+    logger.debug(
+      `Event on master ${masterHandle} port ${event.port}: code=${event.eventCode} mode=0x${event.mode.toString(16)}`
+    );
+
+    if (
+      event.eventCode === EVENT_CODES.EVNT_CODE_S_DEVICELOST ||
+      event.eventCode === EVENT_CODES.EVNT_CODE_M_PREOPERATE
+    ) {
+      return true;
+    }
+    if (DS_COMPLETION_EVENTS.includes(event.eventCode)) {
+      const waiter = this.dsEventWaiters.get(`${masterHandle}:${event.port}`);
+      if (waiter) waiter(event);
+    }
+    return false;
+  }
+
+  // ============================================================================
+  // MASTER THREADS
+  // ============================================================================
+
+  private startMasterThread(masterHandle: number, intervalMs: number): void {
+    const thread = new MasterThread(masterHandle, intervalMs);
+
+    thread.on("cycle", (cycle: AcquisitionCycle) =>
+      this.handleMasterCycle(masterHandle, cycle)
+    );
+    thread.on("connection-lost", () =>
+      this.handleMasterConnectionLost(masterHandle)
+    );
+    thread.on("error", () => {
+      // Logged by the thread; the reconcile scan keeps the master usable
+    });
+
+    this.masterThreads.set(masterHandle, thread);
+    thread.start(
+      this.monitoredPorts.get(masterHandle) || [],
+      this.getMasterProcessDataPorts(masterHandle),
+      this.processImage,
+      this.getProcessImageRow(masterHandle)
+    );
+  }
+
+  private getMasterProcessDataPorts(masterHandle: number): ProcessDataSchedule[] {
+    return this.getProcessDataPorts()
+      .filter((entry) => entry.masterHandle === masterHandle)
+      .map((entry) => ({
+        port: entry.port,
+        periodMs: this.getProcessDataPeriod(masterHandle, entry.port),
+      }));
+  }
+
+  /**
+   * Push the current port lists (monitored, process data) to the thread
+   */
+  private configureMasterThread(masterHandle: number): void {
+    const thread = this.masterThreads.get(masterHandle);
+    if (!thread) return;
+    thread.configure(
+      this.monitoredPorts.get(masterHandle) || [],
+      this.getMasterProcessDataPorts(masterHandle)
+    );
+  }
+
+  /**
+   * Apply one acquisition batch: dispatch events and queue full status
+   * reads for ports whose state changed. Process data never passes through
+   * here; the thread writes it straight into the shared process image.
+   */
+  private handleMasterCycle(masterHandle: number, cycle: AcquisitionCycle): void {
+    if (!this.connectedMasters.has(masterHandle)) return;
+
+    const changedPorts = this.pendingRefreshes.get(masterHandle) || new Set<number>();
+    const failed = new Set(cycle.statusErrors);
+
+    this.portMonitorStats.polls++;
+    this.portMonitorStats.lastPollDurationMs = cycle.durationMs;
+    this.portMonitorStats.maxPollDurationMs = Math.max(
+      this.portMonitorStats.maxPollDurationMs,
+      cycle.durationMs
+    );
+
+    this.outputStats.commits += cycle.outputCommits;
+    this.outputStats.failedCommits += cycle.outputFailures;
+
+    cycle.ports.forEach((port, i) => {
+      if (failed.has(port)) return;
+      this.portMonitorStats.statusReads++;
+      const previous = this.portStates.get(`${masterHandle}:${port}`);
+      if (previous !== (cycle.statuses[i] & SENSOR_STATE_MASK)) {
+        changedPorts.add(port);
+      }
+    });
+
+    for (const event of cycle.events) {
+      if (this.handlePortEvent(masterHandle, event)) {
+        changedPorts.add(event.port);
+      }
+    }
+
+    if (changedPorts.size > 0) {
+      this.pendingRefreshes.set(masterHandle, changedPorts);
+      this.refreshChangedPorts(masterHandle).catch((error: any) =>
+        logger.error(
+          `Port refresh error for master ${masterHandle}:`,
+          error.message
+        )
+      );
+    }
+  }
+
+  /**
+   * Full status reads for ports flagged by the master thread. One refresh
+   * loop per master; ports flagged meanwhile are picked up by the same loop.
+   */
+  private async refreshChangedPorts(masterHandle: number): Promise<void> {
+    if (this.statusPollsInFlight.has(masterHandle)) return;
+    this.statusPollsInFlight.add(masterHandle);
+
+    try {
+      let pending = this.pendingRefreshes.get(masterHandle);
+      while (pending && pending.size > 0) {
+        this.pendingRefreshes.delete(masterHandle);
+
+        for (const port of pending) {
+          if (!this.connectedMasters.has(masterHandle)) return;
+          this.portMonitorStats.changesDetected++;
+          try {
+            await this.refreshPortStatus(masterHandle, port);
+          } catch (error: any) {
+            if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+              this.handleMasterConnectionLost(masterHandle);
+              return;
+            }
+            logger.debug(
+              `Error refreshing port ${port} on master ${masterHandle}:`,
+              error.message
+            );
+          }
+        }
+
+        pending = this.pendingRefreshes.get(masterHandle);
+      }
+
+      this.configureMasterThread(masterHandle);
+    } finally {
+      this.statusPollsInFlight.delete(masterHandle);
+    }
+  }
+
+  getMasterThreadStats(): any[] {
+    return Array.from(this.masterThreads.values()).map((thread) =>
+      thread.getStatus()
+    );
+  }
+
+  /**
+   * Resolve with the next data storage completion event on a port. Events
+   * are normally drained by the port monitor; masters without one are
+   * drained here.
+   */
+  waitForDataStorageEvent(
+    masterHandle: number,
+    port: number,
+    timeoutMs: number = LIMITS.DS_COMMAND_TIMEOUT
+  ): Promise<any> {
+    const deviceKey = `${masterHandle}:${port}`;
+
+    return new Promise((resolve, reject) => {
+      let poller: NodeJS.Timeout | null = null;
+      const finish = () => {
+        clearTimeout(timer);
+        if (poller) clearInterval(poller);
+        this.dsEventWaiters.delete(deviceKey);
+      };
+      const timer = setTimeout(() => {
+        finish();
+        reject(new Error(`No data storage event from ${deviceKey} within ${timeoutMs}ms`));
+      }, timeoutMs);
+
+      this.dsEventWaiters.set(deviceKey, (event: any) => {
+        finish();
+        resolve(event);
+      });
+
+      if (
+        !this.statusMonitors.has(masterHandle) &&
+        !this.masterThreads.has(masterHandle)
+      ) {
+        poller = setInterval(
+          () => this.drainPortEvents(masterHandle),
+          LIMITS.PORT_STATUS_POLL_INTERVAL
+        );
+      }
+    });
+  }
+
+  getIsduStats(): any {
+    const requests =
+      this.isduStats.reads +
+      this.isduStats.coalescedReads +
+      this.isduStats.cacheHits;
+    return {
+      ...this.isduStats,
+      inflight: this.inflightReads.size,
+      coalescedRatio:
+        requests > 0 ? this.isduStats.coalescedReads / requests : 0,
+    };
+  }
+
+  getOutputStats(): any {
+    const handled = this.outputStats.commits + this.outputStats.failedCommits;
+    return {
+      ...this.outputStats,
+      coalescedWrites: Math.max(0, this.outputStats.writes - handled),
+      pendingCommits: this.outputTimers.size,
+    };
+  }
+
+  /**
+   * Master events read since start, oldest first (bounded by EVENT_LOG_SIZE)
+   */
+  getEventLog(since: number = 0): PortEventRecord[] {
+    return this.eventLog.filter((event) => event.timestamp >= since);
+  }
+
+  getPortMonitorStats(): any {
+    return {
+      ...this.portMonitorStats,
+      monitoredMasters: this.statusMonitors.size + this.masterThreads.size,
+      pollIntervalMs: LIMITS.PORT_STATUS_POLL_INTERVAL,
+      reconcileIntervalMs: LIMITS.PORT_RECONCILE_INTERVAL,
+      masterThreads: this.getMasterThreadStats(),
+    };
+  }
+
+  // ============================================================================
+  // PORT MAINTENANCE
+  // ============================================================================
+
+  /**
+   * Reserve a port for a long-running service such as a firmware update.
+   * While reserved, port monitoring leaves the device registration alone and
+   * parameter access from other clients is rejected.
+   */
+  beginPortMaintenance(masterHandle: number, port: number, reason: string): void {
+    const deviceKey = `${masterHandle}:${port}`;
+    const current = this.maintenancePorts.get(deviceKey);
+    if (current) {
+      const error: any = new Error(`Port ${deviceKey} is reserved for ${current}`);
+      error.statusCode = 409;
+      error.apiErrorCode = "PORT_IN_MAINTENANCE";
+      throw error;
+    }
+    this.maintenancePorts.set(deviceKey, reason);
+    logger.info(`Port ${deviceKey} reserved for ${reason}`);
+  }
+
+  /**
+   * Release a reserved port and register whatever device is now attached.
+   */
+  async endPortMaintenance(masterHandle: number, port: number): Promise<void> {
+    const deviceKey = `${masterHandle}:${port}`;
+    if (!this.maintenancePorts.delete(deviceKey)) return;
+
+    this.devices.delete(deviceKey);
+    this.parameters.delete(deviceKey);
+    logger.info(`Port ${deviceKey} released from maintenance`);
+
+    if (!this.connectedMasters.has(masterHandle)) return;
+    try {
+      await this.refreshPortStatus(masterHandle, port);
+    } catch (error: any) {
+      logger.warn(`Could not refresh port ${deviceKey} after maintenance: ${error.message}`);
+    }
+  }
+
+  isPortInMaintenance(masterHandle: number, port: number): boolean {
+    return this.maintenancePorts.has(`${masterHandle}:${port}`);
+  }
+
+  private assertPortAvailable(deviceKey: string): void {
+    const reason = this.maintenancePorts.get(deviceKey);
+    if (reason) {
+      const error: any = new Error(`Device ${deviceKey} is busy with ${reason}`);
+      error.statusCode = 409;
+      error.apiErrorCode = "PORT_IN_MAINTENANCE";
+      throw error;
+    }
   }
 
   async handleNewDeviceDetected(
@@ -439,25 +1144,211 @@ class DeviceManager {
       );
     }
 
-    // Check cache first
+    // Shared process image first: no DLL call, no lock
+    const sample = this.readProcessImage(masterHandle, port);
+    if (sample) {
+      return sample;
+    }
+
     if (device.isProcessDataCacheValid(LIMITS.CACHE_TTL_PROCESS_DATA)) {
       logger.debug(`Returning cached process data for port ${port}`);
       return device.processDataCache;
     }
 
-    const result = await this.iolinkService.readProcessData(masterHandle, port);
-    device.cacheProcessData(result);
-
+    const result = await this.acquireProcessData(masterHandle, port);
     logger.debug(
       `Read process data from port ${port}: ${result.data.length} bytes`
     );
     return result;
   }
 
+  /**
+   * Read process data bypassing the cache TTL and refresh the cache
+   */
+  async refreshProcessData(masterHandle: number, port: number): Promise<any> {
+    this.getDevice(masterHandle, port);
+
+    // Master threads already refresh the process image every cycle
+    if (this.masterThreads.has(masterHandle)) {
+      const sample = this.readProcessImage(masterHandle, port);
+      if (sample) {
+        return sample;
+      }
+    }
+
+    return this.acquireProcessData(masterHandle, port);
+  }
+
+  /**
+   * Latest inputs from the shared process image, or null when the slot is
+   * empty or older than one acquisition period allows
+   */
+  private readProcessImage(masterHandle: number, port: number): any | null {
+    const row = this.processImageRows.get(masterHandle);
+    if (row === undefined) return null;
+
+    const sample = this.processImage.readInputs(row, port);
+    if (!sample) return null;
+
+    const maxAgeMs = this.masterThreads.has(masterHandle)
+      ? this.getProcessDataPeriod(masterHandle, port) * 2
+      : LIMITS.CACHE_TTL_PROCESS_DATA;
+    if (Date.now() - sample.timestamp.getTime() >= maxAgeMs) return null;
+
+    return {
+      data: sample.data,
+      status: sample.status,
+      port,
+      sequence: sample.sequence,
+      timestamp: sample.timestamp,
+    };
+  }
+
+  /**
+   * Inputs of a port from the process image once its sample counter has
+   * moved past afterSequence; null while unchanged or never published
+   */
+  readProcessImageInputs(
+    masterHandle: number,
+    port: number,
+    afterSequence: number
+  ): ProcessImageSample | null {
+    const row = this.processImageRows.get(masterHandle);
+    if (row === undefined) return null;
+    if (this.processImage.inputSequence(row, port) === afterSequence) return null;
+    return this.processImage.readInputs(row, port);
+  }
+
+  /**
+   * Read inputs through the DLL and publish them. With a master thread the
+   * thread is the only writer of the inputs half, so only the cache is set.
+   */
+  private async acquireProcessData(masterHandle: number, port: number): Promise<any> {
+    const device = this.getDevice(masterHandle, port);
+    const result = await this.iolinkService.readProcessData(masterHandle, port);
+    device.cacheProcessData(result);
+
+    if (!this.masterThreads.has(masterHandle)) {
+      this.processImage.writeInputs(
+        this.getProcessImageRow(masterHandle),
+        port,
+        result.data,
+        result.status,
+        result.timestamp.getTime()
+      );
+    }
+    return result;
+  }
+
+  /**
+   * Cyclic process data period of a port on its master thread; defaults to
+   * the status cycle
+   */
+  getProcessDataPeriod(masterHandle: number, port: number): number {
+    return (
+      this.processDataPeriods.get(`${masterHandle}:${port}`) ??
+      LIMITS.PROCESS_DATA_PERIOD_DEFAULT
+    );
+  }
+
+  /**
+   * Set a port's process data period; periods below the device's
+   * MinCycleTime are rejected. Resolves with that minimum (null if the
+   * device does not report one).
+   */
+  async setProcessDataPeriod(
+    masterHandle: number,
+    port: number,
+    periodMs: number
+  ): Promise<number | null> {
+    this.getDevice(masterHandle, port);
+    // Without a thread nothing acquires cyclically, so a period would only
+    // pace output commits while claiming to set the input rate
+    if (!this.masterThreads.has(masterHandle)) {
+      const error: any = new Error(
+        `Master ${masterHandle} has no acquisition thread; process data periods need MASTER_THREADS=true`
+      );
+      error.statusCode = 409;
+      error.apiErrorCode = "MASTER_THREAD_REQUIRED";
+      throw error;
+    }
+
+    const minCycleTimeMs = await this.getMinCycleTime(masterHandle, port);
+    if (minCycleTimeMs !== null && periodMs < minCycleTimeMs) {
+      const error: any = new Error(
+        `Period ${periodMs}ms is below the device minimum cycle time of ${minCycleTimeMs}ms`
+      );
+      error.statusCode = 400;
+      error.apiErrorCode = "INVALID_REQUEST";
+      throw error;
+    }
+
+    this.processDataPeriods.set(`${masterHandle}:${port}`, periodMs);
+    this.configureMasterThread(masterHandle);
+    logger.info(
+      `Process data period of master ${masterHandle} port ${port} set to ${periodMs}ms`
+    );
+    return minCycleTimeMs;
+  }
+
+  /**
+   * Device MinCycleTime in ms, or null if the device does not report it
+   */
+  async getMinCycleTime(masterHandle: number, port: number): Promise<number | null> {
+    try {
+      const result = await this.readDeviceParameter(
+        `${masterHandle}:${port}`,
+        PARAMETER_INDEX.DIRECT_PARAMETER_PAGE,
+        DIRECT_PARAMETER_SUBINDEX.MIN_CYCLE_TIME
+      );
+      const minCycleTime = decodeCycleTime(result.data.readUInt8(0));
+      return Number.isNaN(minCycleTime) ? null : minCycleTime;
+    } catch (error: any) {
+      logger.debug(`Could not read min cycle time: ${error.message}`);
+      return null;
+    }
+  }
+
+  /**
+   * Timing of a port's process data task on its master thread
+   */
+  getProcessDataSchedule(masterHandle: number, port: number): any | null {
+    const schedule = this.masterThreads.get(masterHandle)?.getSchedule();
+    return schedule?.tasks.find((task) => task.name === `pd:${port}`) || null;
+  }
+
+  /**
+   * Ports whose devices are ready for cyclic process data exchange
+   */
+  getProcessDataPorts(): Array<{ masterHandle: number; port: number }> {
+    const ports: Array<{ masterHandle: number; port: number }> = [];
+    for (const device of this.devices.values()) {
+      if (
+        device.isReady() &&
+        device.masterHandle !== null &&
+        device.masterHandle !== undefined &&
+        !this.maintenancePorts.has(`${device.masterHandle}:${device.port}`)
+      ) {
+        ports.push({ masterHandle: device.masterHandle, port: device.port });
+      }
+    }
+    return ports;
+  }
+
+  /**
+   * Post the latest outputs of a port. A write only replaces the port's
+   * output slot in the process image; the output writer (the port's
+   * process data task on the master thread, or a per-port timer here)
+   * sends the newest value at most once per process data period, so a
+   * burst of writes costs one IOL_WriteOutputs per cycle. With confirm the
+   * call waits until this value, or a later one that superseded it, has
+   * been written to the master.
+   */
   async writeProcessData(
     masterHandle: number,
     port: number,
-    data: Buffer | number[]
+    data: Buffer | number[],
+    confirm: boolean = false
   ): Promise<any> {
     const device = this.getDevice(masterHandle, port);
 
@@ -467,15 +1358,175 @@ class DeviceManager {
       );
     }
 
-    const result = await this.iolinkService.writeProcessData(
-      masterHandle,
-      port,
-      data
-    );
+    const buffer = Buffer.isBuffer(data) ? data : Buffer.from(data);
+    const row = this.getProcessImageRow(masterHandle);
+    const postedAt = Date.now();
+    const sequence = this.processImage.writeOutputs(row, port, buffer, postedAt);
+    this.outputStats.writes++;
+
+    // Ports with a process data task on a master thread are committed
+    // there; every other port (no thread, maintenance, device not yet in
+    // the thread's process data list) is committed from here
+    if (!this.masterThreads.get(masterHandle)?.hasProcessDataTask(port)) {
+      this.scheduleOutputCommit(masterHandle, port);
+    }
+
+    const result: any = {
+      success: true,
+      bytesWritten: buffer.length,
+      port: port,
+      sequence,
+      timestamp: new Date(postedAt),
+    };
     logger.debug(
-      `Wrote process data to port ${port}: ${result.bytesWritten} bytes`
+      `Posted process data to port ${port}: ${buffer.length} bytes (sequence ${sequence})`
+    );
+    if (!confirm) return result;
+
+    const timeoutMs = Math.max(
+      LIMITS.OUTPUT_COMMIT_TIMEOUT,
+      2 * this.getProcessDataPeriod(masterHandle, port)
+    );
+    const commit = await this.processImage.waitForCommit(row, port, sequence, timeoutMs);
+    if (!commit) {
+      const error: any = new Error(
+        `Process data for port ${port} was not written within ${timeoutMs}ms`
+      );
+      error.statusCode = 504;
+      error.apiErrorCode = "OUTPUT_COMMIT_TIMEOUT";
+      throw error;
+    }
+    if (!commit.superseded && commit.result !== RETURN_CODES.RETURN_OK) {
+      const error: any = new Error(
+        `Write process data to port ${port} failed with code: ${commit.result}`
+      );
+      error.code = commit.result;
+      throw error;
+    }
+    return { ...result, commit };
+  }
+
+  /**
+   * Commit a port's outputs from the main thread: right away when the last
+   * commit is a period old, otherwise at the end of that period. Writes
+   * arriving before then only replace the value that timer will send.
+   */
+  private scheduleOutputCommit(masterHandle: number, port: number): void {
+    const key = `${masterHandle}:${port}`;
+    if (this.outputTimers.has(key)) return;
+
+    const lastCommit = this.outputCommittedAt.get(key) ?? 0;
+    const delay = Math.max(
+      0,
+      lastCommit + this.getProcessDataPeriod(masterHandle, port) - Date.now()
+    );
+    this.outputTimers.set(
+      key,
+      setTimeout(() => this.commitOutputs(masterHandle, port), delay)
     );
-    return result;
+  }
+
+  private async commitOutputs(masterHandle: number, port: number): Promise<void> {
+    const key = `${masterHandle}:${port}`;
+    const row = this.processImageRows.get(masterHandle);
+    const outputs =
+      row === undefined ? null : this.processImage.takeOutputs(row, port);
+    if (row === undefined || !outputs) {
+      this.outputTimers.delete(key);
+      return;
+    }
+
+    let result: number = RETURN_CODES.RETURN_OK;
+    try {
+      await this.iolinkService.writeProcessData(masterHandle, port, outputs.data);
+      this.outputStats.commits++;
+    } catch (error: any) {
+      result =
+        typeof error.code === "number"
+          ? error.code
+          : RETURN_CODES.RETURN_INTERNAL_ERROR;
+      this.outputStats.failedCommits++;
+    }
+
+    // The master may have been released during the call
+    if (this.processImageRows.get(masterHandle) !== row) return;
+    const committedAt = Date.now();
+    this.processImage.commitOutputs(row, port, outputs.sequence, result, committedAt);
+    this.outputCommittedAt.set(key, committedAt);
+    this.outputTimers.delete(key);
+
+    // Writes posted during the call go out one period later
+    if (this.processImage.takeOutputs(row, port)) {
+      this.scheduleOutputCommit(masterHandle, port);
+    }
+  }
+
+  // ============================================================================
+  // PROCESS IMAGE
+  // ============================================================================
+
+  /**
+   * Row of a master in the shared process image, claimed on first use
+   */
+  private getProcessImageRow(masterHandle: number): number {
+    let row = this.processImageRows.get(masterHandle);
+    if (row === undefined) {
+      row = this.processImage.claim(masterHandle);
+      if (row < 0) {
+        throw new Error(`No free process image row for master ${masterHandle}`);
+      }
+      this.processImageRows.set(masterHandle, row);
+    }
+    return row;
+  }
+
+  private releaseProcessImageRow(masterHandle: number): void {
+    for (const [key, timer] of this.outputTimers) {
+      if (key.startsWith(`${masterHandle}:`)) {
+        clearTimeout(timer);
+        this.outputTimers.delete(key);
+        this.outputCommittedAt.delete(key);
+      }
+    }
+
+    const row = this.processImageRows.get(masterHandle);
+    if (row !== undefined) {
+      this.processImage.release(row);
+      this.processImageRows.delete(masterHandle);
+    }
+  }
+
+  /**
+   * Current inputs and outputs of every port with data in the process image
+   */
+  getProcessImageSnapshot(): any[] {
+    const entries: any[] = [];
+    for (const [masterHandle, row] of this.processImageRows) {
+      for (let port = 1; port <= LIMITS.MAX_PORTS; port++) {
+        const inputs = this.processImage.readInputs(row, port);
+        const outputs = this.processImage.readOutputs(row, port);
+        if (!inputs && !outputs) continue;
+
+        entries.push({
+          masterHandle,
+          port,
+          inputs: inputs && {
+            data: Array.from(inputs.data),
+            dataHex: inputs.data.toString("hex").toUpperCase(),
+            status: inputs.status,
+            sequence: inputs.sequence,
+            timestamp: inputs.timestamp,
+          },
+          outputs: outputs && {
+            data: Array.from(outputs.data),
+            dataHex: outputs.data.toString("hex").toUpperCase(),
+            sequence: outputs.sequence,
+            timestamp: outputs.timestamp,
+          },
+        });
+      }
+    }
+    return entries;
   }
 
   // ============================================================================
@@ -487,6 +1538,7 @@ class DeviceManager {
     index: number,
     subIndex: number = 0
   ): Promise<any> {
+    this.assertPortAvailable(deviceKey);
     const device = this.getDeviceByKey(deviceKey);
     const parameterMap = this.parameters.get(deviceKey);
 
@@ -505,18 +1557,45 @@ class DeviceManager {
       logger.debug(
         `Returning cached parameter ${parameterId} for device ${deviceKey}`
       );
+      this.isduStats.cacheHits++;
+      traceInstant("cache.hit", "parameter", { parameter: parameterId });
       return device.getCachedParameter(index, subIndex);
     }
 
-    const result = await this.iolinkService.readParameter(
+    // Concurrent reads of the same parameter share one ISDU transaction
+    const flightKey = `${deviceKey}:${parameterId}`;
+    const inflight = this.inflightReads.get(flightKey);
+    if (inflight) {
+      this.isduStats.coalescedReads++;
+      return traceAsync("read.coalesced", "parameter", () => inflight, {
+        parameter: parameterId,
+      });
+    }
+
+    const request = this.iolinkService.readParameter(
       device.masterHandle!,
       device.port,
       index,
       subIndex
     );
+    this.inflightReads.set(flightKey, request);
+    this.isduStats.reads++;
+
+    let result: any;
+    let superseded: boolean;
+    try {
+      result = await traceAsync("read.miss", "parameter", () => request, {
+        parameter: parameterId,
+      });
+    } finally {
+      // A write started meanwhile removed (and maybe a later read replaced)
+      // this flight; its value predates the write and must not be cached
+      superseded = this.inflightReads.get(flightKey) !== request;
+      if (!superseded) this.inflightReads.delete(flightKey);
+    }
 
     // Cache the result
-    if (parameter) {
+    if (parameter && !superseded) {
       const parsedValue = parameter.parseValue(result.data);
       parameter.updateValue(parsedValue, result.timestamp);
       device.cacheParameter(index, subIndex, result);
@@ -532,6 +1611,7 @@ class DeviceManager {
     subIndex: number = 0,
     value: any
   ): Promise<any> {
+    this.assertPortAvailable(deviceKey);
     const device = this.getDeviceByKey(deviceKey);
     const parameterMap = this.parameters.get(deviceKey);
 
@@ -559,12 +1639,23 @@ class DeviceManager {
       value = parameter.formatValue(value);
     }
 
-    const result = await this.iolinkService.writeParameter(
-      device.masterHandle!,
-      device.port,
-      index,
-      subIndex,
-      value
+    // Reads from now on must not join a read issued before this write or
+    // be answered from the cache; they queue behind the write instead
+    this.inflightReads.delete(`${deviceKey}:${parameterId}`);
+    device.invalidateParameter(index, subIndex);
+
+    const result = await traceAsync(
+      "write",
+      "parameter",
+      () =>
+        this.iolinkService.writeParameter(
+          device.masterHandle!,
+          device.port,
+          index,
+          subIndex,
+          value
+        ),
+      { parameter: parameterId }
     );
 
     // Update parameter cache
@@ -585,6 +1676,226 @@ class DeviceManager {
     return Array.from(parameterMap.values()).map((param) => param.getSummary());
   }
 
+  /**
+   * Execute a parameter batch. Operations are grouped by port and the port
+   * groups run side by side; within a port, writes keep their original order
+   * and each run of reads between writes is deduplicated. When a run asks for
+   * several subindices of a record with a known layout, the record is read
+   * once (subindex 0) and split locally.
+   *
+   * Outcomes are returned in the order of the input operations.
+   */
+  async executeParameterBatch(
+    masterHandle: number,
+    defaultPort: number,
+    operations: BatchOperation[],
+    recordLayouts: Record<number, RecordItemLayout[]> = {}
+  ): Promise<{ outcomes: BatchOutcome[]; transactions: number }> {
+    const outcomes: BatchOutcome[] = new Array(operations.length);
+    const positionsByPort = new Map<number, number[]>();
+
+    operations.forEach((operation, position) => {
+      const port = operation.port ?? defaultPort;
+      if (!positionsByPort.has(port)) positionsByPort.set(port, []);
+      positionsByPort.get(port)!.push(position);
+    });
+
+    let transactions = 0;
+
+    const runPort = async (port: number, positions: number[]) => {
+      const deviceKey = `${masterHandle}:${port}`;
+      let readRun: number[] = [];
+
+      const flushReads = async () => {
+        if (readRun.length === 0) return;
+        const count = await this.executeReadRun(
+          deviceKey,
+          port,
+          readRun,
+          operations,
+          outcomes,
+          recordLayouts
+        );
+        transactions += count;
+        readRun = [];
+      };
+
+      for (const position of positions) {
+        const operation = operations[position];
+
+        if (operation.type === "read") {
+          readRun.push(position);
+          continue;
+        }
+
+        // Writes are barriers: reads queued before them complete first
+        await flushReads();
+
+        try {
+          if (operation.type !== "write") {
+            throw new Error(`Unknown operation type: ${operation.type}`);
+          }
+          if (operation.value === undefined) {
+            throw new Error("Value is required for write operations");
+          }
+          transactions++;
+          const result = await this.writeDeviceParameter(
+            deviceKey,
+            operation.index,
+            operation.subIndex || 0,
+            operation.value
+          );
+          outcomes[position] = { port, success: true, result };
+        } catch (error: any) {
+          outcomes[position] = { port, success: false, error: error.message };
+        }
+      }
+
+      await flushReads();
+    };
+
+    await Promise.all(
+      Array.from(positionsByPort.entries()).map(([port, positions]) =>
+        runPort(port, positions)
+      )
+    );
+
+    return { outcomes, transactions };
+  }
+
+  /**
+   * Resolve a run of reads on one port with as few ISDU transactions as
+   * possible. Returns the number of transactions issued.
+   */
+  private async executeReadRun(
+    deviceKey: string,
+    port: number,
+    positions: number[],
+    operations: BatchOperation[],
+    outcomes: BatchOutcome[],
+    recordLayouts: Record<number, RecordItemLayout[]>
+  ): Promise<number> {
+    // index -> subIndex -> positions waiting for that value
+    const requested = new Map<number, Map<number, number[]>>();
+    for (const position of positions) {
+      const { index, subIndex = 0 } = operations[position];
+      if (!requested.has(index)) requested.set(index, new Map());
+      const subs = requested.get(index)!;
+      if (!subs.has(subIndex)) subs.set(subIndex, []);
+      subs.get(subIndex)!.push(position);
+    }
+
+    let transactions = 0;
+
+    const settle = (
+      waiting: number[],
+      outcome: Omit<BatchOutcome, "port" | "source">,
+      source: BatchOutcome["source"]
+    ) => {
+      waiting.forEach((position, i) => {
+        outcomes[position] = {
+          port,
+          ...outcome,
+          source: i === 0 ? source : "coalesced",
+        };
+      });
+    };
+
+    for (const [index, subs] of requested) {
+      const layout = recordLayouts[index] || RECORD_LAYOUTS[index];
+      const itemSubs = Array.from(subs.keys()).filter((sub) => sub !== 0);
+      const splittable =
+        layout !== undefined &&
+        itemSubs.length >= 2 &&
+        itemSubs.every((sub) => layout.some((item) => item.subIndex === sub));
+
+      if (splittable) {
+        try {
+          transactions++;
+          const record = await this.readDeviceParameter(deviceKey, index, 0);
+
+          for (const [subIndex, waiting] of subs) {
+            if (subIndex === 0) {
+              settle(waiting, { success: true, result: record }, "device");
+              continue;
+            }
+            const item = layout!.find((entry) => entry.subIndex === subIndex)!;
+            try {
+              const data = this.extractRecordItem(record.data, item);
+              settle(
+                waiting,
+                {
+                  success: true,
+                  result: {
+                    ...record,
+                    subIndex: subIndex,
+                    length: data.length,
+                    data: data,
+                  },
+                },
+                "record"
+              );
+            } catch (error: any) {
+              settle(waiting, { success: false, error: error.message }, "record");
+            }
+          }
+          continue;
+        } catch (error: any) {
+          // Not every device allows reading a whole record; fall back to
+          // individual subindex reads
+          logger.debug(
+            `Record read ${index}.0 failed on ${deviceKey}, reading subindices: ${error.message}`
+          );
+        }
+      }
+
+      for (const [subIndex, waiting] of subs) {
+        try {
+          transactions++;
+          const result = await this.readDeviceParameter(
+            deviceKey,
+            index,
+            subIndex
+          );
+          settle(waiting, { success: true, result }, "device");
+        } catch (error: any) {
+          settle(waiting, { success: false, error: error.message }, "device");
+        }
+      }
+    }
+
+    return transactions;
+  }
+
+  /**
+   * Cut one record item out of a record read with subindex 0. Byte-aligned
+   * items are sliced directly; others are shifted out and returned in the
+   * minimum number of octets.
+   */
+  private extractRecordItem(record: Buffer, item: RecordItemLayout): Buffer {
+    const totalBits = record.length * 8;
+    if (item.bitOffset + item.bitLength > totalBits) {
+      throw new Error(
+        `Subindex ${item.subIndex} lies outside the ${record.length}-byte record`
+      );
+    }
+
+    if (item.bitOffset % 8 === 0 && item.bitLength % 8 === 0) {
+      const end = record.length - item.bitOffset / 8;
+      return record.slice(end - item.bitLength / 8, end);
+    }
+
+    let value = BigInt(`0x${record.toString("hex") || "0"}`);
+    value = (value >> BigInt(item.bitOffset)) & ((1n << BigInt(item.bitLength)) - 1n);
+
+    const out = Buffer.alloc(Math.ceil(item.bitLength / 8));
+    for (let i = out.length - 1; i >= 0; i--) {
+      out[i] = Number(value & 0xffn);
+      value >>= 8n;
+    }
+    return out;
+  }
+
   // ============================================================================
   // UTILITY METHODS
   // ============================================================================
@@ -602,6 +1913,14 @@ class DeviceManager {
     return device;
   }
 
+  /**
+   * Access to the DLL wrapper for services that run their own protocols on
+   * top of a device (BLOB, data storage, firmware update).
+   */
+  getIOLinkService(): IOLinkService {
+    return this.iolinkService;
+  }
+
   getDeviceCount(): number {
     return this.devices.size;
   }
@@ -620,6 +1939,10 @@ class DeviceManager {
       clearInterval(intervalId);
     }
     this.scanIntervals.clear();
+    for (const [masterHandle, monitorId] of this.statusMonitors) {
+      clearInterval(monitorId);
+    }
+    this.statusMonitors.clear();
 
     // Disconnect all masters
     for (const [handle, masterInfo] of this.connectedMasters) {
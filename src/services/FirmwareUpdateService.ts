@@ -0,0 +1,625 @@
+/**
+ * Firmware Update Service
+ * Concurrent firmware update jobs over the DLL firmware update state machine
+ *
+ */
+
+import { EventEmitter } from "events";
+import { createHash, randomUUID } from "crypto";
+import { promises as fs } from "fs";
+import path from "path";
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import {
+  FWUPDATE_STATES,
+  FWUPDATE_STATE_NAMES,
+  FWUPDATE_RETURN_CODES,
+  FWUPDATE_RETURN_MESSAGES,
+  BLOB_STATES,
+  LIMITS,
+  isValidPort,
+} from "../utils/constants";
+
+type JobState =
+  | "starting"
+  | "running"
+  | "waiting"
+  | "completed"
+  | "failed"
+  | "aborted";
+
+interface FirmwareImageEntry {
+  id: string;
+  source: "upload" | "metafile";
+  metafile: string | null;
+  vendorId: number;
+  passwordRequired: boolean;
+  hwKey: string;
+  size: number;
+  firmware: Buffer;
+  loadedAt: Date;
+}
+
+interface FirmwareJob {
+  id: string;
+  campaignId: string;
+  masterHandle: number;
+  port: number;
+  deviceKey: string;
+  imageId: string | null;
+  metafile: string | null;
+  state: JobState;
+  phase: string;
+  nextState: number;
+  percentComplete: number;
+  steps: number;
+  error: string | null;
+  errorCode: number | null;
+  abortRequested: boolean;
+  startedAt: Date;
+  finishedAt: Date | null;
+}
+
+interface CampaignTarget {
+  masterHandle: number;
+  port: number;
+}
+
+interface CampaignRequest {
+  targets: CampaignTarget[];
+  imageId?: string;
+  metafile?: string;
+  password?: string;
+}
+
+interface ImageOptions {
+  vendorId: number;
+  hwKey: string;
+  passwordRequired?: boolean;
+}
+
+const ACTIVE_STATES: JobState[] = ["starting", "running", "waiting"];
+
+const WAIT_STATES: number[] = [
+  FWUPDATE_STATES.FWUPDATE_STATE_WAITREBOOT,
+  FWUPDATE_STATES.FWUPDATE_STATE_WAITACTIVATE,
+];
+
+// ============================================================================
+// FIRMWARE UPDATE SERVICE CLASS
+// ============================================================================
+
+/**
+ * Runs one job per target port, all concurrently. Each job drives its own
+ * IOL_FwUpdateContinue loop on the thread pool; in the reboot and activation
+ * phases a job yields on a timer between polls so it neither spins nor holds
+ * a pool worker while the device restarts. Images are kept once in memory
+ * (keyed by content hash) and every job points the DLL at the same buffer.
+ *
+ * Emits "progress", "completed" and "failed" with the job summary.
+ */
+class FirmwareUpdateService extends EventEmitter {
+  private deviceManager: DeviceManager;
+  private images: Map<string, FirmwareImageEntry>;
+  private metafileImages: Map<string, Promise<string | null>>;
+  private jobs: Map<string, FirmwareJob>;
+  private activePorts: Map<string, string>;
+  private passwords: Map<string, string>;
+  private firmwareDir: string;
+
+  constructor(deviceManager: DeviceManager, firmwareDir?: string) {
+    super();
+    this.deviceManager = deviceManager;
+    this.firmwareDir =
+      firmwareDir ||
+      process.env.FIRMWARE_DIR ||
+      path.join(process.cwd(), "data", "firmware");
+    this.images = new Map();
+    this.metafileImages = new Map();
+    this.jobs = new Map();
+    this.activePorts = new Map();
+    this.passwords = new Map();
+  }
+
+  // ============================================================================
+  // IMAGES
+  // ============================================================================
+
+  registerImage(
+    firmware: Buffer,
+    options: ImageOptions,
+    source: "upload" | "metafile" = "upload",
+    metafile: string | null = null
+  ): FirmwareImageEntry {
+    const id = createHash("sha256").update(firmware).digest("hex");
+    const existing = this.images.get(id);
+    if (existing) {
+      return existing;
+    }
+
+    const entry: FirmwareImageEntry = {
+      id,
+      source,
+      metafile,
+      vendorId: options.vendorId,
+      passwordRequired: options.passwordRequired === true,
+      hwKey: options.hwKey,
+      size: firmware.length,
+      firmware,
+      loadedAt: new Date(),
+    };
+    this.images.set(id, entry);
+    logger.info(
+      `Firmware image ${id.substring(0, 12)} loaded (${firmware.length} bytes, vendor ${options.vendorId})`
+    );
+    return entry;
+  }
+
+  removeImage(imageId: string): boolean {
+    for (const job of this.jobs.values()) {
+      if (job.imageId === imageId && ACTIVE_STATES.includes(job.state)) {
+        const error: any = new Error(`Firmware image ${imageId} is in use by job ${job.id}`);
+        error.statusCode = 409;
+        error.apiErrorCode = "FIRMWARE_IMAGE_IN_USE";
+        throw error;
+      }
+    }
+    for (const [key, pending] of this.metafileImages) {
+      pending.then((id) => {
+        if (id === imageId) this.metafileImages.delete(key);
+      });
+    }
+    return this.images.delete(imageId);
+  }
+
+  getImages(): any[] {
+    return Array.from(this.images.values()).map((image) => ({
+      id: image.id,
+      source: image.source,
+      metafile: image.metafile,
+      vendorId: image.vendorId,
+      passwordRequired: image.passwordRequired,
+      hwKey: image.hwKey,
+      size: image.size,
+      loadedAt: image.loadedAt,
+    }));
+  }
+
+  // ============================================================================
+  // JOBS
+  // ============================================================================
+
+  /**
+   * Validate all targets up front, then start one job per target without
+   * waiting for any of them.
+   */
+  async startCampaign(request: CampaignRequest): Promise<{
+    campaignId: string;
+    jobs: FirmwareJob[];
+  }> {
+    if (!request.imageId === !request.metafile) {
+      throw this.requestError("Specify exactly one of imageId or metafile");
+    }
+    if (request.imageId && !this.images.has(request.imageId)) {
+      const error: any = new Error(`Firmware image ${request.imageId} not found`);
+      error.statusCode = 404;
+      error.apiErrorCode = "FIRMWARE_IMAGE_NOT_FOUND";
+      throw error;
+    }
+
+    let metafileKey: string | null = null;
+    if (request.metafile) {
+      const metafile = await this.resolveMetafile(request.metafile);
+      try {
+        const stats = await fs.stat(metafile);
+        // A rewritten package gets loaded again
+        metafileKey = `${metafile}@${stats.mtimeMs}`;
+      } catch (error: any) {
+        throw this.requestError(`Metafile not readable: ${request.metafile}`);
+      }
+      request = { ...request, metafile };
+    }
+
+    const connected = new Set<number>(
+      this.deviceManager.getConnectedMasters().map((master) => master.handle)
+    );
+    const seen = new Set<string>();
+    for (const target of request.targets) {
+      const deviceKey = `${target.masterHandle}:${target.port}`;
+      if (!isValidPort(target.port)) {
+        throw this.requestError(`Invalid port ${target.port}`);
+      }
+      if (!connected.has(target.masterHandle)) {
+        const error: any = new Error(`Master ${target.masterHandle} not connected`);
+        error.statusCode = 404;
+        error.apiErrorCode = "MASTER_NOT_FOUND";
+        throw error;
+      }
+      if (seen.has(deviceKey)) {
+        throw this.requestError(`Duplicate target ${deviceKey}`);
+      }
+      if (this.activePorts.has(deviceKey)) {
+        const error: any = new Error(
+          `Firmware update ${this.activePorts.get(deviceKey)} already running on ${deviceKey}`
+        );
+        error.statusCode = 409;
+        error.apiErrorCode = "FIRMWARE_UPDATE_BUSY";
+        throw error;
+      }
+      seen.add(deviceKey);
+    }
+    if (this.activePorts.size + seen.size > LIMITS.MAX_FIRMWARE_JOBS) {
+      const error: any = new Error(
+        `At most ${LIMITS.MAX_FIRMWARE_JOBS} firmware updates can run at once`
+      );
+      error.statusCode = 429;
+      error.apiErrorCode = "FIRMWARE_JOB_LIMIT";
+      throw error;
+    }
+
+    const campaignId = randomUUID();
+    const jobs: FirmwareJob[] = [];
+
+    for (const target of request.targets) {
+      const job = this.createJob(campaignId, target, request);
+      if (request.password) {
+        this.passwords.set(job.id, request.password);
+      }
+      jobs.push(job);
+    }
+
+    logger.info(
+      `Firmware campaign ${campaignId} started on ${jobs.length} port(s)`
+    );
+    for (const job of jobs) {
+      // Deliberately not awaited: the jobs run side by side
+      this.run(job, metafileKey).catch(() => undefined);
+    }
+
+    return { campaignId, jobs };
+  }
+
+  abort(jobId: string): boolean {
+    const job = this.jobs.get(jobId);
+    if (!job || !ACTIVE_STATES.includes(job.state)) {
+      return false;
+    }
+    job.abortRequested = true;
+    logger.info(`Abort requested for firmware update ${jobId}`);
+    return true;
+  }
+
+  getJob(jobId: string): FirmwareJob | undefined {
+    return this.jobs.get(jobId);
+  }
+
+  getJobs(campaignId?: string): FirmwareJob[] {
+    const jobs = Array.from(this.jobs.values());
+    return campaignId ? jobs.filter((job) => job.campaignId === campaignId) : jobs;
+  }
+
+  // ============================================================================
+  // STATE MACHINE
+  // ============================================================================
+
+  private createJob(
+    campaignId: string,
+    target: CampaignTarget,
+    request: CampaignRequest
+  ): FirmwareJob {
+    const deviceKey = `${target.masterHandle}:${target.port}`;
+    const job: FirmwareJob = {
+      id: randomUUID(),
+      campaignId,
+      masterHandle: target.masterHandle,
+      port: target.port,
+      deviceKey,
+      imageId: request.imageId || null,
+      metafile: request.metafile || null,
+      state: "starting",
+      phase: FWUPDATE_STATE_NAMES[FWUPDATE_STATES.FWUPDATE_STATE_IDLE],
+      nextState: FWUPDATE_STATES.FWUPDATE_STATE_IDLE,
+      percentComplete: 0,
+      steps: 0,
+      error: null,
+      errorCode: null,
+      abortRequested: false,
+      startedAt: new Date(),
+      finishedAt: null,
+    };
+
+    this.jobs.set(job.id, job);
+    this.activePorts.set(deviceKey, job.id);
+    this.pruneFinished();
+    return job;
+  }
+
+  private async run(job: FirmwareJob, metafileKey: string | null): Promise<void> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+    let reserved = false;
+
+    try {
+      this.deviceManager.beginPortMaintenance(
+        job.masterHandle,
+        job.port,
+        `firmware update ${job.id}`
+      );
+      reserved = true;
+
+      const { session, step } = await this.startJob(job, metafileKey);
+      await this.drive(job, session, step);
+
+      job.state = "completed";
+      job.percentComplete = 100;
+      this.emit("completed", { ...job });
+      logger.info(
+        `Firmware update on ${job.deviceKey} completed in ${Date.now() - job.startedAt.getTime()}ms`
+      );
+    } catch (error: any) {
+      job.state = job.abortRequested ? "aborted" : "failed";
+      job.error = error.message;
+      job.errorCode = error.code !== undefined ? error.code : null;
+      this.emit("failed", { ...job });
+      logger.error(
+        `Firmware update on ${job.deviceKey} ${job.state}:`,
+        error.message
+      );
+
+      // Resets the device's BLOB state so a new attempt can start cleanly
+      if (reserved) {
+        try {
+          await iolinkService.abortFirmwareUpdate(job.masterHandle, job.port);
+        } catch (abortError: any) {
+          logger.debug(`IOL_FwUpdateAbort after failure: ${abortError.message}`);
+        }
+      }
+    } finally {
+      job.finishedAt = new Date();
+      this.passwords.delete(job.id);
+      this.activePorts.delete(job.deviceKey);
+      if (reserved) {
+        await this.deviceManager.endPortMaintenance(job.masterHandle, job.port);
+      }
+    }
+  }
+
+  /**
+   * Start from a cached image when possible. For a metafile, the first job
+   * lets the DLL parse the package and the image it loaded is copied into
+   * the cache; jobs for the same package wait for that and then start from
+   * the shared copy instead of parsing it again.
+   */
+  private async startJob(
+    job: FirmwareJob,
+    metafileKey: string | null
+  ): Promise<{ session: any; step: any }> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+
+    if (job.imageId) {
+      return iolinkService.startFirmwareUpdate(
+        job.masterHandle,
+        job.port,
+        this.requireImage(job.imageId)
+      );
+    }
+
+    const metafile = job.metafile!;
+    const key = metafileKey || metafile;
+    const pending = this.metafileImages.get(key);
+    if (pending) {
+      const imageId = await pending;
+      if (imageId && this.images.has(imageId)) {
+        job.imageId = imageId;
+        return iolinkService.startFirmwareUpdate(
+          job.masterHandle,
+          job.port,
+          this.requireImage(imageId)
+        );
+      }
+      return iolinkService.startFirmwareUpdateByMetafile(
+        job.masterHandle,
+        job.port,
+        metafile
+      );
+    }
+
+    let resolveLoad: (imageId: string | null) => void = () => undefined;
+    this.metafileImages.set(
+      key,
+      new Promise((resolve) => {
+        resolveLoad = resolve;
+      })
+    );
+
+    try {
+      const started = await iolinkService.startFirmwareUpdateByMetafile(
+        job.masterHandle,
+        job.port,
+        metafile
+      );
+      const image = iolinkService.getFirmwareImage(started.session);
+      if (image) {
+        const entry = this.registerImage(image.firmware, image, "metafile", metafile);
+        job.imageId = entry.id;
+        resolveLoad(entry.id);
+      } else {
+        this.metafileImages.delete(key);
+        resolveLoad(null);
+      }
+      return started;
+    } catch (error) {
+      this.metafileImages.delete(key);
+      resolveLoad(null);
+      throw error;
+    }
+  }
+
+  private async drive(job: FirmwareJob, session: any, firstStep: any): Promise<void> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+    let step = firstStep;
+    let waitingSince = 0;
+
+    for (;;) {
+      job.steps++;
+      this.checkStep(step);
+      this.updateProgress(job, step);
+
+      if (step.nextState === FWUPDATE_STATES.FWUPDATE_STATE_IDLE) {
+        return;
+      }
+      if (job.abortRequested) {
+        throw new Error("Firmware update aborted");
+      }
+
+      if (WAIT_STATES.includes(step.nextState)) {
+        // The device is restarting: poll on a timer rather than back to back
+        if (!waitingSince) {
+          waitingSince = Date.now();
+        } else if (Date.now() - waitingSince > LIMITS.FIRMWARE_WAIT_TIMEOUT) {
+          throw new Error(
+            `Device did not come back within ${LIMITS.FIRMWARE_WAIT_TIMEOUT}ms (${job.phase})`
+          );
+        }
+        job.state = "waiting";
+        await new Promise((resolve) =>
+          setTimeout(resolve, LIMITS.FIRMWARE_WAIT_POLL_INTERVAL)
+        );
+      } else {
+        waitingSince = 0;
+        job.state = "running";
+      }
+
+      const password =
+        step.nextState === FWUPDATE_STATES.FWUPDATE_STATE_PASSWORD
+          ? this.passwords.get(job.id) || null
+          : null;
+      step = await iolinkService.continueFirmwareUpdate(
+        job.masterHandle,
+        job.port,
+        session,
+        password
+      );
+    }
+  }
+
+  private checkStep(step: any): void {
+    if (step.result < 0) {
+      const error: any = new Error(`Firmware update step failed with DLL code: ${step.result}`);
+      error.code = step.result;
+      throw error;
+    }
+    if (step.result !== FWUPDATE_RETURN_CODES.FWUPDATE_RET_OK) {
+      const error: any = new Error(
+        FWUPDATE_RETURN_MESSAGES[step.result] ||
+          `Firmware update error: ${step.result}`
+      );
+      // A failed DLL service shows up as a negative dllReturnValue
+      if (step.dllReturnValue < 0) {
+        error.code = step.dllReturnValue;
+      }
+      throw error;
+    }
+    if (step.nextState === FWUPDATE_STATES.FWUPDATE_STATE_ERROR) {
+      throw new Error(
+        `Firmware update state machine error: Code=${step.errorCode}, Additional=${step.additionalCode}`
+      );
+    }
+  }
+
+  private updateProgress(job: FirmwareJob, step: any): void {
+    const phase =
+      FWUPDATE_STATE_NAMES[step.nextState] || `STATE_${step.nextState}`;
+    let percent = job.percentComplete;
+    if (
+      step.executedState === FWUPDATE_STATES.FWUPDATE_STATE_DOWNLOADFIRMWARE &&
+      step.blob.executedState !== BLOB_STATES.BLOB_STATE_IDLE
+    ) {
+      percent = step.blob.percentComplete;
+    }
+
+    const changed = phase !== job.phase || percent !== job.percentComplete;
+    job.phase = phase;
+    job.nextState = step.nextState;
+    job.percentComplete = percent;
+
+    if (changed) {
+      this.emit("progress", {
+        id: job.id,
+        campaignId: job.campaignId,
+        deviceKey: job.deviceKey,
+        phase: phase,
+        percentComplete: percent,
+        timestamp: new Date(),
+      });
+    }
+  }
+
+  // ============================================================================
+  // HELPERS
+  // ============================================================================
+
+  private requireImage(imageId: string): FirmwareImageEntry {
+    const image = this.images.get(imageId);
+    if (!image) {
+      throw new Error(`Firmware image ${imageId} not found`);
+    }
+    return image;
+  }
+
+  /**
+   * Path of a metafile given relative to the firmware directory. Absolute
+   * paths, ".." and symlinks leading out of the directory are rejected.
+   */
+  private async resolveMetafile(metafile: string): Promise<string> {
+    const outside = () =>
+      this.requestError(`Metafile must be a relative path inside the firmware directory`);
+    if (path.isAbsolute(metafile) || metafile.split(/[\\/]/).includes("..")) {
+      throw outside();
+    }
+
+    let root: string;
+    let resolved: string;
+    try {
+      root = await fs.realpath(this.firmwareDir);
+      resolved = await fs.realpath(path.resolve(root, metafile));
+    } catch (error: any) {
+      throw this.requestError(`Metafile not readable: ${metafile}`);
+    }
+    const relative = path.relative(root, resolved);
+    if (!relative || relative.split(path.sep)[0] === ".." || path.isAbsolute(relative)) {
+      throw outside();
+    }
+    return resolved;
+  }
+
+  private requestError(message: string): Error {
+    const error: any = new Error(message);
+    error.statusCode = 400;
+    error.apiErrorCode = "INVALID_FIRMWARE_REQUEST";
+    return error;
+  }
+
+  private pruneFinished(maxEntries: number = 500): void {
+    if (this.jobs.size <= maxEntries) return;
+    for (const [id, job] of this.jobs) {
+      if (!ACTIVE_STATES.includes(job.state)) {
+        this.jobs.delete(id);
+        if (this.jobs.size <= maxEntries) return;
+      }
+    }
+  }
+
+  getStatus(): any {
+    const counts: Record<string, number> = {};
+    for (const job of this.jobs.values()) {
+      counts[job.state] = (counts[job.state] || 0) + 1;
+    }
+    return {
+      activeJobs: this.activePorts.size,
+      jobsByState: counts,
+      images: this.images.size,
+    };
+  }
+}
+
+export default FirmwareUpdateService;
@@ -0,0 +1,215 @@
+/**
+ * History Service
+ * Records logged process data per port into downsampling pyramids
+ *
+ */
+
+import DataLoggingService, { LoggedSamples } from "./DataLoggingService";
+import logger from "../utils/logger";
+import { DownsamplePyramid, PyramidQuery } from "../utils/downsamplePyramid";
+import { DATA_TYPES, DATA_TYPE_SIZES } from "../utils/constants";
+
+export interface ChannelDecoding {
+  // Numeric DATA_TYPES; without one the whole input (up to 4 bytes) is
+  // read as an unsigned big-endian integer
+  dataType?: string;
+  // Byte offset into the process data inputs
+  offset: number;
+  // value * scale + bias
+  scale: number;
+  bias: number;
+}
+
+interface Channel {
+  masterHandle: number;
+  port: number;
+  decoding: ChannelDecoding;
+  pyramid: DownsamplePyramid;
+  createdAt: Date;
+  invalidSkipped: number;
+  undecodable: number;
+}
+
+const DEFAULT_DECODING: ChannelDecoding = { offset: 0, scale: 1, bias: 0 };
+
+/**
+ * IO-Link process data is big-endian
+ */
+export function decodeChannelValue(data: Buffer, decoding: ChannelDecoding): number | null {
+  const { offset } = decoding;
+  let raw: number;
+
+  if (!decoding.dataType) {
+    const length = Math.min(data.length - offset, 4);
+    if (length <= 0) return null;
+    raw = data.readUIntBE(offset, length);
+  } else {
+    if (offset + (DATA_TYPE_SIZES[decoding.dataType] ?? Infinity) > data.length) {
+      return null;
+    }
+    switch (decoding.dataType) {
+      case DATA_TYPES.UINT8:
+        raw = data.readUInt8(offset);
+        break;
+      case DATA_TYPES.INT8:
+        raw = data.readInt8(offset);
+        break;
+      case DATA_TYPES.UINT16:
+        raw = data.readUInt16BE(offset);
+        break;
+      case DATA_TYPES.INT16:
+        raw = data.readInt16BE(offset);
+        break;
+      case DATA_TYPES.UINT32:
+        raw = data.readUInt32BE(offset);
+        break;
+      case DATA_TYPES.INT32:
+        raw = data.readInt32BE(offset);
+        break;
+      case DATA_TYPES.FLOAT32:
+        raw = data.readFloatBE(offset);
+        break;
+      case DATA_TYPES.FLOAT64:
+        raw = data.readDoubleBE(offset);
+        break;
+      case DATA_TYPES.BOOLEAN:
+        raw = data.readUInt8(offset) !== 0 ? 1 : 0;
+        break;
+      default:
+        return null;
+    }
+  }
+
+  return raw * decoding.scale + decoding.bias;
+}
+
+// ============================================================================
+// HISTORY SERVICE
+// ============================================================================
+
+/**
+ * Every sample the data logging service drains is decoded to one number per
+ * port and folded into that port's pyramid while it is ingested. Queries
+ * read pre-aggregated buckets only, so zooming out over days costs the same
+ * as zooming into a second. Samples with invalid inputs and gap records are
+ * not recorded; gaps show up as missing buckets.
+ */
+class HistoryService {
+  private dataLoggingService: DataLoggingService;
+  private channels: Map<string, Channel>;
+  private decodings: Map<string, ChannelDecoding>;
+  private listener: ((batch: LoggedSamples) => void) | null;
+
+  constructor(dataLoggingService: DataLoggingService) {
+    this.dataLoggingService = dataLoggingService;
+    this.channels = new Map();
+    this.decodings = new Map();
+    this.listener = null;
+  }
+
+  start(): void {
+    if (this.listener) return;
+    this.listener = (batch) => this.ingest(batch);
+    this.dataLoggingService.on("samples", this.listener);
+    logger.info("Process data history recording started");
+  }
+
+  stop(): void {
+    if (!this.listener) return;
+    this.dataLoggingService.off("samples", this.listener);
+    this.listener = null;
+    logger.info("Process data history recording stopped");
+  }
+
+  private ingest(batch: LoggedSamples): void {
+    const key = `${batch.masterHandle}:${batch.port}`;
+    let channel = this.channels.get(key);
+    if (!channel) {
+      channel = this.createChannel(batch.masterHandle, batch.port);
+      this.channels.set(key, channel);
+    }
+
+    for (const sample of batch.samples) {
+      if (sample.gap) continue;
+      if (!sample.inputValid) {
+        channel.invalidSkipped++;
+        continue;
+      }
+      const value = decodeChannelValue(sample.inputData, channel.decoding);
+      if (value === null) {
+        channel.undecodable++;
+        continue;
+      }
+      channel.pyramid.add(sample.timestamp, value);
+    }
+  }
+
+  private createChannel(masterHandle: number, port: number): Channel {
+    return {
+      masterHandle,
+      port,
+      decoding: this.getDecoding(masterHandle, port),
+      pyramid: new DownsamplePyramid(),
+      createdAt: new Date(),
+      invalidSkipped: 0,
+      undecodable: 0,
+    };
+  }
+
+  // ============================================================================
+  // CHANNELS
+  // ============================================================================
+
+  /**
+   * Change how a port's inputs become a value. Recorded history in the old
+   * decoding is dropped since it would not be comparable.
+   */
+  setDecoding(masterHandle: number, port: number, decoding: Partial<ChannelDecoding>): ChannelDecoding {
+    const key = `${masterHandle}:${port}`;
+    const merged = { ...DEFAULT_DECODING, ...decoding };
+    this.decodings.set(key, merged);
+    this.channels.delete(key);
+    return merged;
+  }
+
+  getDecoding(masterHandle: number, port: number): ChannelDecoding {
+    return this.decodings.get(`${masterHandle}:${port}`) || DEFAULT_DECODING;
+  }
+
+  clear(masterHandle: number, port: number): boolean {
+    return this.channels.delete(`${masterHandle}:${port}`);
+  }
+
+  query(
+    masterHandle: number,
+    port: number,
+    from: number,
+    to: number,
+    points: number
+  ): (PyramidQuery & { decoding: ChannelDecoding }) | null {
+    const channel = this.channels.get(`${masterHandle}:${port}`);
+    if (!channel) return null;
+    return { ...channel.pyramid.query(from, to, points), decoding: channel.decoding };
+  }
+
+  getChannels(): any[] {
+    return Array.from(this.channels.values()).map((channel) => ({
+      masterHandle: channel.masterHandle,
+      port: channel.port,
+      decoding: channel.decoding,
+      createdAt: channel.createdAt.toISOString(),
+      invalidSkipped: channel.invalidSkipped,
+      undecodable: channel.undecodable,
+      ...channel.pyramid.getStatus(),
+    }));
+  }
+
+  getStatus() {
+    return {
+      recording: this.listener !== null,
+      channels: this.channels.size,
+    };
+  }
+}
+
+export default HistoryService;
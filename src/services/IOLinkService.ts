@@ -9,12 +9,20 @@ import * as ffi from "ffi-napi";
 import * as ref from "ref-napi";
 import StructType from "ref-struct-napi";
 import ArrayType from "ref-array-napi";
+import { performance } from "perf_hooks";
 import logger from "../utils/logger";
+import {
+  instrumentLibrary,
+  IOLINK_DLL_INSTRUMENTATION,
+} from "../utils/diagnostics";
+import { tracer } from "../utils/tracing";
 import {
   RETURN_CODES,
   PORT_MODES,
   SENSOR_STATUS,
   PARAMETER_INDEX,
+  LIMITS,
+  getMaxMasters,
 } from "../utils/constants";
 
 // ============================================================================
@@ -52,6 +60,72 @@ const TParameter = StructType({
   AdditionalCode: BYTE,
 });
 
+// Event Structure (IOL_ReadEvent)
+const TEvent = StructType({
+  Number: WORD,
+  Port: WORD,
+  EventCode: WORD,
+  Instance: BYTE,
+  Mode: BYTE,
+  Type: BYTE,
+  PDValid: BYTE,
+  LocalGenerated: BYTE,
+});
+
+// BLOB Status Structure (TMGIOLBlob.h, packed to 1 byte)
+const TBLOBStatus = StructType(
+  {
+    executedState: BYTE,
+    errorCode: BYTE,
+    additionalCode: BYTE,
+    dllReturnValue: LONG,
+    Position: DWORD,
+    PercentComplete: BYTE,
+    nextState: BYTE,
+  },
+  { packed: true }
+);
+
+// Firmware Update State Structure (TMGIOLFwUpdate.h, packed to 1 byte)
+const TFWUpdateState = StructType(
+  {
+    executedState: BYTE,
+    errorCode: BYTE,
+    additionalCode: BYTE,
+    dllReturnValue: LONG,
+    blobReturnValue: LONG,
+    nextState: BYTE,
+    BlobStatus: TBLOBStatus,
+  },
+  { packed: true }
+);
+
+// Firmware Update Info Structure (TMGIOLFwUpdate.h, packed to 1 byte)
+const TFwUpdateInfo = StructType(
+  {
+    vendorID: WORD,
+    fwPasswordRequired: BYTE,
+    hwKey: ArrayType(BYTE, 65),
+    pFirmware: ref.refType(BYTE),
+    fwLength: DWORD,
+  },
+  { packed: true }
+);
+
+// Statistic Counter Structure (IOL_GetStatisticCounter)
+const TStatisticCounter = StructType({
+  CycleCounter: DWORD,
+  RetryCounter: DWORD,
+  AbortCounter: DWORD,
+});
+
+// Hardware Info Structure (IOL_GetHWInfo)
+const THardwareInfo = StructType({
+  InfoVersion: DWORD,
+  PowerSource: DWORD,
+  PowerLevel: DWORD,
+});
+
 // Port Configuration Structure
 const TPortConfiguration = StructType({
   PortModeDetails: BYTE,
@@ -97,9 +171,82 @@ const iolinkDll = ffi.Library(
       [LONG, DWORD, ref.refType(BYTE), ref.refType(DWORD), ref.refType(DWORD)],
     ],
     IOL_WriteOutputs: [LONG, [LONG, DWORD, ref.refType(BYTE), DWORD]],
+
+    // Process data logging
+    IOL_StartDataLoggingInBuffer: [
+      LONG,
+      [LONG, DWORD, LONG, DWORD, ref.refType(DWORD)],
+    ],
+    IOL_StopDataLogging: [LONG, [LONG]],
+    IOL_ReadLoggingBuffer: [
+      LONG,
+      [LONG, ref.refType(LONG), ref.refType(BYTE), ref.refType(DWORD)],
+    ],
+
+    // Event handling
+    IOL_ReadEvent: [LONG, [LONG, ref.refType(TEvent), ref.refType(DWORD)]],
+
+    // Diagnostics
+    IOL_GetStatisticCounter: [
+      LONG,
+      [LONG, DWORD, ref.refType(TStatisticCounter), ref.types.bool],
+    ],
+    IOL_GetHWInfo: [LONG, [LONG, ref.refType(THardwareInfo)]],
+
+    // Data storage
+    IOL_DS_Command: [LONG, [LONG, DWORD, DWORD]],
+    IOL_DS_ContentGet: [
+      LONG,
+      [LONG, DWORD, ref.refType(BYTE), ref.refType(DWORD)],
+    ],
+    IOL_DS_ContentSet: [LONG, [LONG, DWORD, ref.refType(BYTE), DWORD]],
+
+    // BLOB transfer
+    BLOB_uploadBLOB: [
+      LONG,
+      [
+        LONG,
+        DWORD,
+        LONG,
+        DWORD,
+        ref.refType(BYTE),
+        ref.refType(DWORD),
+        ref.refType(TBLOBStatus),
+      ],
+    ],
+    BLOB_downloadBLOB: [
+      LONG,
+      [LONG, DWORD, LONG, DWORD, ref.refType(BYTE), ref.refType(TBLOBStatus)],
+    ],
+    BLOB_Continue: [LONG, [LONG, DWORD, ref.refType(TBLOBStatus)]],
+    BLOB_Abort: [LONG, [LONG, DWORD, ref.refType(TBLOBStatus)]],
+
+    // Firmware update
+    IOL_FwUpdateStart: [
+      LONG,
+      [LONG, DWORD, ref.refType(TFwUpdateInfo), ref.refType(TFWUpdateState)],
+    ],
+    IOL_FwUpdateStartByMetafile: [
+      LONG,
+      [
+        LONG,
+        DWORD,
+        ref.types.CString,
+        ref.refType(TFwUpdateInfo),
+        ref.refType(TFWUpdateState),
+      ],
+    ],
+    IOL_FwUpdateContinue: [
+      LONG,
+      [LONG, DWORD, ref.types.CString, ref.refType(TFWUpdateState)],
+    ],
+    IOL_FwUpdateAbort: [LONG, [LONG, DWORD, ref.refType(TFWUpdateState)]],
   }
 ) as any;
 
+// Per-call latency histograms (function, return code, master, port)
+instrumentLibrary(iolinkDll, IOLINK_DLL_INSTRUMENTATION);
+
 // ============================================================================
 // INTERFACES
 // ============================================================================
@@ -137,6 +284,71 @@ interface PortStatus {
   timestamp: Date;
 }
 
+interface MasterEvent {
+  number: number;
+  port: number;
+  eventCode: number;
+  instance: number;
+  mode: number;
+  type: number;
+  localGenerated: boolean;
+  timestamp: Date;
+}
+
+interface BlobSession {
+  status: any;
+  lengthRead: any;
+  buffer: Buffer;
+}
+
+interface BlobStep {
+  result: number;
+  executedState: number;
+  nextState: number;
+  errorCode: number;
+  additionalCode: number;
+  dllReturnValue: number;
+  position: number;
+  percentComplete: number;
+}
+
+interface StatisticCounters {
+  port: number;
+  cycles: number;
+  retries: number;
+  aborts: number;
+}
+
+interface HardwareInfo {
+  infoVersion: number;
+  externalPower: boolean;
+  powerLevelMv: number;
+}
+
+interface FirmwareImage {
+  vendorId: number;
+  passwordRequired: boolean;
+  hwKey: string;
+  firmware: Buffer;
+}
+
+interface FirmwareSession {
+  info: any;
+  state: any;
+  firmware: Buffer | null;
+}
+
+interface FirmwareStep {
+  result: number;
+  executedState: number;
+  nextState: number;
+  errorCode: number;
+  additionalCode: number;
+  dllReturnValue: number;
+  blobReturnValue: number;
+  blob: BlobStep;
+}
+
 interface ProcessDataRead {
   data: Buffer;
   status: number;
@@ -151,6 +363,13 @@ interface ProcessDataWrite {
   timestamp: Date;
 }
 
+interface LoggingBufferRead {
+  bytesRead: number;
+  status: number;
+  // performance.now() right after the call returned
+  readAt: number;
+}
+
 interface ParameterRead {
   index: number;
   subIndex: number;
@@ -191,6 +410,7 @@ interface DeviceInfo {
 
 class IOLinkService {
   private masterStates: Map<number, MasterState>;
+  private isduQueues: Map<string, Promise<any>>;
   private globalMasterRegistry: Map<
     string,
     { handle: number; connected: boolean }
@@ -199,6 +419,7 @@ class IOLinkService {
   constructor() {
     this.masterStates = new Map();
     this.globalMasterRegistry = new Map();
+    this.isduQueues = new Map();
   }
 
   // ============================================================================
@@ -215,6 +436,52 @@ class IOLinkService {
     }
   }
 
+  /**
+   * Run a DLL function on the libuv thread pool instead of the event loop.
+   */
+  private callAsync(fn: any, ...args: any[]): Promise<number> {
+    return new Promise((resolve, reject) => {
+      fn.async(...args, (err: any, result: number) =>
+        err ? reject(err) : resolve(result)
+      );
+    });
+  }
+
+  /**
+   * A port handles one ISDU service at a time, so requests on the same port
+   * are chained while different ports proceed independently.
+   */
+  runIsdu<T>(
+    handle: number,
+    port: number,
+    task: () => Promise<T>
+  ): Promise<T> {
+    const key = `${handle}:${port}`;
+    const previous = this.isduQueues.get(key) || Promise.resolve();
+
+    // Sampled requests see the wait behind earlier ISDUs as its own span
+    const context = tracer.current();
+    const queuedAt = context ? performance.now() : 0;
+    const run = context
+      ? () => {
+          tracer.span(context, "isdu.queue", "isdu", queuedAt, performance.now(), {
+            port,
+          });
+          return task();
+        }
+      : task;
+    const next = previous.then(run, run);
+    this.isduQueues.set(key, next);
+
+    const cleanup = () => {
+      if (this.isduQueues.get(key) === next) {
+        this.isduQueues.delete(key);
+      }
+    };
+    next.then(cleanup, cleanup);
+    return next;
+  }
+
   private extractString(arrayField: any): string {
     try {
       if (!arrayField) return "Unknown";
@@ -308,9 +575,10 @@ class IOLinkService {
   // MASTER DISCOVERY AND CONNECTION
   // ============================================================================
 
-  async discoverMasters(): Promise<DiscoveredMaster[]> {
-    const maxDevices = 5;
-    logger.info("Searching for IO-Link Master devices...");
+  async discoverMasters(
+    maxDevices: number = getMaxMasters()
+  ): Promise<DiscoveredMaster[]> {
+    logger.debug("Searching for IO-Link Master devices...");
 
     try {
       const structSize = (TDeviceIdentification as any).size;
@@ -318,7 +586,7 @@ class IOLinkService {
       const deviceBuffer = Buffer.alloc(bufferSize);
 
       const numDevices = iolinkDll.IOL_GetUSBDevices(deviceBuffer, maxDevices);
-      logger.info(`Found ${numDevices} device(s)`);
+      logger.debug(`Found ${numDevices} device(s)`);
 
       if (numDevices <= 0) {
         return [];
@@ -346,7 +614,7 @@ class IOLinkService {
             master.name.trim() !== ""
           ) {
             discoveredMasters.push(master);
-            logger.info(`Found Master: ${master.name} (${master.productCode})`);
+            logger.debug(`Found Master: ${master.name} (${master.productCode})`);
           }
         } catch (err: any) {
           logger.error(`Error processing device ${i}:`, err.message);
@@ -590,6 +858,27 @@ class IOLinkService {
     }
   }
 
+  /**
+   * Release a master whose USB link is gone. IOL_Destroy is still called to
+   * free the DLL handle, but its return code is ignored since the device is
+   * no longer there to acknowledge it.
+   */
+  releaseMaster(handle: number): void {
+    const masterState = this.masterStates.get(handle);
+
+    try {
+      const result = iolinkDll.IOL_Destroy(handle);
+      logger.debug(`IOL_Destroy(${handle}) after connection loss = ${result}`);
+    } catch (error: any) {
+      logger.debug(`IOL_Destroy(${handle}) failed: ${error.message}`);
+    }
+
+    if (masterState) {
+      this.globalMasterRegistry.delete(masterState.deviceName);
+    }
+    this.masterStates.delete(handle);
+  }
+
   // ============================================================================
   // PORT CONFIGURATION
   // ============================================================================
@@ -672,6 +961,53 @@ class IOLinkService {
     }
   }
 
+  /**
+   * Read only the port status byte. Much cheaper than IOL_GetModeEx, used by
+   * the change detector to decide which ports need a full status read.
+   */
+  getSensorStatus(handle: number, port: number): number {
+    const status = ref.alloc(DWORD) as any;
+    const result = iolinkDll.IOL_GetSensorStatus(handle, port - 1, status);
+    this.checkReturnCode(result, `Get port ${port} sensor status`);
+    return status.deref();
+  }
+
+  /**
+   * Configured target mode of a port (PORT_MODES)
+   */
+  getPortTargetMode(handle: number, port: number): number {
+    const config = new (TPortConfiguration as any)();
+    const result = iolinkDll.IOL_GetPortConfig(handle, port - 1, config.ref());
+    this.checkReturnCode(result, `Get port ${port} configuration`);
+    return config.TargetMode;
+  }
+
+  /**
+   * Pop the next event from the master's event FIFO (10 entries deep).
+   * Returns null when the FIFO is empty.
+   */
+  readEvent(handle: number): MasterEvent | null {
+    const event = new (TEvent as any)();
+    const status = ref.alloc(DWORD) as any;
+    const result = iolinkDll.IOL_ReadEvent(handle, event.ref(), status);
+
+    if (result === RETURN_CODES.RETURN_NO_EVENT) {
+      return null;
+    }
+    this.checkReturnCode(result, "Read event");
+
+    return {
+      number: event.Number,
+      port: event.Port + 1,
+      eventCode: event.EventCode,
+      instance: event.Instance,
+      mode: event.Mode,
+      type: event.Type,
+      localGenerated: event.LocalGenerated !== 0,
+      timestamp: new Date(),
+    };
+  }
+
   // ============================================================================
   // PROCESS DATA COMMUNICATION
   // ============================================================================
@@ -739,6 +1075,65 @@ class IOLinkService {
     }
   }
 
+  // ============================================================================
+  // PROCESS DATA LOGGING
+  // ============================================================================
+
+  /**
+   * Add a port to the master's logging buffer. sampleTime is in µs
+   * (LOGGING_MODES.TIME) or master cycles; returns the one the master
+   * granted.
+   */
+  startDataLogging(
+    handle: number,
+    port: number,
+    memorySize: number,
+    mode: number,
+    sampleTime: number
+  ): number {
+    const sampleTimeRef = ref.alloc(DWORD, sampleTime) as any;
+    const result = iolinkDll.IOL_StartDataLoggingInBuffer(
+      handle,
+      port - 1,
+      memorySize,
+      mode,
+      sampleTimeRef
+    );
+    this.checkReturnCode(result, `Start data logging on port ${port}`);
+    return sampleTimeRef.deref() || sampleTime;
+  }
+
+  /**
+   * Stops logging of every port on the master
+   */
+  stopDataLogging(handle: number): void {
+    const result = iolinkDll.IOL_StopDataLogging(handle);
+    this.checkReturnCode(result, "Stop data logging");
+  }
+
+  /**
+   * Copy logged entries into buffer on the thread pool. The buffer must not
+   * be reused before the promise settles.
+   */
+  async readLoggingBuffer(
+    handle: number,
+    buffer: Buffer
+  ): Promise<LoggingBufferRead> {
+    const length = ref.alloc(LONG, buffer.length) as any;
+    const status = ref.alloc(DWORD) as any;
+    const result = await this.callAsync(
+      iolinkDll.IOL_ReadLoggingBuffer,
+      handle,
+      length,
+      buffer,
+      status
+    );
+    const readAt = performance.now();
+    this.checkReturnCode(result, "Read logging buffer");
+
+    return { bytesRead: length.deref(), status: status.deref(), readAt };
+  }
+
   // ============================================================================
   // PARAMETER COMMUNICATION (ISDU)
   // ============================================================================
@@ -755,7 +1150,9 @@ class IOLinkService {
       parameter.SubIndex = subIndex;
       parameter.Length = 0;
 
-      const result = iolinkDll.IOL_ReadReq(handle, port - 1, parameter.ref());
+      const result = await this.runIsdu(handle, port, () =>
+        this.callAsync(iolinkDll.IOL_ReadReq, handle, port - 1, parameter.ref())
+      );
       this.checkReturnCode(
         result,
         `Read parameter ${index}.${subIndex} from port ${port}`
@@ -806,7 +1203,9 @@ class IOLinkService {
         Math.min(dataBuffer.length, 256)
       );
 
-      const result = iolinkDll.IOL_WriteReq(handle, port - 1, parameter.ref());
+      const result = await this.runIsdu(handle, port, () =>
+        this.callAsync(iolinkDll.IOL_WriteReq, handle, port - 1, parameter.ref())
+      );
       this.checkReturnCode(
         result,
         `Write parameter ${index}.${subIndex} to port ${port}`
@@ -835,6 +1234,328 @@ class IOLinkService {
       throw error;
     }
   }
+
+  // ============================================================================
+  // DIAGNOSTICS
+  // ============================================================================
+
+  /**
+   * Counters are kept by the master itself, so reading them causes no
+   * traffic on the IO-Link line.
+   */
+  async getStatisticCounters(
+    handle: number,
+    port: number,
+    reset: boolean = false
+  ): Promise<StatisticCounters> {
+    const counters = new (TStatisticCounter as any)();
+    const result = await this.callAsync(
+      iolinkDll.IOL_GetStatisticCounter,
+      handle,
+      port - 1,
+      counters.ref(),
+      reset
+    );
+    this.checkReturnCode(result, `Get statistic counters for port ${port}`);
+
+    return {
+      port: port,
+      cycles: counters.CycleCounter,
+      retries: counters.RetryCounter,
+      aborts: counters.AbortCounter,
+    };
+  }
+
+  async getHardwareInfo(handle: number): Promise<HardwareInfo> {
+    const info = new (THardwareInfo as any)();
+    const result = await this.callAsync(iolinkDll.IOL_GetHWInfo, handle, info.ref());
+    this.checkReturnCode(result, "Get hardware info");
+
+    return {
+      infoVersion: info.InfoVersion,
+      externalPower: info.PowerSource !== 0,
+      // Reported in units of 100 mV
+      powerLevelMv: info.PowerLevel * 100,
+    };
+  }
+
+  // ============================================================================
+  // DATA STORAGE
+  // ============================================================================
+
+  /**
+   * Data storage content lives in the master; only the upload and download
+   * commands talk to the device, so they are queued on the port's ISDU chain.
+   */
+  async dataStorageCommand(
+    handle: number,
+    port: number,
+    command: number
+  ): Promise<void> {
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(iolinkDll.IOL_DS_Command, handle, port - 1, command)
+    );
+    this.checkReturnCode(result, `Data storage command ${command}`);
+  }
+
+  async getDataStorageContent(handle: number, port: number): Promise<Buffer> {
+    const buffer = Buffer.alloc(LIMITS.MAX_DS_CONTENT_SIZE);
+    const length = ref.alloc(DWORD, buffer.length) as any;
+
+    const result = await this.callAsync(
+      iolinkDll.IOL_DS_ContentGet,
+      handle,
+      port - 1,
+      buffer,
+      length
+    );
+    this.checkReturnCode(result, "Read data storage content");
+
+    return Buffer.from(buffer.slice(0, length.deref()));
+  }
+
+  async setDataStorageContent(
+    handle: number,
+    port: number,
+    data: Buffer
+  ): Promise<void> {
+    const result = await this.callAsync(
+      iolinkDll.IOL_DS_ContentSet,
+      handle,
+      port - 1,
+      data,
+      data.length
+    );
+    this.checkReturnCode(result, "Write data storage content");
+  }
+
+  // ============================================================================
+  // BLOB TRANSFER
+  // ============================================================================
+
+  /**
+   * Each BLOB call performs one protocol step and is queued on the port's
+   * ISDU chain, so parameter access can interleave with a long transfer.
+   * The session buffer must stay referenced until the transfer ends since
+   * the DLL keeps writing into (or reading from) it between steps.
+   */
+  private readBlobStep(result: number, status: any): BlobStep {
+    return {
+      result: result,
+      executedState: status.executedState,
+      nextState: status.nextState,
+      errorCode: status.errorCode,
+      additionalCode: status.additionalCode,
+      dllReturnValue: status.dllReturnValue,
+      position: status.Position,
+      percentComplete: status.PercentComplete,
+    };
+  }
+
+  async startBlobUpload(
+    handle: number,
+    port: number,
+    blobId: number,
+    buffer: Buffer
+  ): Promise<{ session: BlobSession; step: BlobStep }> {
+    const session: BlobSession = {
+      status: new (TBLOBStatus as any)(),
+      lengthRead: ref.alloc(DWORD, 0),
+      buffer: buffer,
+    };
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(
+        iolinkDll.BLOB_uploadBLOB,
+        handle,
+        port - 1,
+        blobId,
+        buffer.length,
+        buffer,
+        session.lengthRead,
+        session.status.ref()
+      )
+    );
+    return { session, step: this.readBlobStep(result, session.status) };
+  }
+
+  async startBlobDownload(
+    handle: number,
+    port: number,
+    blobId: number,
+    data: Buffer
+  ): Promise<{ session: BlobSession; step: BlobStep }> {
+    const session: BlobSession = {
+      status: new (TBLOBStatus as any)(),
+      lengthRead: null,
+      buffer: data,
+    };
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(
+        iolinkDll.BLOB_downloadBLOB,
+        handle,
+        port - 1,
+        blobId,
+        data.length,
+        data,
+        session.status.ref()
+      )
+    );
+    return { session, step: this.readBlobStep(result, session.status) };
+  }
+
+  async continueBlob(
+    handle: number,
+    port: number,
+    session: BlobSession
+  ): Promise<BlobStep> {
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(
+        iolinkDll.BLOB_Continue,
+        handle,
+        port - 1,
+        session.status.ref()
+      )
+    );
+    return this.readBlobStep(result, session.status);
+  }
+
+  async abortBlob(handle: number, port: number): Promise<BlobStep> {
+    const status = new (TBLOBStatus as any)();
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(iolinkDll.BLOB_Abort, handle, port - 1, status.ref())
+    );
+    return this.readBlobStep(result, status);
+  }
+
+  getBlobLengthRead(session: BlobSession): number {
+    return session.lengthRead ? session.lengthRead.deref() : 0;
+  }
+
+  // ============================================================================
+  // FIRMWARE UPDATE
+  // ============================================================================
+
+  /**
+   * Like BLOB transfers, every firmware update call executes one step of the
+   * DLL state machine on the port's ISDU chain. The info structure and the
+   * image it points to must stay referenced until the update has finished.
+   */
+  private readFirmwareStep(result: number, state: any): FirmwareStep {
+    return {
+      result: result,
+      executedState: state.executedState,
+      nextState: state.nextState,
+      errorCode: state.errorCode,
+      additionalCode: state.additionalCode,
+      dllReturnValue: state.dllReturnValue,
+      blobReturnValue: state.blobReturnValue,
+      blob: this.readBlobStep(state.blobReturnValue, state.BlobStatus),
+    };
+  }
+
+  async startFirmwareUpdate(
+    handle: number,
+    port: number,
+    image: FirmwareImage
+  ): Promise<{ session: FirmwareSession; step: FirmwareStep }> {
+    const info = new (TFwUpdateInfo as any)();
+    info.vendorID = image.vendorId;
+    info.fwPasswordRequired = image.passwordRequired ? 1 : 0;
+    const hwKey = Buffer.from(image.hwKey, "ascii");
+    for (let i = 0; i < 64; i++) {
+      info.hwKey[i] = i < hwKey.length ? hwKey[i] : 0;
+    }
+    info.hwKey[64] = 0;
+    info.pFirmware = image.firmware;
+    info.fwLength = image.firmware.length;
+
+    const session: FirmwareSession = {
+      info: info,
+      state: new (TFWUpdateState as any)(),
+      firmware: image.firmware,
+    };
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(
+        iolinkDll.IOL_FwUpdateStart,
+        handle,
+        port - 1,
+        info.ref(),
+        session.state.ref()
+      )
+    );
+    return { session, step: this.readFirmwareStep(result, session.state) };
+  }
+
+  async startFirmwareUpdateByMetafile(
+    handle: number,
+    port: number,
+    fileName: string
+  ): Promise<{ session: FirmwareSession; step: FirmwareStep }> {
+    const session: FirmwareSession = {
+      info: new (TFwUpdateInfo as any)(),
+      state: new (TFWUpdateState as any)(),
+      firmware: null,
+    };
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(
+        iolinkDll.IOL_FwUpdateStartByMetafile,
+        handle,
+        port - 1,
+        fileName,
+        session.info.ref(),
+        session.state.ref()
+      )
+    );
+    return { session, step: this.readFirmwareStep(result, session.state) };
+  }
+
+  /**
+   * Copy the image the DLL loaded from a metafile so that further updates
+   * with the same package can use IOL_FwUpdateStart without parsing again.
+   */
+  getFirmwareImage(session: FirmwareSession): FirmwareImage | null {
+    const info = session.info;
+    if (!info.fwLength || ref.isNull(info.pFirmware)) {
+      return null;
+    }
+    const firmware = Buffer.from(
+      ref.reinterpret(info.pFirmware, info.fwLength, 0)
+    );
+    const hwKey: Buffer = Buffer.from(info.hwKey.buffer);
+    const hwKeyEnd = hwKey.indexOf(0);
+    return {
+      vendorId: info.vendorID,
+      passwordRequired: info.fwPasswordRequired !== 0,
+      hwKey: hwKey.toString("ascii", 0, hwKeyEnd < 0 ? 64 : hwKeyEnd),
+      firmware: firmware,
+    };
+  }
+
+  async continueFirmwareUpdate(
+    handle: number,
+    port: number,
+    session: FirmwareSession,
+    password: string | null = null
+  ): Promise<FirmwareStep> {
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(
+        iolinkDll.IOL_FwUpdateContinue,
+        handle,
+        port - 1,
+        password,
+        session.state.ref()
+      )
+    );
+    return this.readFirmwareStep(result, session.state);
+  }
+
+  async abortFirmwareUpdate(handle: number, port: number): Promise<FirmwareStep> {
+    const state = new (TFWUpdateState as any)();
+    const result = await this.runIsdu(handle, port, () =>
+      this.callAsync(iolinkDll.IOL_FwUpdateAbort, handle, port - 1, state.ref())
+    );
+    return this.readFirmwareStep(result, state);
+  }
 }
 
 export default IOLinkService;
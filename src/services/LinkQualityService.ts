@@ -0,0 +1,539 @@
+/**
+ * Link Quality Service
+ * Periodic sampling of port statistic counters and master power information
+ *
+ */
+
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import { LIMITS, RETURN_CODES } from "../utils/constants";
+import { PrometheusMetric } from "../utils/diagnostics";
+
+interface SamplerOptions {
+  intervalMs?: number;
+  capacity?: number;
+}
+
+interface CounterReading {
+  cycles: number;
+  retries: number;
+  aborts: number;
+}
+
+interface PortSeries {
+  masterHandle: number;
+  port: number;
+  ring: SampleRing;
+  last: CounterReading | null;
+  totals: CounterReading;
+  resets: number;
+}
+
+interface MasterSeries {
+  masterHandle: number;
+  deviceName: string;
+  ring: SampleRing;
+  ports: Map<number, PortSeries>;
+  hwInfoSupported: boolean;
+  unsupportedPorts: Set<number>;
+  // Failed counter reads per port; the other ports are still sampled
+  portErrors: Map<number, number>;
+}
+
+// ============================================================================
+// SAMPLE RING
+// ============================================================================
+
+type ColumnType = "f64" | "f32" | "u32" | "u16" | "u8";
+
+/**
+ * Fixed-capacity ring of samples stored column-wise in typed arrays, so a
+ * port's hour of history is a few kilobytes and adds nothing to GC pressure.
+ */
+class SampleRing {
+  readonly capacity: number;
+  private columns: Map<string, Float64Array | Float32Array | Uint32Array | Uint16Array | Uint8Array>;
+  private head: number;
+  private size: number;
+
+  constructor(capacity: number, layout: Record<string, ColumnType>) {
+    this.capacity = capacity;
+    this.columns = new Map();
+    this.head = 0;
+    this.size = 0;
+
+    for (const [name, type] of Object.entries(layout)) {
+      switch (type) {
+        case "f64":
+          this.columns.set(name, new Float64Array(capacity));
+          break;
+        case "f32":
+          this.columns.set(name, new Float32Array(capacity));
+          break;
+        case "u32":
+          this.columns.set(name, new Uint32Array(capacity));
+          break;
+        case "u16":
+          this.columns.set(name, new Uint16Array(capacity));
+          break;
+        case "u8":
+          this.columns.set(name, new Uint8Array(capacity));
+          break;
+      }
+    }
+  }
+
+  push(values: Record<string, number>): void {
+    for (const [name, column] of this.columns) {
+      column[this.head] = values[name] || 0;
+    }
+    this.head = (this.head + 1) % this.capacity;
+    this.size = Math.min(this.size + 1, this.capacity);
+  }
+
+  get length(): number {
+    return this.size;
+  }
+
+  /**
+   * Most recent `limit` samples, oldest first.
+   */
+  toArray(limit: number = this.size): Array<Record<string, number>> {
+    const count = Math.min(limit, this.size);
+    const samples: Array<Record<string, number>> = [];
+    for (let i = count; i > 0; i--) {
+      const index = (this.head - i + this.capacity) % this.capacity;
+      const sample: Record<string, number> = {};
+      for (const [name, column] of this.columns) {
+        sample[name] = column[index];
+      }
+      samples.push(sample);
+    }
+    return samples;
+  }
+
+  latest(): Record<string, number> | null {
+    return this.size > 0 ? this.toArray(1)[0] : null;
+  }
+}
+
+const PORT_LAYOUT: Record<string, ColumnType> = {
+  timestamp: "f64",
+  cycles: "u32",
+  retries: "u32",
+  aborts: "u32",
+  retryRate: "f32",
+};
+
+const MASTER_LAYOUT: Record<string, ColumnType> = {
+  timestamp: "f64",
+  externalPower: "u8",
+  powerLevelMv: "u16",
+};
+
+const COUNTER_RANGE = 0x100000000;
+
+// ============================================================================
+// LINK QUALITY SERVICE CLASS
+// ============================================================================
+
+/**
+ * Reads IOL_GetStatisticCounter for every port and IOL_GetHWInfo for every
+ * master on a fixed schedule. The counters live in the master, so sampling
+ * causes no IO-Link traffic; calls are issued one at a time on the thread
+ * pool so they never queue up in front of process data access.
+ *
+ * Each sample stores the counter deltas since the previous one and the
+ * retry rate per 1000 cycles.
+ */
+class LinkQualityService {
+  private deviceManager: DeviceManager;
+  private intervalMs: number;
+  private capacity: number;
+  private masters: Map<number, MasterSeries>;
+  private timer: NodeJS.Timeout | null;
+  private running: boolean;
+  private sampleCount: number;
+  private lastSampleDurationMs: number;
+  private lastSampleAt: Date | null;
+
+  constructor(deviceManager: DeviceManager, options: SamplerOptions = {}) {
+    this.deviceManager = deviceManager;
+    this.intervalMs =
+      options.intervalMs ||
+      parseInt(process.env.LINK_QUALITY_INTERVAL_MS || "", 10) ||
+      LIMITS.LINK_QUALITY_INTERVAL_DEFAULT;
+    this.capacity = options.capacity || LIMITS.LINK_QUALITY_HISTORY;
+    this.masters = new Map();
+    this.timer = null;
+    this.running = false;
+    this.sampleCount = 0;
+    this.lastSampleDurationMs = 0;
+    this.lastSampleAt = null;
+  }
+
+  // ============================================================================
+  // LIFECYCLE
+  // ============================================================================
+
+  start(): void {
+    if (this.running) return;
+    this.running = true;
+    logger.info(
+      `Link quality sampler started (interval: ${this.intervalMs}ms, history: ${this.capacity} samples)`
+    );
+    this.scheduleNext(this.intervalMs);
+  }
+
+  stop(): void {
+    this.running = false;
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    logger.info("Link quality sampler stopped");
+  }
+
+  private scheduleNext(delayMs: number): void {
+    if (!this.running) return;
+    this.timer = setTimeout(() => {
+      this.sample()
+        .catch((error: any) =>
+          logger.error("Link quality sampling failed:", error.message)
+        )
+        .finally(() => this.scheduleNext(this.intervalMs));
+    }, delayMs);
+  }
+
+  // ============================================================================
+  // SAMPLING
+  // ============================================================================
+
+  async sample(): Promise<void> {
+    const started = Date.now();
+    const connected = this.deviceManager.getConnectedMasters();
+    const present = new Set<number>(connected.map((m) => m.handle));
+
+    // Forget masters that went away; their counters restart on reconnect
+    for (const handle of Array.from(this.masters.keys())) {
+      if (!present.has(handle)) {
+        this.masters.delete(handle);
+      }
+    }
+
+    for (const master of connected) {
+      let series = this.masters.get(master.handle);
+      if (!series) {
+        series = {
+          masterHandle: master.handle,
+          deviceName: master.deviceName,
+          ring: new SampleRing(this.capacity, MASTER_LAYOUT),
+          ports: new Map(),
+          hwInfoSupported: true,
+          unsupportedPorts: new Set(),
+          portErrors: new Map(),
+        };
+        this.masters.set(master.handle, series);
+      }
+
+      try {
+        await this.sampleMaster(series);
+      } catch (error: any) {
+        logger.debug(
+          `Link quality sample of master ${master.handle} failed: ${error.message}`
+        );
+      }
+    }
+
+    this.sampleCount++;
+    this.lastSampleAt = new Date();
+    this.lastSampleDurationMs = Date.now() - started;
+  }
+
+  private async sampleMaster(series: MasterSeries): Promise<void> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+    const now = Date.now();
+
+    if (series.hwInfoSupported) {
+      try {
+        const info = await iolinkService.getHardwareInfo(series.masterHandle);
+        series.ring.push({
+          timestamp: now,
+          externalPower: info.externalPower ? 1 : 0,
+          powerLevelMv: info.powerLevelMv,
+        });
+      } catch (error: any) {
+        if (this.isUnsupported(error)) {
+          series.hwInfoSupported = false;
+        } else if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+          throw error;
+        } else {
+          logger.debug(
+            `Hardware info of master ${series.masterHandle} failed: ${error.message}`
+          );
+        }
+      }
+    }
+
+    for (let port = LIMITS.MIN_PORT; port <= LIMITS.MAX_PORTS; port++) {
+      if (series.unsupportedPorts.has(port)) continue;
+
+      let reading: CounterReading;
+      try {
+        reading = await iolinkService.getStatisticCounters(series.masterHandle, port);
+      } catch (error: any) {
+        if (this.isUnsupported(error)) {
+          series.unsupportedPorts.add(port);
+          continue;
+        }
+        // Nothing more to read from a lost master
+        if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+          throw error;
+        }
+        // One failing port must not leave holes in the others' series
+        series.portErrors.set(port, (series.portErrors.get(port) || 0) + 1);
+        logger.debug(
+          `Link quality sample of master ${series.masterHandle} port ${port} failed: ${error.message}`
+        );
+        continue;
+      }
+
+      let portSeries = series.ports.get(port);
+      if (!portSeries) {
+        portSeries = {
+          masterHandle: series.masterHandle,
+          port,
+          ring: new SampleRing(this.capacity, PORT_LAYOUT),
+          last: null,
+          totals: { cycles: 0, retries: 0, aborts: 0 },
+          resets: 0,
+        };
+        series.ports.set(port, portSeries);
+      }
+      this.recordCounters(portSeries, reading, now);
+    }
+  }
+
+  private recordCounters(
+    series: PortSeries,
+    reading: CounterReading,
+    timestamp: number
+  ): void {
+    const previous = series.last;
+    series.last = reading;
+    // The first reading only establishes the baseline
+    if (!previous) return;
+
+    let reset = false;
+    const delta = (current: number, last: number): number => {
+      if (current >= last) return current - last;
+      // A small backwards step is a counter reset (e.g. master power cycle);
+      // a large one is a 32-bit wrap
+      if (last - current > COUNTER_RANGE / 2) return current + COUNTER_RANGE - last;
+      reset = true;
+      return current;
+    };
+
+    const cycles = delta(reading.cycles, previous.cycles);
+    const retries = delta(reading.retries, previous.retries);
+    const aborts = delta(reading.aborts, previous.aborts);
+    if (reset) series.resets++;
+
+    series.totals.cycles += cycles;
+    series.totals.retries += retries;
+    series.totals.aborts += aborts;
+
+    series.ring.push({
+      timestamp,
+      cycles,
+      retries,
+      aborts,
+      retryRate: cycles > 0 ? (retries * 1000) / cycles : 0,
+    });
+  }
+
+  private isUnsupported(error: any): boolean {
+    return (
+      error.code === RETURN_CODES.RETURN_FUNCTION_NOT_IMPLEMENTED ||
+      error.code === RETURN_CODES.RETURN_WRONG_PARAMETER
+    );
+  }
+
+  // ============================================================================
+  // QUERIES
+  // ============================================================================
+
+  /**
+   * Aggregate the most recent `window` samples of a port.
+   */
+  private summarizePort(series: PortSeries, window: number): any {
+    const samples = series.ring.toArray(window);
+    let cycles = 0;
+    let retries = 0;
+    let aborts = 0;
+    for (const sample of samples) {
+      cycles += sample.cycles;
+      retries += sample.retries;
+      aborts += sample.aborts;
+    }
+    const retryRate = cycles > 0 ? (retries * 1000) / cycles : 0;
+
+    return {
+      port: series.port,
+      samples: series.ring.length,
+      window: {
+        samples: samples.length,
+        cycles,
+        retries,
+        aborts,
+        retriesPer1000Cycles: Math.round(retryRate * 1000) / 1000,
+      },
+      totals: { ...series.totals },
+      counterResets: series.resets,
+      degraded:
+        aborts > 0 || retryRate > LIMITS.LINK_QUALITY_RETRY_RATE_WARN,
+    };
+  }
+
+  getSummary(window: number = LIMITS.LINK_QUALITY_SUMMARY_WINDOW): any {
+    return Array.from(this.masters.values()).map((master) => {
+      const power = master.ring.latest();
+      return {
+        masterHandle: master.masterHandle,
+        deviceName: master.deviceName,
+        power: power
+          ? {
+              externalPower: power.externalPower === 1,
+              powerLevelMv: power.powerLevelMv,
+              timestamp: new Date(power.timestamp).toISOString(),
+            }
+          : null,
+        ports: Array.from(master.ports.values()).map((series) =>
+          this.summarizePort(series, window)
+        ),
+        unsupportedPorts: Array.from(master.unsupportedPorts),
+        portErrors: Object.fromEntries(master.portErrors),
+      };
+    });
+  }
+
+  getPortHistory(masterHandle: number, port: number, limit?: number): any[] | null {
+    const series = this.masters.get(masterHandle)?.ports.get(port);
+    if (!series) return null;
+
+    return series.ring.toArray(limit).map((sample) => ({
+      timestamp: new Date(sample.timestamp).toISOString(),
+      cycles: sample.cycles,
+      retries: sample.retries,
+      aborts: sample.aborts,
+      retriesPer1000Cycles: Math.round(sample.retryRate * 1000) / 1000,
+    }));
+  }
+
+  /**
+   * Raw samples of every port, oldest first
+   */
+  getAllPortSamples(): Array<{
+    masterHandle: number;
+    port: number;
+    samples: Array<Record<string, number>>;
+  }> {
+    const result = [];
+    for (const master of this.masters.values()) {
+      for (const series of master.ports.values()) {
+        result.push({
+          masterHandle: series.masterHandle,
+          port: series.port,
+          samples: series.ring.toArray(),
+        });
+      }
+    }
+    return result;
+  }
+
+  getMasterHistory(masterHandle: number, limit?: number): any[] | null {
+    const series = this.masters.get(masterHandle);
+    if (!series) return null;
+
+    return series.ring.toArray(limit).map((sample) => ({
+      timestamp: new Date(sample.timestamp).toISOString(),
+      externalPower: sample.externalPower === 1,
+      powerLevelMv: sample.powerLevelMv,
+    }));
+  }
+
+  getStatus(): any {
+    return {
+      running: this.running,
+      intervalMs: this.intervalMs,
+      historySamples: this.capacity,
+      sampleCount: this.sampleCount,
+      lastSampleAt: this.lastSampleAt,
+      lastSampleDurationMs: this.lastSampleDurationMs,
+      masters: this.masters.size,
+    };
+  }
+
+  getPrometheusMetrics(): PrometheusMetric[] {
+    const cycles: PrometheusMetric = {
+      name: "iolink_port_cycles_total",
+      help: "IO-Link frame cycles counted since the sampler started",
+      type: "counter",
+      samples: [],
+    };
+    const retries: PrometheusMetric = {
+      name: "iolink_port_retries_total",
+      help: "IO-Link frame retries counted since the sampler started",
+      type: "counter",
+      samples: [],
+    };
+    const aborts: PrometheusMetric = {
+      name: "iolink_port_aborts_total",
+      help: "IO-Link connection aborts counted since the sampler started",
+      type: "counter",
+      samples: [],
+    };
+    const retryRate: PrometheusMetric = {
+      name: "iolink_port_retries_per_1000_cycles",
+      help: "Retries per 1000 cycles over the last sample interval",
+      type: "gauge",
+      samples: [],
+    };
+    const powerLevel: PrometheusMetric = {
+      name: "iolink_master_power_level_volts",
+      help: "Master supply level reported by IOL_GetHWInfo",
+      type: "gauge",
+      samples: [],
+    };
+    const externalPower: PrometheusMetric = {
+      name: "iolink_master_external_power",
+      help: "1 if the master runs from external power, 0 for USB power",
+      type: "gauge",
+      samples: [],
+    };
+
+    for (const master of this.masters.values()) {
+      const masterLabels = { master: master.deviceName, handle: master.masterHandle };
+      const power = master.ring.latest();
+      if (power) {
+        powerLevel.samples.push({ labels: masterLabels, value: power.powerLevelMv / 1000 });
+        externalPower.samples.push({ labels: masterLabels, value: power.externalPower });
+      }
+
+      for (const series of master.ports.values()) {
+        const labels = { ...masterLabels, port: series.port };
+        cycles.samples.push({ labels, value: series.totals.cycles });
+        retries.samples.push({ labels, value: series.totals.retries });
+        aborts.samples.push({ labels, value: series.totals.aborts });
+        const latest = series.ring.latest();
+        if (latest) {
+          retryRate.samples.push({ labels, value: latest.retryRate });
+        }
+      }
+    }
+
+    return [cycles, retries, aborts, retryRate, powerLevel, externalPower];
+  }
+}
+
+export default LinkQualityService;
@@ -0,0 +1,362 @@
+/**
+ * Master Clock Service
+ * Correlates each master's cycle counter with the host monotonic clock
+ *
+ */
+
+import { performance } from "perf_hooks";
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import {
+  DIRECT_PARAMETER_SUBINDEX,
+  LIMITS,
+  PARAMETER_INDEX,
+  RETURN_CODES,
+  decodeCycleTime,
+} from "../utils/constants";
+
+interface ClockOptions {
+  intervalMs?: number;
+  window?: number;
+}
+
+interface MasterClock {
+  masterHandle: number;
+  port: number;
+  nominalCycleMs: number | null;
+  // Unwrapped cycle counter and host midpoint (performance.now) per pair
+  cycles: Float64Array;
+  hosts: Float64Array;
+  rtts: Float64Array;
+  head: number;
+  size: number;
+  lastRaw: number | null;
+  unwrapped: number;
+  fit: ClockFit | null;
+  resets: number;
+}
+
+interface ClockFit {
+  // host = hostRef + cycleMs * (cycles - cycleRef)
+  cycleRef: number;
+  hostRef: number;
+  cycleMs: number;
+  residualUs: number;
+  // One-way USB latency estimate (half the best round trip)
+  latencyMs: number;
+  pairs: number;
+}
+
+const COUNTER_RANGE = 0x100000000;
+
+// ============================================================================
+// MASTER CLOCK SERVICE
+// ============================================================================
+
+/**
+ * Every interval the service reads IOL_GetStatisticCounter for one operating
+ * port per master and pairs its CycleCounter with the midpoint of the call
+ * on the host monotonic clock. A least-squares line through the recent
+ * pairs gives the master's cycle duration in host time (its drift) and the
+ * host time of any cycle (its offset). Only pairs whose round trip is
+ * close to the best one in the window are used, since a slow call says
+ * little about when the counter was read.
+ *
+ * align() maps a host timestamp of a sample from a master onto that
+ * master's cycle grid, so samples from different masters that were read
+ * with different USB latencies end up on one comparable timeline.
+ */
+class MasterClockService {
+  private deviceManager: DeviceManager;
+  private intervalMs: number;
+  private window: number;
+  private clocks: Map<number, MasterClock>;
+  private timer: NodeJS.Timeout | null;
+  private running: boolean;
+
+  constructor(deviceManager: DeviceManager, options: ClockOptions = {}) {
+    this.deviceManager = deviceManager;
+    this.intervalMs =
+      options.intervalMs ||
+      parseInt(process.env.MASTER_CLOCK_INTERVAL_MS || "", 10) ||
+      LIMITS.MASTER_CLOCK_INTERVAL_DEFAULT;
+    this.window = options.window || LIMITS.MASTER_CLOCK_WINDOW;
+    this.clocks = new Map();
+    this.timer = null;
+    this.running = false;
+  }
+
+  // ============================================================================
+  // LIFECYCLE
+  // ============================================================================
+
+  start(): void {
+    if (this.running) return;
+    this.running = true;
+    logger.info(
+      `Master clock correlation started (interval: ${this.intervalMs}ms, window: ${this.window} pairs)`
+    );
+    this.scheduleNext(0);
+  }
+
+  stop(): void {
+    this.running = false;
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    logger.info("Master clock correlation stopped");
+  }
+
+  private scheduleNext(delayMs: number): void {
+    if (!this.running) return;
+    this.timer = setTimeout(() => {
+      this.sample()
+        .catch((error: any) =>
+          logger.error("Master clock sampling failed:", error.message)
+        )
+        .finally(() => this.scheduleNext(this.intervalMs));
+    }, delayMs);
+  }
+
+  // ============================================================================
+  // SAMPLING
+  // ============================================================================
+
+  async sample(): Promise<void> {
+    // The cycle counter only runs on a port that exchanges cycles
+    const referencePorts = new Map<number, number>();
+    for (const { masterHandle, port } of this.deviceManager.getProcessDataPorts()) {
+      const current = referencePorts.get(masterHandle);
+      if (current === undefined || port < current) {
+        referencePorts.set(masterHandle, port);
+      }
+    }
+
+    for (const handle of Array.from(this.clocks.keys())) {
+      if (!referencePorts.has(handle)) {
+        this.clocks.delete(handle);
+      }
+    }
+
+    for (const [masterHandle, port] of referencePorts) {
+      let clock = this.clocks.get(masterHandle);
+      if (!clock || clock.port !== port) {
+        clock = this.createClock(masterHandle, port);
+        this.clocks.set(masterHandle, clock);
+        this.readNominalCycle(clock);
+      }
+
+      try {
+        await this.samplePair(clock);
+      } catch (error: any) {
+        if (
+          error.code === RETURN_CODES.RETURN_FUNCTION_NOT_IMPLEMENTED ||
+          error.code === RETURN_CODES.RETURN_WRONG_PARAMETER
+        ) {
+          this.clocks.delete(masterHandle);
+        }
+        logger.debug(
+          `Clock sample of master ${masterHandle} failed: ${error.message}`
+        );
+      }
+    }
+  }
+
+  private createClock(masterHandle: number, port: number): MasterClock {
+    return {
+      masterHandle,
+      port,
+      nominalCycleMs: null,
+      cycles: new Float64Array(this.window),
+      hosts: new Float64Array(this.window),
+      rtts: new Float64Array(this.window),
+      head: 0,
+      size: 0,
+      lastRaw: null,
+      unwrapped: 0,
+      fit: null,
+      resets: 0,
+    };
+  }
+
+  private readNominalCycle(clock: MasterClock): void {
+    this.deviceManager
+      .readDeviceParameter(
+        `${clock.masterHandle}:${clock.port}`,
+        PARAMETER_INDEX.DIRECT_PARAMETER_PAGE,
+        DIRECT_PARAMETER_SUBINDEX.MASTER_CYCLE_TIME
+      )
+      .then((result: any) => {
+        const cycleMs = decodeCycleTime(result.data.readUInt8(0));
+        clock.nominalCycleMs = Number.isNaN(cycleMs) || cycleMs <= 0 ? null : cycleMs;
+      })
+      .catch((error: any) =>
+        logger.debug(`Could not read master cycle time: ${error.message}`)
+      );
+  }
+
+  private async samplePair(clock: MasterClock): Promise<void> {
+    const iolinkService = this.deviceManager.getIOLinkService();
+    const before = performance.now();
+    const counters = await iolinkService.getStatisticCounters(
+      clock.masterHandle,
+      clock.port
+    );
+    const after = performance.now();
+
+    if (clock.lastRaw !== null) {
+      let delta = counters.cycles - clock.lastRaw;
+      if (delta < 0) {
+        if (clock.lastRaw - counters.cycles > COUNTER_RANGE / 2) {
+          delta += COUNTER_RANGE;
+        } else {
+          // Counter reset: earlier pairs no longer line up
+          clock.resets++;
+          clock.head = 0;
+          clock.size = 0;
+          delta = 0;
+        }
+      }
+      clock.unwrapped += delta;
+    }
+    clock.lastRaw = counters.cycles;
+
+    clock.cycles[clock.head] = clock.unwrapped;
+    clock.hosts[clock.head] = (before + after) / 2;
+    clock.rtts[clock.head] = after - before;
+    clock.head = (clock.head + 1) % this.window;
+    clock.size = Math.min(clock.size + 1, this.window);
+
+    clock.fit = this.fitClock(clock);
+  }
+
+  /**
+   * Least squares over the pairs whose round trip is within twice the best
+   */
+  private fitClock(clock: MasterClock): ClockFit | null {
+    if (clock.size < 2) return null;
+
+    let bestRtt = Infinity;
+    for (let i = 0; i < clock.size; i++) {
+      bestRtt = Math.min(bestRtt, clock.rtts[i]);
+    }
+    const rttLimit = Math.max(bestRtt * 2, bestRtt + 0.5);
+
+    let n = 0;
+    let meanC = 0;
+    let meanH = 0;
+    for (let i = 0; i < clock.size; i++) {
+      if (clock.rtts[i] > rttLimit) continue;
+      n++;
+      meanC += clock.cycles[i];
+      meanH += clock.hosts[i];
+    }
+    if (n < 2) return clock.fit;
+    meanC /= n;
+    meanH /= n;
+
+    let sCC = 0;
+    let sCH = 0;
+    for (let i = 0; i < clock.size; i++) {
+      if (clock.rtts[i] > rttLimit) continue;
+      const dc = clock.cycles[i] - meanC;
+      sCC += dc * dc;
+      sCH += dc * (clock.hosts[i] - meanH);
+    }
+    if (sCC === 0) return clock.fit;
+    const cycleMs = sCH / sCC;
+
+    let sRR = 0;
+    for (let i = 0; i < clock.size; i++) {
+      if (clock.rtts[i] > rttLimit) continue;
+      const residual = clock.hosts[i] - (meanH + cycleMs * (clock.cycles[i] - meanC));
+      sRR += residual * residual;
+    }
+
+    return {
+      cycleRef: meanC,
+      hostRef: meanH,
+      cycleMs,
+      residualUs: Math.sqrt(sRR / n) * 1000,
+      latencyMs: bestRtt / 2,
+      pairs: n,
+    };
+  }
+
+  // ============================================================================
+  // ALIGNMENT
+  // ============================================================================
+
+  /**
+   * Host time (epoch ms) of a master's cycle counter value
+   */
+  toHostTime(masterHandle: number, cycleCounter: number): number | null {
+    const clock = this.clocks.get(masterHandle);
+    if (!clock?.fit || clock.lastRaw === null) return null;
+
+    let delta = cycleCounter - clock.lastRaw;
+    if (delta > COUNTER_RANGE / 2) delta -= COUNTER_RANGE;
+    if (delta < -COUNTER_RANGE / 2) delta += COUNTER_RANGE;
+    const cycles = clock.unwrapped + delta;
+
+    const { fit } = clock;
+    return performance.timeOrigin + fit.hostRef + fit.cycleMs * (cycles - fit.cycleRef);
+  }
+
+  /**
+   * Move a host timestamp (epoch ms) taken when a sample of a master was
+   * read back by the USB latency and onto the start of the master cycle it
+   * belongs to. Timestamps of unsynchronized masters pass through.
+   */
+  align(masterHandle: number, timestampMs: number): { timestamp: number; aligned: boolean } {
+    const fit = this.clocks.get(masterHandle)?.fit;
+    if (!fit || fit.cycleMs <= 0) {
+      return { timestamp: timestampMs, aligned: false };
+    }
+
+    const host = timestampMs - performance.timeOrigin - fit.latencyMs;
+    const cycle = Math.floor(fit.cycleRef + (host - fit.hostRef) / fit.cycleMs);
+    return {
+      timestamp: performance.timeOrigin + fit.hostRef + fit.cycleMs * (cycle - fit.cycleRef),
+      aligned: true,
+    };
+  }
+
+  getClocks(): any[] {
+    return Array.from(this.clocks.values()).map((clock) => {
+      const { fit } = clock;
+      return {
+        masterHandle: clock.masterHandle,
+        referencePort: clock.port,
+        pairs: clock.size,
+        counterResets: clock.resets,
+        synchronized: fit !== null,
+        cycleUs: fit ? fit.cycleMs * 1000 : null,
+        nominalCycleUs: clock.nominalCycleMs !== null ? clock.nominalCycleMs * 1000 : null,
+        driftPpm:
+          fit && clock.nominalCycleMs
+            ? ((fit.cycleMs - clock.nominalCycleMs) / clock.nominalCycleMs) * 1e6
+            : null,
+        residualUs: fit ? fit.residualUs : null,
+        latencyUs: fit ? fit.latencyMs * 1000 : null,
+        // Host time of the most recent counter reading on the fitted line
+        lastReadingAt:
+          fit && clock.lastRaw !== null
+            ? new Date(this.toHostTime(clock.masterHandle, clock.lastRaw)!).toISOString()
+            : null,
+      };
+    });
+  }
+
+  getStatus() {
+    return {
+      running: this.running,
+      intervalMs: this.intervalMs,
+      window: this.window,
+      masters: this.clocks.size,
+    };
+  }
+}
+
+export default MasterClockService;
@@ -0,0 +1,221 @@
+/**
+ * Master Thread
+ * Owns the acquisition worker thread of one master handle
+ *
+ */
+
+import { Worker } from "worker_threads";
+import { EventEmitter } from "events";
+import path from "path";
+import logger from "../utils/logger";
+import { LIMITS } from "../utils/constants";
+import { ProcessImage } from "../utils/processImage";
+import type {
+  AcquisitionConfig,
+  AcquisitionCycle,
+  AcquisitionCommand,
+  ProcessDataSchedule,
+} from "../workers/masterAcquisition";
+import type { CyclicSchedulerStats } from "../workers/cyclicScheduler";
+
+// ============================================================================
+// MASTER THREAD
+// ============================================================================
+
+/**
+ * Runs the cyclic acquisition of one master on its own thread, so blocking
+ * DLL calls against a slow or hung master only stall that master. Emits
+ * "cycle" with each batch, "connection-lost", and "stalled"/"recovered"
+ * when batches stop arriving for longer than the stall timeout.
+ */
+class MasterThread extends EventEmitter {
+  readonly masterHandle: number;
+  readonly intervalMs: number;
+  private worker: Worker | null;
+  private watchdog: NodeJS.Timeout | null;
+  private stalled: boolean;
+  private schedule: CyclicSchedulerStats | null;
+  // Ports last handed to the thread for process data exchange
+  private processDataPorts: Set<number>;
+  private stats: {
+    cycles: number;
+    lastCycleAt: number;
+    lastCycleMs: number;
+    maxCycleMs: number;
+    stalls: number;
+    errors: number;
+  };
+
+  constructor(masterHandle: number, intervalMs: number) {
+    super();
+    this.masterHandle = masterHandle;
+    this.intervalMs = intervalMs;
+    this.worker = null;
+    this.watchdog = null;
+    this.stalled = false;
+    this.schedule = null;
+    this.processDataPorts = new Set();
+    this.stats = {
+      cycles: 0,
+      lastCycleAt: 0,
+      lastCycleMs: 0,
+      maxCycleMs: 0,
+      stalls: 0,
+      errors: 0,
+    };
+  }
+
+  start(
+    ports: number[],
+    processDataPorts: ProcessDataSchedule[],
+    processImage: ProcessImage,
+    masterIndex: number
+  ): void {
+    if (this.worker) return;
+    this.processDataPorts = new Set(processDataPorts.map((entry) => entry.port));
+
+    const extension = path.extname(__filename);
+    const priority = parseInt(process.env.MASTER_THREAD_PRIORITY || "", 10);
+    const config: AcquisitionConfig = {
+      masterHandle: this.masterHandle,
+      intervalMs: this.intervalMs,
+      ports,
+      processDataPorts,
+      priority: Number.isNaN(priority) ? undefined : priority,
+      processImage: processImage.buffer,
+      processImageMasters: processImage.masters,
+      masterIndex,
+    };
+
+    this.worker = new Worker(
+      path.join(__dirname, "..", "workers", `masterAcquisition${extension}`),
+      {
+        workerData: config,
+        // Development runs from TypeScript sources
+        execArgv: extension === ".ts" ? ["--require", "ts-node/register"] : undefined,
+      }
+    );
+
+    this.worker.on("message", (message: any) => this.handleMessage(message));
+    this.worker.on("error", (error) => {
+      this.stats.errors++;
+      logger.error(
+        `Acquisition thread for master ${this.masterHandle} failed: ${error.message}`
+      );
+      this.emit("error", error);
+    });
+    this.worker.on("exit", () => {
+      this.worker = null;
+      this.clearWatchdog();
+    });
+
+    this.stats.lastCycleAt = Date.now();
+    this.watchdog = setInterval(() => this.checkStall(), LIMITS.MASTER_THREAD_STALL_TIMEOUT / 2);
+
+    logger.info(
+      `Started acquisition thread for master ${this.masterHandle} (${this.intervalMs}ms cycle, ${ports.length} ports)`
+    );
+  }
+
+  configure(ports: number[], processDataPorts: ProcessDataSchedule[]): void {
+    this.processDataPorts = new Set(processDataPorts.map((entry) => entry.port));
+    this.post({ type: "configure", ports, processDataPorts });
+  }
+
+  /**
+   * Ask the loop to finish its cycle and exit. A thread blocked inside a
+   * DLL call exits once the call returns; it no longer delivers batches.
+   */
+  stop(): void {
+    this.post({ type: "stop" });
+    this.clearWatchdog();
+    this.removeAllListeners("cycle");
+    logger.info(`Stopped acquisition thread for master ${this.masterHandle}`);
+  }
+
+  /**
+   * Whether the thread runs a process data task (and so commits the
+   * outputs) for a port
+   */
+  hasProcessDataTask(port: number): boolean {
+    return this.isRunning() && this.processDataPorts.has(port);
+  }
+
+  isRunning(): boolean {
+    return this.worker !== null;
+  }
+
+  private post(command: AcquisitionCommand): void {
+    this.worker?.postMessage(command);
+  }
+
+  private handleMessage(message: any): void {
+    switch (message.type) {
+      case "cycle": {
+        const cycle = message as AcquisitionCycle;
+        this.stats.cycles++;
+        this.stats.lastCycleAt = Date.now();
+        this.stats.lastCycleMs = cycle.durationMs;
+        this.stats.maxCycleMs = Math.max(this.stats.maxCycleMs, cycle.durationMs);
+        if (this.stalled) {
+          this.stalled = false;
+          logger.info(`Master ${this.masterHandle} acquisition recovered`);
+          this.emit("recovered");
+        }
+        this.emit("cycle", cycle);
+        break;
+      }
+      case "schedule":
+        this.schedule = message.stats;
+        break;
+      case "connection-lost":
+        this.emit("connection-lost");
+        break;
+      case "error":
+        this.stats.errors++;
+        logger.error(
+          `Acquisition cycle error on master ${this.masterHandle}: ${message.message}`
+        );
+        break;
+    }
+  }
+
+  private checkStall(): void {
+    const silentMs = Date.now() - this.stats.lastCycleAt;
+    if (!this.stalled && silentMs > LIMITS.MASTER_THREAD_STALL_TIMEOUT) {
+      this.stalled = true;
+      this.stats.stalls++;
+      logger.warn(
+        `Master ${this.masterHandle} acquisition stalled (no cycle for ${silentMs}ms)`
+      );
+      this.emit("stalled");
+    }
+  }
+
+  private clearWatchdog(): void {
+    if (this.watchdog) {
+      clearInterval(this.watchdog);
+      this.watchdog = null;
+    }
+  }
+
+  /**
+   * Latest per-task timing (period, overruns, start jitter) from the thread
+   */
+  getSchedule(): CyclicSchedulerStats | null {
+    return this.schedule;
+  }
+
+  getStatus() {
+    return {
+      masterHandle: this.masterHandle,
+      running: this.isRunning(),
+      stalled: this.stalled,
+      intervalMs: this.intervalMs,
+      ...this.stats,
+      schedule: this.schedule,
+    };
+  }
+}
+
+export default MasterThread;
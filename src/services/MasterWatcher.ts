@@ -0,0 +1,275 @@
+/**
+ * Master Watcher Service
+ * Background USB hot-plug detection for IO-Link masters
+ *
+ */
+
+import { EventEmitter } from "events";
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import { LIMITS, getMaxMasters } from "../utils/constants";
+
+interface WatcherOptions {
+  intervalMs?: number;
+  maxMasters?: number;
+}
+
+interface LatencyStats {
+  count: number;
+  lastMs: number | null;
+  minMs: number | null;
+  maxMs: number | null;
+  avgMs: number | null;
+  totalMs: number;
+}
+
+interface HotPlugEvent {
+  deviceName: string;
+  handle?: number;
+  latencyMs: number;
+  timestamp: Date;
+}
+
+// ============================================================================
+// MASTER WATCHER CLASS
+// ============================================================================
+
+/**
+ * Periodically diffs the IOL_GetUSBDevices result against the connected
+ * masters. New masters are connected concurrently (each connect is mostly
+ * initialization waits, so they overlap instead of queueing); masters that
+ * vanish from the USB list are torn down through the connection-lost path.
+ *
+ * Emits "master:attached", "master:detached" and "master:error".
+ */
+class MasterWatcher extends EventEmitter {
+  private deviceManager: DeviceManager;
+  private intervalMs: number;
+  private maxMasters: number;
+  private timer: NodeJS.Timeout | null;
+  private running: boolean;
+  private polling: boolean;
+  private knownMasters: Set<string>;
+  private firstSeen: Map<string, number>;
+  private failedMasters: Set<string>;
+  private pollCount: number;
+  private lastPollDurationMs: number;
+  private lastPollAt: Date | null;
+  private attachLatency: LatencyStats;
+  private detachLatency: LatencyStats;
+
+  constructor(deviceManager: DeviceManager, options: WatcherOptions = {}) {
+    super();
+    this.deviceManager = deviceManager;
+    this.intervalMs =
+      options.intervalMs ||
+      parseInt(process.env.MASTER_WATCH_INTERVAL_MS || "", 10) ||
+      LIMITS.MASTER_WATCH_INTERVAL_DEFAULT;
+    this.maxMasters = options.maxMasters || getMaxMasters();
+    this.timer = null;
+    this.running = false;
+    this.polling = false;
+    this.knownMasters = new Set();
+    this.firstSeen = new Map();
+    this.failedMasters = new Set();
+    this.pollCount = 0;
+    this.lastPollDurationMs = 0;
+    this.lastPollAt = null;
+    this.attachLatency = this.createLatencyStats();
+    this.detachLatency = this.createLatencyStats();
+  }
+
+  // ============================================================================
+  // LIFECYCLE
+  // ============================================================================
+
+  start(): void {
+    if (this.running) return;
+    this.running = true;
+    logger.info(
+      `Master watcher started (interval: ${this.intervalMs}ms, max masters: ${this.maxMasters})`
+    );
+    this.scheduleNext(0);
+  }
+
+  stop(): void {
+    this.running = false;
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    logger.info("Master watcher stopped");
+  }
+
+  isRunning(): boolean {
+    return this.running;
+  }
+
+  private scheduleNext(delayMs: number): void {
+    if (!this.running) return;
+    // setTimeout chain rather than setInterval so a slow USB enumeration
+    // never stacks polls on top of each other
+    this.timer = setTimeout(() => {
+      this.poll()
+        .catch((error: any) =>
+          logger.error("Master watcher poll failed:", error.message)
+        )
+        .finally(() => this.scheduleNext(this.intervalMs));
+    }, delayMs);
+  }
+
+  // ============================================================================
+  // DIFFING
+  // ============================================================================
+
+  async poll(): Promise<void> {
+    if (this.polling) return;
+    this.polling = true;
+    const started = Date.now();
+
+    try {
+      const masters = await this.deviceManager.listUsbMasters(this.maxMasters);
+      const present = new Set<string>(masters.map((m) => m.name));
+
+      // Newly appeared masters: connect all of them at once
+      const added: string[] = [];
+      for (const name of present) {
+        if (!this.firstSeen.has(name)) {
+          this.firstSeen.set(name, started);
+        }
+        if (
+          !this.knownMasters.has(name) &&
+          !this.failedMasters.has(name) &&
+          this.deviceManager.getMasterHandleByName(name) === undefined &&
+          !this.deviceManager.isMasterConnecting(name)
+        ) {
+          added.push(name);
+        }
+      }
+
+      // Masters that disappeared from the USB list
+      for (const master of this.deviceManager.getConnectedMasters()) {
+        if (!present.has(master.deviceName)) {
+          this.detachMaster(master.deviceName, master.handle, started);
+        }
+      }
+      for (const name of Array.from(this.firstSeen.keys())) {
+        if (!present.has(name)) {
+          this.firstSeen.delete(name);
+          this.knownMasters.delete(name);
+          // A replugged master gets a fresh connection attempt
+          this.failedMasters.delete(name);
+        }
+      }
+
+      for (const name of added) {
+        this.knownMasters.add(name);
+        // Deliberately not awaited: initialization takes seconds and must not
+        // hold up detection of other masters on the next poll
+        this.attachMaster(name);
+      }
+    } finally {
+      this.pollCount++;
+      this.lastPollAt = new Date();
+      this.lastPollDurationMs = Date.now() - started;
+      this.polling = false;
+    }
+  }
+
+  private async attachMaster(deviceName: string): Promise<void> {
+    try {
+      const handle = await this.deviceManager.connectMaster(deviceName);
+      const latencyMs = Date.now() - (this.firstSeen.get(deviceName) || Date.now());
+      this.recordLatency(this.attachLatency, latencyMs);
+
+      logger.info(
+        `Hot-plugged master ${deviceName} ready with handle ${handle} (${latencyMs}ms)`
+      );
+      this.emit("master:attached", {
+        deviceName,
+        handle,
+        latencyMs,
+        timestamp: new Date(),
+      } as HotPlugEvent);
+    } catch (error: any) {
+      // Do not hammer a master that refuses to open; it is retried once it
+      // has been unplugged and plugged back in
+      this.knownMasters.delete(deviceName);
+      this.failedMasters.add(deviceName);
+      logger.error(
+        `Hot-plug connect failed for master ${deviceName}:`,
+        error.message
+      );
+      this.emit("master:error", {
+        deviceName,
+        message: error.message,
+        timestamp: new Date(),
+      });
+    }
+  }
+
+  private detachMaster(
+    deviceName: string,
+    handle: number,
+    detectedAt: number
+  ): void {
+    if (!this.deviceManager.handleMasterConnectionLost(handle)) return;
+
+    const latencyMs = Date.now() - detectedAt;
+    this.recordLatency(this.detachLatency, latencyMs);
+
+    logger.info(`Master ${deviceName} unplugged, handle ${handle} released`);
+    this.emit("master:detached", {
+      deviceName,
+      handle,
+      latencyMs,
+      timestamp: new Date(),
+    } as HotPlugEvent);
+  }
+
+  // ============================================================================
+  // METRICS
+  // ============================================================================
+
+  private createLatencyStats(): LatencyStats {
+    return {
+      count: 0,
+      lastMs: null,
+      minMs: null,
+      maxMs: null,
+      avgMs: null,
+      totalMs: 0,
+    };
+  }
+
+  private recordLatency(stats: LatencyStats, latencyMs: number): void {
+    stats.count++;
+    stats.totalMs += latencyMs;
+    stats.lastMs = latencyMs;
+    stats.minMs = stats.minMs === null ? latencyMs : Math.min(stats.minMs, latencyMs);
+    stats.maxMs = stats.maxMs === null ? latencyMs : Math.max(stats.maxMs, latencyMs);
+    stats.avgMs = Math.round(stats.totalMs / stats.count);
+  }
+
+  getStatus(): any {
+    return {
+      running: this.running,
+      intervalMs: this.intervalMs,
+      maxMasters: this.maxMasters,
+      pollCount: this.pollCount,
+      lastPollAt: this.lastPollAt,
+      lastPollDurationMs: this.lastPollDurationMs,
+      presentMasters: Array.from(this.firstSeen.keys()),
+      failedMasters: Array.from(this.failedMasters),
+      metrics: {
+        // Time from first USB sighting until the master is initialized and
+        // its ports have been scanned once
+        attachLatency: { ...this.attachLatency },
+        // Time from the poll that noticed the removal until teardown
+        detachLatency: { ...this.detachLatency },
+      },
+    };
+  }
+}
+
+export default MasterWatcher;
@@ -0,0 +1,272 @@
+/**
+ * Parameter Subscription Manager
+ * Shared, adaptive-rate polling of subscribed device parameters
+ *
+ */
+
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import { LIMITS } from "../utils/constants";
+
+type Publisher = (topic: string, event: string, payload: any) => void;
+
+interface SubscriberBounds {
+  minInterval: number;
+  maxInterval: number;
+}
+
+interface ParameterPoller {
+  topic: string;
+  deviceKey: string;
+  index: number;
+  subIndex: number;
+  subscribers: Map<string, SubscriberBounds>;
+  interval: number;
+  timer: NodeJS.Timeout | null;
+  lastRawHex: string | null;
+  lastPayload: any;
+  lastEmitAt: number;
+  lastChangeAt: number;
+  reads: number;
+  changes: number;
+}
+
+// ============================================================================
+// PARAMETER SUBSCRIPTION MANAGER CLASS
+// ============================================================================
+
+/**
+ * All subscribers of one parameter share a single poller. The poll interval
+ * starts at the fastest rate any subscriber allows and backs off while the
+ * value stays unchanged, up to the tightest staleness bound among the
+ * subscribers. Values are published only when they change; a keep-alive is
+ * published when nothing has been sent for a while.
+ */
+class ParameterSubscriptionManager {
+  private deviceManager: DeviceManager;
+  private publisher: Publisher | null;
+  private pollers: Map<string, ParameterPoller>;
+
+  constructor(deviceManager: DeviceManager) {
+    this.deviceManager = deviceManager;
+    this.publisher = null;
+    this.pollers = new Map();
+  }
+
+  setPublisher(publisher: Publisher): void {
+    this.publisher = publisher;
+  }
+
+  // ============================================================================
+  // SUBSCRIPTIONS
+  // ============================================================================
+
+  /**
+   * Add a subscriber to the poller for a parameter, creating it if needed.
+   * Returns the last published value (if any) so the caller can hand it to
+   * the new subscriber right away.
+   */
+  subscribe(
+    topic: string,
+    deviceKey: string,
+    index: number,
+    subIndex: number,
+    subscriberId: string,
+    bounds: SubscriberBounds
+  ): any {
+    let poller = this.pollers.get(topic);
+
+    if (!poller) {
+      poller = {
+        topic,
+        deviceKey,
+        index,
+        subIndex,
+        subscribers: new Map(),
+        interval: bounds.minInterval,
+        timer: null,
+        lastRawHex: null,
+        lastPayload: null,
+        lastEmitAt: 0,
+        lastChangeAt: 0,
+        reads: 0,
+        changes: 0,
+      };
+      this.pollers.set(topic, poller);
+      logger.info(
+        `Started parameter polling for ${deviceKey} param ${index}.${subIndex}`
+      );
+    }
+
+    poller.subscribers.set(subscriberId, bounds);
+
+    // A faster subscriber takes effect immediately
+    const { minInterval } = this.getEffectiveBounds(poller);
+    if (poller.timer === null || poller.interval > minInterval) {
+      poller.interval = minInterval;
+      this.schedule(poller, poller.timer === null ? 0 : minInterval);
+    }
+
+    return poller.lastPayload;
+  }
+
+  unsubscribe(topic: string, subscriberId: string): void {
+    const poller = this.pollers.get(topic);
+    if (!poller) return;
+
+    poller.subscribers.delete(subscriberId);
+    if (poller.subscribers.size > 0) return;
+
+    if (poller.timer) {
+      clearTimeout(poller.timer);
+    }
+    this.pollers.delete(topic);
+    logger.info(
+      `Stopped parameter polling for ${poller.deviceKey} param ${poller.index}.${poller.subIndex}`
+    );
+  }
+
+  private getEffectiveBounds(poller: ParameterPoller): SubscriberBounds {
+    let minInterval = Infinity;
+    let maxInterval = Infinity;
+    for (const bounds of poller.subscribers.values()) {
+      minInterval = Math.min(minInterval, bounds.minInterval);
+      maxInterval = Math.min(maxInterval, bounds.maxInterval);
+    }
+    return { minInterval, maxInterval: Math.max(minInterval, maxInterval) };
+  }
+
+  // ============================================================================
+  // POLLING
+  // ============================================================================
+
+  private schedule(poller: ParameterPoller, delayMs: number): void {
+    if (poller.timer) {
+      clearTimeout(poller.timer);
+    }
+    poller.timer = setTimeout(() => {
+      this.poll(poller).finally(() => {
+        // Poller may have been removed while the read was in flight
+        if (this.pollers.get(poller.topic) === poller) {
+          this.schedule(poller, poller.interval);
+        }
+      });
+    }, delayMs);
+  }
+
+  private async poll(poller: ParameterPoller): Promise<void> {
+    const { deviceKey, index, subIndex, topic } = poller;
+    const now = Date.now();
+
+    try {
+      const result = await this.deviceManager.readDeviceParameter(
+        deviceKey,
+        index,
+        subIndex
+      );
+      poller.reads++;
+
+      const rawHex = result.data.toString("hex").toUpperCase();
+      const { minInterval, maxInterval } = this.getEffectiveBounds(poller);
+
+      if (rawHex !== poller.lastRawHex) {
+        poller.lastRawHex = rawHex;
+        poller.lastChangeAt = now;
+        poller.changes++;
+        // Value is moving: poll as fast as subscribers allow
+        poller.interval = minInterval;
+
+        poller.lastPayload = {
+          deviceKey: deviceKey,
+          index: index,
+          subIndex: subIndex,
+          rawData: Array.from(result.data),
+          rawDataHex: rawHex,
+          parsedValue: this.parseValue(deviceKey, index, subIndex, result.data),
+          timestamp: result.timestamp,
+        };
+        this.publish(topic, "parameter:value", poller.lastPayload);
+        poller.lastEmitAt = now;
+        return;
+      }
+
+      // Unchanged: back off towards the slowest rate still within bounds
+      poller.interval = Math.min(
+        maxInterval,
+        Math.round(poller.interval * LIMITS.PARAMETER_POLL_BACKOFF)
+      );
+
+      if (now - poller.lastEmitAt >= LIMITS.PARAMETER_KEEPALIVE_INTERVAL) {
+        this.publish(topic, "parameter:keepalive", {
+          deviceKey: deviceKey,
+          index: index,
+          subIndex: subIndex,
+          lastChangeAt: new Date(poller.lastChangeAt).toISOString(),
+          pollInterval: poller.interval,
+          timestamp: new Date(now).toISOString(),
+        });
+        poller.lastEmitAt = now;
+      }
+    } catch (error: any) {
+      logger.error(
+        `Parameter streaming error for ${deviceKey} param ${index}.${subIndex}:`,
+        error.message
+      );
+      this.publish(topic, "parameter:error", {
+        deviceKey: deviceKey,
+        index: index,
+        subIndex: subIndex,
+        error: error.message,
+        timestamp: new Date().toISOString(),
+      });
+      poller.lastEmitAt = now;
+    }
+  }
+
+  private parseValue(
+    deviceKey: string,
+    index: number,
+    subIndex: number,
+    data: Buffer
+  ): any {
+    try {
+      const parameter = this.deviceManager.parameters
+        .get(deviceKey)
+        ?.get(`${index}.${subIndex}`);
+      if (parameter) {
+        return parameter.parseValue(data);
+      }
+    } catch (error: any) {
+      logger.debug(`Could not parse parameter value: ${error.message}`);
+    }
+    return data;
+  }
+
+  private publish(topic: string, event: string, payload: any): void {
+    if (this.publisher) {
+      this.publisher(topic, event, payload);
+    }
+  }
+
+  // ============================================================================
+  // STATUS
+  // ============================================================================
+
+  getStatus(): any[] {
+    return Array.from(this.pollers.values()).map((poller) => ({
+      topic: poller.topic,
+      deviceKey: poller.deviceKey,
+      index: poller.index,
+      subIndex: poller.subIndex,
+      subscribers: poller.subscribers.size,
+      pollInterval: poller.interval,
+      reads: poller.reads,
+      changes: poller.changes,
+      lastChangeAt: poller.lastChangeAt
+        ? new Date(poller.lastChangeAt).toISOString()
+        : null,
+    }));
+  }
+}
+
+export default ParameterSubscriptionManager;
@@ -0,0 +1,146 @@
+/**
+ * Process Image Publisher
+ * Cyclic snapshot of all ready ports' process data for HTTP worker processes
+ *
+ */
+
+import DeviceManager from "./DeviceManager";
+import logger from "../utils/logger";
+import { LIMITS } from "../utils/constants";
+
+export interface ProcessImageEntry {
+  masterHandle: number;
+  port: number;
+  data: Buffer;
+  status: number;
+  timestamp: Date;
+}
+
+export interface ProcessImageBatch {
+  type: "process-image";
+  seq: number;
+  intervalMs: number;
+  publishedAt: number;
+  entries: ProcessImageEntry[];
+}
+
+interface PublisherOptions {
+  intervalMs?: number;
+}
+
+// ============================================================================
+// PUBLISHER
+// ============================================================================
+
+/**
+ * Runs in the process that owns the master handles. Every cycle it reads the
+ * process data of all ready ports in parallel and hands one batch to the
+ * publish callback, which fans it out to the workers. Workers serve process
+ * data reads from their copy without touching the DLL.
+ */
+class ProcessImagePublisher {
+  private deviceManager: DeviceManager;
+  private publish: (batch: ProcessImageBatch) => void;
+  private intervalMs: number;
+  private timer: NodeJS.Timeout | null;
+  private running: boolean;
+  private seq: number;
+  private stats: { batches: number; entries: number; readErrors: number; lastCycleMs: number };
+
+  constructor(
+    deviceManager: DeviceManager,
+    publish: (batch: ProcessImageBatch) => void,
+    options: PublisherOptions = {}
+  ) {
+    this.deviceManager = deviceManager;
+    this.publish = publish;
+    this.intervalMs =
+      options.intervalMs ||
+      parseInt(
+        process.env.PROCESS_IMAGE_INTERVAL_MS ||
+          String(LIMITS.PROCESS_IMAGE_INTERVAL_DEFAULT),
+        10
+      );
+    this.timer = null;
+    this.running = false;
+    this.seq = 0;
+    this.stats = { batches: 0, entries: 0, readErrors: 0, lastCycleMs: 0 };
+  }
+
+  start(): void {
+    if (this.running) return;
+    this.running = true;
+    logger.info(`Process image publisher started (every ${this.intervalMs}ms)`);
+    this.scheduleNext(0);
+  }
+
+  stop(): void {
+    this.running = false;
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    logger.info("Process image publisher stopped");
+  }
+
+  private scheduleNext(delayMs: number): void {
+    if (!this.running) return;
+    this.timer = setTimeout(() => {
+      const started = Date.now();
+      this.cycle()
+        .catch((error: any) =>
+          logger.error("Process image cycle failed:", error.message)
+        )
+        .finally(() => {
+          this.stats.lastCycleMs = Date.now() - started;
+          this.scheduleNext(Math.max(0, this.intervalMs - this.stats.lastCycleMs));
+        });
+    }, delayMs);
+  }
+
+  private async cycle(): Promise<void> {
+    const ports = this.deviceManager.getProcessDataPorts();
+
+    const results = await Promise.allSettled(
+      ports.map(({ masterHandle, port }) =>
+        this.deviceManager.refreshProcessData(masterHandle, port)
+      )
+    );
+
+    const entries: ProcessImageEntry[] = [];
+    results.forEach((result, i) => {
+      if (result.status === "fulfilled") {
+        entries.push({
+          masterHandle: ports[i].masterHandle,
+          port: ports[i].port,
+          data: result.value.data,
+          status: result.value.status,
+          timestamp: result.value.timestamp,
+        });
+      } else {
+        this.stats.readErrors++;
+      }
+    });
+
+    this.publish({
+      type: "process-image",
+      seq: ++this.seq,
+      intervalMs: this.intervalMs,
+      publishedAt: Date.now(),
+      entries,
+    });
+    this.stats.batches++;
+    this.stats.entries += entries.length;
+  }
+
+  getStatus() {
+    return {
+      running: this.running,
+      intervalMs: this.intervalMs,
+      seq: this.seq,
+      ...this.stats,
+    };
+  }
+}
+
+export default ProcessImagePublisher;
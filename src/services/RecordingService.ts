@@ -0,0 +1,380 @@
+/**
+ * Recording Service
+ * Compressed on-disk recordings of logged process data
+ *
+ */
+
+import { promises as fs } from "fs";
+import * as path from "path";
+import DataLoggingService, { LoggedSamples } from "./DataLoggingService";
+import HistoryService, { ChannelDecoding, decodeChannelValue } from "./HistoryService";
+import logger from "../utils/logger";
+import { ChannelBlockEncoder, DecodedBlock, readBlockHeader } from "../utils/columnCodec";
+import {
+  BlockIndexEntry,
+  indexEntry,
+  readBlocks,
+  scanBlockIndex,
+  FLAG_INPUT_VALID,
+  QUALITY_SHIFT,
+} from "../utils/recordingFile";
+import { QUALITY_CODES } from "../utils/loggingRing";
+
+export interface RecordingMeta {
+  id: string;
+  masterHandle: number;
+  port: number;
+  startedAt: string;
+  stoppedAt: string | null;
+  decoding: ChannelDecoding;
+  samples: number;
+  blocks: number;
+  // Size of the same samples as plain columns (timestamp, index, flags,
+  // value, input bytes)
+  rawBytes: number;
+  storedBytes: number;
+}
+
+interface ActiveRecording {
+  meta: RecordingMeta;
+  encoder: ChannelBlockEncoder;
+  file: fs.FileHandle;
+  index: BlockIndexEntry[];
+  // Offset of the next block; advanced when a block is queued
+  end: number;
+  writes: Promise<void>;
+}
+
+// Timestamp, sample index, flags and value as plain columns, per sample
+const RAW_SAMPLE_BYTES = 8 + 8 + 1 + 8;
+
+const RECORDING_ID = /^m\d+-p\d+-\d+$/;
+
+// ============================================================================
+// RECORDING SERVICE
+// ============================================================================
+
+/**
+ * Each recorded port appends to <id>.iolr a sequence of self-contained
+ * column blocks (see utils/columnCodec): timestamps as delta-of-delta,
+ * the decoded value XOR-compressed, and flags and each input byte as
+ * bit-packed deltas. Slowly changing or periodic signals shrink 10-40x.
+ * <id>.json holds the port, the value decoding and the totals, rewritten
+ * after every block. A recording stops with its port's data logging and
+ * on shutdown (stopAll), which writes out the partly filled block.
+ *
+ * Reads never decode the whole file: the block index (kept while
+ * recording, rebuilt from the block headers otherwise) selects the blocks
+ * of a time range, which are read and decoded on their own.
+ */
+class RecordingService {
+  private dataLoggingService: DataLoggingService;
+  private historyService: HistoryService;
+  private recordDir: string;
+  private active: Map<string, ActiveRecording>;
+  private indexes: Map<string, BlockIndexEntry[]>;
+  private listener: ((batch: LoggedSamples) => void) | null;
+
+  constructor(
+    dataLoggingService: DataLoggingService,
+    historyService: HistoryService,
+    recordDir?: string
+  ) {
+    this.dataLoggingService = dataLoggingService;
+    this.historyService = historyService;
+    this.recordDir =
+      recordDir ||
+      process.env.RECORDING_DIR ||
+      path.join(process.cwd(), "data", "recordings");
+    this.active = new Map();
+    this.indexes = new Map();
+    this.listener = null;
+
+    // Nothing feeds a recording once its port stops logging
+    this.dataLoggingService.on("stopped", ({ masterHandle, port }) => {
+      this.stop(masterHandle, port).catch((error: any) =>
+        logger.error(`Stopping recording of master ${masterHandle} port ${port} failed: ${error.message}`)
+      );
+    });
+  }
+
+  // ============================================================================
+  // RECORDING
+  // ============================================================================
+
+  async start(masterHandle: number, port: number): Promise<RecordingMeta> {
+    const key = `${masterHandle}:${port}`;
+    const running = this.active.get(key);
+    if (running) return running.meta;
+
+    if (!this.dataLoggingService.isLogging(masterHandle, port)) {
+      const error: any = new Error(
+        `Data logging is not running on master ${masterHandle} port ${port}`
+      );
+      error.statusCode = 409;
+      error.apiErrorCode = "LOGGING_NOT_ACTIVE";
+      throw error;
+    }
+
+    await fs.mkdir(this.recordDir, { recursive: true });
+    const startedAt = new Date();
+    const id = `m${masterHandle}-p${port}-${startedAt.getTime()}`;
+    const meta: RecordingMeta = {
+      id,
+      masterHandle,
+      port,
+      startedAt: startedAt.toISOString(),
+      stoppedAt: null,
+      decoding: this.historyService.getDecoding(masterHandle, port),
+      samples: 0,
+      blocks: 0,
+      rawBytes: 0,
+      storedBytes: 0,
+    };
+    const file = await fs.open(this.blockPath(id), "wx");
+    await this.writeMeta(meta);
+
+    this.active.set(key, {
+      meta,
+      encoder: new ChannelBlockEncoder(),
+      file,
+      index: [],
+      end: 0,
+      writes: Promise.resolve(),
+    });
+    this.subscribe();
+
+    logger.info(`Recording master ${masterHandle} port ${port} to ${id}`);
+    return meta;
+  }
+
+  async stop(masterHandle: number, port: number): Promise<RecordingMeta | null> {
+    const key = `${masterHandle}:${port}`;
+    const recording = this.active.get(key);
+    if (!recording) return null;
+    this.active.delete(key);
+    if (this.active.size === 0) this.unsubscribe();
+
+    const last = recording.encoder.flush();
+    if (last) this.append(recording, last);
+    await recording.writes;
+    await recording.file.close();
+
+    recording.meta.stoppedAt = new Date().toISOString();
+    await this.writeMeta(recording.meta);
+    this.indexes.set(recording.meta.id, recording.index);
+
+    logger.info(
+      `Recording ${recording.meta.id} stopped: ${recording.meta.samples} samples in ${recording.meta.storedBytes} bytes`
+    );
+    return recording.meta;
+  }
+
+  async stopAll(): Promise<void> {
+    await Promise.all(
+      Array.from(this.active.values()).map((recording) =>
+        this.stop(recording.meta.masterHandle, recording.meta.port)
+      )
+    );
+  }
+
+  private subscribe(): void {
+    if (this.listener) return;
+    this.listener = (batch) => this.ingest(batch);
+    this.dataLoggingService.on("samples", this.listener);
+  }
+
+  private unsubscribe(): void {
+    if (!this.listener) return;
+    this.dataLoggingService.off("samples", this.listener);
+    this.listener = null;
+  }
+
+  private ingest(batch: LoggedSamples): void {
+    const recording = this.active.get(`${batch.masterHandle}:${batch.port}`);
+    if (!recording) return;
+    const { meta, encoder } = recording;
+
+    for (const sample of batch.samples) {
+      // Gaps show as a jump in timestamps and sample indexes
+      if (sample.gap) continue;
+
+      const value = sample.inputValid
+        ? decodeChannelValue(sample.inputData, meta.decoding)
+        : null;
+      const flags =
+        (sample.inputValid ? FLAG_INPUT_VALID : 0) |
+        (QUALITY_CODES.indexOf(sample.timestampQuality) << QUALITY_SHIFT);
+
+      const sealed = encoder.push(
+        sample.timestamp,
+        sample.sampleIndex,
+        flags,
+        value === null ? NaN : value,
+        sample.inputData
+      );
+      meta.samples++;
+      meta.rawBytes += RAW_SAMPLE_BYTES + sample.inputData.length;
+      for (const block of sealed) {
+        this.append(recording, block);
+      }
+    }
+  }
+
+  private append(recording: ActiveRecording, block: Buffer): void {
+    const header = readBlockHeader(block)!;
+    const offset = recording.end;
+    recording.end += block.length;
+    recording.meta.blocks++;
+    recording.meta.storedBytes += block.length;
+
+    recording.writes = recording.writes
+      .then(() => recording.file.write(block, 0, block.length, offset))
+      .then(() => {
+        // Visible to readers once on disk
+        recording.index.push(indexEntry(offset, header));
+        // Totals on disk stay current up to the last sealed block, so a
+        // crash loses at most the block being encoded
+        return this.writeMeta(recording.meta);
+      })
+      .catch((error: any) =>
+        logger.error(`Recording ${recording.meta.id} write failed: ${error.message}`)
+      );
+  }
+
+  // ============================================================================
+  // READING
+  // ============================================================================
+
+  private findActive(id: string): ActiveRecording | undefined {
+    return Array.from(this.active.values()).find((recording) => recording.meta.id === id);
+  }
+
+  async getRecording(id: string): Promise<RecordingMeta> {
+    const recording = this.findActive(id);
+    if (recording) return recording.meta;
+    if (!RECORDING_ID.test(id)) throw this.notFound(id);
+    try {
+      return JSON.parse(await fs.readFile(this.metaPath(id), "utf8"));
+    } catch (error) {
+      throw this.notFound(id);
+    }
+  }
+
+  async listRecordings(): Promise<RecordingMeta[]> {
+    let files: string[];
+    try {
+      files = await fs.readdir(this.recordDir);
+    } catch (error) {
+      return [];
+    }
+    const recordings = await Promise.all(
+      files
+        .filter((f) => f.endsWith(".json"))
+        .map((f) => this.getRecording(f.slice(0, -5)).catch(() => null))
+    );
+    return recordings
+      .filter((r): r is RecordingMeta => r !== null)
+      .sort((a, b) => b.startedAt.localeCompare(a.startedAt));
+  }
+
+  /**
+   * Decoded blocks of a recording overlapping [from, to], oldest first
+   */
+  async *readBlocks(id: string, from: number, to: number): AsyncGenerator<DecodedBlock> {
+    await this.getRecording(id);
+    const recording = this.findActive(id);
+    const index = recording ? recording.index.slice() : await this.loadIndex(id);
+    yield* readBlocks(this.blockPath(id), index, from, to);
+  }
+
+  /**
+   * Samples of a recording within [from, to], at most limit
+   */
+  async readSamples(id: string, from: number, to: number, limit: number) {
+    const samples: any[] = [];
+    let truncated = false;
+
+    for await (const block of this.readBlocks(id, from, to)) {
+      for (let i = 0; i < block.count; i++) {
+        const timestamp = block.timestamps[i];
+        if (timestamp < from || timestamp > to) continue;
+        if (samples.length === limit) {
+          truncated = true;
+          break;
+        }
+        const flags = block.flags[i];
+        const input = block.inputs.subarray(i * block.lanes, (i + 1) * block.lanes);
+        samples.push({
+          sampleIndex: block.sampleIndexes[i],
+          timestamp,
+          timestampQuality: QUALITY_CODES[flags >> QUALITY_SHIFT],
+          inputValid: (flags & FLAG_INPUT_VALID) !== 0,
+          value: Number.isNaN(block.values[i]) ? null : block.values[i],
+          dataHex: Buffer.from(input).toString("hex").toUpperCase(),
+        });
+      }
+      if (truncated) break;
+    }
+    return { samples, truncated };
+  }
+
+  /**
+   * Block index of a finished recording from its block headers
+   */
+  private async loadIndex(id: string): Promise<BlockIndexEntry[]> {
+    let index = this.indexes.get(id);
+    if (!index) {
+      index = await scanBlockIndex(this.blockPath(id));
+      this.indexes.set(id, index);
+    }
+    return index;
+  }
+
+  async deleteRecording(id: string): Promise<void> {
+    await this.getRecording(id);
+    if (this.findActive(id)) {
+      const error: any = new Error(`Recording ${id} is still running`);
+      error.statusCode = 409;
+      error.apiErrorCode = "RECORDING_ACTIVE";
+      throw error;
+    }
+    await fs.rm(this.blockPath(id), { force: true });
+    await fs.rm(this.metaPath(id), { force: true });
+    this.indexes.delete(id);
+  }
+
+  getStatus() {
+    return {
+      recordDir: this.recordDir,
+      active: Array.from(this.active.values()).map((recording) => ({
+        ...recording.meta,
+        pendingSamples: recording.encoder.pending,
+      })),
+    };
+  }
+
+  // Replaced by rename so a crash never leaves a torn <id>.json
+  private async writeMeta(meta: RecordingMeta): Promise<void> {
+    const target = this.metaPath(meta.id);
+    await fs.writeFile(`${target}.tmp`, JSON.stringify(meta, null, 2));
+    await fs.rename(`${target}.tmp`, target);
+  }
+
+  private blockPath(id: string): string {
+    return path.join(this.recordDir, `${id}.iolr`);
+  }
+
+  private metaPath(id: string): string {
+    return path.join(this.recordDir, `${id}.json`);
+  }
+
+  private notFound(id: string): Error {
+    const error: any = new Error(`Recording not found: ${id}`);
+    error.statusCode = 404;
+    error.apiErrorCode = "RECORDING_NOT_FOUND";
+    return error;
+  }
+}
+
+export default RecordingService;
@@ -0,0 +1,366 @@
+/**
+ * Rules Service
+ * Threshold, edge, rate and stuck-value alarms evaluated on every process data sample
+ *
+ */
+
+import { EventEmitter } from "events";
+import { randomUUID } from "crypto";
+import { performance } from "perf_hooks";
+import DeviceManager from "./DeviceManager";
+import DataLoggingService, { LoggedSamples } from "./DataLoggingService";
+import HistoryService from "./HistoryService";
+import logger from "../utils/logger";
+import { LIMITS, SENSOR_STATUS } from "../utils/constants";
+import {
+  PortProgram,
+  RuleDecoding,
+  RuleDefinition,
+  TRANSITION_CLEARED,
+  TRANSITION_NAMES,
+  TRANSITION_RAISED,
+  decodingSize,
+  isDecodable,
+} from "../utils/ruleProgram";
+
+export interface AlarmEvent {
+  ruleId: string;
+  name: string;
+  type: string;
+  masterHandle: number;
+  port: number;
+  transition: string;
+  // Raised (threshold, rate, stuck) alarms stay active until cleared;
+  // edges are momentary
+  active: boolean;
+  // Decoded value, or the rate for rate rules
+  value: number;
+  // Sample time (epoch ms) and how long after it the alarm was emitted
+  timestamp: number;
+  latencyMs: number;
+  source: "logging" | "process-image";
+}
+
+interface PortState {
+  program: PortProgram;
+  // Last process image sample counter seen by the scan
+  lastSequence: number;
+}
+
+// ============================================================================
+// RULES SERVICE
+// ============================================================================
+
+/**
+ * Rules are compiled per port into a PortProgram, which decodes each sample
+ * once per distinct channel and runs every rule of the port over typed
+ * arrays. Two inputs feed the programs:
+ *
+ * - every sample the data logging service drains, at the logged sample rate
+ * - for ports that are not logged, the shared process image, scanned every
+ *   RULES_SCAN_INTERVAL and evaluated only when the acquisition thread has
+ *   published a new sample
+ *
+ * State changes are emitted as "alarm" (AlarmEvent) right in the ingest
+ * path, within the drain or acquisition cycle that delivered the sample.
+ * Rules live in memory; a rule's decoding defaults to the port's history
+ * decoding when it is created.
+ */
+class RulesService extends EventEmitter {
+  private dataLoggingService: DataLoggingService;
+  private historyService: HistoryService;
+  private deviceManager: DeviceManager;
+  private rules: Map<string, RuleDefinition>;
+  private ports: Map<string, PortState>;
+  private active: Map<string, AlarmEvent>;
+  private alarmLog: AlarmEvent[];
+  private listener: ((batch: LoggedSamples) => void) | null;
+  private scanTimer: NodeJS.Timeout | null;
+  private stats: {
+    alarms: number;
+    evaluationMs: number;
+    maxLatencyMs: number;
+  };
+
+  constructor(
+    dataLoggingService: DataLoggingService,
+    historyService: HistoryService,
+    deviceManager: DeviceManager
+  ) {
+    super();
+    this.dataLoggingService = dataLoggingService;
+    this.historyService = historyService;
+    this.deviceManager = deviceManager;
+    this.rules = new Map();
+    this.ports = new Map();
+    this.active = new Map();
+    this.alarmLog = [];
+    this.listener = null;
+    this.scanTimer = null;
+    this.stats = { alarms: 0, evaluationMs: 0, maxLatencyMs: 0 };
+  }
+
+  // ============================================================================
+  // LIFECYCLE
+  // ============================================================================
+
+  start(): void {
+    if (this.listener) return;
+    this.listener = (batch) => this.ingest(batch);
+    this.dataLoggingService.on("samples", this.listener);
+    this.scanTimer = setInterval(() => this.scan(), LIMITS.RULES_SCAN_INTERVAL);
+    logger.info(`Rules engine started (scan interval: ${LIMITS.RULES_SCAN_INTERVAL}ms)`);
+  }
+
+  stop(): void {
+    if (!this.listener) return;
+    this.dataLoggingService.off("samples", this.listener);
+    this.listener = null;
+    if (this.scanTimer) {
+      clearInterval(this.scanTimer);
+      this.scanTimer = null;
+    }
+    logger.info("Rules engine stopped");
+  }
+
+  // ============================================================================
+  // EVALUATION
+  // ============================================================================
+
+  private ingest(batch: LoggedSamples): void {
+    const state = this.ports.get(`${batch.masterHandle}:${batch.port}`);
+    if (!state) return;
+
+    const started = performance.now();
+    const { program } = state;
+    const sink = this.sinkFor(program, "logging");
+    for (const sample of batch.samples) {
+      if (sample.gap) {
+        program.resetHistory();
+        continue;
+      }
+      if (!sample.inputValid) continue;
+      program.evaluate(sample.inputData, sample.timestamp, sink);
+    }
+    this.stats.evaluationMs += performance.now() - started;
+  }
+
+  /**
+   * Evaluate ports that are not logged on the latest process image sample
+   */
+  private scan(): void {
+    if (this.ports.size === 0) return;
+
+    const started = performance.now();
+    for (const state of this.ports.values()) {
+      const { program } = state;
+      if (this.dataLoggingService.isLogging(program.masterHandle, program.port)) continue;
+
+      const sample = this.deviceManager.readProcessImageInputs(
+        program.masterHandle,
+        program.port,
+        state.lastSequence
+      );
+      if (!sample) continue;
+      state.lastSequence = sample.sequence;
+      if ((sample.status & SENSOR_STATUS.BIT_PDVALID) === 0) continue;
+
+      program.evaluate(sample.data, sample.timestamp.getTime(), this.sinkFor(program, "process-image"));
+    }
+    this.stats.evaluationMs += performance.now() - started;
+  }
+
+  private sinkFor(program: PortProgram, source: AlarmEvent["source"]) {
+    return (rule: number, transition: number, value: number, timestamp: number) =>
+      this.emitAlarm(program.rules[rule], transition, value, timestamp, source);
+  }
+
+  private emitAlarm(
+    rule: RuleDefinition,
+    transition: number,
+    value: number,
+    timestamp: number,
+    source: AlarmEvent["source"]
+  ): void {
+    const latencyMs = Date.now() - timestamp;
+    const event: AlarmEvent = {
+      ruleId: rule.id,
+      name: rule.name,
+      type: rule.type,
+      masterHandle: rule.masterHandle,
+      port: rule.port,
+      transition: TRANSITION_NAMES[transition],
+      active: transition === TRANSITION_RAISED,
+      value,
+      timestamp,
+      latencyMs,
+      source,
+    };
+
+    if (transition === TRANSITION_RAISED) {
+      this.active.set(rule.id, event);
+    } else if (transition === TRANSITION_CLEARED) {
+      this.active.delete(rule.id);
+    }
+
+    this.alarmLog.push(event);
+    if (this.alarmLog.length > LIMITS.ALARM_LOG_SIZE) {
+      this.alarmLog.splice(0, this.alarmLog.length - LIMITS.ALARM_LOG_SIZE);
+    }
+    this.stats.alarms++;
+    this.stats.maxLatencyMs = Math.max(this.stats.maxLatencyMs, latencyMs);
+    this.emit("alarm", event);
+  }
+
+  // ============================================================================
+  // RULES
+  // ============================================================================
+
+  addRule(
+    definition: Omit<RuleDefinition, "id" | "name" | "decoding"> & {
+      name?: string;
+      decoding?: Partial<RuleDecoding>;
+    }
+  ): RuleDefinition {
+    if (this.rules.size >= LIMITS.RULES_MAX) {
+      const error: any = new Error(`At most ${LIMITS.RULES_MAX} rules are supported`);
+      error.statusCode = 409;
+      error.apiErrorCode = "RULE_LIMIT_REACHED";
+      throw error;
+    }
+
+    const id = randomUUID();
+    const rule: RuleDefinition = {
+      ...definition,
+      id,
+      name: definition.name || `${definition.type} ${definition.masterHandle}:${definition.port}`,
+      decoding: {
+        ...this.historyService.getDecoding(definition.masterHandle, definition.port),
+        ...definition.decoding,
+      },
+    };
+    if (!isDecodable(rule.decoding)) {
+      const error: any = new Error(`Data type ${rule.decoding.dataType} cannot be evaluated by rules`);
+      error.statusCode = 400;
+      error.apiErrorCode = "INVALID_REQUEST";
+      throw error;
+    }
+    const inputLength = this.getInputLength(rule.masterHandle, rule.port);
+    if (inputLength !== null && !this.fits(rule, inputLength)) {
+      const error: any = new Error(
+        `Decoding at offset ${rule.decoding.offset} needs ${decodingSize(rule.decoding)} byte(s) ` +
+          `but the device on port ${rule.port} has ${inputLength} input byte(s)`
+      );
+      error.statusCode = 400;
+      error.apiErrorCode = "INVALID_REQUEST";
+      throw error;
+    }
+
+    this.rules.set(id, rule);
+    this.compile(rule.masterHandle, rule.port);
+    logger.info(`Rule ${id} (${rule.type}) added on master ${rule.masterHandle} port ${rule.port}`);
+    return rule;
+  }
+
+  removeRule(ruleId: string): void {
+    const rule = this.rules.get(ruleId);
+    if (!rule) {
+      const error: any = new Error(`Rule ${ruleId} not found`);
+      error.statusCode = 404;
+      error.apiErrorCode = "RULE_NOT_FOUND";
+      throw error;
+    }
+
+    this.rules.delete(ruleId);
+    this.active.delete(ruleId);
+    this.compile(rule.masterHandle, rule.port);
+    logger.info(`Rule ${ruleId} removed`);
+  }
+
+  /**
+   * Rebuild the program of a port from its current rules
+   */
+  private compile(masterHandle: number, port: number): void {
+    const key = `${masterHandle}:${port}`;
+    const rules = Array.from(this.rules.values()).filter(
+      (rule) => rule.masterHandle === masterHandle && rule.port === port
+    );
+    const state = this.ports.get(key);
+
+    if (rules.length === 0) {
+      this.ports.delete(key);
+      return;
+    }
+    const program = new PortProgram(masterHandle, port, rules, state?.program);
+    this.ports.set(key, { program, lastSequence: state?.lastSequence ?? 0 });
+  }
+
+  /**
+   * Process data input length of the device on a port; null while unknown
+   */
+  private getInputLength(masterHandle: number, port: number): number | null {
+    try {
+      return this.deviceManager.getDevice(masterHandle, port).processDataInputLength || null;
+    } catch {
+      return null;
+    }
+  }
+
+  private fits(rule: RuleDefinition, inputLength: number): boolean {
+    return rule.decoding.offset + decodingSize(rule.decoding) <= inputLength;
+  }
+
+  /**
+   * Rules with their state. outOfRange flags rules the current device's
+   * inputs are too short for (e.g. after a device swap); undecodable counts
+   * the samples they had to skip.
+   */
+  getRules(): any[] {
+    const entries: any[] = [];
+    for (const { program } of this.ports.values()) {
+      const inputLength = this.getInputLength(program.masterHandle, program.port);
+      program.rules.forEach((rule, r) => {
+        entries.push({
+          ...rule,
+          active: program.isActive(r),
+          lastValue: program.getLastValue(r),
+          outOfRange: inputLength !== null && !this.fits(rule, inputLength),
+          undecodable: program.getMisses(r),
+        });
+      });
+    }
+    return entries;
+  }
+
+  /**
+   * Active alarms and the most recent transitions, newest first
+   */
+  getAlarms(limit: number = LIMITS.ALARM_LOG_SIZE) {
+    return {
+      active: Array.from(this.active.values()),
+      recent: this.alarmLog.slice(-limit).reverse(),
+    };
+  }
+
+  getStatus() {
+    let samples = 0;
+    let undecodable = 0;
+    for (const { program } of this.ports.values()) {
+      samples += program.samples;
+      undecodable += program.undecodable;
+    }
+    return {
+      running: this.listener !== null,
+      rules: this.rules.size,
+      ports: this.ports.size,
+      activeAlarms: this.active.size,
+      samplesEvaluated: samples,
+      undecodable,
+      alarms: this.stats.alarms,
+      evaluationMs: Math.round(this.stats.evaluationMs * 1000) / 1000,
+      maxLatencyMs: this.stats.maxLatencyMs,
+    };
+  }
+}
+
+export default RulesService;
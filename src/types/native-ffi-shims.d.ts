@@ -22,10 +22,13 @@ declare module 'ref-napi' {
   export function get(buffer: Buffer, offset: number, type: any): any;
   export function refType(type: any): any;
   export function isNull(pointer: any): boolean;
+  export function reinterpret(buffer: Buffer, size: number, offset?: number): Buffer;
+  export function allocCString(value: string, encoding?: string): Buffer;
+  export const NULL: Buffer;
 }
 
 declare module 'ref-struct-napi' {
-  function StructType(fields: any): any;
+  function StructType(fields: any, options?: { packed?: boolean }): any;
   export = StructType;
 }
 
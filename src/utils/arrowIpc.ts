@@ -0,0 +1,377 @@
+/**
+ * Arrow IPC
+ * Apache Arrow IPC stream encoding of column batches
+ *
+ */
+
+// ============================================================================
+// FLATBUFFERS
+// ============================================================================
+//
+// Arrow IPC metadata is a FlatBuffer. Only writing is needed, so objects are
+// laid out front to back: each table is preceded by its vtable and followed
+// by the objects it references, which keeps every reference a forward
+// (unsigned) offset as the format requires.
+
+type ScalarType = 'bool' | 'u8' | 'i16' | 'i32' | 'i64';
+
+const SCALAR_SIZES: Record<ScalarType, number> = { bool: 1, u8: 1, i16: 2, i32: 4, i64: 8 };
+
+type FbNode =
+  | { kind: 'table'; fields: Array<FbField | undefined> }
+  | { kind: 'string'; value: string }
+  | { kind: 'tables'; items: FbNode[] }
+  | { kind: 'structs'; bytes: Buffer };
+
+type FbField =
+  | { kind: 'scalar'; type: ScalarType; value: number }
+  | { kind: 'ref'; node: FbNode };
+
+const table = (...fields: Array<FbField | undefined>): FbNode => ({ kind: 'table', fields });
+const scalar = (type: ScalarType, value: number): FbField => ({ kind: 'scalar', type, value });
+const ref = (node: FbNode): FbField => ({ kind: 'ref', node });
+const string = (value: string): FbNode => ({ kind: 'string', value });
+const tables = (items: FbNode[]): FbNode => ({ kind: 'tables', items });
+
+class FlatWriter {
+  private buffer: Buffer;
+  private length: number;
+
+  constructor() {
+    this.buffer = Buffer.alloc(512);
+    this.length = 0;
+  }
+
+  finish(root: FbNode): Buffer {
+    this.reserve(4);
+    const rootPosition = this.write(root);
+    this.buffer.writeUInt32LE(rootPosition, 0);
+    return this.buffer.subarray(0, this.length);
+  }
+
+  private reserve(size: number): number {
+    const position = this.length;
+    while (this.buffer.length < position + size) {
+      const grown = Buffer.alloc(this.buffer.length * 2);
+      this.buffer.copy(grown);
+      this.buffer = grown;
+    }
+    this.length += size;
+    return position;
+  }
+
+  private alignTo(alignment: number, extra: number = 0): void {
+    const padding = (alignment - ((this.length + extra) % alignment)) % alignment;
+    this.reserve(padding);
+  }
+
+  private patch(slot: number, target: number): void {
+    this.buffer.writeUInt32LE(target - slot, slot);
+  }
+
+  private write(node: FbNode): number {
+    switch (node.kind) {
+      case 'string': {
+        const bytes = Buffer.from(node.value, 'utf8');
+        this.alignTo(4);
+        const position = this.reserve(4 + bytes.length + 1);
+        this.buffer.writeUInt32LE(bytes.length, position);
+        bytes.copy(this.buffer, position + 4);
+        this.buffer[position + 4 + bytes.length] = 0;
+        return position;
+      }
+      case 'structs': {
+        // Struct elements hold 64-bit values: align the data after the count
+        this.alignTo(8, 4);
+        const position = this.reserve(4 + node.bytes.length);
+        this.buffer.writeUInt32LE(node.bytes.length / 16, position);
+        node.bytes.copy(this.buffer, position + 4);
+        return position;
+      }
+      case 'tables': {
+        this.alignTo(4);
+        const position = this.reserve(4 + 4 * node.items.length);
+        this.buffer.writeUInt32LE(node.items.length, position);
+        node.items.forEach((item, i) => {
+          const slot = position + 4 + 4 * i;
+          this.patch(slot, this.write(item));
+        });
+        return position;
+      }
+      case 'table':
+        return this.writeTable(node.fields);
+    }
+  }
+
+  private writeTable(fields: Array<FbField | undefined>): number {
+    // Field offsets within the table, largest first to avoid padding; the
+    // table itself starts 8-aligned after its 4-byte vtable offset
+    const offsets = new Array<number>(fields.length).fill(0);
+    const order = fields
+      .map((field, id) => ({ field, id }))
+      .filter((entry) => entry.field !== undefined)
+      .sort((a, b) => fieldSize(b.field!) - fieldSize(a.field!));
+    let size = 4;
+    for (const { field, id } of order) {
+      const fieldBytes = fieldSize(field!);
+      size = Math.ceil(size / fieldBytes) * fieldBytes;
+      offsets[id] = size;
+      size += fieldBytes;
+    }
+
+    this.alignTo(2);
+    const vtableSize = 4 + 2 * fields.length;
+    const vtable = this.reserve(vtableSize);
+    this.alignTo(8);
+    const position = this.reserve(size);
+
+    this.buffer.writeUInt16LE(vtableSize, vtable);
+    this.buffer.writeUInt16LE(size, vtable + 2);
+    offsets.forEach((offset, id) => this.buffer.writeUInt16LE(offset, vtable + 4 + 2 * id));
+    this.buffer.writeInt32LE(position - vtable, position);
+
+    const references: Array<{ slot: number; node: FbNode }> = [];
+    fields.forEach((field, id) => {
+      if (!field) return;
+      const at = position + offsets[id];
+      if (field.kind === 'ref') {
+        references.push({ slot: at, node: field.node });
+        return;
+      }
+      switch (field.type) {
+        case 'bool':
+        case 'u8':
+          this.buffer.writeUInt8(field.value, at);
+          break;
+        case 'i16':
+          this.buffer.writeInt16LE(field.value, at);
+          break;
+        case 'i32':
+          this.buffer.writeInt32LE(field.value, at);
+          break;
+        case 'i64':
+          this.buffer.writeBigInt64LE(BigInt(field.value), at);
+          break;
+      }
+    });
+
+    for (const { slot, node } of references) {
+      this.patch(slot, this.write(node));
+    }
+    return position;
+  }
+}
+
+function fieldSize(field: FbField): number {
+  return field.kind === 'ref' ? 4 : SCALAR_SIZES[field.type];
+}
+
+// ============================================================================
+// SCHEMA
+// ============================================================================
+
+export type ArrowType =
+  | { id: 'int'; bitWidth: 8 | 16 | 32 | 64; signed: boolean }
+  | { id: 'float'; precision: 'single' | 'double' }
+  | { id: 'bool' }
+  | { id: 'utf8' }
+  | { id: 'binary' }
+  | { id: 'timestamp'; unit: 'ms' | 'us'; timezone?: string };
+
+export interface ArrowField {
+  name: string;
+  type: ArrowType;
+  nullable: boolean;
+}
+
+// Message.fbs / Schema.fbs enum values
+const METADATA_V5 = 4;
+const HEADER_SCHEMA = 1;
+const HEADER_RECORD_BATCH = 3;
+const TYPE_IDS = { int: 2, float: 3, binary: 4, utf8: 5, bool: 6, timestamp: 10 };
+const PRECISION = { single: 1, double: 2 };
+const TIME_UNITS = { ms: 1, us: 2 };
+
+function typeTable(type: ArrowType): FbNode {
+  switch (type.id) {
+    case 'int':
+      return table(scalar('i32', type.bitWidth), scalar('bool', type.signed ? 1 : 0));
+    case 'float':
+      return table(scalar('i16', PRECISION[type.precision]));
+    case 'timestamp':
+      return table(
+        scalar('i16', TIME_UNITS[type.unit]),
+        type.timezone ? ref(string(type.timezone)) : undefined
+      );
+    default:
+      return table();
+  }
+}
+
+function message(headerType: number, header: FbNode, bodyLength: number): Buffer {
+  return new FlatWriter().finish(
+    table(
+      scalar('i16', METADATA_V5),
+      scalar('u8', headerType),
+      ref(header),
+      scalar('i64', bodyLength)
+    )
+  );
+}
+
+/**
+ * Continuation marker, metadata length, metadata padded to 8 bytes
+ */
+function frame(metadata: Buffer): Buffer {
+  const padded = Math.ceil((metadata.length + 8) / 8) * 8 - 8;
+  const framed = Buffer.alloc(8 + padded);
+  framed.writeUInt32LE(0xffffffff, 0);
+  framed.writeInt32LE(padded, 4);
+  metadata.copy(framed, 8);
+  return framed;
+}
+
+export function encodeSchema(fields: ArrowField[]): Buffer {
+  const schema = table(
+    scalar('i16', 0), // little endian
+    ref(
+      tables(
+        fields.map((field) =>
+          table(
+            ref(string(field.name)),
+            scalar('bool', field.nullable ? 1 : 0),
+            scalar('u8', TYPE_IDS[field.type.id]),
+            ref(typeTable(field.type)),
+            undefined, // dictionary
+            ref(tables([])) // children
+          )
+        )
+      )
+    )
+  );
+  return frame(message(HEADER_SCHEMA, schema, 0));
+}
+
+// End-of-stream marker
+export const ARROW_END_OF_STREAM = Buffer.from([0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0]);
+
+// ============================================================================
+// RECORD BATCHES
+// ============================================================================
+
+/**
+ * One column of a batch: its buffers in Arrow order after the validity
+ * bitmap (values; or offsets and data for utf8/binary)
+ */
+export interface ArrowColumn {
+  length: number;
+  nullCount: number;
+  // Bit i set when row i is valid; omitted when nullCount is 0
+  validity?: Uint8Array;
+  buffers: Uint8Array[];
+}
+
+/**
+ * Record batch message and body. Buffers are referenced where they are,
+ * not copied; the returned chunks are written out in order.
+ */
+export function encodeRecordBatch(length: number, columns: ArrowColumn[]): Buffer[] {
+  const nodes = Buffer.alloc(16 * columns.length);
+  const bodyBuffers: Uint8Array[] = [];
+  columns.forEach((column, i) => {
+    nodes.writeBigInt64LE(BigInt(column.length), 16 * i);
+    nodes.writeBigInt64LE(BigInt(column.nullCount), 16 * i + 8);
+    bodyBuffers.push(column.nullCount > 0 && column.validity ? column.validity : new Uint8Array(0));
+    bodyBuffers.push(...column.buffers);
+  });
+
+  const specs = Buffer.alloc(16 * bodyBuffers.length);
+  const body: Buffer[] = [];
+  let offset = 0;
+  bodyBuffers.forEach((buffer, i) => {
+    specs.writeBigInt64LE(BigInt(offset), 16 * i);
+    specs.writeBigInt64LE(BigInt(buffer.byteLength), 16 * i + 8);
+    if (buffer.byteLength === 0) return;
+    body.push(Buffer.from(buffer.buffer, buffer.byteOffset, buffer.byteLength));
+    const padding = (8 - (buffer.byteLength % 8)) % 8;
+    if (padding > 0) body.push(Buffer.alloc(padding));
+    offset += buffer.byteLength + padding;
+  });
+
+  const batch = table(
+    scalar('i64', length),
+    ref({ kind: 'structs', bytes: nodes }),
+    ref({ kind: 'structs', bytes: specs })
+  );
+  return [frame(message(HEADER_RECORD_BATCH, batch, offset)), ...body];
+}
+
+// ============================================================================
+// COLUMN BUILDERS
+// ============================================================================
+
+/**
+ * Primitive column straight from a typed array
+ */
+export function primitiveColumn(
+  values: Float64Array | Float32Array | Int32Array | Uint32Array | Int16Array | Uint16Array | Int8Array | Uint8Array,
+  validity?: Uint8Array,
+  nullCount: number = 0
+): ArrowColumn {
+  return { length: values.length, nullCount, validity, buffers: [values] };
+}
+
+/**
+ * 64-bit integers (e.g. microsecond timestamps) from doubles holding integers
+ */
+export function int64Column(values: Float64Array | number[], scale: number = 1): ArrowColumn {
+  const words = new Uint32Array(values.length * 2);
+  for (let i = 0; i < values.length; i++) {
+    const value = Math.round(values[i] * scale);
+    const high = Math.floor(value / 0x100000000);
+    words[2 * i] = value - high * 0x100000000;
+    words[2 * i + 1] = high;
+  }
+  return { length: values.length, nullCount: 0, buffers: [words] };
+}
+
+export function boolColumn(values: ArrayLike<boolean | number>): ArrowColumn {
+  const bits = new Uint8Array(Math.ceil(values.length / 8));
+  for (let i = 0; i < values.length; i++) {
+    if (values[i]) bits[i >> 3] |= 1 << (i & 7);
+  }
+  return { length: values.length, nullCount: 0, buffers: [bits] };
+}
+
+/**
+ * Utf8 or binary column from strings or byte slices
+ */
+export function variableColumn(values: Array<string | Uint8Array>): ArrowColumn {
+  const encoded = values.map((value) =>
+    typeof value === 'string' ? Buffer.from(value, 'utf8') : value
+  );
+  const offsets = new Int32Array(values.length + 1);
+  let total = 0;
+  encoded.forEach((bytes, i) => {
+    offsets[i] = total;
+    total += bytes.length;
+  });
+  offsets[values.length] = total;
+
+  const data = new Uint8Array(total);
+  encoded.forEach((bytes, i) => data.set(bytes, offsets[i]));
+  return { length: values.length, nullCount: 0, buffers: [offsets, data] };
+}
+
+/**
+ * Validity bitmap from a per-row predicate; returns the null count with it
+ */
+export function validityBitmap(length: number, valid: (row: number) => boolean): { bitmap: Uint8Array; nullCount: number } {
+  const bitmap = new Uint8Array(Math.ceil(length / 8));
+  let nullCount = 0;
+  for (let i = 0; i < length; i++) {
+    if (valid(i)) bitmap[i >> 3] |= 1 << (i & 7);
+    else nullCount++;
+  }
+  return { bitmap, nullCount };
+}
@@ -0,0 +1,262 @@
+/**
+ * Capture Export
+ * Arrow IPC streams of recordings, master events and link statistics
+ *
+ */
+
+import {
+  ArrowColumn,
+  ArrowField,
+  ArrowType,
+  ARROW_END_OF_STREAM,
+  boolColumn,
+  encodeRecordBatch,
+  encodeSchema,
+  int64Column,
+  primitiveColumn,
+  validityBitmap,
+  variableColumn,
+} from './arrowIpc';
+import { DecodedBlock } from './columnCodec';
+import { FLAG_INPUT_VALID, QUALITY_SHIFT } from './recordingFile';
+import { QUALITY_CODES } from './loggingRing';
+import { DATA_TYPES, EVENT_CODE_NAMES } from './constants';
+
+// Same shape as the history service's channel decoding
+interface ValueDecoding {
+  dataType?: string;
+  scale: number;
+  bias: number;
+}
+
+export const ARROW_STREAM_CONTENT_TYPE = 'application/vnd.apache.arrow.stream';
+
+// ============================================================================
+// RECORDINGS
+// ============================================================================
+
+type ValueArray = Float64Array | Float32Array | Int32Array | Uint32Array | Int16Array | Uint16Array | Int8Array | Uint8Array;
+
+// Arrow type and array of decoded values that are plain device integers
+const RAW_VALUE_TYPES: Record<string, { type: ArrowType; array: new (length: number) => ValueArray }> = {
+  [DATA_TYPES.UINT8]: { type: { id: 'int', bitWidth: 8, signed: false }, array: Uint8Array },
+  [DATA_TYPES.INT8]: { type: { id: 'int', bitWidth: 8, signed: true }, array: Int8Array },
+  [DATA_TYPES.UINT16]: { type: { id: 'int', bitWidth: 16, signed: false }, array: Uint16Array },
+  [DATA_TYPES.INT16]: { type: { id: 'int', bitWidth: 16, signed: true }, array: Int16Array },
+  [DATA_TYPES.UINT32]: { type: { id: 'int', bitWidth: 32, signed: false }, array: Uint32Array },
+  [DATA_TYPES.INT32]: { type: { id: 'int', bitWidth: 32, signed: true }, array: Int32Array },
+  [DATA_TYPES.FLOAT32]: { type: { id: 'float', precision: 'single' }, array: Float32Array },
+};
+
+/**
+ * The value column keeps the device's own type when the decoding does not
+ * scale; scaled values and float64 are doubles, booleans are Arrow bools.
+ */
+function valueType(decoding: ValueDecoding): { type: ArrowType; array: (new (length: number) => ValueArray) | null } {
+  const unscaled = decoding.scale === 1 && decoding.bias === 0;
+  if (unscaled && decoding.dataType === DATA_TYPES.BOOLEAN) {
+    return { type: { id: 'bool' }, array: null };
+  }
+  if (unscaled && decoding.dataType && RAW_VALUE_TYPES[decoding.dataType]) {
+    return RAW_VALUE_TYPES[decoding.dataType];
+  }
+  return { type: { id: 'float', precision: 'double' }, array: Float64Array };
+}
+
+// Timestamp quality names as UTF-8, indexed by the flags' quality bits
+const QUALITY_BYTES = QUALITY_CODES.map((code) => Buffer.from(code, 'utf8'));
+
+/**
+ * Utf8 column of timestamp qualities straight from the recorded flags
+ */
+function qualityColumn(flags: Uint8Array): ArrowColumn {
+  const offsets = new Int32Array(flags.length + 1);
+  let total = 0;
+  for (let i = 0; i < flags.length; i++) {
+    offsets[i] = total;
+    total += QUALITY_BYTES[flags[i] >> QUALITY_SHIFT].length;
+  }
+  offsets[flags.length] = total;
+
+  const data = new Uint8Array(total);
+  for (let i = 0; i < flags.length; i++) {
+    data.set(QUALITY_BYTES[flags[i] >> QUALITY_SHIFT], offsets[i]);
+  }
+  return { length: flags.length, nullCount: 0, buffers: [offsets, data] };
+}
+
+export function recordingFields(decoding: ValueDecoding): ArrowField[] {
+  return [
+    { name: 'timestamp', type: { id: 'timestamp', unit: 'us', timezone: 'UTC' }, nullable: false },
+    { name: 'sampleIndex', type: { id: 'int', bitWidth: 64, signed: true }, nullable: false },
+    { name: 'inputValid', type: { id: 'bool' }, nullable: false },
+    { name: 'timestampQuality', type: { id: 'utf8' }, nullable: false },
+    { name: 'value', type: valueType(decoding).type, nullable: true },
+    { name: 'input', type: { id: 'binary' }, nullable: false },
+  ];
+}
+
+/**
+ * One record batch of the samples of a block within [from, to]; null when
+ * none fall in the range. Timestamps and sample indexes are widened to
+ * int64 and values are narrowed to their column type; everything else is
+ * handed over as the decoder's typed arrays.
+ */
+export function recordingBatch(
+  block: DecodedBlock,
+  decoding: ValueDecoding,
+  from: number,
+  to: number
+): Buffer[] | null {
+  let start = 0;
+  while (start < block.count && block.timestamps[start] < from) start++;
+  let end = block.count;
+  while (end > start && block.timestamps[end - 1] > to) end--;
+  const length = end - start;
+  if (length === 0) return null;
+
+  const flags = block.flags.subarray(start, end);
+  const values = block.values.subarray(start, end);
+  const lanes = block.lanes;
+
+  const { bitmap, nullCount } = validityBitmap(
+    length,
+    (row) => (flags[row] & FLAG_INPUT_VALID) !== 0 && !Number.isNaN(values[row])
+  );
+  const { array } = valueType(decoding);
+  let valueColumn: ArrowColumn;
+  if (array === null) {
+    valueColumn = { ...boolColumn(values), validity: bitmap, nullCount };
+  } else if (array === Float64Array) {
+    valueColumn = primitiveColumn(values, bitmap, nullCount);
+  } else {
+    const narrowed = new array(length);
+    for (let i = 0; i < length; i++) {
+      narrowed[i] = Number.isNaN(values[i]) ? 0 : values[i];
+    }
+    valueColumn = primitiveColumn(narrowed, bitmap, nullCount);
+  }
+
+  const inputOffsets = new Int32Array(length + 1);
+  for (let i = 0; i <= length; i++) {
+    inputOffsets[i] = i * lanes;
+  }
+
+  const columns: ArrowColumn[] = [
+    int64Column(block.timestamps.subarray(start, end), 1000),
+    int64Column(block.sampleIndexes.subarray(start, end)),
+    boolColumn(Array.from(flags, (flag) => flag & FLAG_INPUT_VALID)),
+    qualityColumn(flags),
+    valueColumn,
+    {
+      length,
+      nullCount: 0,
+      buffers: [inputOffsets, block.inputs.subarray(start * lanes, end * lanes)],
+    },
+  ];
+  return encodeRecordBatch(length, columns);
+}
+
+/**
+ * Arrow IPC stream of a recording: schema, one batch per block, end marker
+ */
+export async function* recordingArrowStream(
+  blocks: AsyncIterable<DecodedBlock>,
+  decoding: ValueDecoding,
+  from: number,
+  to: number
+): AsyncGenerator<Buffer> {
+  yield encodeSchema(recordingFields(decoding));
+  for await (const block of blocks) {
+    const batch = recordingBatch(block, decoding, from, to);
+    if (batch) yield* batch;
+  }
+  yield ARROW_END_OF_STREAM;
+}
+
+// ============================================================================
+// EVENTS AND LINK STATISTICS
+// ============================================================================
+
+interface EventRow {
+  timestamp: number;
+  masterHandle: number;
+  port: number;
+  eventCode: number;
+  instance: number;
+  mode: number;
+  type: number;
+  localGenerated: boolean;
+}
+
+interface LinkStatisticsSeries {
+  masterHandle: number;
+  port: number;
+  samples: Array<Record<string, number>>;
+}
+
+const msTimestamp: ArrowType = { id: 'timestamp', unit: 'ms', timezone: 'UTC' };
+
+function table(fields: ArrowField[], length: number, columns: ArrowColumn[]): Buffer[] {
+  const chunks = [encodeSchema(fields)];
+  if (length > 0) chunks.push(...encodeRecordBatch(length, columns));
+  chunks.push(ARROW_END_OF_STREAM);
+  return chunks;
+}
+
+export function eventsArrow(events: EventRow[]): Buffer[] {
+  return table(
+    [
+      { name: 'timestamp', type: msTimestamp, nullable: false },
+      { name: 'masterHandle', type: { id: 'int', bitWidth: 32, signed: true }, nullable: false },
+      { name: 'port', type: { id: 'int', bitWidth: 8, signed: false }, nullable: false },
+      { name: 'eventCode', type: { id: 'int', bitWidth: 16, signed: false }, nullable: false },
+      { name: 'eventName', type: { id: 'utf8' }, nullable: false },
+      { name: 'instance', type: { id: 'int', bitWidth: 8, signed: false }, nullable: false },
+      { name: 'mode', type: { id: 'int', bitWidth: 8, signed: false }, nullable: false },
+      { name: 'type', type: { id: 'int', bitWidth: 8, signed: false }, nullable: false },
+      { name: 'localGenerated', type: { id: 'bool' }, nullable: false },
+    ],
+    events.length,
+    [
+      int64Column(events.map((event) => event.timestamp)),
+      primitiveColumn(Int32Array.from(events, (event) => event.masterHandle)),
+      primitiveColumn(Uint8Array.from(events, (event) => event.port)),
+      primitiveColumn(Uint16Array.from(events, (event) => event.eventCode)),
+      variableColumn(
+        events.map((event) => EVENT_CODE_NAMES[event.eventCode] || `0x${event.eventCode.toString(16)}`)
+      ),
+      primitiveColumn(Uint8Array.from(events, (event) => event.instance)),
+      primitiveColumn(Uint8Array.from(events, (event) => event.mode)),
+      primitiveColumn(Uint8Array.from(events, (event) => event.type)),
+      boolColumn(events.map((event) => event.localGenerated)),
+    ]
+  );
+}
+
+export function linkStatisticsArrow(series: LinkStatisticsSeries[]): Buffer[] {
+  const rows = series.flatMap((entry) =>
+    entry.samples.map((sample) => ({ masterHandle: entry.masterHandle, port: entry.port, sample }))
+  );
+  return table(
+    [
+      { name: 'timestamp', type: msTimestamp, nullable: false },
+      { name: 'masterHandle', type: { id: 'int', bitWidth: 32, signed: true }, nullable: false },
+      { name: 'port', type: { id: 'int', bitWidth: 8, signed: false }, nullable: false },
+      { name: 'cycles', type: { id: 'int', bitWidth: 32, signed: false }, nullable: false },
+      { name: 'retries', type: { id: 'int', bitWidth: 32, signed: false }, nullable: false },
+      { name: 'aborts', type: { id: 'int', bitWidth: 32, signed: false }, nullable: false },
+      { name: 'retriesPer1000Cycles', type: { id: 'float', precision: 'single' }, nullable: false },
+    ],
+    rows.length,
+    [
+      int64Column(rows.map((row) => row.sample.timestamp)),
+      primitiveColumn(Int32Array.from(rows, (row) => row.masterHandle)),
+      primitiveColumn(Uint8Array.from(rows, (row) => row.port)),
+      primitiveColumn(Uint32Array.from(rows, (row) => row.sample.cycles)),
+      primitiveColumn(Uint32Array.from(rows, (row) => row.sample.retries)),
+      primitiveColumn(Uint32Array.from(rows, (row) => row.sample.aborts)),
+      primitiveColumn(Float32Array.from(rows, (row) => row.sample.retryRate)),
+    ]
+  );
+}
@@ -0,0 +1,608 @@
+/**
+ * Column Codec
+ * Compressed blocks of recorded channel samples
+ *
+ */
+
+import { LIMITS } from './constants';
+import { PROCESS_DATA_MAX_LENGTH } from './processImage';
+
+// ============================================================================
+// BLOCK FORMAT
+// ============================================================================
+//
+// Little-endian header, then one length-prefixed section per column:
+//
+//   u32 magic 'IOLB' | u8 version | u8 lanes | u16 reserved
+//   u32 count | u32 body length
+//   f64 first timestamp | f64 last timestamp (epoch ms)
+//   body: [u32 length, bytes] x (timestamps, sample indexes, flags, values,
+//         one section per process data input byte)
+//
+// Timestamps are kept at 1 us resolution.
+
+const BLOCK_MAGIC = 0x424c4f49;
+const BLOCK_VERSION = 1;
+export const BLOCK_HEADER_SIZE = 32;
+
+// Values per bit-packed frame; each frame has one width, so a frame decodes
+// in a single fixed-width loop
+const FRAME_SIZE = 128;
+
+export interface BlockHeader {
+  count: number;
+  lanes: number;
+  // Header plus body
+  byteLength: number;
+  firstTimestamp: number;
+  lastTimestamp: number;
+}
+
+export interface DecodedBlock {
+  count: number;
+  timestamps: Float64Array;
+  sampleIndexes: Float64Array;
+  flags: Uint8Array;
+  values: Float64Array;
+  // Input byte i of sample j at inputs[j * lanes + i]
+  lanes: number;
+  inputs: Uint8Array;
+}
+
+// ============================================================================
+// BIT STREAMS
+// ============================================================================
+
+class BitWriter {
+  private bytes: Uint8Array;
+  private length: number;
+  private current: number;
+  private used: number;
+
+  constructor(capacity: number = 1024) {
+    this.bytes = new Uint8Array(capacity);
+    this.length = 0;
+    this.current = 0;
+    this.used = 0;
+  }
+
+  /**
+   * Append the low `width` (0..32) bits of value, most significant first
+   */
+  write(value: number, width: number): void {
+    while (width > 0) {
+      const free = 8 - this.used;
+      const take = free < width ? free : width;
+      const bits = (value >>> (width - take)) & ((1 << take) - 1);
+      this.current |= bits << (free - take);
+      this.used += take;
+      width -= take;
+      if (this.used === 8) {
+        this.pushByte(this.current);
+        this.current = 0;
+        this.used = 0;
+      }
+    }
+  }
+
+  // Width up to 53 bits
+  writeWide(value: number, width: number): void {
+    if (width > 32) {
+      this.write(Math.floor(value / 0x100000000), width - 32);
+      this.write(value % 0x100000000, 32);
+    } else {
+      this.write(value, width);
+    }
+  }
+
+  writeVarint(value: number): void {
+    this.align();
+    while (value >= 0x80) {
+      this.pushByte((value % 0x80) | 0x80);
+      value = Math.floor(value / 0x80);
+    }
+    this.pushByte(value);
+  }
+
+  align(): void {
+    if (this.used > 0) {
+      this.pushByte(this.current);
+      this.current = 0;
+      this.used = 0;
+    }
+  }
+
+  finish(): Uint8Array {
+    this.align();
+    return this.bytes.subarray(0, this.length);
+  }
+
+  private pushByte(byte: number): void {
+    if (this.length === this.bytes.length) {
+      const grown = new Uint8Array(this.bytes.length * 2);
+      grown.set(this.bytes);
+      this.bytes = grown;
+    }
+    this.bytes[this.length++] = byte;
+  }
+}
+
+class BitReader {
+  private bytes: Uint8Array;
+  private position: number;
+  private used: number;
+
+  constructor(bytes: Uint8Array) {
+    this.bytes = bytes;
+    this.position = 0;
+    this.used = 0;
+  }
+
+  read(width: number): number {
+    let result = 0;
+    while (width > 0) {
+      const free = 8 - this.used;
+      const take = free < width ? free : width;
+      const bits = (this.bytes[this.position] >>> (free - take)) & ((1 << take) - 1);
+      result = ((result << take) | bits) >>> 0;
+      this.used += take;
+      width -= take;
+      if (this.used === 8) {
+        this.position++;
+        this.used = 0;
+      }
+    }
+    return result;
+  }
+
+  readWide(width: number): number {
+    if (width > 32) {
+      const high = this.read(width - 32);
+      return high * 0x100000000 + this.read(32);
+    }
+    return this.read(width);
+  }
+
+  readVarint(): number {
+    this.align();
+    let result = 0;
+    let scale = 1;
+    for (;;) {
+      const byte = this.bytes[this.position++];
+      result += (byte & 0x7f) * scale;
+      if (byte < 0x80) return result;
+      scale *= 0x80;
+    }
+  }
+
+  align(): void {
+    if (this.used > 0) {
+      this.position++;
+      this.used = 0;
+    }
+  }
+}
+
+// ============================================================================
+// INTEGER COLUMNS
+// ============================================================================
+
+const zigzag = (value: number): number => (value >= 0 ? value * 2 : -value * 2 - 1);
+const unzigzag = (value: number): number => (value % 2 === 0 ? value / 2 : -(value + 1) / 2);
+
+function bitWidth(value: number): number {
+  if (value < 0x100000000) return 32 - Math.clz32(value);
+  return 64 - Math.clz32(Math.floor(value / 0x100000000));
+}
+
+/**
+ * Frame-of-reference bit-packing of non-negative integers: every frame of
+ * FRAME_SIZE values stores its minimum and the width of (value - minimum).
+ * A constant frame costs two bytes.
+ */
+function packUnsigned(values: Float64Array, count: number, writer: BitWriter): void {
+  for (let start = 0; start < count; start += FRAME_SIZE) {
+    const end = Math.min(start + FRAME_SIZE, count);
+    let min = values[start];
+    let max = values[start];
+    for (let i = start + 1; i < end; i++) {
+      const value = values[i];
+      if (value < min) min = value;
+      if (value > max) max = value;
+    }
+    const width = bitWidth(max - min);
+    writer.writeVarint(min);
+    writer.writeVarint(width);
+    if (width === 0) continue;
+    for (let i = start; i < end; i++) {
+      writer.writeWide(values[i] - min, width);
+    }
+  }
+  writer.align();
+}
+
+function unpackUnsigned(reader: BitReader, count: number, into: Float64Array): void {
+  for (let start = 0; start < count; start += FRAME_SIZE) {
+    const end = Math.min(start + FRAME_SIZE, count);
+    const min = reader.readVarint();
+    const width = reader.readVarint();
+    if (width === 0) {
+      into.fill(min, start, end);
+      continue;
+    }
+    for (let i = start; i < end; i++) {
+      into[i] = min + reader.readWide(width);
+    }
+  }
+  reader.align();
+}
+
+/**
+ * Integers as zigzagged differences of the given order (1 = delta,
+ * 2 = delta-of-delta), bit-packed. The first `order` residuals (the start
+ * value and, for order 2, the first delta) are varints ahead of the frames
+ * so they do not widen the first frame.
+ */
+function encodeDifferences(values: Float64Array, count: number, order: number): Uint8Array {
+  const residuals = new Float64Array(count);
+  let previous = 0;
+  let previousDelta = 0;
+  for (let i = 0; i < count; i++) {
+    const delta = values[i] - previous;
+    residuals[i] = zigzag(order === 2 && i > 0 ? delta - previousDelta : delta);
+    previousDelta = delta;
+    previous = values[i];
+  }
+
+  const head = Math.min(order, count);
+  const writer = new BitWriter(Math.max(64, count));
+  for (let i = 0; i < head; i++) {
+    writer.writeVarint(residuals[i]);
+  }
+  packUnsigned(residuals.subarray(head), count - head, writer);
+  return writer.finish();
+}
+
+function decodeDifferences(bytes: Uint8Array, count: number, order: number, into: Float64Array): void {
+  const reader = new BitReader(bytes);
+  const head = Math.min(order, count);
+  for (let i = 0; i < head; i++) {
+    into[i] = reader.readVarint();
+  }
+  unpackUnsigned(reader, count - head, into.subarray(head));
+
+  let previous = 0;
+  let previousDelta = 0;
+  for (let i = 0; i < count; i++) {
+    const residual = unzigzag(into[i]);
+    const delta = order === 2 && i > 0 ? residual + previousDelta : residual;
+    previous += delta;
+    previousDelta = delta;
+    into[i] = previous;
+  }
+}
+
+// ============================================================================
+// FLOAT COLUMNS
+// ============================================================================
+
+const floatView = new Float64Array(1);
+const wordView = new Uint32Array(floatView.buffer);
+
+function countTrailingZeros(word: number): number {
+  return word === 0 ? 32 : 31 - Math.clz32(word & -word);
+}
+
+/**
+ * XOR compression of doubles (as in Gorilla): each value is XORed with the
+ * previous one; an unchanged value costs one bit, and a change whose
+ * meaningful bits fit the previous window costs two bits plus those bits.
+ */
+function encodeFloats(values: Float64Array, count: number): Uint8Array {
+  const writer = new BitWriter(Math.max(64, count));
+  if (count === 0) return writer.finish();
+
+  floatView[0] = values[0];
+  let previousLow = wordView[0];
+  let previousHigh = wordView[1];
+  writer.write(previousHigh, 32);
+  writer.write(previousLow, 32);
+
+  let windowLeading = -1;
+  let windowTrailing = 0;
+
+  for (let i = 1; i < count; i++) {
+    floatView[0] = values[i];
+    const low = wordView[0];
+    const high = wordView[1];
+    const xorLow = (low ^ previousLow) >>> 0;
+    const xorHigh = (high ^ previousHigh) >>> 0;
+    previousLow = low;
+    previousHigh = high;
+
+    if (xorLow === 0 && xorHigh === 0) {
+      writer.write(0, 1);
+      continue;
+    }
+    writer.write(1, 1);
+
+    let leading = xorHigh !== 0 ? Math.clz32(xorHigh) : 32 + Math.clz32(xorLow);
+    const trailing = xorLow !== 0 ? countTrailingZeros(xorLow) : 32 + countTrailingZeros(xorHigh);
+    if (leading > 31) leading = 31;
+
+    if (windowLeading >= 0 && leading >= windowLeading && trailing >= windowTrailing) {
+      writer.write(0, 1);
+      writeMeaningful(writer, xorHigh, xorLow, windowTrailing, 64 - windowLeading - windowTrailing);
+    } else {
+      const length = 64 - leading - trailing;
+      writer.write(1, 1);
+      writer.write(leading, 5);
+      writer.write(length & 0x3f, 6);
+      writeMeaningful(writer, xorHigh, xorLow, trailing, length);
+      windowLeading = leading;
+      windowTrailing = trailing;
+    }
+  }
+  return writer.finish();
+}
+
+// Bits trailing .. trailing + length - 1 of the 64-bit high:low word
+function writeMeaningful(writer: BitWriter, high: number, low: number, trailing: number, length: number): void {
+  const end = trailing + length;
+  if (end > 32) {
+    const from = trailing > 32 ? trailing : 32;
+    writer.write(high >>> (from - 32), end - from);
+  }
+  if (trailing < 32) {
+    const to = end < 32 ? end : 32;
+    writer.write(low >>> trailing, to - trailing);
+  }
+}
+
+function decodeFloats(bytes: Uint8Array, count: number, into: Float64Array): void {
+  if (count === 0) return;
+  const reader = new BitReader(bytes);
+
+  let high = reader.read(32);
+  let low = reader.read(32);
+  wordView[0] = low;
+  wordView[1] = high;
+  into[0] = floatView[0];
+
+  let leading = 0;
+  let trailing = 0;
+
+  for (let i = 1; i < count; i++) {
+    if (reader.read(1) === 1) {
+      if (reader.read(1) === 1) {
+        leading = reader.read(5);
+        const length = reader.read(6) || 64;
+        trailing = 64 - leading - length;
+      }
+      const end = 64 - leading;
+      let xorHigh = 0;
+      let xorLow = 0;
+      if (end > 32) {
+        const from = trailing > 32 ? trailing : 32;
+        xorHigh = (reader.read(end - from) << (from - 32)) >>> 0;
+      }
+      if (trailing < 32) {
+        const to = end < 32 ? end : 32;
+        xorLow = (reader.read(to - trailing) * 2 ** trailing) >>> 0;
+      }
+      high = (high ^ xorHigh) >>> 0;
+      low = (low ^ xorLow) >>> 0;
+    }
+    wordView[0] = low;
+    wordView[1] = high;
+    into[i] = floatView[0];
+  }
+}
+
+// ============================================================================
+// BLOCKS
+// ============================================================================
+
+export function encodeBlock(
+  count: number,
+  timestamps: Float64Array,
+  sampleIndexes: Float64Array,
+  flags: Uint8Array,
+  values: Float64Array,
+  lanes: number,
+  inputs: Uint8Array
+): Buffer {
+  const micros = new Float64Array(count);
+  for (let i = 0; i < count; i++) {
+    micros[i] = Math.round(timestamps[i] * 1000);
+  }
+  const flagColumn = Float64Array.from(flags.subarray(0, count));
+
+  const sections: Uint8Array[] = [
+    encodeDifferences(micros, count, 2),
+    encodeDifferences(sampleIndexes, count, 2),
+    encodeDifferences(flagColumn, count, 1),
+    encodeFloats(values, count),
+  ];
+  // Input bytes lane by lane, so each lane's slow changes pack together
+  const lane = new Float64Array(count);
+  for (let l = 0; l < lanes; l++) {
+    for (let i = 0; i < count; i++) {
+      lane[i] = inputs[i * lanes + l];
+    }
+    sections.push(encodeDifferences(lane, count, 1));
+  }
+
+  let bodyLength = 0;
+  for (const section of sections) {
+    bodyLength += 4 + section.length;
+  }
+
+  const block = Buffer.allocUnsafe(BLOCK_HEADER_SIZE + bodyLength);
+  block.writeUInt32LE(BLOCK_MAGIC, 0);
+  block.writeUInt8(BLOCK_VERSION, 4);
+  block.writeUInt8(lanes, 5);
+  block.writeUInt16LE(0, 6);
+  block.writeUInt32LE(count, 8);
+  block.writeUInt32LE(bodyLength, 12);
+  block.writeDoubleLE(micros[0] / 1000, 16);
+  block.writeDoubleLE(micros[count - 1] / 1000, 24);
+
+  let offset = BLOCK_HEADER_SIZE;
+  for (const section of sections) {
+    block.writeUInt32LE(section.length, offset);
+    block.set(section, offset + 4);
+    offset += 4 + section.length;
+  }
+  return block;
+}
+
+/**
+ * Header of the block at offset, or null if there is no complete header
+ */
+export function readBlockHeader(buffer: Buffer, offset: number = 0): BlockHeader | null {
+  if (buffer.length - offset < BLOCK_HEADER_SIZE) return null;
+  if (buffer.readUInt32LE(offset) !== BLOCK_MAGIC) {
+    throw new Error(`No recording block at offset ${offset}`);
+  }
+  if (buffer.readUInt8(offset + 4) !== BLOCK_VERSION) {
+    throw new Error(`Unsupported recording block version ${buffer.readUInt8(offset + 4)}`);
+  }
+  return {
+    lanes: buffer.readUInt8(offset + 5),
+    count: buffer.readUInt32LE(offset + 8),
+    byteLength: BLOCK_HEADER_SIZE + buffer.readUInt32LE(offset + 12),
+    firstTimestamp: buffer.readDoubleLE(offset + 16),
+    lastTimestamp: buffer.readDoubleLE(offset + 24),
+  };
+}
+
+export function decodeBlock(block: Buffer): DecodedBlock {
+  const header = readBlockHeader(block);
+  if (!header || block.length < header.byteLength) {
+    throw new Error('Truncated recording block');
+  }
+  const { count, lanes } = header;
+
+  let offset = BLOCK_HEADER_SIZE;
+  const nextSection = (): Uint8Array => {
+    const length = block.readUInt32LE(offset);
+    const section = block.subarray(offset + 4, offset + 4 + length);
+    offset += 4 + length;
+    return section;
+  };
+
+  const timestamps = new Float64Array(count);
+  decodeDifferences(nextSection(), count, 2, timestamps);
+  for (let i = 0; i < count; i++) {
+    timestamps[i] /= 1000;
+  }
+
+  const sampleIndexes = new Float64Array(count);
+  decodeDifferences(nextSection(), count, 2, sampleIndexes);
+
+  const scratch = new Float64Array(count);
+  decodeDifferences(nextSection(), count, 1, scratch);
+  const flags = Uint8Array.from(scratch);
+
+  const values = new Float64Array(count);
+  decodeFloats(nextSection(), count, values);
+
+  const inputs = new Uint8Array(count * lanes);
+  for (let l = 0; l < lanes; l++) {
+    decodeDifferences(nextSection(), count, 1, scratch);
+    for (let i = 0; i < count; i++) {
+      inputs[i * lanes + l] = scratch[i];
+    }
+  }
+
+  return { count, timestamps, sampleIndexes, flags, values, lanes, inputs };
+}
+
+// ============================================================================
+// STREAMING ENCODER
+// ============================================================================
+
+/**
+ * Collects samples of one channel column-wise and seals them into a block
+ * every LIMITS.RECORDING_BLOCK_SAMPLES samples, or earlier when the
+ * process data length changes. Blocks decode independently, so a reader
+ * seeks to the blocks of a time range through their headers alone.
+ */
+export class ChannelBlockEncoder {
+  readonly blockSamples: number;
+  private timestamps: Float64Array;
+  private sampleIndexes: Float64Array;
+  private flags: Uint8Array;
+  private values: Float64Array;
+  private inputs: Uint8Array;
+  private lanes: number;
+  private count: number;
+
+  constructor(blockSamples: number = LIMITS.RECORDING_BLOCK_SAMPLES, maxLanes: number = PROCESS_DATA_MAX_LENGTH) {
+    this.blockSamples = blockSamples;
+    this.timestamps = new Float64Array(blockSamples);
+    this.sampleIndexes = new Float64Array(blockSamples);
+    this.flags = new Uint8Array(blockSamples);
+    this.values = new Float64Array(blockSamples);
+    this.inputs = new Uint8Array(blockSamples * maxLanes);
+    this.lanes = 0;
+    this.count = 0;
+  }
+
+  get pending(): number {
+    return this.count;
+  }
+
+  /**
+   * Add a sample; returns the blocks it sealed (usually none)
+   */
+  push(
+    timestamp: number,
+    sampleIndex: number,
+    flags: number,
+    value: number,
+    inputData: Uint8Array
+  ): Buffer[] {
+    const sealed: Buffer[] = [];
+    if (this.count > 0 && inputData.length !== this.lanes) {
+      sealed.push(this.seal());
+    }
+    if (this.count === 0) {
+      this.lanes = inputData.length;
+    }
+
+    const i = this.count++;
+    this.timestamps[i] = timestamp;
+    this.sampleIndexes[i] = sampleIndex;
+    this.flags[i] = flags;
+    this.values[i] = value;
+    this.inputs.set(inputData, i * this.lanes);
+
+    if (this.count === this.blockSamples) {
+      sealed.push(this.seal());
+    }
+    return sealed;
+  }
+
+  /**
+   * Seal the pending samples, if any
+   */
+  flush(): Buffer | null {
+    return this.count > 0 ? this.seal() : null;
+  }
+
+  private seal(): Buffer {
+    const block = encodeBlock(
+      this.count,
+      this.timestamps,
+      this.sampleIndexes,
+      this.flags,
+      this.values,
+      this.lanes,
+      this.inputs
+    );
+    this.count = 0;
+    return block;
+  }
+}
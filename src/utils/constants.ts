@@ -12,8 +12,20 @@ export const RETURN_CODES = {
   RETURN_OK: 0,
   RETURN_INTERNAL_ERROR: -1,
   RETURN_DEVICE_NOT_AVAILABLE: -2,
+  RETURN_DEVICE_ERROR: -3,
+  RETURN_OUT_OF_MEMORY: -4,
+  RETURN_CONNECTION_LOST: -5,
+  RETURN_UART_TIMEOUT: -6,
   RETURN_UNKNOWN_HANDLE: -7,
+  RETURN_NO_EVENT: -8,
+  RETURN_WRONG_DEVICE: -9,
   RETURN_WRONG_PARAMETER: -10,
+  RETURN_WRONG_COMMAND: -11,
+  RETURN_STATE_CONFLICT: -12,
+  RETURN_FUNCTION_NOT_IMPLEMENTED: -13,
+  RETURN_FUNCTION_DELAYED: -14,
+  RETURN_FUNCTION_CALLEDFROMCALLBACK: -15,
+  RETURN_FIRMWARE_NOT_COMPATIBLE: -16,
 } as const;
 
 export type ReturnCode = typeof RETURN_CODES[keyof typeof RETURN_CODES];
@@ -22,8 +34,20 @@ export const RETURN_CODE_MESSAGES: Record<number, string> = {
   [RETURN_CODES.RETURN_OK]: 'Operation successful',
   [RETURN_CODES.RETURN_INTERNAL_ERROR]: 'Internal DLL error',
   [RETURN_CODES.RETURN_DEVICE_NOT_AVAILABLE]: 'Device not available',
+  [RETURN_CODES.RETURN_DEVICE_ERROR]: 'Device error',
+  [RETURN_CODES.RETURN_OUT_OF_MEMORY]: 'Out of memory',
+  [RETURN_CODES.RETURN_CONNECTION_LOST]: 'Connection to master lost',
+  [RETURN_CODES.RETURN_UART_TIMEOUT]: 'UART timeout',
   [RETURN_CODES.RETURN_UNKNOWN_HANDLE]: 'Unknown handle',
+  [RETURN_CODES.RETURN_NO_EVENT]: 'No event available',
+  [RETURN_CODES.RETURN_WRONG_DEVICE]: 'Wrong device',
   [RETURN_CODES.RETURN_WRONG_PARAMETER]: 'Wrong parameter',
+  [RETURN_CODES.RETURN_WRONG_COMMAND]: 'Wrong command',
+  [RETURN_CODES.RETURN_STATE_CONFLICT]: 'State conflict',
+  [RETURN_CODES.RETURN_FUNCTION_NOT_IMPLEMENTED]: 'Function not implemented',
+  [RETURN_CODES.RETURN_FUNCTION_DELAYED]: 'Function delayed',
+  [RETURN_CODES.RETURN_FUNCTION_CALLEDFROMCALLBACK]: 'Function called from callback',
+  [RETURN_CODES.RETURN_FIRMWARE_NOT_COMPATIBLE]: 'Firmware not compatible',
 };
 
 // ============================================================================
@@ -72,6 +96,204 @@ export const SENSOR_STATUS_NAMES: Record<number, string> = {
   [SENSOR_STATUS.BIT_SENSORSTATEKNOWN]: 'SENSOR_STATE_KNOWN',
 };
 
+// Bits that describe the port's device state (connected, preoperate, wrong
+// sensor). PD-valid and event-available toggle during normal operation.
+export const SENSOR_STATE_MASK = 0x13;
+
+// ============================================================================
+// EVENTS
+// ============================================================================
+
+export const EVENT_CODES = {
+  EVNT_CODE_M_PDU_CHECK: 2,
+  EVNT_CODE_S_DEVICELOST: 16,
+  EVNT_CODE_S_WRONGSENSOR: 26,
+  EVNT_CODE_S_RETRY: 27,
+  EVNT_CODE_P_SHORT: 30,
+  EVNT_CODE_P_SENSOR: 31,
+  EVNT_CODE_P_ACTOR: 32,
+  EVNT_CODE_P_POWER: 33,
+  EVNT_CODE_P_RESET: 34,
+  EVNT_CODE_S_FALLBACK: 35,
+  EVNT_CODE_M_PREOPERATE: 36,
+  EVNT_CODE_DSREADY_NOACTION: 40,
+  DS_FAULT_IDENT: 41,
+  DS_FAULT_SIZE: 42,
+  DS_FAULT_UPLOAD: 43,
+  DS_FAULT_DOWNLOAD: 44,
+  DS_FAULT_DEVICE_LOCKED: 47,
+  EVNT_CODE_DSREADY_DOWNLOAD: 50,
+  EVNT_CODE_DSREADY_UPLOAD: 51,
+} as const;
+
+export const EVENT_MODES = {
+  EVNT_MODE_SINGLE: 0x40,
+  EVNT_MODE_COMING: 0xc0,
+  EVNT_MODE_GOING: 0x80,
+} as const;
+
+export const EVENT_CODE_NAMES: Record<number, string> = {
+  [EVENT_CODES.EVNT_CODE_M_PDU_CHECK]: 'PDU_CHECK',
+  [EVENT_CODES.EVNT_CODE_S_DEVICELOST]: 'DEVICE_LOST',
+  [EVENT_CODES.EVNT_CODE_S_WRONGSENSOR]: 'WRONG_SENSOR',
+  [EVENT_CODES.EVNT_CODE_S_RETRY]: 'RETRY',
+  [EVENT_CODES.EVNT_CODE_P_SHORT]: 'SHORT_CIRCUIT',
+  [EVENT_CODES.EVNT_CODE_P_SENSOR]: 'SENSOR_SUPPLY',
+  [EVENT_CODES.EVNT_CODE_P_ACTOR]: 'ACTOR_SUPPLY',
+  [EVENT_CODES.EVNT_CODE_P_POWER]: 'POWER_SUPPLY',
+  [EVENT_CODES.EVNT_CODE_P_RESET]: 'PORT_RESET',
+  [EVENT_CODES.EVNT_CODE_S_FALLBACK]: 'FALLBACK',
+  [EVENT_CODES.EVNT_CODE_M_PREOPERATE]: 'PREOPERATE',
+  [EVENT_CODES.EVNT_CODE_DSREADY_NOACTION]: 'DS_READY_NOACTION',
+  [EVENT_CODES.DS_FAULT_IDENT]: 'DS_FAULT_IDENT',
+  [EVENT_CODES.DS_FAULT_SIZE]: 'DS_FAULT_SIZE',
+  [EVENT_CODES.DS_FAULT_UPLOAD]: 'DS_FAULT_UPLOAD',
+  [EVENT_CODES.DS_FAULT_DOWNLOAD]: 'DS_FAULT_DOWNLOAD',
+  [EVENT_CODES.DS_FAULT_DEVICE_LOCKED]: 'DS_FAULT_DEVICE_LOCKED',
+  [EVENT_CODES.EVNT_CODE_DSREADY_DOWNLOAD]: 'DS_READY_DOWNLOAD',
+  [EVENT_CODES.EVNT_CODE_DSREADY_UPLOAD]: 'DS_READY_UPLOAD',
+};
+
+// ============================================================================
+// DATA STORAGE
+// ============================================================================
+
+export const DS_COMMANDS = {
+  DS_CMD_UPLOAD: 0x01,
+  DS_CMD_DOWNLOAD: 0x02,
+  DS_CMD_CLEAR: 0x03,
+} as const;
+
+// Events that end a data storage upload or download on a port
+export const DS_COMPLETION_EVENTS: number[] = [
+  EVENT_CODES.EVNT_CODE_DSREADY_NOACTION,
+  EVENT_CODES.EVNT_CODE_DSREADY_DOWNLOAD,
+  EVENT_CODES.EVNT_CODE_DSREADY_UPLOAD,
+  EVENT_CODES.DS_FAULT_IDENT,
+  EVENT_CODES.DS_FAULT_SIZE,
+  EVENT_CODES.DS_FAULT_UPLOAD,
+  EVENT_CODES.DS_FAULT_DOWNLOAD,
+  EVENT_CODES.DS_FAULT_DEVICE_LOCKED,
+];
+
+// ============================================================================
+// PROCESS DATA LOGGING
+// ============================================================================
+
+export const LOGGING_MODES = {
+  TIME: 0, // pSampleTime in microseconds
+  CYCLES: 1, // pSampleTime in master cycles
+} as const;
+
+// Bits of the IOL_ReadLoggingBuffer status
+export const LOGGING_STATUS = {
+  RUNNING: 1,
+  AVAILABLE: 2,
+  OVERRUN: 4, // logging has stopped until restarted
+} as const;
+
+// InValidity byte of a logging entry
+export const LOGGING_INPUTS_INVALID = 0x40;
+
+// ============================================================================
+// BLOB TRANSFER
+// ============================================================================
+
+export const BLOB_STATES = {
+  BLOB_STATE_IDLE: 0,
+  BLOB_STATE_PREPARE_DOWNLOAD: 1,
+  BLOB_STATE_DOWNLOAD: 2,
+  BLOB_STATE_FINALIZE_DOWNLOAD: 3,
+  BLOB_STATE_PREPARE_UPLOAD: 4,
+  BLOB_STATE_UPLOAD: 5,
+  BLOB_STATE_FINALIZE_UPLOAD: 6,
+  BLOB_STATE_ERROR: 7,
+} as const;
+
+export const BLOB_RETURN_CODES = {
+  BLOB_RET_OK: 0,
+  BLOB_RET_ERROR_BUSY: 1,
+  BLOB_RET_ERROR_ISDU_READ: 2,
+  BLOB_RET_ERROR_ISDU_WRITE: 3,
+  BLOB_RET_ERROR_STATECONFLICT: 4,
+  BLOB_RET_ERROR_CHECKBLOBINFO_FAILED: 5,
+  BLOB_RET_ERROR_WRONGCRC: 6,
+  BLOB_RET_ERROR_SIZEOVERRUN: 7,
+  BLOB_RET_ERROR_STOPPED: 8,
+} as const;
+
+export const BLOB_RETURN_MESSAGES: Record<number, string> = {
+  [BLOB_RETURN_CODES.BLOB_RET_OK]: 'BLOB transfer successful',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_BUSY]: 'Another BLOB service is pending',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_ISDU_READ]: 'ISDU read failed',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_ISDU_WRITE]: 'ISDU write failed',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_STATECONFLICT]: 'BLOB state conflict',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_CHECKBLOBINFO_FAILED]: 'BLOB info check failed',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_WRONGCRC]: 'BLOB CRC mismatch',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_SIZEOVERRUN]: 'BLOB larger than buffer',
+  [BLOB_RETURN_CODES.BLOB_RET_ERROR_STOPPED]: 'BLOB transfer stopped',
+};
+
+// ============================================================================
+// FIRMWARE UPDATE
+// ============================================================================
+
+export const FWUPDATE_STATES = {
+  FWUPDATE_STATE_IDLE: 0,
+  FWUPDATE_STATE_IDENTIFICATION: 1,
+  FWUPDATE_STATE_VERIFICATION: 2,
+  FWUPDATE_STATE_PASSWORD: 3,
+  FWUPDATE_STATE_SWITCHTOBOOTLOADER: 4,
+  FWUPDATE_STATE_WAITREBOOT: 5,
+  FWUPDATE_STATE_STARTDOWNLOAD: 6,
+  FWUPDATE_STATE_DOWNLOADFIRMWARE: 7,
+  FWUPDATE_STATE_ACTIVATENEWFIRMWARE: 8,
+  FWUPDATE_STATE_WAITACTIVATE: 9,
+  FWUPDATE_STATE_CHECKNEWFIRMWARE: 10,
+  FWUPDATE_STATE_ERROR: 11,
+} as const;
+
+export const FWUPDATE_STATE_NAMES: Record<number, string> = {
+  [FWUPDATE_STATES.FWUPDATE_STATE_IDLE]: 'IDLE',
+  [FWUPDATE_STATES.FWUPDATE_STATE_IDENTIFICATION]: 'IDENTIFICATION',
+  [FWUPDATE_STATES.FWUPDATE_STATE_VERIFICATION]: 'VERIFICATION',
+  [FWUPDATE_STATES.FWUPDATE_STATE_PASSWORD]: 'PASSWORD',
+  [FWUPDATE_STATES.FWUPDATE_STATE_SWITCHTOBOOTLOADER]: 'SWITCH_TO_BOOTLOADER',
+  [FWUPDATE_STATES.FWUPDATE_STATE_WAITREBOOT]: 'WAIT_REBOOT',
+  [FWUPDATE_STATES.FWUPDATE_STATE_STARTDOWNLOAD]: 'START_DOWNLOAD',
+  [FWUPDATE_STATES.FWUPDATE_STATE_DOWNLOADFIRMWARE]: 'DOWNLOAD_FIRMWARE',
+  [FWUPDATE_STATES.FWUPDATE_STATE_ACTIVATENEWFIRMWARE]: 'ACTIVATE_NEW_FIRMWARE',
+  [FWUPDATE_STATES.FWUPDATE_STATE_WAITACTIVATE]: 'WAIT_ACTIVATE',
+  [FWUPDATE_STATES.FWUPDATE_STATE_CHECKNEWFIRMWARE]: 'CHECK_NEW_FIRMWARE',
+  [FWUPDATE_STATES.FWUPDATE_STATE_ERROR]: 'ERROR',
+};
+
+export const FWUPDATE_RETURN_CODES = {
+  FWUPDATE_RET_OK: 0,
+  FWUPDATE_RET_ERROR_BUSY: 1,
+  FWUPDATE_RET_ERROR_WRONG_VENDORID: 2,
+  FWUPDATE_RET_ERROR_WRONG_REVISION: 3,
+  FWUPDATE_RET_ERROR_WRONG_HWKEY: 4,
+  FWUPDATE_RET_ERROR_WRONG_BOOTSTATUS: 5,
+  FWUPDATE_RET_ERROR_BOOT_MODE_NOT_REACHED: 6,
+  FWUPDATE_RET_ERROR_ACTIVATION_FAILED: 7,
+  FWUPDATE_RET_ERROR_BLOB_ERROR: 8,
+  FWUPDATE_RET_ERROR_XML_ERROR: 9,
+} as const;
+
+export const FWUPDATE_RETURN_MESSAGES: Record<number, string> = {
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_OK]: 'Firmware update step successful',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_BUSY]: 'Another firmware update is pending',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_WRONG_VENDORID]: 'Firmware is for a different vendor',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_WRONG_REVISION]: 'Device does not support firmware update',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_WRONG_HWKEY]: 'Firmware does not match the hardware key',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_WRONG_BOOTSTATUS]: 'Unexpected bootloader status',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_BOOT_MODE_NOT_REACHED]: 'Device did not enter the bootloader',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_ACTIVATION_FAILED]: 'Activation of the new firmware failed',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_BLOB_ERROR]: 'Firmware BLOB transfer failed',
+  [FWUPDATE_RETURN_CODES.FWUPDATE_RET_ERROR_XML_ERROR]: 'Firmware metafile could not be parsed',
+};
+
 // ============================================================================
 // VALIDATION MODES
 // ============================================================================
@@ -224,6 +446,36 @@ export const STANDARD_PARAMETERS: Record<number, ParameterDefinition> = {
   },
 };
 
+// ============================================================================
+// RECORD LAYOUTS
+// ============================================================================
+
+// Position of a subindex inside a record parameter. As in the IODD, the bit
+// offset is counted from the least significant bit of the last octet.
+export interface RecordItemLayout {
+  subIndex: number;
+  bitOffset: number;
+  bitLength: number;
+}
+
+// Subindices of Direct Parameter Page 1 (ISDU index 0); the PARAMETER_INDEX
+// entries of the same names are octet positions, not ISDU indices
+export const DIRECT_PARAMETER_SUBINDEX = {
+  MASTER_CYCLE_TIME: 2,
+  MIN_CYCLE_TIME: 3,
+} as const;
+
+// Records whose layout is fixed by the IO-Link specification. Vendor records
+// can be passed with the request (taken from the device's IODD).
+export const RECORD_LAYOUTS: Record<number, RecordItemLayout[]> = {
+  // Direct Parameter Page 1: subindex n is octet n-1
+  [PARAMETER_INDEX.DIRECT_PARAMETER_PAGE]: Array.from({ length: 16 }, (_, i) => ({
+    subIndex: i + 1,
+    bitOffset: (15 - i) * 8,
+    bitLength: 8,
+  })),
+};
+
 // ============================================================================
 // VENDOR IDENTIFIERS
 // ============================================================================
@@ -303,10 +555,12 @@ export type ApiErrorCode = typeof API_ERROR_CODES[keyof typeof API_ERROR_CODES];
 // ============================================================================
 
 export const LIMITS = {
+  MAX_MASTERS: 16,
   MAX_PORTS: 8,
   MIN_PORT: 1,
   MAX_PROCESS_DATA_LENGTH: 32,
   MAX_PARAMETER_LENGTH: 256,
+  MAX_BLOB_SIZE: 4 * 1024 * 1024,
   DEFAULT_TIMEOUT: 5000,
   MAX_RETRY_ATTEMPTS: 3,
   CACHE_TTL_PROCESS_DATA: 1000,
@@ -314,6 +568,64 @@ export const LIMITS = {
   STREAM_INTERVAL_MIN: 100,
   STREAM_INTERVAL_DEFAULT: 1000,
   STREAM_INTERVAL_MAX: 60000,
+  PARAMETER_POLL_BACKOFF: 1.5,
+  PARAMETER_KEEPALIVE_INTERVAL: 15000,
+  MASTER_WATCH_INTERVAL_DEFAULT: 2000,
+  PORT_STATUS_POLL_INTERVAL: 50, // status bytes of IO-Link ports only
+  PORT_RECONCILE_INTERVAL: 60000,
+  EVENT_LOG_SIZE: 10000, // master events kept for export
+  MAX_FIRMWARE_SIZE: 16 * 1024 * 1024,
+  FIRMWARE_WAIT_POLL_INTERVAL: 500,
+  FIRMWARE_WAIT_TIMEOUT: 120000,
+  MAX_FIRMWARE_JOBS: 128,
+  MAX_DS_CONTENT_SIZE: 4096,
+  DS_COMMAND_TIMEOUT: 15000,
+  LINK_QUALITY_INTERVAL_DEFAULT: 10000,
+  LINK_QUALITY_HISTORY: 360,
+  LINK_QUALITY_SUMMARY_WINDOW: 30,
+  LINK_QUALITY_RETRY_RATE_WARN: 1,
+  TRACE_BUFFER_SIZE: 20000,
+  TRACE_FLUSH_INTERVAL: 1000,
+  TRACE_MAX_FILE_SIZE: 256 * 1024 * 1024,
+  PROCESS_IMAGE_INTERVAL_DEFAULT: 100,
+  PROCESS_IMAGE_STALE_FACTOR: 3,
+  RATE_LIMIT_STORE_TIMEOUT: 1000, // worker wait for the owner's hit counter
+  MASTER_THREAD_STALL_TIMEOUT: 5000,
+  PROCESS_DATA_PERIOD_MIN: 0.4,
+  PROCESS_DATA_PERIOD_DEFAULT: 50,
+  PROCESS_DATA_PERIOD_MAX: 60000,
+  OUTPUT_COMMIT_TIMEOUT: 1000, // wait for a confirmed output write
+  SCHEDULER_SPIN_US: 200,
+  LOGGING_CLOCK_CORRECTION_INTERVAL: 1000,
+  LOGGING_CLOCK_MAX_DRIFT_PPM: 1000,
+  LOGGING_SAMPLE_TIME_MIN: 100, // µs
+  LOGGING_SAMPLE_TIME_DEFAULT: 1000,
+  LOGGING_SAMPLE_TIME_MAX: 60000000,
+  LOGGING_MEMORY_MIN: 4096, // bytes of master logging buffer per port
+  LOGGING_MEMORY_MAX: 1048576,
+  LOGGING_BUFFER_HEADROOM_MS: 2000,
+  LOGGING_READ_BUFFER: 65536,
+  LOGGING_DRAIN_INTERVAL: 20, // first drain; then adapted to the fill level
+  LOGGING_DRAIN_INTERVAL_MIN: 2,
+  LOGGING_DRAIN_INTERVAL_MAX: 250,
+  LOGGING_DRAIN_TARGET_FILL: 0.25, // of the buffer between two drains
+  LOGGING_RING_SIZE: 16384, // samples kept per port
+  LOGGING_SAMPLES_MAX: 5000, // samples per request
+  HISTORY_BASE_MS: 1, // finest pyramid bucket
+  HISTORY_LEVELS: 24,
+  HISTORY_LEVEL_BUCKETS: 8192,
+  HISTORY_POINTS_DEFAULT: 1000,
+  HISTORY_POINTS_MAX: 10000,
+  HISTORY_RANGE_DEFAULT: 60 * 60 * 1000,
+  RECORDING_BLOCK_SAMPLES: 4096, // samples per compressed block
+  RECORDING_SAMPLES_MAX: 10000, // samples per request
+  MASTER_CLOCK_INTERVAL_DEFAULT: 1000,
+  MASTER_CLOCK_WINDOW: 60,
+  MERGE_MAX_DELAY_DEFAULT: 250,
+  MERGE_MAX_DELAY_MAX: 10000,
+  RULES_MAX: 10000,
+  RULES_SCAN_INTERVAL: 10, // process image scan for ports that are not logged
+  ALARM_LOG_SIZE: 1000,
 } as const;
 
 // ============================================================================
@@ -385,6 +697,31 @@ export function isValidPort(port: number): boolean {
   );
 }
 
+export function getMaxMasters(): number {
+  const configured = parseInt(process.env.IOLINK_MAX_MASTERS || '', 10);
+  return Number.isInteger(configured) && configured > 0
+    ? configured
+    : LIMITS.MAX_MASTERS;
+}
+
+/**
+ * Decode an IO-Link cycle time byte (MinCycleTime, MasterCycleTime) to ms:
+ * bits 7-6 select the time base, bits 5-0 are the multiplier
+ */
+export function decodeCycleTime(value: number): number {
+  const multiplier = value & 0x3f;
+  switch ((value >> 6) & 0x03) {
+    case 0:
+      return multiplier * 0.1;
+    case 1:
+      return 6.4 + multiplier * 0.4;
+    case 2:
+      return 32 + multiplier * 1.6;
+    default:
+      return NaN;
+  }
+}
+
 export function isValidDataType(dataType: string): boolean {
   return Object.values(DATA_TYPES).includes(dataType as any);
 }
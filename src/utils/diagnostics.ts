@@ -1,8 +1,422 @@
 /**
  * Diagnostics Utility
  * Diagnostic utilities for the IO-Link interface
- * 
+ *
  */
 
-// Placeholder for future diagnostic functionality
-export {};
+import { performance } from 'perf_hooks';
+import { Request, Response, NextFunction } from 'express';
+import { tracer } from './tracing';
+
+// ============================================================================
+// PROMETHEUS EXPOSITION
+// ============================================================================
+
+export const PROMETHEUS_CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8';
+
+export type PrometheusMetricType = 'gauge' | 'counter' | 'histogram' | 'summary' | 'untyped';
+
+export interface PrometheusSample {
+  labels?: Record<string, string | number>;
+  value: number;
+  // Appended to the metric name, e.g. "_bucket" or "_sum" for histograms
+  suffix?: string;
+}
+
+export interface PrometheusMetric {
+  name: string;
+  help: string;
+  type: PrometheusMetricType;
+  samples: PrometheusSample[];
+}
+
+function escapeLabelValue(value: string): string {
+  return value.replace(/\\/g, '\\\\').replace(/\n/g, '\\n').replace(/"/g, '\\"');
+}
+
+function formatValue(value: number): string {
+  if (Number.isNaN(value)) return 'NaN';
+  if (value === Infinity) return '+Inf';
+  if (value === -Infinity) return '-Inf';
+  return String(value);
+}
+
+/**
+ * Render metrics in the Prometheus text exposition format.
+ */
+export function formatPrometheus(metrics: PrometheusMetric[]): string {
+  const lines: string[] = [];
+
+  for (const metric of metrics) {
+    lines.push(`# HELP ${metric.name} ${metric.help}`);
+    lines.push(`# TYPE ${metric.name} ${metric.type}`);
+
+    for (const sample of metric.samples) {
+      const labels = sample.labels
+        ? Object.entries(sample.labels)
+            .map(([key, value]) => `${key}="${escapeLabelValue(String(value))}"`)
+            .join(',')
+        : '';
+      const name = metric.name + (sample.suffix || '');
+      lines.push(
+        `${name}${labels ? `{${labels}}` : ''} ${formatValue(sample.value)}`
+      );
+    }
+  }
+
+  return lines.join('\n') + '\n';
+}
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+
+// Log-linear buckets in microseconds: values below 16us get their own bucket,
+// above that every power of two is split into 16 sub-buckets, bounding the
+// relative error to 1/16 over 1us .. ~71min in 464 counters
+const SUB_BUCKET_BITS = 4;
+const SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const BUCKET_COUNT = SUB_BUCKETS + (32 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+const MAX_TRACKED_US = 0xffffffff;
+
+function bucketIndex(us: number): number {
+  if (us < SUB_BUCKETS) return us;
+  const exponent = 31 - Math.clz32(us);
+  const shift = exponent - SUB_BUCKET_BITS;
+  return SUB_BUCKETS + shift * SUB_BUCKETS + ((us >>> shift) & (SUB_BUCKETS - 1));
+}
+
+function bucketUpperBound(index: number): number {
+  if (index < SUB_BUCKETS) return index + 1;
+  const shift = (index - SUB_BUCKETS) >> SUB_BUCKET_BITS;
+  const sub = (index - SUB_BUCKETS) & (SUB_BUCKETS - 1);
+  return (SUB_BUCKETS + sub + 1) * 2 ** shift;
+}
+
+// Prometheus bucket boundaries in seconds
+const PROMETHEUS_BUCKETS = [
+  0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25,
+  0.5, 1, 2.5, 5, 10,
+];
+
+export class LatencyHistogram {
+  private counts: Float64Array;
+  count: number;
+  sumUs: number;
+  minUs: number;
+  maxUs: number;
+
+  constructor() {
+    this.counts = new Float64Array(BUCKET_COUNT);
+    this.count = 0;
+    this.sumUs = 0;
+    this.minUs = Infinity;
+    this.maxUs = 0;
+  }
+
+  record(us: number): void {
+    const value = us < 0 ? 0 : us > MAX_TRACKED_US ? MAX_TRACKED_US : Math.round(us);
+    this.counts[bucketIndex(value)]++;
+    this.count++;
+    this.sumUs += value;
+    if (value < this.minUs) this.minUs = value;
+    if (value > this.maxUs) this.maxUs = value;
+  }
+
+  /**
+   * Upper bound of the bucket holding the given percentile (0-100).
+   */
+  percentile(p: number): number {
+    if (this.count === 0) return 0;
+    const rank = Math.max(1, Math.ceil((p / 100) * this.count));
+    let seen = 0;
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      seen += this.counts[i];
+      if (seen >= rank) {
+        return Math.min(bucketUpperBound(i), this.maxUs);
+      }
+    }
+    return this.maxUs;
+  }
+
+  /**
+   * Cumulative counts at the given boundaries (microseconds).
+   */
+  cumulative(boundsUs: number[]): number[] {
+    const result: number[] = [];
+    let index = 0;
+    let seen = 0;
+    for (const bound of boundsUs) {
+      while (index < BUCKET_COUNT && bucketUpperBound(index) <= bound) {
+        seen += this.counts[index];
+        index++;
+      }
+      result.push(seen);
+    }
+    return result;
+  }
+
+  summary(): Record<string, number> {
+    return {
+      count: this.count,
+      minUs: this.count ? this.minUs : 0,
+      meanUs: this.count ? Math.round(this.sumUs / this.count) : 0,
+      p50Us: this.percentile(50),
+      p90Us: this.percentile(90),
+      p99Us: this.percentile(99),
+      p999Us: this.percentile(99.9),
+      maxUs: this.maxUs,
+    };
+  }
+}
+
+// ============================================================================
+// LATENCY REGISTRY
+// ============================================================================
+
+interface HistogramSeries {
+  labels: Record<string, string>;
+  histogram: LatencyHistogram;
+}
+
+interface HistogramFamily {
+  name: string;
+  help: string;
+  labelNames: string[];
+  series: Map<string, HistogramSeries>;
+}
+
+/**
+ * Named families of latency histograms, one histogram per label set.
+ * Recording is a string key lookup plus a bucket increment.
+ */
+class LatencyRegistry {
+  private families: Map<string, HistogramFamily>;
+
+  constructor() {
+    this.families = new Map();
+  }
+
+  define(name: string, help: string, labelNames: string[]): void {
+    if (!this.families.has(name)) {
+      this.families.set(name, { name, help, labelNames, series: new Map() });
+    }
+  }
+
+  record(name: string, labelValues: Array<string | number>, us: number): void {
+    const family = this.families.get(name);
+    if (!family) return;
+
+    const key = labelValues.join('|');
+    let series = family.series.get(key);
+    if (!series) {
+      const labels: Record<string, string> = {};
+      family.labelNames.forEach((label, i) => {
+        labels[label] = String(labelValues[i]);
+      });
+      series = { labels, histogram: new LatencyHistogram() };
+      family.series.set(key, series);
+    }
+    series.histogram.record(us);
+  }
+
+  reset(): void {
+    for (const family of this.families.values()) {
+      family.series.clear();
+    }
+  }
+
+  toJSON(familyName?: string): Record<string, any[]> {
+    const result: Record<string, any[]> = {};
+    for (const family of this.families.values()) {
+      if (familyName && family.name !== familyName) continue;
+      result[family.name] = Array.from(family.series.values())
+        .map((series) => ({ ...series.labels, ...series.histogram.summary() }))
+        .sort((a, b) => b.count - a.count);
+    }
+    return result;
+  }
+
+  toPrometheus(): PrometheusMetric[] {
+    const boundsUs = PROMETHEUS_BUCKETS.map((seconds) => seconds * 1e6);
+
+    return Array.from(this.families.values()).map((family) => {
+      const samples: PrometheusSample[] = [];
+      for (const series of family.series.values()) {
+        const { histogram, labels } = series;
+        histogram.cumulative(boundsUs).forEach((count, i) => {
+          samples.push({
+            suffix: '_bucket',
+            labels: { ...labels, le: PROMETHEUS_BUCKETS[i] },
+            value: count,
+          });
+        });
+        samples.push({ suffix: '_bucket', labels: { ...labels, le: '+Inf' }, value: histogram.count });
+        samples.push({ suffix: '_sum', labels, value: histogram.sumUs / 1e6 });
+        samples.push({ suffix: '_count', labels, value: histogram.count });
+      }
+      return {
+        name: family.name,
+        help: family.help,
+        type: 'histogram' as PrometheusMetricType,
+        samples,
+      };
+    });
+  }
+}
+
+export const latencyRegistry = new LatencyRegistry();
+
+export const DLL_CALL_METRIC = 'iolink_dll_call_duration_seconds';
+export const HTTP_REQUEST_METRIC = 'iolink_http_request_duration_seconds';
+export const SOCKET_EVENT_METRIC = 'iolink_socket_event_duration_seconds';
+
+latencyRegistry.define(
+  DLL_CALL_METRIC,
+  'DLL call latency (async calls include thread pool queueing)',
+  ['function', 'code', 'master', 'port']
+);
+latencyRegistry.define(
+  HTTP_REQUEST_METRIC,
+  'HTTP request latency by route',
+  ['method', 'route', 'status']
+);
+latencyRegistry.define(
+  SOCKET_EVENT_METRIC,
+  'Socket.IO event handler latency',
+  ['event']
+);
+
+// ============================================================================
+// INSTRUMENTATION
+// ============================================================================
+
+interface InstrumentOptions {
+  // Functions without a port as second argument
+  portless?: string[];
+  // Functions returning a value (count, handle) instead of a status code
+  valueReturning?: string[];
+}
+
+// Shape of the IO-Link master DLL: (handle, port, ...) unless listed here
+export const IOLINK_DLL_INSTRUMENTATION: InstrumentOptions = {
+  portless: [
+    'IOL_GetUSBDevices',
+    'IOL_Create',
+    'IOL_Destroy',
+    'IOL_ReadEvent',
+    'IOL_GetHWInfo',
+    'IOL_StopDataLogging',
+    'IOL_ReadLoggingBuffer',
+  ],
+  valueReturning: ['IOL_GetUSBDevices', 'IOL_Create'],
+};
+
+/**
+ * Wrap every function of an ffi library (and its `.async` variant) so that
+ * each call is recorded by function, return code, master handle and port.
+ */
+export function instrumentLibrary<T extends Record<string, any>>(
+  library: T,
+  options: InstrumentOptions = {}
+): T {
+  const portless = new Set(options.portless || []);
+  const valueReturning = new Set(options.valueReturning || []);
+
+  for (const name of Object.keys(library)) {
+    const original = library[name];
+    if (typeof original !== 'function') continue;
+
+    const hasPort = !portless.has(name);
+    const returnsValue = valueReturning.has(name);
+
+    const labelsFor = (args: any[], result: any): Array<string | number> => [
+      name,
+      returnsValue && result >= 0 ? 'ok' : result,
+      typeof args[0] === 'number' ? args[0] : '',
+      hasPort && typeof args[1] === 'number' ? args[1] + 1 : '',
+    ];
+
+    const record = (args: any[], result: any, start: number, context: any) => {
+      const end = performance.now();
+      const labels = labelsFor(args, result);
+      latencyRegistry.record(DLL_CALL_METRIC, labels, (end - start) * 1000);
+      if (context) {
+        tracer.span(context, name, 'dll', start, end, { code: labels[1], port: labels[3] });
+      }
+    };
+
+    const wrapped: any = (...args: any[]) => {
+      const context = tracer.current();
+      const start = performance.now();
+      const result = original(...args);
+      record(args, result, start, context);
+      return result;
+    };
+
+    if (typeof original.async === 'function') {
+      wrapped.async = (...args: any[]) => {
+        const callback = args.pop();
+        const context = tracer.current();
+        const start = performance.now();
+        original.async(...args, (err: any, result: any) => {
+          record(args, err ? 'error' : result, start, context);
+          callback(err, result);
+        });
+      };
+    }
+
+    (library as any)[name] = wrapped;
+  }
+
+  return library;
+}
+
+/**
+ * Express middleware recording request latency by route template (not the
+ * raw path, to keep the label set bounded).
+ */
+export function requestLatency(req: Request, res: Response, next: NextFunction): void {
+  const start = performance.now();
+  res.on('finish', () => {
+    const route = req.route ? `${req.baseUrl}${req.route.path}` : 'unmatched';
+    latencyRegistry.record(
+      HTTP_REQUEST_METRIC,
+      [req.method, route, `${Math.floor(res.statusCode / 100)}xx`],
+      (performance.now() - start) * 1000
+    );
+  });
+  next();
+}
+
+/**
+ * Wrap a Socket.IO event handler; asynchronous handlers are timed until
+ * their promise settles.
+ */
+export function timedSocketHandler<A extends any[]>(
+  event: string,
+  handler: (...args: A) => any
+): (...args: A) => void {
+  return (...args: A) => {
+    const start = performance.now();
+    const done = () =>
+      latencyRegistry.record(
+        SOCKET_EVENT_METRIC,
+        [event],
+        (performance.now() - start) * 1000
+      );
+
+    let result: any;
+    try {
+      result = handler(...args);
+    } catch (error) {
+      done();
+      throw error;
+    }
+    if (result && typeof result.then === 'function') {
+      result.then(done, done);
+    } else {
+      done();
+    }
+  };
+}
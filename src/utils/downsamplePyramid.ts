@@ -0,0 +1,207 @@
+/**
+ * Downsample Pyramid
+ * Min/max/mean/count aggregates of one channel at power-of-two resolutions
+ *
+ */
+
+import { LIMITS } from './constants';
+
+export interface PyramidQuery {
+  level: number;
+  bucketMs: number;
+  // Start of each bucket, epoch ms
+  timestamps: number[];
+  min: number[];
+  max: number[];
+  mean: number[];
+  count: number[];
+}
+
+/**
+ * Non-empty buckets of one resolution in a ring, oldest first. Buckets are
+ * appended in time order, so their indexes are sorted and a range is found
+ * by binary search.
+ */
+class PyramidLevel {
+  readonly bucketMs: number;
+  private capacity: number;
+  private indexes: Float64Array;
+  private mins: Float64Array;
+  private maxs: Float64Array;
+  private sums: Float64Array;
+  private counts: Uint32Array;
+  private written: number;
+
+  constructor(bucketMs: number, capacity: number) {
+    this.bucketMs = bucketMs;
+    this.capacity = capacity;
+    this.indexes = new Float64Array(capacity);
+    this.mins = new Float64Array(capacity);
+    this.maxs = new Float64Array(capacity);
+    this.sums = new Float64Array(capacity);
+    this.counts = new Uint32Array(capacity);
+    this.written = 0;
+  }
+
+  add(timestamp: number, value: number): void {
+    const index = Math.floor(timestamp / this.bucketMs);
+    const last = (this.written - 1) % this.capacity;
+
+    // Late samples (e.g. after a clock step) are folded into the newest bucket
+    if (this.written > 0 && index <= this.indexes[last]) {
+      if (value < this.mins[last]) this.mins[last] = value;
+      if (value > this.maxs[last]) this.maxs[last] = value;
+      this.sums[last] += value;
+      this.counts[last]++;
+      return;
+    }
+
+    const slot = this.written % this.capacity;
+    this.indexes[slot] = index;
+    this.mins[slot] = value;
+    this.maxs[slot] = value;
+    this.sums[slot] = value;
+    this.counts[slot] = 1;
+    this.written++;
+  }
+
+  get size(): number {
+    return Math.min(this.written, this.capacity);
+  }
+
+  /**
+   * True until the ring wraps: every bucket since the first sample is held
+   */
+  get complete(): boolean {
+    return this.written <= this.capacity;
+  }
+
+  /**
+   * Start of the oldest bucket still held, epoch ms
+   */
+  get oldest(): number | null {
+    if (this.written === 0) return null;
+    return this.indexes[this.slotAt(0)] * this.bucketMs;
+  }
+
+  get newest(): number | null {
+    if (this.written === 0) return null;
+    return (this.indexes[this.slotAt(this.size - 1)] + 1) * this.bucketMs;
+  }
+
+  // Ring slot of the i-th held bucket (0 = oldest)
+  private slotAt(i: number): number {
+    return (Math.max(0, this.written - this.capacity) + i) % this.capacity;
+  }
+
+  // First held bucket with index >= target
+  private lowerBound(target: number): number {
+    let lo = 0;
+    let hi = this.size;
+    while (lo < hi) {
+      const mid = (lo + hi) >> 1;
+      if (this.indexes[this.slotAt(mid)] < target) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  read(from: number, to: number, into: PyramidQuery): void {
+    const first = this.lowerBound(Math.floor(from / this.bucketMs));
+    const end = this.lowerBound(Math.floor(to / this.bucketMs) + 1);
+    for (let i = first; i < end; i++) {
+      const slot = this.slotAt(i);
+      into.timestamps.push(this.indexes[slot] * this.bucketMs);
+      into.min.push(this.mins[slot]);
+      into.max.push(this.maxs[slot]);
+      into.mean.push(this.sums[slot] / this.counts[slot]);
+      into.count.push(this.counts[slot]);
+    }
+  }
+}
+
+// ============================================================================
+// DOWNSAMPLE PYRAMID
+// ============================================================================
+
+/**
+ * Level k holds buckets of HISTORY_BASE_MS * 2^k, each updated as samples
+ * are ingested, so no query ever touches raw samples. Every level keeps the
+ * same number of buckets; coarser levels therefore reach further back, and
+ * memory stays fixed however long the capture runs.
+ *
+ * A query over [from, to] for at most `points` buckets reads the finest
+ * level whose buckets are at least (to - from) / points wide and that still
+ * covers from, i.e. has not dropped any bucket at or after it. The answer
+ * has about `points` entries whatever the zoom.
+ */
+export class DownsamplePyramid {
+  private levels: PyramidLevel[];
+  private samples: number;
+
+  constructor(
+    levels: number = LIMITS.HISTORY_LEVELS,
+    bucketsPerLevel: number = LIMITS.HISTORY_LEVEL_BUCKETS
+  ) {
+    this.levels = [];
+    for (let k = 0; k < levels; k++) {
+      this.levels.push(new PyramidLevel(LIMITS.HISTORY_BASE_MS * 2 ** k, bucketsPerLevel));
+    }
+    this.samples = 0;
+  }
+
+  add(timestamp: number, value: number): void {
+    if (!Number.isFinite(value)) return;
+    for (const level of this.levels) {
+      level.add(timestamp, value);
+    }
+    this.samples++;
+  }
+
+  query(from: number, to: number, points: number): PyramidQuery {
+    const span = Math.max(to - from, 0);
+    const wanted = span / Math.max(points, 1);
+
+    let chosen = this.levels.length - 1;
+    for (let k = 0; k < this.levels.length; k++) {
+      const level = this.levels[k];
+      const oldest = level.oldest;
+      // A level that has not wrapped covers any from, including one before
+      // the first sample
+      if (level.bucketMs >= wanted && (level.complete || (oldest !== null && oldest <= from))) {
+        chosen = k;
+        break;
+      }
+    }
+
+    const level = this.levels[chosen];
+    const result: PyramidQuery = {
+      level: chosen,
+      bucketMs: level.bucketMs,
+      timestamps: [],
+      min: [],
+      max: [],
+      mean: [],
+      count: [],
+    };
+    level.read(from, to, result);
+    return result;
+  }
+
+  getStatus() {
+    const top = this.levels[this.levels.length - 1];
+    return {
+      samples: this.samples,
+      levels: this.levels.length,
+      baseMs: LIMITS.HISTORY_BASE_MS,
+      oldest: top.oldest,
+      newest: top.newest,
+      // How far back each level reaches
+      coverage: this.levels.map((level) => ({
+        bucketMs: level.bucketMs,
+        buckets: level.size,
+        from: level.oldest,
+      })),
+    };
+  }
+}
@@ -5,6 +5,7 @@
  */
 
 import { format } from 'util';
+import fs from 'fs';
 
 type LogLevel = 'error' | 'warn' | 'info' | 'debug';
 
@@ -15,49 +16,209 @@ const LOG_LEVELS: Record<LogLevel, number> = {
   debug: 3,
 };
 
+const LEVEL_NAMES: LogLevel[] = ['error', 'warn', 'info', 'debug'];
+
+const DEFAULT_RING_SIZE = 8192;
+
+// ============================================================================
+// RECORD RING
+// ============================================================================
+
+/**
+ * Preallocated ring of unformatted log records. The hot path only stores the
+ * level, a timestamp and references to the message and its arguments;
+ * formatting and writing happen later in one batch.
+ */
+class RecordRing {
+  readonly capacity: number;
+  private levels: Uint8Array;
+  private times: Float64Array;
+  private contexts: Array<string | null>;
+  private messages: string[];
+  private args: Array<any[] | null>;
+  private head: number;
+  private size: number;
+
+  constructor(capacity: number) {
+    this.capacity = capacity;
+    this.levels = new Uint8Array(capacity);
+    this.times = new Float64Array(capacity);
+    this.contexts = new Array(capacity).fill(null);
+    this.messages = new Array(capacity).fill('');
+    this.args = new Array(capacity).fill(null);
+    this.head = 0;
+    this.size = 0;
+  }
+
+  get length(): number {
+    return this.size;
+  }
+
+  push(level: number, context: string | null, message: string, args: any[]): boolean {
+    if (this.size === this.capacity) return false;
+    const slot = (this.head + this.size) % this.capacity;
+    this.levels[slot] = level;
+    this.times[slot] = Date.now();
+    this.contexts[slot] = context;
+    this.messages[slot] = message;
+    this.args[slot] = args.length > 0 ? args : null;
+    this.size++;
+    return true;
+  }
+
+  /**
+   * Format and remove every queued record, split by output stream.
+   */
+  drain(json: boolean): { out: string; err: string } {
+    let out = '';
+    let err = '';
+
+    while (this.size > 0) {
+      const slot = this.head;
+      const level = this.levels[slot];
+      const args = this.args[slot];
+      const context = this.contexts[slot];
+      const message = args ? format(this.messages[slot], ...args) : this.messages[slot];
+      const time = new Date(this.times[slot]).toISOString();
+
+      const line = json
+        ? JSON.stringify({ time, level: LEVEL_NAMES[level], context: context || undefined, msg: message })
+        : `[${time}] [${LEVEL_NAMES[level].toUpperCase()}] ${context ? `[${context}] ` : ''}${message}`;
+
+      if (level <= LOG_LEVELS.warn) {
+        err += line + '\n';
+      } else {
+        out += line + '\n';
+      }
+
+      // Release references so arguments can be collected
+      this.messages[slot] = '';
+      this.args[slot] = null;
+      this.contexts[slot] = null;
+      this.head = (this.head + 1) % this.capacity;
+      this.size--;
+    }
+
+    return { out, err };
+  }
+}
+
+// ============================================================================
+// LOGGER
+// ============================================================================
+
 class Logger {
   private logLevel: LogLevel;
   private levels: Record<LogLevel, number>;
+  private threshold: number;
+  private ring: RecordRing;
+  private json: boolean;
+  private flushScheduled: boolean;
+  private dropped: number;
+  private droppedReported: number;
+  private written: number;
 
   constructor() {
     this.logLevel = (process.env.LOG_LEVEL as LogLevel) || 'info';
     this.levels = LOG_LEVELS;
+    this.threshold = this.levels[this.logLevel] ?? LOG_LEVELS.info;
+    this.ring = new RecordRing(
+      parseInt(process.env.LOG_RING_SIZE || String(DEFAULT_RING_SIZE), 10) || DEFAULT_RING_SIZE
+    );
+    this.json = process.env.LOG_FORMAT === 'json';
+    this.flushScheduled = false;
+    this.dropped = 0;
+    this.droppedReported = 0;
+    this.written = 0;
+
+    // Whatever is still queued when the process exits is written synchronously
+    process.on('exit', () => this.flushSync());
   }
 
-  private _shouldLog(level: LogLevel): boolean {
-    return this.levels[level] <= this.levels[this.logLevel];
+  isLevelEnabled(level: LogLevel): boolean {
+    return this.levels[level] <= this.threshold;
   }
 
-  private _formatMessage(level: LogLevel, message: string, ...args: any[]): string {
-    const timestamp = new Date().toISOString();
-    const formattedMessage =
-      args.length > 0 ? format(message, ...args) : message;
-    return `[${timestamp}] [${level.toUpperCase()}] ${formattedMessage}`;
+  /**
+   * Queue a record. Disabled levels return before touching the arguments,
+   * enabled ones are formatted later, off the caller's path.
+   */
+  log(level: LogLevel, context: string | null, message: string, args: any[]): void {
+    const levelValue = this.levels[level];
+    if (levelValue > this.threshold) return;
+
+    if (!this.ring.push(levelValue, context, message, args)) {
+      this.dropped++;
+    }
+
+    if (!this.flushScheduled) {
+      this.flushScheduled = true;
+      setImmediate(() => this.flush());
+    }
   }
 
   private _log(level: LogLevel, message: string, ...args: any[]): void {
-    if (!this._shouldLog(level)) return;
-
-    const formattedMessage = this._formatMessage(level, message, ...args);
-
-    switch (level) {
-      case 'error':
-        console.error(formattedMessage);
-        break;
-      case 'warn':
-        console.warn(formattedMessage);
-        break;
-      case 'info':
-        console.info(formattedMessage);
-        break;
-      case 'debug':
-        console.debug(formattedMessage);
-        break;
-      default:
-        console.log(formattedMessage);
+    this.log(level, null, message, args);
+  }
+
+  /**
+   * Drain the ring, followed by a notice for the records dropped since the
+   * last batch. The notice goes in after the drain: pushed into the still
+   * full ring it would be dropped itself.
+   */
+  private takeBatch(): { out: string; err: string; count: number } | null {
+    const lost = this.dropped - this.droppedReported;
+    if (this.ring.length === 0 && lost === 0) return null;
+
+    let count = this.ring.length;
+    const batch = this.ring.drain(this.json);
+    if (lost > 0) {
+      this.droppedReported = this.dropped;
+      this.ring.push(LOG_LEVELS.warn, 'logger', `${lost} log records dropped (ring full)`, []);
+      batch.err += this.ring.drain(this.json).err;
+      count++;
+    }
+    return { ...batch, count };
+  }
+
+  /**
+   * Format the queued batch and hand it to stdout/stderr in one write each.
+   */
+  flush(): void {
+    this.flushScheduled = false;
+
+    const batch = this.takeBatch();
+    if (!batch) return;
+
+    this.written += batch.count;
+    if (batch.err) process.stderr.write(batch.err);
+    if (batch.out) process.stdout.write(batch.out);
+  }
+
+  private flushSync(): void {
+    const batch = this.takeBatch();
+    if (!batch) return;
+
+    this.written += batch.count;
+    try {
+      if (batch.err) fs.writeSync(2, batch.err);
+      if (batch.out) fs.writeSync(1, batch.out);
+    } catch (e) {
+      // Nothing left to report to
     }
   }
 
+  getStats() {
+    return {
+      level: this.logLevel,
+      format: this.json ? 'json' : 'text',
+      ringSize: this.ring.capacity,
+      queued: this.ring.length,
+      written: this.written,
+      dropped: this.dropped,
+    };
+  }
+
   error(message: string, ...args: any[]): void {
     this._log('error', message, ...args);
   }
@@ -120,6 +281,8 @@ class Logger {
   }
 
   streamEvent(deviceId: string | number, port: number, event: string, data: any = null): void {
+    if (!this.isLevelEnabled('debug')) return;
+
     const message = `Stream Device ${deviceId} Port ${port}: ${event}`;
     if (data) {
       this.debug(`${message} - ${JSON.stringify(data)}`);
@@ -136,6 +299,7 @@ class Logger {
   setLevel(level: string): void {
     if (this.levels.hasOwnProperty(level)) {
       this.logLevel = level as LogLevel;
+      this.threshold = this.levels[this.logLevel];
       this.info(`Log level changed to: ${level}`);
     } else {
       this.warn(
@@ -156,24 +320,20 @@ class ChildLogger {
     this.context = context;
   }
 
-  private _formatWithContext(message: string): string {
-    return `[${this.context}] ${message}`;
-  }
-
   error(message: string, ...args: any[]): void {
-    this.parent.error(this._formatWithContext(message), ...args);
+    this.parent.log('error', this.context, message, args);
   }
 
   warn(message: string, ...args: any[]): void {
-    this.parent.warn(this._formatWithContext(message), ...args);
+    this.parent.log('warn', this.context, message, args);
   }
 
   info(message: string, ...args: any[]): void {
-    this.parent.info(this._formatWithContext(message), ...args);
+    this.parent.log('info', this.context, message, args);
   }
 
   debug(message: string, ...args: any[]): void {
-    this.parent.debug(this._formatWithContext(message), ...args);
+    this.parent.log('debug', this.context, message, args);
   }
 }
 
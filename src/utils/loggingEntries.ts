@@ -0,0 +1,89 @@
+/**
+ * Logging Entries
+ * Parser for the entry stream returned by IOL_ReadLoggingBuffer
+ *
+ */
+
+import { LIMITS, LOGGING_INPUTS_INVALID } from './constants';
+
+export interface LoggingEntry {
+  port: number;
+  inputData: Buffer;
+  inputValid: boolean;
+  outputData: Buffer;
+  rawBuffer: Buffer;
+}
+
+/**
+ * Split IOL_ReadLoggingBuffer data into entries. Each entry is
+ * Port, InLength, InputData[InLength - 1], InValidity, OutLength,
+ * OutputData[OutLength]; the port byte is 0-based like all DLL ports.
+ * The entry buffers are views into the given buffer.
+ */
+export function parseLoggingEntries(
+  buffer: Buffer,
+  length: number = buffer.length
+): { entries: LoggingEntry[]; consumed: number } {
+  const entries: LoggingEntry[] = [];
+  let offset = 0;
+
+  while (offset + 2 <= length) {
+    const inLength = buffer[offset + 1];
+    const outLengthOffset = offset + 2 + inLength;
+    if (inLength < 1 || outLengthOffset >= length) break;
+
+    const outLength = buffer[outLengthOffset];
+    const end = outLengthOffset + 1 + outLength;
+    if (end > length) break;
+
+    entries.push({
+      port: buffer[offset] + 1,
+      inputData: buffer.subarray(offset + 2, offset + 1 + inLength),
+      inputValid: buffer[offset + 1 + inLength] !== LOGGING_INPUTS_INVALID,
+      outputData: buffer.subarray(outLengthOffset + 1, end),
+      rawBuffer: buffer.subarray(offset, end),
+    });
+    offset = end;
+  }
+
+  return { entries, consumed: offset };
+}
+
+// ============================================================================
+// SIZING AND LOSS ESTIMATES
+// ============================================================================
+
+/**
+ * Bytes one entry takes in the logging buffer: port, InLength, inputs,
+ * validity, OutLength, outputs
+ */
+export function loggingEntryBytes(inputLength: number, outputLength: number): number {
+  return 4 + inputLength + outputLength;
+}
+
+/**
+ * Logging buffer size for one port that holds LOGGING_BUFFER_HEADROOM_MS of
+ * samples, so a drain can be late by that much before the master overruns
+ */
+export function loggingBufferSize(
+  sampleTimeUs: number,
+  inputLength: number,
+  outputLength: number
+): number {
+  const entries = (LIMITS.LOGGING_BUFFER_HEADROOM_MS * 1000) / sampleTimeUs;
+  const bytes = Math.ceil(entries * loggingEntryBytes(inputLength, outputLength));
+  return Math.min(LIMITS.LOGGING_MEMORY_MAX, Math.max(LIMITS.LOGGING_MEMORY_MIN, bytes));
+}
+
+/**
+ * Samples the master would have taken between the last delivered one and
+ * a restart of logging. An estimate: it relies on the sample clock's time
+ * of the last sample.
+ */
+export function estimateLostSamples(
+  lastTimestamp: number,
+  periodMs: number,
+  restartedAt: number
+): number {
+  return Math.max(0, Math.ceil((restartedAt - lastTimestamp) / periodMs) - 1);
+}
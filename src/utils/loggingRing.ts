@@ -0,0 +1,181 @@
+/**
+ * Logging Ring
+ * Fixed-capacity column store of logged samples for one port
+ *
+ */
+
+import { PROCESS_DATA_MAX_LENGTH } from './processImage';
+import { TimestampQuality } from './sampleClock';
+
+export const QUALITY_CODES: TimestampQuality[] = ['estimated', 'locked', 'overrun'];
+
+const FLAG_INPUT_VALID = 0x01;
+const FLAG_GAP = 0x02;
+
+export interface LoggingGap {
+  // Estimated samples the master did not deliver
+  lostSamples: number;
+  // Epoch ms when logging resumed
+  until: number;
+}
+
+export interface LoggedSample {
+  // Position in the ring's write order; never reused, use as a cursor
+  sequence: number;
+  sampleIndex: number;
+  // Epoch ms
+  timestamp: number;
+  timestampQuality: TimestampQuality;
+  inputValid: boolean;
+  inputData: Buffer;
+  outputData: Buffer;
+  // Set on gap records, which stand for the samples lost at an overrun or
+  // restart; sampleIndex and timestamp are those of the first lost sample
+  gap?: LoggingGap;
+}
+
+// ============================================================================
+// LOGGING RING
+// ============================================================================
+
+/**
+ * Samples are stored column-wise in preallocated typed arrays, with process
+ * data in fixed 32-byte strides, so a drain at several kHz allocates
+ * nothing. Once full, the oldest samples are overwritten; readers that fall
+ * further behind than the capacity skip ahead. Gaps in the capture are kept
+ * in sequence as gap records.
+ */
+export class LoggingRing {
+  readonly capacity: number;
+  private timestamps: Float64Array;
+  private sampleIndexes: Float64Array;
+  private inputLengths: Uint8Array;
+  private outputLengths: Uint8Array;
+  private flags: Uint8Array;
+  private quality: Uint8Array;
+  private inputs: Uint8Array;
+  private outputs: Uint8Array;
+  private gapLost: Float64Array;
+  private gapUntil: Float64Array;
+  private written: number;
+
+  constructor(capacity: number) {
+    this.capacity = capacity;
+    this.timestamps = new Float64Array(capacity);
+    this.sampleIndexes = new Float64Array(capacity);
+    this.inputLengths = new Uint8Array(capacity);
+    this.outputLengths = new Uint8Array(capacity);
+    this.flags = new Uint8Array(capacity);
+    this.quality = new Uint8Array(capacity);
+    this.inputs = new Uint8Array(capacity * PROCESS_DATA_MAX_LENGTH);
+    this.outputs = new Uint8Array(capacity * PROCESS_DATA_MAX_LENGTH);
+    this.gapLost = new Float64Array(capacity);
+    this.gapUntil = new Float64Array(capacity);
+    this.written = 0;
+  }
+
+  push(
+    sampleIndex: number,
+    timestamp: number,
+    quality: TimestampQuality,
+    inputValid: boolean,
+    inputData: Uint8Array,
+    outputData: Uint8Array
+  ): void {
+    const slot = this.written % this.capacity;
+    const inLength = Math.min(inputData.length, PROCESS_DATA_MAX_LENGTH);
+    const outLength = Math.min(outputData.length, PROCESS_DATA_MAX_LENGTH);
+
+    this.timestamps[slot] = timestamp;
+    this.sampleIndexes[slot] = sampleIndex;
+    this.inputLengths[slot] = inLength;
+    this.outputLengths[slot] = outLength;
+    this.flags[slot] = inputValid ? FLAG_INPUT_VALID : 0;
+    this.quality[slot] = QUALITY_CODES.indexOf(quality);
+    this.inputs.set(inputData.subarray(0, inLength), slot * PROCESS_DATA_MAX_LENGTH);
+    this.outputs.set(outputData.subarray(0, outLength), slot * PROCESS_DATA_MAX_LENGTH);
+    this.written++;
+  }
+
+  /**
+   * Record lostSamples missing samples from sampleIndex on, the first at
+   * timestamp; returns the record
+   */
+  pushGap(sampleIndex: number, timestamp: number, gap: LoggingGap): LoggedSample {
+    const slot = this.written % this.capacity;
+    this.timestamps[slot] = timestamp;
+    this.sampleIndexes[slot] = sampleIndex;
+    this.inputLengths[slot] = 0;
+    this.outputLengths[slot] = 0;
+    this.flags[slot] = FLAG_GAP;
+    this.quality[slot] = QUALITY_CODES.indexOf('overrun');
+    this.gapLost[slot] = gap.lostSamples;
+    this.gapUntil[slot] = gap.until;
+    this.written++;
+    return this.get(this.written - 1);
+  }
+
+  /**
+   * Sequence the next pushed sample will get
+   */
+  get head(): number {
+    return this.written;
+  }
+
+  /**
+   * Sequence of the oldest sample still held
+   */
+  get tail(): number {
+    return Math.max(0, this.written - this.capacity);
+  }
+
+  get size(): number {
+    return this.written - this.tail;
+  }
+
+  /**
+   * Up to limit samples with sequence >= since, oldest first. Without since,
+   * the newest limit samples.
+   */
+  read(since: number | null, limit: number): LoggedSample[] {
+    const start = since === null
+      ? Math.max(this.tail, this.written - limit)
+      : Math.max(this.tail, since);
+    const end = Math.min(this.written, start + limit);
+
+    const samples: LoggedSample[] = [];
+    for (let sequence = start; sequence < end; sequence++) {
+      samples.push(this.get(sequence));
+    }
+    return samples;
+  }
+
+  private get(sequence: number): LoggedSample {
+    const slot = sequence % this.capacity;
+    const offset = slot * PROCESS_DATA_MAX_LENGTH;
+    if (this.flags[slot] & FLAG_GAP) {
+      return {
+        sequence,
+        sampleIndex: this.sampleIndexes[slot],
+        timestamp: this.timestamps[slot],
+        timestampQuality: QUALITY_CODES[this.quality[slot]],
+        inputValid: false,
+        inputData: Buffer.alloc(0),
+        outputData: Buffer.alloc(0),
+        gap: {
+          lostSamples: this.gapLost[slot],
+          until: this.gapUntil[slot],
+        },
+      };
+    }
+    return {
+      sequence,
+      sampleIndex: this.sampleIndexes[slot],
+      timestamp: this.timestamps[slot],
+      timestampQuality: QUALITY_CODES[this.quality[slot]],
+      inputValid: (this.flags[slot] & FLAG_INPUT_VALID) !== 0,
+      inputData: Buffer.from(this.inputs.subarray(offset, offset + this.inputLengths[slot])),
+      outputData: Buffer.from(this.outputs.subarray(offset, offset + this.outputLengths[slot])),
+    };
+  }
+}
@@ -0,0 +1,318 @@
+/**
+ * Process Image
+ * Fixed-layout shared-memory table of the latest process data per port
+ *
+ */
+
+// ============================================================================
+// LAYOUT
+// ============================================================================
+
+// Per master: one Int32 owner word (master handle + 1, 0 = free), padded to
+// a whole slot. Per port, a 128-byte slot with two independently written
+// halves, each guarded by its own seqlock, and the commit words of the
+// output writer:
+//
+//   0  inSeq      i32   odd while the acquisition side writes
+//   4  status     i32   IOL_ReadInputs status
+//   8  inLength   i32
+//  12  sequence   i32   sample counter
+//  16  timestamp  f64   ms since epoch
+//  24  inputs     32 bytes
+//  56  outSeq     i32   odd while the output side writes
+//  60  outLength  i32
+//  64  outTime    f64
+//  72  outputs    32 bytes
+// 104  outSequence  i32  output write counter
+// 108  committed    i32  outSequence last handed to IOL_WriteOutputs
+// 112  commitResult i32  its return code
+// 120  commitTime   f64  ms since epoch
+export const PROCESS_IMAGE_SLOT_BYTES = 128;
+export const PROCESS_DATA_MAX_LENGTH = 32;
+
+const IN_SEQ = 0;
+const IN_STATUS = 1;
+const IN_LENGTH = 2;
+const IN_SEQUENCE = 3;
+const IN_TIME = 2; // f64 index
+const IN_DATA = 24; // byte offset
+const OUT_SEQ = 14;
+const OUT_LENGTH = 15;
+const OUT_TIME = 8; // f64 index
+const OUT_DATA = 72; // byte offset
+const OUT_SEQUENCE = 26;
+const COMMITTED = 27;
+const COMMIT_RESULT = 28;
+const COMMIT_TIME = 15; // f64 index
+
+// A writer that died mid-update leaves its half odd; readers give up
+const MAX_READ_RETRIES = 64;
+
+export interface ProcessImageSample {
+  data: Buffer;
+  status: number;
+  sequence: number;
+  timestamp: Date;
+}
+
+export interface ProcessImageOutputs {
+  data: Buffer;
+  sequence: number;
+  timestamp: Date;
+}
+
+export interface OutputCommit {
+  // outSequence of the value that was written; later than the awaited one
+  // when that value was superseded before the writer reached it
+  sequence: number;
+  superseded: boolean;
+  result: number;
+  timestamp: Date;
+}
+
+// Atomics.waitAsync (Node 16+) is not in the ES2020 lib typings
+const waitAsync: (
+  array: Int32Array,
+  index: number,
+  value: number,
+  timeoutMs: number
+) => { async: boolean; value: any } = (Atomics as any).waitAsync;
+
+// ============================================================================
+// PROCESS IMAGE
+// ============================================================================
+
+/**
+ * The same SharedArrayBuffer is mapped by the main thread and every master
+ * acquisition thread. Each half of a slot has exactly one writer; readers
+ * never block it and retry only while a write is in progress.
+ */
+export class ProcessImage {
+  readonly buffer: SharedArrayBuffer;
+  readonly masters: number;
+  readonly ports: number;
+  private headerBytes: number;
+  private i32: Int32Array;
+  private f64: Float64Array;
+  private u8: Uint8Array;
+
+  constructor(masters: number, ports: number, buffer?: SharedArrayBuffer) {
+    this.masters = masters;
+    this.ports = ports;
+    this.headerBytes =
+      Math.ceil((masters * 4) / PROCESS_IMAGE_SLOT_BYTES) * PROCESS_IMAGE_SLOT_BYTES;
+    this.buffer =
+      buffer ||
+      new SharedArrayBuffer(this.headerBytes + masters * ports * PROCESS_IMAGE_SLOT_BYTES);
+    this.i32 = new Int32Array(this.buffer);
+    this.f64 = new Float64Array(this.buffer);
+    this.u8 = new Uint8Array(this.buffer);
+  }
+
+  // ==========================================================================
+  // OWNERSHIP
+  // ==========================================================================
+
+  /**
+   * Claim a free master row for a handle; its slots start out empty
+   */
+  claim(masterHandle: number): number {
+    for (let index = 0; index < this.masters; index++) {
+      if (Atomics.compareExchange(this.i32, index, 0, masterHandle + 1) === 0) {
+        this.clearRow(index);
+        return index;
+      }
+    }
+    return -1;
+  }
+
+  release(masterIndex: number): void {
+    Atomics.store(this.i32, masterIndex, 0);
+  }
+
+  /**
+   * Writers check this each cycle, so a thread that outlives its master
+   * cannot write into a row that was handed to another master
+   */
+  isOwnedBy(masterIndex: number, masterHandle: number): boolean {
+    return Atomics.load(this.i32, masterIndex) === masterHandle + 1;
+  }
+
+  private clearRow(masterIndex: number): void {
+    for (let port = 1; port <= this.ports; port++) {
+      const slot = this.slotOffset(masterIndex, port);
+      this.u8.fill(0, slot, slot + PROCESS_IMAGE_SLOT_BYTES);
+    }
+  }
+
+  private slotOffset(masterIndex: number, port: number): number {
+    return (
+      this.headerBytes +
+      (masterIndex * this.ports + (port - 1)) * PROCESS_IMAGE_SLOT_BYTES
+    );
+  }
+
+  // ==========================================================================
+  // WRITERS
+  // ==========================================================================
+
+  writeInputs(
+    masterIndex: number,
+    port: number,
+    data: Uint8Array,
+    status: number,
+    timestampMs: number
+  ): void {
+    const offset = this.slotOffset(masterIndex, port);
+    const i = offset / 4;
+    const length = Math.min(data.length, PROCESS_DATA_MAX_LENGTH);
+
+    Atomics.add(this.i32, i + IN_SEQ, 1);
+    this.i32[i + IN_STATUS] = status;
+    this.i32[i + IN_LENGTH] = length;
+    this.i32[i + IN_SEQUENCE] = (this.i32[i + IN_SEQUENCE] + 1) | 0;
+    this.f64[offset / 8 + IN_TIME] = timestampMs;
+    this.u8.set(data.subarray(0, length), offset + IN_DATA);
+    Atomics.add(this.i32, i + IN_SEQ, 1);
+  }
+
+  /**
+   * Post the latest outputs of a port, replacing any value not yet
+   * committed; returns its outSequence
+   */
+  writeOutputs(masterIndex: number, port: number, data: Uint8Array, timestampMs: number): number {
+    const offset = this.slotOffset(masterIndex, port);
+    const i = offset / 4;
+    const length = Math.min(data.length, PROCESS_DATA_MAX_LENGTH);
+    const sequence = (this.i32[i + OUT_SEQUENCE] + 1) | 0;
+
+    Atomics.add(this.i32, i + OUT_SEQ, 1);
+    this.i32[i + OUT_LENGTH] = length;
+    this.i32[i + OUT_SEQUENCE] = sequence;
+    this.f64[offset / 8 + OUT_TIME] = timestampMs;
+    this.u8.set(data.subarray(0, length), offset + OUT_DATA);
+    Atomics.add(this.i32, i + OUT_SEQ, 1);
+    return sequence;
+  }
+
+  /**
+   * Record that the output writer handed outSequence to the master and wake
+   * anyone waiting for it. Only the output writer of the port calls this.
+   */
+  commitOutputs(
+    masterIndex: number,
+    port: number,
+    sequence: number,
+    result: number,
+    timestampMs: number
+  ): void {
+    const offset = this.slotOffset(masterIndex, port);
+    const i = offset / 4;
+
+    this.i32[i + COMMIT_RESULT] = result;
+    this.f64[offset / 8 + COMMIT_TIME] = timestampMs;
+    Atomics.store(this.i32, i + COMMITTED, sequence);
+    Atomics.notify(this.i32, i + COMMITTED);
+  }
+
+  // ==========================================================================
+  // READERS
+  // ==========================================================================
+
+  /**
+   * Latest inputs of a port, or null if never written (or a writer died
+   * mid-update)
+   */
+  readInputs(masterIndex: number, port: number): ProcessImageSample | null {
+    const offset = this.slotOffset(masterIndex, port);
+    const i = offset / 4;
+
+    for (let attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+      const before = Atomics.load(this.i32, i + IN_SEQ);
+      if (before === 0) return null;
+      if (before & 1) continue;
+
+      const length = this.i32[i + IN_LENGTH];
+      const status = this.i32[i + IN_STATUS];
+      const sequence = this.i32[i + IN_SEQUENCE];
+      const timestamp = this.f64[offset / 8 + IN_TIME];
+      const data = Buffer.from(this.u8.slice(offset + IN_DATA, offset + IN_DATA + length));
+
+      if (Atomics.load(this.i32, i + IN_SEQ) === before) {
+        return { data, status, sequence, timestamp: new Date(timestamp) };
+      }
+    }
+    return null;
+  }
+
+  /**
+   * Sample counter of a port's inputs without copying them; 0 while empty
+   */
+  inputSequence(masterIndex: number, port: number): number {
+    const i = this.slotOffset(masterIndex, port) / 4;
+    return Atomics.load(this.i32, i + IN_SEQ) === 0 ? 0 : Atomics.load(this.i32, i + IN_SEQUENCE);
+  }
+
+  readOutputs(masterIndex: number, port: number): ProcessImageOutputs | null {
+    const offset = this.slotOffset(masterIndex, port);
+    const i = offset / 4;
+
+    for (let attempt = 0; attempt < MAX_READ_RETRIES; attempt++) {
+      const before = Atomics.load(this.i32, i + OUT_SEQ);
+      if (before === 0) return null;
+      if (before & 1) continue;
+
+      const length = this.i32[i + OUT_LENGTH];
+      const sequence = this.i32[i + OUT_SEQUENCE];
+      const timestamp = this.f64[offset / 8 + OUT_TIME];
+      const data = Buffer.from(this.u8.slice(offset + OUT_DATA, offset + OUT_DATA + length));
+
+      if (Atomics.load(this.i32, i + OUT_SEQ) === before) {
+        return { data, sequence, timestamp: new Date(timestamp) };
+      }
+    }
+    return null;
+  }
+
+  /**
+   * Latest outputs of a port if they have not been committed yet; values
+   * written in between were superseded and are never sent
+   */
+  takeOutputs(masterIndex: number, port: number): ProcessImageOutputs | null {
+    const outputs = this.readOutputs(masterIndex, port);
+    if (!outputs) return null;
+    const i = this.slotOffset(masterIndex, port) / 4;
+    return outputs.sequence === Atomics.load(this.i32, i + COMMITTED) ? null : outputs;
+  }
+
+  /**
+   * Resolves once outSequence, or a later value that superseded it, has
+   * been committed; null after timeoutMs
+   */
+  async waitForCommit(
+    masterIndex: number,
+    port: number,
+    sequence: number,
+    timeoutMs: number
+  ): Promise<OutputCommit | null> {
+    const offset = this.slotOffset(masterIndex, port);
+    const i = offset / 4;
+    const deadline = Date.now() + timeoutMs;
+
+    for (;;) {
+      const committed = Atomics.load(this.i32, i + COMMITTED);
+      if (((committed - sequence) | 0) >= 0) {
+        return {
+          sequence: committed,
+          superseded: committed !== sequence,
+          result: this.i32[i + COMMIT_RESULT],
+          timestamp: new Date(this.f64[offset / 8 + COMMIT_TIME]),
+        };
+      }
+      const remaining = deadline - Date.now();
+      if (remaining <= 0) return null;
+      const wait = waitAsync(this.i32, i + COMMITTED, committed, remaining);
+      if (wait.async) await wait.value;
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/**
+ * Shared Rate Limit Store
+ * Hit counters of the owner process, used by the HTTP workers over IPC
+ *
+ */
+
+import cluster, { Worker } from 'cluster';
+import type { ClientRateLimitInfo, Store } from 'express-rate-limit';
+import { LIMITS } from './constants';
+
+interface RateLimitRequest {
+  type: 'rate-limit';
+  id: number;
+  op: 'increment' | 'decrement' | 'resetKey';
+  key: string;
+}
+
+interface RateLimitReply {
+  type: 'rate-limit';
+  id: number;
+  totalHits?: number;
+  resetTime?: number;
+  error?: string;
+}
+
+// ============================================================================
+// OWNER SIDE
+// ============================================================================
+
+/**
+ * Answer the workers' counter operations from a store of the owner, so a
+ * client has one budget no matter which worker (or the owner) serves it
+ */
+export function serveRateLimitStore(store: Store): void {
+  cluster.on('message', async (worker: Worker, message: any) => {
+    if (message?.type !== 'rate-limit') return;
+    const request = message as RateLimitRequest;
+    const reply: RateLimitReply = { type: 'rate-limit', id: request.id };
+
+    try {
+      if (request.op === 'increment') {
+        const info = await store.increment(request.key);
+        reply.totalHits = info.totalHits;
+        reply.resetTime = info.resetTime?.getTime();
+      } else {
+        await store[request.op](request.key);
+      }
+    } catch (error: any) {
+      reply.error = error.message;
+    }
+    if (worker.isConnected()) worker.send(reply);
+  });
+}
+
+// ============================================================================
+// WORKER SIDE
+// ============================================================================
+
+/**
+ * express-rate-limit store of an HTTP worker that keeps no counters itself
+ */
+export class OwnerRateLimitStore implements Store {
+  // Counters live in the owner and are shared by every worker
+  localKeys = false;
+  private nextId = 1;
+  private pending = new Map<
+    number,
+    { resolve: (reply: RateLimitReply) => void; reject: (error: Error) => void; timer: NodeJS.Timeout }
+  >();
+
+  constructor() {
+    process.on('message', (message: any) => {
+      if (message?.type !== 'rate-limit') return;
+      const entry = this.pending.get(message.id);
+      if (!entry) return;
+      this.pending.delete(message.id);
+      clearTimeout(entry.timer);
+      if (message.error) {
+        entry.reject(new Error(message.error));
+      } else {
+        entry.resolve(message);
+      }
+    });
+  }
+
+  async increment(key: string): Promise<ClientRateLimitInfo> {
+    const reply = await this.call('increment', key);
+    return {
+      totalHits: reply.totalHits ?? 0,
+      resetTime: reply.resetTime === undefined ? undefined : new Date(reply.resetTime),
+    };
+  }
+
+  async decrement(key: string): Promise<void> {
+    await this.call('decrement', key);
+  }
+
+  async resetKey(key: string): Promise<void> {
+    await this.call('resetKey', key);
+  }
+
+  private call(op: RateLimitRequest['op'], key: string): Promise<RateLimitReply> {
+    return new Promise((resolve, reject) => {
+      if (!process.send) {
+        reject(new Error('No owner process to count requests'));
+        return;
+      }
+      const id = this.nextId++;
+      const timer = setTimeout(() => {
+        this.pending.delete(id);
+        reject(new Error('Owner did not answer the rate limit request'));
+      }, LIMITS.RATE_LIMIT_STORE_TIMEOUT);
+      this.pending.set(id, { resolve, reject, timer });
+      const request: RateLimitRequest = { type: 'rate-limit', id, op, key };
+      process.send(request);
+    });
+  }
+}
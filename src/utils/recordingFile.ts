@@ -0,0 +1,83 @@
+/**
+ * Recording File
+ * Block index and range reads of recording block files
+ *
+ */
+
+import { promises as fs } from 'fs';
+import {
+  BlockHeader,
+  DecodedBlock,
+  decodeBlock,
+  readBlockHeader,
+  BLOCK_HEADER_SIZE,
+} from './columnCodec';
+
+// Recorded sample flags: bit 0 input valid, bits 1-2 timestamp quality
+export const FLAG_INPUT_VALID = 0x01;
+export const QUALITY_SHIFT = 1;
+
+export interface BlockIndexEntry {
+  offset: number;
+  byteLength: number;
+  count: number;
+  firstTimestamp: number;
+  lastTimestamp: number;
+}
+
+export function indexEntry(offset: number, header: BlockHeader): BlockIndexEntry {
+  return {
+    offset,
+    byteLength: header.byteLength,
+    count: header.count,
+    firstTimestamp: header.firstTimestamp,
+    lastTimestamp: header.lastTimestamp,
+  };
+}
+
+/**
+ * Block index of a block file from its headers alone. A block cut off by a
+ * crash ends the index.
+ */
+export async function scanBlockIndex(filePath: string): Promise<BlockIndexEntry[]> {
+  const index: BlockIndexEntry[] = [];
+  const file = await fs.open(filePath, 'r');
+  try {
+    const { size } = await file.stat();
+    const headerBuffer = Buffer.alloc(BLOCK_HEADER_SIZE);
+    let offset = 0;
+    while (offset + BLOCK_HEADER_SIZE <= size) {
+      await file.read(headerBuffer, 0, BLOCK_HEADER_SIZE, offset);
+      const header = readBlockHeader(headerBuffer);
+      if (!header || offset + header.byteLength > size) break;
+      index.push(indexEntry(offset, header));
+      offset += header.byteLength;
+    }
+  } finally {
+    await file.close();
+  }
+  return index;
+}
+
+/**
+ * Decoded blocks overlapping [from, to], oldest first. Samples outside the
+ * range at the edges are included; one block is in memory at a time.
+ */
+export async function* readBlocks(
+  filePath: string,
+  index: BlockIndexEntry[],
+  from: number,
+  to: number
+): AsyncGenerator<DecodedBlock> {
+  const file = await fs.open(filePath, 'r');
+  try {
+    for (const entry of index) {
+      if (entry.lastTimestamp < from || entry.firstTimestamp > to) continue;
+      const block = Buffer.allocUnsafe(entry.byteLength);
+      await file.read(block, 0, entry.byteLength, entry.offset);
+      yield decodeBlock(block);
+    }
+  } finally {
+    await file.close();
+  }
+}
@@ -0,0 +1,405 @@
+/**
+ * Rule Program
+ * Alarm rules of one port compiled into flat tables and evaluated per sample
+ *
+ */
+
+import { DATA_TYPES, DATA_TYPE_SIZES } from './constants';
+
+export type RuleType = 'threshold' | 'edge' | 'rate' | 'stuck';
+
+export interface RuleDecoding {
+  dataType?: string;
+  offset: number;
+  scale: number;
+  bias: number;
+}
+
+export interface RuleDefinition {
+  id: string;
+  name: string;
+  masterHandle: number;
+  port: number;
+  type: RuleType;
+  decoding: RuleDecoding;
+  // threshold: raised beyond limit, cleared once back by hysteresis
+  direction?: 'above' | 'below';
+  limit?: number;
+  hysteresis?: number;
+  // edge: crossings of level
+  edge?: 'rising' | 'falling' | 'both';
+  level?: number;
+  // rate: |change per second| over windowMs against limit (and hysteresis)
+  windowMs?: number;
+  // stuck: no change beyond tolerance for durationMs
+  durationMs?: number;
+  tolerance?: number;
+}
+
+export const TRANSITION_RAISED = 1;
+export const TRANSITION_CLEARED = 2;
+export const TRANSITION_RISING = 3;
+export const TRANSITION_FALLING = 4;
+
+export const TRANSITION_NAMES = ['', 'raised', 'cleared', 'rising', 'falling'];
+
+/**
+ * Called for state changes only: rule index within the program, one of the
+ * TRANSITION_ codes, the value that caused it (the rate for rate rules) and
+ * the sample timestamp
+ */
+export type TransitionSink = (rule: number, transition: number, value: number, timestamp: number) => void;
+
+// ============================================================================
+// CODES
+// ============================================================================
+
+const KIND_THRESHOLD = 0;
+const KIND_EDGE = 1;
+const KIND_RATE = 2;
+const KIND_STUCK = 3;
+
+const KIND_CODES: Record<RuleType, number> = {
+  threshold: KIND_THRESHOLD,
+  edge: KIND_EDGE,
+  rate: KIND_RATE,
+  stuck: KIND_STUCK,
+};
+
+const EDGE_RISING = 1;
+const EDGE_FALLING = 2;
+
+// Decoder codes; 0 reads up to 4 bytes as an unsigned integer
+const TYPE_CODES: Record<string, number> = {
+  [DATA_TYPES.UINT8]: 1,
+  [DATA_TYPES.INT8]: 2,
+  [DATA_TYPES.UINT16]: 3,
+  [DATA_TYPES.INT16]: 4,
+  [DATA_TYPES.UINT32]: 5,
+  [DATA_TYPES.INT32]: 6,
+  [DATA_TYPES.FLOAT32]: 7,
+  [DATA_TYPES.FLOAT64]: 8,
+  [DATA_TYPES.BOOLEAN]: 9,
+};
+
+export function isDecodable(decoding: RuleDecoding): boolean {
+  return !decoding.dataType || TYPE_CODES[decoding.dataType] !== undefined;
+}
+
+/**
+ * Input bytes a decoding needs past its offset; without a data type at
+ * least one
+ */
+export function decodingSize(decoding: RuleDecoding): number {
+  return decoding.dataType ? DATA_TYPE_SIZES[decoding.dataType] : 1;
+}
+
+function decodingKey(decoding: RuleDecoding): string {
+  return `${decoding.dataType || ''}@${decoding.offset}*${decoding.scale}+${decoding.bias}`;
+}
+
+// ============================================================================
+// PORT PROGRAM
+// ============================================================================
+
+/**
+ * All rules of a port as struct-of-arrays tables. Rules sharing a decoding
+ * share a channel, so each sample is decoded once per distinct channel and
+ * the rule loop only reads and writes typed arrays; nothing is allocated
+ * unless a rule changes state.
+ *
+ * Rebuilding a program after rules are added or removed carries the state
+ * of the rules that stay, so an active alarm is neither lost nor raised
+ * again.
+ */
+export class PortProgram {
+  readonly masterHandle: number;
+  readonly port: number;
+  readonly rules: RuleDefinition[];
+
+  // Channels
+  private channelType: Uint8Array;
+  private channelOffset: Uint8Array;
+  private channelSize: Uint8Array;
+  private channelScale: Float64Array;
+  private channelBias: Float64Array;
+  private channelMisses: Float64Array; // samples too short for the channel
+  private values: Float64Array; // NaN where the sample is too short
+
+  // Rules
+  private kind: Uint8Array;
+  private channel: Uint16Array;
+  private mode: Int8Array; // threshold direction (1 above, -1 below) or edge mask
+  private limit: Float64Array; // threshold limit, edge level, rate limit
+  private hysteresis: Float64Array; // threshold/rate hysteresis, stuck tolerance
+  private span: Float64Array; // rate window, stuck duration (ms)
+
+  // State
+  private active: Uint8Array;
+  private previous: Float64Array; // edge: last value
+  private refTime: Float64Array; // rate/stuck: start of the window
+  private refValue: Float64Array;
+  private lastValue: Float64Array;
+
+  samples: number;
+  undecodable: number;
+
+  constructor(masterHandle: number, port: number, rules: RuleDefinition[], previous?: PortProgram) {
+    this.masterHandle = masterHandle;
+    this.port = port;
+    this.rules = rules;
+    this.samples = previous?.samples ?? 0;
+    this.undecodable = previous?.undecodable ?? 0;
+
+    const count = rules.length;
+    const channels = new Map<string, number>();
+    const decodings: RuleDecoding[] = [];
+    this.channel = new Uint16Array(count);
+    rules.forEach((rule, r) => {
+      const key = decodingKey(rule.decoding);
+      let index = channels.get(key);
+      if (index === undefined) {
+        index = decodings.length;
+        channels.set(key, index);
+        decodings.push(rule.decoding);
+      }
+      this.channel[r] = index;
+    });
+
+    this.channelType = Uint8Array.from(decodings, (d) => (d.dataType ? TYPE_CODES[d.dataType] : 0));
+    this.channelOffset = Uint8Array.from(decodings, (d) => d.offset);
+    this.channelSize = Uint8Array.from(decodings, decodingSize);
+    this.channelScale = Float64Array.from(decodings, (d) => d.scale);
+    this.channelBias = Float64Array.from(decodings, (d) => d.bias);
+    this.channelMisses = new Float64Array(decodings.length);
+    this.values = new Float64Array(decodings.length);
+
+    this.kind = new Uint8Array(count);
+    this.mode = new Int8Array(count);
+    this.limit = new Float64Array(count);
+    this.hysteresis = new Float64Array(count);
+    this.span = new Float64Array(count);
+    this.active = new Uint8Array(count);
+    this.previous = new Float64Array(count).fill(NaN);
+    this.refTime = new Float64Array(count).fill(NaN);
+    this.refValue = new Float64Array(count).fill(NaN);
+    this.lastValue = new Float64Array(count).fill(NaN);
+
+    rules.forEach((rule, r) => {
+      this.kind[r] = KIND_CODES[rule.type];
+      switch (rule.type) {
+        case 'threshold':
+          this.mode[r] = rule.direction === 'below' ? -1 : 1;
+          this.limit[r] = rule.limit ?? 0;
+          this.hysteresis[r] = rule.hysteresis ?? 0;
+          break;
+        case 'edge':
+          this.mode[r] =
+            rule.edge === 'rising' ? EDGE_RISING : rule.edge === 'falling' ? EDGE_FALLING : EDGE_RISING | EDGE_FALLING;
+          this.limit[r] = rule.level ?? 0.5;
+          break;
+        case 'rate':
+          this.limit[r] = rule.limit ?? 0;
+          this.hysteresis[r] = rule.hysteresis ?? 0;
+          this.span[r] = rule.windowMs ?? 100;
+          break;
+        case 'stuck':
+          this.hysteresis[r] = rule.tolerance ?? 0;
+          this.span[r] = rule.durationMs ?? 1000;
+          break;
+      }
+    });
+
+    if (previous) {
+      const carried = new Map(previous.rules.map((rule, r) => [rule.id, r]));
+      rules.forEach((rule, r) => {
+        const from = carried.get(rule.id);
+        if (from === undefined) return;
+        this.active[r] = previous.active[from];
+        this.previous[r] = previous.previous[from];
+        this.refTime[r] = previous.refTime[from];
+        this.refValue[r] = previous.refValue[from];
+        this.lastValue[r] = previous.lastValue[from];
+      });
+    }
+  }
+
+  isActive(rule: number): boolean {
+    return this.active[rule] !== 0;
+  }
+
+  getLastValue(rule: number): number | null {
+    return Number.isNaN(this.lastValue[rule]) ? null : this.lastValue[rule];
+  }
+
+  // Samples since the program was built that were too short for the rule
+  getMisses(rule: number): number {
+    return this.channelMisses[this.channel[rule]];
+  }
+
+  /**
+   * Decode the channels of one sample. A channel the inputs are too short
+   * for becomes NaN, so only its own rules skip the sample; returns the
+   * number of such channels.
+   */
+  private decode(data: Buffer): number {
+    const length = data.length;
+    let missed = 0;
+    for (let c = 0; c < this.values.length; c++) {
+      const offset = this.channelOffset[c];
+      const type = this.channelType[c];
+      if (offset + this.channelSize[c] > length) {
+        this.values[c] = NaN;
+        this.channelMisses[c]++;
+        missed++;
+        continue;
+      }
+
+      let raw: number;
+      switch (type) {
+        case 0: {
+          const end = Math.min(offset + 4, length);
+          raw = 0;
+          for (let i = offset; i < end; i++) raw = raw * 256 + data[i];
+          break;
+        }
+        case 1:
+          raw = data[offset];
+          break;
+        case 2:
+          raw = (data[offset] << 24) >> 24;
+          break;
+        case 3:
+          raw = (data[offset] << 8) | data[offset + 1];
+          break;
+        case 4:
+          raw = (((data[offset] << 8) | data[offset + 1]) << 16) >> 16;
+          break;
+        case 5:
+          raw =
+            ((data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3]) >>> 0;
+          break;
+        case 6:
+          raw = (data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3];
+          break;
+        case 7:
+          raw = data.readFloatBE(offset);
+          break;
+        case 8:
+          raw = data.readDoubleBE(offset);
+          break;
+        default:
+          raw = data[offset] !== 0 ? 1 : 0;
+      }
+      this.values[c] = raw * this.channelScale[c] + this.channelBias[c];
+    }
+    return missed;
+  }
+
+  /**
+   * Run every rule of the port against one valid sample; rules whose
+   * channel the sample is too short for keep their state
+   */
+  evaluate(data: Buffer, timestamp: number, sink: TransitionSink): void {
+    const missed = this.decode(data);
+    if (missed > 0) {
+      this.undecodable++;
+      if (missed === this.values.length) return;
+    }
+    this.samples++;
+
+    const count = this.kind.length;
+    for (let r = 0; r < count; r++) {
+      const value = this.values[this.channel[r]];
+      if (value !== value) continue; // NaN: channel not in this sample
+      this.lastValue[r] = value;
+
+      switch (this.kind[r]) {
+        case KIND_THRESHOLD: {
+          // Mirror "below" so one comparison covers both directions
+          const sign = this.mode[r];
+          const x = sign * value;
+          const limit = sign * this.limit[r];
+          if (this.active[r] === 0) {
+            if (x > limit) {
+              this.active[r] = 1;
+              sink(r, TRANSITION_RAISED, value, timestamp);
+            }
+          } else if (x < limit - this.hysteresis[r]) {
+            this.active[r] = 0;
+            sink(r, TRANSITION_CLEARED, value, timestamp);
+          }
+          break;
+        }
+
+        case KIND_EDGE: {
+          const previous = this.previous[r];
+          const level = this.limit[r];
+          this.previous[r] = value;
+          if (previous <= level && value > level) {
+            if (this.mode[r] & EDGE_RISING) sink(r, TRANSITION_RISING, value, timestamp);
+          } else if (previous > level && value <= level) {
+            if (this.mode[r] & EDGE_FALLING) sink(r, TRANSITION_FALLING, value, timestamp);
+          }
+          break;
+        }
+
+        case KIND_RATE: {
+          const elapsed = timestamp - this.refTime[r];
+          if (!(elapsed >= 0)) {
+            // First sample, or time went backwards after a restart
+            this.refTime[r] = timestamp;
+            this.refValue[r] = value;
+            break;
+          }
+          if (elapsed < this.span[r]) break;
+
+          const rate = ((value - this.refValue[r]) * 1000) / elapsed;
+          const magnitude = Math.abs(rate);
+          this.refTime[r] = timestamp;
+          this.refValue[r] = value;
+          if (this.active[r] === 0) {
+            if (magnitude > this.limit[r]) {
+              this.active[r] = 1;
+              sink(r, TRANSITION_RAISED, rate, timestamp);
+            }
+          } else if (magnitude < this.limit[r] - this.hysteresis[r]) {
+            this.active[r] = 0;
+            sink(r, TRANSITION_CLEARED, rate, timestamp);
+          }
+          break;
+        }
+
+        case KIND_STUCK: {
+          if (!(Math.abs(value - this.refValue[r]) <= this.hysteresis[r])) {
+            // Moved (or first sample): restart the window
+            this.refTime[r] = timestamp;
+            this.refValue[r] = value;
+            if (this.active[r] !== 0) {
+              this.active[r] = 0;
+              sink(r, TRANSITION_CLEARED, value, timestamp);
+            }
+          } else if (this.active[r] === 0 && timestamp - this.refTime[r] >= this.span[r]) {
+            this.active[r] = 1;
+            sink(r, TRANSITION_RAISED, value, timestamp);
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  /**
+   * Forget edge and window history, e.g. across a logging gap, so a jump
+   * over lost samples is not reported as an edge or a rate
+   */
+  resetHistory(): void {
+    this.previous.fill(NaN);
+    for (let r = 0; r < this.kind.length; r++) {
+      if (this.kind[r] === KIND_RATE) {
+        this.refTime[r] = NaN;
+        this.refValue[r] = NaN;
+      }
+    }
+  }
+}
@@ -0,0 +1,175 @@
+/**
+ * Sample Clock
+ * Reconstructs acquisition times of equidistant logging samples
+ *
+ */
+
+import { performance } from 'perf_hooks';
+import { LIMITS } from './constants';
+
+export type TimestampQuality = 'locked' | 'estimated' | 'overrun';
+
+export interface StampedBatch {
+  // Index of the first sample since the clock was (re)started
+  firstIndex: number;
+  // Epoch milliseconds with sub-millisecond resolution, one per sample
+  timestamps: Float64Array;
+  quality: TimestampQuality;
+}
+
+// Fraction of the measured phase and period error applied per correction
+const CORRECTION_GAIN = 0.25;
+
+// ============================================================================
+// SAMPLE CLOCK
+// ============================================================================
+
+/**
+ * The master samples at a fixed period, so sample i was taken at
+ * anchorTime + (i - anchorIndex) * period. The host only learns when a batch
+ * was read, which bounds the newest sample from above whenever the read
+ * emptied the buffer. Those drained reads steer the model:
+ *
+ * - the first one anchors it (samples before that are 'estimated')
+ * - a model that puts the newest sample after the read is stepped back
+ * - at most once per correction interval the period is pulled toward the
+ *   measured one, bounded by the drift limit, and the phase toward the read
+ *
+ * Times run on the monotonic clock and are converted to epoch ms only when
+ * stamped, so wall clock steps do not bend the sample grid.
+ */
+export class SampleClock {
+  readonly nominalPeriodMs: number;
+  private periodMs: number;
+  private nextIndex: number;
+  private anchorIndex: number;
+  private anchorTime: number;
+  private anchored: boolean;
+  private corrections: number;
+  private lastCorrection: { index: number; time: number };
+  private lastError: number;
+
+  constructor(periodUs: number) {
+    this.nominalPeriodMs = periodUs / 1000;
+    this.periodMs = this.nominalPeriodMs;
+    this.nextIndex = 0;
+    this.anchorIndex = 0;
+    this.anchorTime = 0;
+    this.anchored = false;
+    this.corrections = 0;
+    this.lastCorrection = { index: 0, time: 0 };
+    this.lastError = 0;
+  }
+
+  /**
+   * Assign times to the next count samples. readAt is the monotonic time
+   * (performance.now) right after the read returned; drained tells whether
+   * the read emptied the buffer.
+   */
+  stamp(
+    count: number,
+    readAt: number,
+    drained: boolean,
+    overrun: boolean = false
+  ): StampedBatch {
+    const firstIndex = this.nextIndex;
+    const lastIndex = firstIndex + count - 1;
+
+    if (count > 0 && drained) {
+      this.observe(lastIndex, readAt);
+    }
+
+    const timestamps = new Float64Array(count);
+    if (this.anchored) {
+      const base = performance.timeOrigin + this.anchorTime;
+      for (let i = 0; i < count; i++) {
+        timestamps[i] = base + (firstIndex + i - this.anchorIndex) * this.periodMs;
+      }
+    } else {
+      // Nothing to anchor on yet: assume the batch ends at the read
+      const base = performance.timeOrigin + readAt;
+      for (let i = 0; i < count; i++) {
+        timestamps[i] = base - (count - 1 - i) * this.periodMs;
+      }
+    }
+
+    this.nextIndex += count;
+
+    let quality: TimestampQuality = this.corrections > 0 ? 'locked' : 'estimated';
+    if (overrun) {
+      // The index chain breaks here; the next batch starts a new anchor
+      quality = 'overrun';
+      this.restart();
+    }
+    return { firstIndex, timestamps, quality };
+  }
+
+  /**
+   * Forget the anchor and the index chain, e.g. after logging restarted.
+   * The period estimate is kept.
+   */
+  restart(): void {
+    this.nextIndex = 0;
+    this.anchored = false;
+    this.corrections = 0;
+  }
+
+  private timeOf(index: number): number {
+    return this.anchorTime + (index - this.anchorIndex) * this.periodMs;
+  }
+
+  private observe(index: number, readAt: number): void {
+    if (!this.anchored) {
+      this.anchorIndex = index;
+      this.anchorTime = readAt;
+      this.anchored = true;
+      this.lastCorrection = { index, time: readAt };
+      return;
+    }
+
+    const predicted = this.timeOf(index);
+    const error = readAt - predicted;
+    this.lastError = error;
+
+    if (error < 0) {
+      // A sample cannot be taken after it was read
+      this.anchorIndex = index;
+      this.anchorTime = readAt;
+      return;
+    }
+
+    const elapsed = readAt - this.lastCorrection.time;
+    const samples = index - this.lastCorrection.index;
+    if (elapsed < LIMITS.LOGGING_CLOCK_CORRECTION_INTERVAL || samples <= 0) {
+      return;
+    }
+
+    const maxDeviation = (this.nominalPeriodMs * LIMITS.LOGGING_CLOCK_MAX_DRIFT_PPM) / 1e6;
+    const measured = elapsed / samples;
+    this.periodMs = Math.min(
+      this.nominalPeriodMs + maxDeviation,
+      Math.max(
+        this.nominalPeriodMs - maxDeviation,
+        this.periodMs + CORRECTION_GAIN * (measured - this.periodMs)
+      )
+    );
+
+    // Re-anchor on the model itself so the grid does not jump, then slew
+    this.anchorTime = predicted + CORRECTION_GAIN * error;
+    this.anchorIndex = index;
+    this.lastCorrection = { index, time: readAt };
+    this.corrections++;
+  }
+
+  getStatus() {
+    return {
+      nominalPeriodUs: this.nominalPeriodMs * 1000,
+      periodUs: this.periodMs * 1000,
+      driftPpm: ((this.periodMs - this.nominalPeriodMs) / this.nominalPeriodMs) * 1e6,
+      samples: this.nextIndex,
+      anchored: this.anchored,
+      corrections: this.corrections,
+      lastErrorUs: this.lastError * 1000,
+    };
+  }
+}
@@ -0,0 +1,22 @@
+/**
+ * Thread Pool Sizing
+ * Must be imported before anything that touches the libuv thread pool
+ *
+ */
+
+// ============================================================================
+// THREAD POOL
+// ============================================================================
+
+// Every asynchronous DLL call (ISDU, BLOB and firmware update steps) occupies
+// a libuv worker until the device answers. The default of four workers would
+// serialize concurrent services on more than four ports, so the pool is sized
+// for a fleet of ports unless the operator set it explicitly. libuv reads the
+// variable once, when the pool is first used.
+const DEFAULT_THREADPOOL_SIZE = 64;
+
+if (!process.env.UV_THREADPOOL_SIZE) {
+  process.env.UV_THREADPOOL_SIZE = String(DEFAULT_THREADPOOL_SIZE);
+}
+
+export {};
@@ -0,0 +1,177 @@
+/**
+ * Time-Ordered Merge
+ * Merges per-source sample streams into one stream ordered by timestamp
+ *
+ */
+
+export interface TimedSample {
+  // Epoch milliseconds
+  timestamp: number;
+}
+
+interface MergeOptions<T extends TimedSample> {
+  // Longest a sample is held back waiting for slower sources
+  maxDelayMs: number;
+  emit: (source: string, sample: T) => void;
+}
+
+interface HeapEntry<T> {
+  source: string;
+  sample: T;
+  order: number;
+  arrivedAt: number;
+}
+
+// ============================================================================
+// TIME-ORDERED MERGE
+// ============================================================================
+
+/**
+ * Each source must deliver its own samples in order. A sample is released
+ * once every source has delivered something at least as new (the
+ * watermark), or once it has waited maxDelayMs of wall time, whichever comes
+ * first. A sample older than one already released is late: it is dropped
+ * and counted, so the output never goes back in time.
+ */
+export class TimeOrderedMerge<T extends TimedSample> {
+  private options: MergeOptions<T>;
+  private heap: HeapEntry<T>[];
+  private sources: Map<string, { latest: number; arrivedAt: number }>;
+  private order: number;
+  private lastEmitted: number;
+  private stats: { received: number; emitted: number; late: number; timedOut: number };
+
+  constructor(options: MergeOptions<T>) {
+    this.options = options;
+    this.heap = [];
+    this.sources = new Map();
+    this.order = 0;
+    this.lastEmitted = -Infinity;
+    this.stats = { received: 0, emitted: 0, late: 0, timedOut: 0 };
+  }
+
+  addSource(source: string): void {
+    if (!this.sources.has(source)) {
+      this.sources.set(source, { latest: -Infinity, arrivedAt: Date.now() });
+    }
+  }
+
+  removeSource(source: string): void {
+    this.sources.delete(source);
+    this.drain();
+  }
+
+  push(source: string, sample: T): void {
+    this.stats.received++;
+    if (sample.timestamp < this.lastEmitted) {
+      this.stats.late++;
+      return;
+    }
+
+    const now = Date.now();
+    const state = this.sources.get(source);
+    if (state) {
+      state.latest = Math.max(state.latest, sample.timestamp);
+      state.arrivedAt = now;
+    } else {
+      this.sources.set(source, { latest: sample.timestamp, arrivedAt: now });
+    }
+
+    this.heapPush({ source, sample, order: this.order++, arrivedAt: now });
+    this.drain(now);
+  }
+
+  /**
+   * Release everything due; call periodically so silent sources cannot
+   * hold samples back beyond maxDelayMs
+   */
+  drain(now: number = Date.now()): void {
+    const watermark = this.watermark(now);
+
+    while (this.heap.length > 0) {
+      const head = this.heap[0];
+      const waited = now - head.arrivedAt;
+      const due = head.sample.timestamp <= watermark;
+      if (!due && waited < this.options.maxDelayMs) break;
+      if (!due) this.stats.timedOut++;
+
+      this.heapPop();
+      this.lastEmitted = head.sample.timestamp;
+      this.stats.emitted++;
+      this.options.emit(head.source, head.sample);
+    }
+  }
+
+  /**
+   * Everything still held, in order (e.g. when the stream closes)
+   */
+  flush(): void {
+    while (this.heap.length > 0) {
+      const head = this.heapPop()!;
+      this.lastEmitted = head.sample.timestamp;
+      this.stats.emitted++;
+      this.options.emit(head.source, head.sample);
+    }
+  }
+
+  // Sources quiet for longer than maxDelayMs do not hold the others back
+  private watermark(now: number): number {
+    let watermark = Infinity;
+    for (const state of this.sources.values()) {
+      if (now - state.arrivedAt >= this.options.maxDelayMs) continue;
+      watermark = Math.min(watermark, state.latest);
+    }
+    return watermark;
+  }
+
+  getStatus() {
+    return {
+      sources: this.sources.size,
+      pending: this.heap.length,
+      maxDelayMs: this.options.maxDelayMs,
+      ...this.stats,
+    };
+  }
+
+  // ==========================================================================
+  // BINARY HEAP
+  // ==========================================================================
+
+  private before(a: HeapEntry<T>, b: HeapEntry<T>): boolean {
+    return a.sample.timestamp < b.sample.timestamp ||
+      (a.sample.timestamp === b.sample.timestamp && a.order < b.order);
+  }
+
+  private heapPush(entry: HeapEntry<T>): void {
+    const heap = this.heap;
+    heap.push(entry);
+    let i = heap.length - 1;
+    while (i > 0) {
+      const parent = (i - 1) >> 1;
+      if (!this.before(heap[i], heap[parent])) break;
+      [heap[i], heap[parent]] = [heap[parent], heap[i]];
+      i = parent;
+    }
+  }
+
+  private heapPop(): HeapEntry<T> | undefined {
+    const heap = this.heap;
+    const top = heap[0];
+    const last = heap.pop();
+    if (heap.length > 0 && last) {
+      heap[0] = last;
+      let i = 0;
+      for (;;) {
+        const left = 2 * i + 1;
+        const right = left + 1;
+        let smallest = i;
+        if (left < heap.length && this.before(heap[left], heap[smallest])) smallest = left;
+        if (right < heap.length && this.before(heap[right], heap[smallest])) smallest = right;
+        if (smallest === i) break;
+        [heap[i], heap[smallest]] = [heap[smallest], heap[i]];
+        i = smallest;
+      }
+    }
+    return top;
+  }
+}
@@ -0,0 +1,268 @@
+/**
+ * Request Tracing
+ * Sampled span tracing from route to DLL call, exported as Chrome trace JSON
+ *
+ */
+
+import { AsyncLocalStorage } from 'async_hooks';
+import { performance } from 'perf_hooks';
+import { Request, Response, NextFunction } from 'express';
+import fs from 'fs';
+import path from 'path';
+import logger from './logger';
+import { LIMITS } from './constants';
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+export interface TraceContext {
+  traceId: number;
+}
+
+// Chrome trace event ("X" = complete span, "i" = instant)
+interface TraceEvent {
+  name: string;
+  cat: string;
+  ph: 'X' | 'i';
+  ts: number;
+  dur?: number;
+  s?: 't';
+  pid: number;
+  tid: number;
+  args?: Record<string, any>;
+}
+
+export interface TracingOptions {
+  enabled: boolean;
+  sampleRate?: number;
+}
+
+// ============================================================================
+// TRACER
+// ============================================================================
+
+/**
+ * Spans are buffered in memory and appended to a trace file in the Chrome
+ * JSON array format, which Perfetto and chrome://tracing open directly (the
+ * closing bracket is optional). Each sampled request gets its own track.
+ */
+class Tracer {
+  private storage: AsyncLocalStorage<TraceContext>;
+  private buffer: TraceEvent[];
+  private flushTimer: NodeJS.Timeout | null;
+  private flushing: Promise<void>;
+  private nextTraceId: number;
+  enabled: boolean;
+  sampleRate: number;
+  file: string | null;
+  private fileSize: number;
+  private stats: { traces: number; spans: number; dropped: number };
+
+  constructor() {
+    this.storage = new AsyncLocalStorage();
+    this.buffer = [];
+    this.flushTimer = null;
+    this.flushing = Promise.resolve();
+    this.nextTraceId = 1;
+    this.enabled = false;
+    this.sampleRate = 0.01;
+    this.file = null;
+    this.fileSize = 0;
+    this.stats = { traces: 0, spans: 0, dropped: 0 };
+  }
+
+  /**
+   * Start or stop tracing; starting opens a new trace file.
+   */
+  async configure(options: TracingOptions): Promise<void> {
+    if (options.sampleRate !== undefined) {
+      this.sampleRate = options.sampleRate;
+    }
+
+    if (options.enabled && !this.enabled) {
+      const dir = process.env.TRACE_DIR || path.join('data', 'traces');
+      await fs.promises.mkdir(dir, { recursive: true });
+      this.file = path.join(
+        dir,
+        `trace-${new Date().toISOString().replace(/[:.]/g, '-')}.json`
+      );
+      await fs.promises.writeFile(this.file, '[\n');
+      this.fileSize = 2;
+      this.stats = { traces: 0, spans: 0, dropped: 0 };
+      this.enabled = true;
+      this.flushTimer = setInterval(() => this.flush(), LIMITS.TRACE_FLUSH_INTERVAL);
+      logger.info(`Tracing enabled (sample rate ${this.sampleRate}): ${this.file}`);
+    } else if (!options.enabled && this.enabled) {
+      this.enabled = false;
+      if (this.flushTimer) {
+        clearInterval(this.flushTimer);
+        this.flushTimer = null;
+      }
+      await this.flush();
+      logger.info(`Tracing disabled: ${this.file}`);
+    }
+  }
+
+  /**
+   * Context of the sampled trace the caller runs in, if any.
+   */
+  current(): TraceContext | undefined {
+    return this.enabled ? this.storage.getStore() : undefined;
+  }
+
+  /**
+   * Run fn inside a new trace if this call is sampled.
+   */
+  sample<T>(fn: (context: TraceContext | undefined) => T): T {
+    if (!this.enabled || Math.random() >= this.sampleRate) {
+      return fn(undefined);
+    }
+    const context = { traceId: this.nextTraceId++ };
+    this.stats.traces++;
+    return this.storage.run(context, () => fn(context));
+  }
+
+  span(
+    context: TraceContext,
+    name: string,
+    cat: string,
+    startMs: number,
+    endMs: number,
+    args?: Record<string, any>
+  ): void {
+    this.push({
+      name,
+      cat,
+      ph: 'X',
+      ts: Math.round(startMs * 1000),
+      dur: Math.max(0, Math.round((endMs - startMs) * 1000)),
+      pid: process.pid,
+      tid: context.traceId,
+      args,
+    });
+  }
+
+  instant(context: TraceContext, name: string, cat: string, args?: Record<string, any>): void {
+    this.push({
+      name,
+      cat,
+      ph: 'i',
+      s: 't',
+      ts: Math.round(performance.now() * 1000),
+      pid: process.pid,
+      tid: context.traceId,
+      args,
+    });
+  }
+
+  private push(event: TraceEvent): void {
+    if (!this.enabled) return;
+    if (this.buffer.length >= LIMITS.TRACE_BUFFER_SIZE) {
+      this.stats.dropped++;
+      return;
+    }
+    this.buffer.push(event);
+    this.stats.spans++;
+  }
+
+  private flush(): Promise<void> {
+    this.flushing = this.flushing.then(async () => {
+      if (this.buffer.length === 0 || !this.file) return;
+
+      const events = this.buffer;
+      this.buffer = [];
+      const chunk = events.map((event) => JSON.stringify(event) + ',\n').join('');
+
+      try {
+        await fs.promises.appendFile(this.file, chunk);
+        this.fileSize += Buffer.byteLength(chunk);
+      } catch (error: any) {
+        logger.error(`Trace file write failed: ${error.message}`);
+        this.stats.dropped += events.length;
+        return;
+      }
+
+      if (this.enabled && this.fileSize >= LIMITS.TRACE_MAX_FILE_SIZE) {
+        logger.warn(`Trace file reached ${this.fileSize} bytes, disabling tracing`);
+        // Not awaited: the final flush queues behind this one
+        void this.configure({ enabled: false });
+      }
+    });
+    return this.flushing;
+  }
+
+  getStatus() {
+    return {
+      enabled: this.enabled,
+      sampleRate: this.sampleRate,
+      file: this.file,
+      fileSize: this.fileSize,
+      buffered: this.buffer.length,
+      ...this.stats,
+    };
+  }
+}
+
+export const tracer = new Tracer();
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+/**
+ * Time an async operation as a span of the current trace; a plain call when
+ * the caller is not sampled.
+ */
+export async function traceAsync<T>(
+  name: string,
+  cat: string,
+  fn: () => Promise<T>,
+  args?: Record<string, any>
+): Promise<T> {
+  const context = tracer.current();
+  if (!context) return fn();
+
+  const start = performance.now();
+  try {
+    return await fn();
+  } finally {
+    tracer.span(context, name, cat, start, performance.now(), args);
+  }
+}
+
+/**
+ * Mark a point in the current trace (cache hit, coalesced read, ...).
+ */
+export function traceInstant(name: string, cat: string, args?: Record<string, any>): void {
+  const context = tracer.current();
+  if (context) tracer.instant(context, name, cat, args);
+}
+
+/**
+ * Express middleware opening a trace for sampled requests. The request span
+ * is named by route template; JSON serialization gets its own span.
+ */
+export function requestTracing(req: Request, res: Response, next: NextFunction): void {
+  tracer.sample((context) => {
+    if (!context) return next();
+
+    const start = performance.now();
+    const json = res.json.bind(res);
+    res.json = (body: any) => {
+      const serializeStart = performance.now();
+      const result = json(body);
+      tracer.span(context, 'serialize', 'http', serializeStart, performance.now());
+      return result;
+    };
+
+    res.on('finish', () => {
+      const route = req.route ? `${req.baseUrl}${req.route.path}` : req.path;
+      tracer.span(context, `${req.method} ${route}`, 'http', start, performance.now(), {
+        url: req.originalUrl,
+        status: res.statusCode,
+      });
+    });
+    next();
+  });
+}
@@ -0,0 +1,196 @@
+/**
+ * Cyclic Scheduler
+ * Absolute-deadline task scheduler for acquisition threads
+ *
+ */
+
+import { performance } from 'perf_hooks';
+import { LatencyHistogram } from '../utils/diagnostics';
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+export interface CyclicTaskStats {
+  name: string;
+  periodMs: number;
+  cycles: number;
+  overruns: number;
+  skippedCycles: number;
+  lastDurationUs: number;
+  maxDurationUs: number;
+  jitter: Record<string, number>;
+}
+
+export interface CyclicSchedulerStats {
+  running: boolean;
+  spinUs: number;
+  tasks: CyclicTaskStats[];
+}
+
+/**
+ * Runs one cycle of a task. deadline is the scheduled start on the
+ * performance.now() timeline; sampledAt the actual start in epoch ms.
+ */
+export type CyclicTaskRun = (deadline: number, sampledAt: number) => void | Promise<void>;
+
+interface CyclicTask {
+  name: string;
+  periodMs: number;
+  run: CyclicTaskRun;
+  deadline: number;
+  cycles: number;
+  overruns: number;
+  skippedCycles: number;
+  lastDurationUs: number;
+  maxDurationUs: number;
+  jitter: LatencyHistogram;
+}
+
+interface SchedulerOptions {
+  // Final stretch before a deadline that is busy-waited instead of slept
+  spinUs: number;
+  // Called once per iteration; returning false ends the loop
+  poll: () => boolean;
+}
+
+// ============================================================================
+// SCHEDULER
+// ============================================================================
+
+/**
+ * Single-threaded scheduler for a worker thread that owns its event loop.
+ * Each task runs at deadline = start + k * period, so sample spacing does
+ * not drift with execution time. The thread sleeps with Atomics.wait until
+ * shortly before the next deadline and spins the rest. A task that runs past
+ * its next deadline counts an overrun and skips the missed cycles instead of
+ * running them back to back. Lateness of every start is kept as jitter.
+ */
+export class CyclicScheduler {
+  private tasks: Map<string, CyclicTask>;
+  private options: SchedulerOptions;
+  private sleepWord: Int32Array;
+  private running: boolean;
+
+  constructor(options: SchedulerOptions) {
+    this.tasks = new Map();
+    this.options = options;
+    this.sleepWord = new Int32Array(new SharedArrayBuffer(4));
+    this.running = false;
+  }
+
+  /**
+   * Add or re-time a task; a changed period restarts its deadline chain
+   */
+  set(name: string, periodMs: number, run: CyclicTaskRun): void {
+    const existing = this.tasks.get(name);
+    if (existing) {
+      existing.run = run;
+      if (existing.periodMs !== periodMs) {
+        existing.periodMs = periodMs;
+        existing.deadline = performance.now();
+      }
+      return;
+    }
+
+    this.tasks.set(name, {
+      name,
+      periodMs,
+      run,
+      deadline: performance.now(),
+      cycles: 0,
+      overruns: 0,
+      skippedCycles: 0,
+      lastDurationUs: 0,
+      maxDurationUs: 0,
+      jitter: new LatencyHistogram(),
+    });
+  }
+
+  delete(name: string): void {
+    this.tasks.delete(name);
+  }
+
+  has(name: string): boolean {
+    return this.tasks.has(name);
+  }
+
+  names(): string[] {
+    return Array.from(this.tasks.keys());
+  }
+
+  stop(): void {
+    this.running = false;
+  }
+
+  async run(): Promise<void> {
+    this.running = true;
+
+    while (this.running && this.options.poll()) {
+      const task = this.nextTask();
+      if (!task) {
+        this.sleepUntil(performance.now() + 10);
+        continue;
+      }
+
+      this.sleepUntil(task.deadline);
+
+      const started = performance.now();
+      task.jitter.record((started - task.deadline) * 1000);
+      await task.run(task.deadline, performance.timeOrigin + started);
+
+      const finished = performance.now();
+      const durationUs = (finished - started) * 1000;
+      task.cycles++;
+      task.lastDurationUs = durationUs;
+      task.maxDurationUs = Math.max(task.maxDurationUs, durationUs);
+
+      task.deadline += task.periodMs;
+      if (task.deadline <= finished) {
+        const missed = Math.floor((finished - task.deadline) / task.periodMs) + 1;
+        task.overruns++;
+        task.skippedCycles += missed;
+        task.deadline += missed * task.periodMs;
+      }
+    }
+
+    this.running = false;
+  }
+
+  private nextTask(): CyclicTask | null {
+    let next: CyclicTask | null = null;
+    for (const task of this.tasks.values()) {
+      if (!next || task.deadline < next.deadline) {
+        next = task;
+      }
+    }
+    return next;
+  }
+
+  private sleepUntil(deadline: number): void {
+    const sleepMs = deadline - performance.now() - this.options.spinUs / 1000;
+    if (sleepMs > 0) {
+      Atomics.wait(this.sleepWord, 0, 0, sleepMs);
+    }
+    while (performance.now() < deadline) {
+      // Busy-wait the last few microseconds; timer wakeups are coarser
+    }
+  }
+
+  getStats(): CyclicSchedulerStats {
+    return {
+      running: this.running,
+      spinUs: this.options.spinUs,
+      tasks: Array.from(this.tasks.values()).map((task) => ({
+        name: task.name,
+        periodMs: task.periodMs,
+        cycles: task.cycles,
+        overruns: task.overruns,
+        skippedCycles: task.skippedCycles,
+        lastDurationUs: Math.round(task.lastDurationUs),
+        maxDurationUs: Math.round(task.maxDurationUs),
+        jitter: task.jitter.summary(),
+      })),
+    };
+  }
+}
@@ -0,0 +1,265 @@
+/**
+ * Master Acquisition Worker
+ * Cyclic status, event and process data acquisition for one master handle
+ *
+ */
+
+import os from 'os';
+import { parentPort, workerData, receiveMessageOnPort } from 'worker_threads';
+import IOLinkService from '../services/IOLinkService';
+import { RETURN_CODES, SENSOR_STATUS, LIMITS } from '../utils/constants';
+import { ProcessImage } from '../utils/processImage';
+import { CyclicScheduler, CyclicSchedulerStats } from './cyclicScheduler';
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+export interface AcquisitionConfig {
+  masterHandle: number;
+  intervalMs: number;
+  ports: number[];
+  processDataPorts: ProcessDataSchedule[];
+  // Thread nice value (-20..19), unset leaves the default
+  priority?: number;
+  // Shared process image and this master's row in it
+  processImage: SharedArrayBuffer;
+  processImageMasters: number;
+  masterIndex: number;
+}
+
+// Cyclic process data exchange of one port: pending outputs, then inputs
+export interface ProcessDataSchedule {
+  port: number;
+  periodMs: number;
+}
+
+export interface AcquiredEvent {
+  port: number;
+  eventCode: number;
+  instance: number;
+  mode: number;
+  type: number;
+  localGenerated: boolean;
+}
+
+// One status cycle; statuses[i] belongs to ports[i], failed reads are
+// listed in statusErrors and left 0. processDataReads, outputCommits and
+// outputFailures count the process data reads and output writes since the
+// previous status cycle.
+export interface AcquisitionCycle {
+  type: 'cycle';
+  seq: number;
+  startedAt: number;
+  durationMs: number;
+  ports: number[];
+  statuses: Uint8Array;
+  statusErrors: number[];
+  events: AcquiredEvent[];
+  processDataReads: number;
+  outputCommits: number;
+  outputFailures: number;
+}
+
+export interface AcquisitionSchedule {
+  type: 'schedule';
+  stats: CyclicSchedulerStats;
+}
+
+export type AcquisitionCommand =
+  | { type: 'configure'; ports: number[]; processDataPorts: ProcessDataSchedule[] }
+  | { type: 'stop' };
+
+// ============================================================================
+// ACQUISITION LOOP
+// ============================================================================
+
+// The worker has its own DLL bindings; the handle is process-wide, so only
+// calls that need no master registration are made here
+const iolinkService = new IOLinkService();
+const config = workerData as AcquisitionConfig;
+const handle = config.masterHandle;
+const processImage = new ProcessImage(
+  config.processImageMasters,
+  LIMITS.MAX_PORTS,
+  config.processImage
+);
+
+let ports: number[] = config.ports;
+let running = true;
+let seq = 0;
+let processDataReads = 0;
+let outputCommits = 0;
+let outputFailures = 0;
+let statsPostedAt = 0;
+
+// Last known PD-valid bit per port, from the status task
+const processDataValid = new Map<number, boolean>();
+
+// FIFO holds 10 events; the bound only guards against a misbehaving DLL
+const MAX_EVENTS_PER_CYCLE = 32;
+const SCHEDULE_STATS_INTERVAL = 1000;
+
+// The scheduler keeps this thread busy, so commands are drained
+// synchronously between task runs rather than through 'message' events
+const scheduler = new CyclicScheduler({
+  spinUs: LIMITS.SCHEDULER_SPIN_US,
+  poll: () => {
+    let received;
+    while ((received = receiveMessageOnPort(parentPort as any))) {
+      handleCommand(received.message as AcquisitionCommand);
+    }
+    return running;
+  },
+});
+
+function handleCommand(command: AcquisitionCommand): void {
+  if (command.type === 'configure') {
+    ports = command.ports;
+    scheduleProcessData(command.processDataPorts);
+  } else if (command.type === 'stop') {
+    running = false;
+  }
+}
+
+function scheduleProcessData(schedules: ProcessDataSchedule[]): void {
+  const wanted = new Set(schedules.map((schedule) => `pd:${schedule.port}`));
+  for (const name of scheduler.names()) {
+    if (name.startsWith('pd:') && !wanted.has(name)) {
+      scheduler.delete(name);
+    }
+  }
+  for (const { port, periodMs } of schedules) {
+    scheduler.set(`pd:${port}`, periodMs, async (_deadline, sampledAt) => {
+      if (!processImage.isOwnedBy(config.masterIndex, handle)) return;
+      await commitOutputs(port);
+      await readProcessData(port, sampledAt);
+    });
+  }
+}
+
+function statusCycle(): void {
+  const startedAt = Date.now();
+  const statuses = new Uint8Array(ports.length);
+  const statusErrors: number[] = [];
+  const events: AcquiredEvent[] = [];
+  let eventPending = false;
+
+  for (let i = 0; i < ports.length; i++) {
+    try {
+      statuses[i] = iolinkService.getSensorStatus(handle, ports[i]);
+    } catch (error: any) {
+      if (error.code === RETURN_CODES.RETURN_CONNECTION_LOST) {
+        parentPort!.postMessage({ type: 'connection-lost' });
+        running = false;
+        return;
+      }
+      statusErrors.push(ports[i]);
+      continue;
+    }
+    processDataValid.set(ports[i], (statuses[i] & SENSOR_STATUS.BIT_PDVALID) !== 0);
+    if (statuses[i] & SENSOR_STATUS.BIT_EVENTAVAILABLE) {
+      eventPending = true;
+    }
+  }
+
+  if (eventPending) {
+    for (let i = 0; i < MAX_EVENTS_PER_CYCLE; i++) {
+      let event;
+      try {
+        event = iolinkService.readEvent(handle);
+      } catch (error) {
+        break;
+      }
+      if (!event) break;
+      events.push({
+        port: event.port,
+        eventCode: event.eventCode,
+        instance: event.instance,
+        mode: event.mode,
+        type: event.type,
+        localGenerated: event.localGenerated,
+      });
+    }
+  }
+
+  const message: AcquisitionCycle = {
+    type: 'cycle',
+    seq: ++seq,
+    startedAt,
+    durationMs: Date.now() - startedAt,
+    ports,
+    statuses,
+    statusErrors,
+    events,
+    processDataReads,
+    outputCommits,
+    outputFailures,
+  };
+  parentPort!.postMessage(message, [statuses.buffer]);
+  processDataReads = 0;
+  outputCommits = 0;
+  outputFailures = 0;
+
+  if (startedAt - statsPostedAt >= SCHEDULE_STATS_INTERVAL) {
+    statsPostedAt = startedAt;
+    const schedule: AcquisitionSchedule = { type: 'schedule', stats: scheduler.getStats() };
+    parentPort!.postMessage(schedule);
+  }
+}
+
+/**
+ * Write the latest outputs posted to the process image, if any arrived
+ * since the last cycle. Writers only replace the slot, so a burst costs one
+ * IOL_WriteOutputs per cycle and the master always gets the newest value.
+ */
+async function commitOutputs(port: number): Promise<void> {
+  const outputs = processImage.takeOutputs(config.masterIndex, port);
+  if (!outputs) return;
+
+  let result: number = RETURN_CODES.RETURN_OK;
+  try {
+    await iolinkService.writeProcessData(handle, port, outputs.data);
+    outputCommits++;
+  } catch (error: any) {
+    result = typeof error.code === 'number' ? error.code : RETURN_CODES.RETURN_INTERNAL_ERROR;
+    outputFailures++;
+  }
+  processImage.commitOutputs(config.masterIndex, port, outputs.sequence, result, Date.now());
+}
+
+/**
+ * Inputs go straight into the shared process image, stamped with the
+ * actual start of the read
+ */
+async function readProcessData(port: number, sampledAt: number): Promise<void> {
+  if (processDataValid.get(port) === false) return;
+
+  try {
+    const result = await iolinkService.readProcessData(handle, port);
+    processImage.writeInputs(config.masterIndex, port, result.data, result.status, sampledAt);
+    processDataReads++;
+  } catch (error) {
+    // Reported through the status byte on the next status cycle
+  }
+}
+
+// Linux applies a nice value set from a thread to that thread only
+if (config.priority !== undefined) {
+  try {
+    os.setPriority(0, config.priority);
+  } catch (error: any) {
+    parentPort!.postMessage({ type: 'error', message: `setPriority: ${error.message}` });
+  }
+}
+
+scheduler.set('status', config.intervalMs, () => {
+  try {
+    statusCycle();
+  } catch (error: any) {
+    parentPort!.postMessage({ type: 'error', message: error.message });
+  }
+});
+scheduleProcessData(config.processDataPorts);
+
+scheduler.run().then(() => process.exit(0));
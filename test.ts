@@ -0,0 +1,508 @@
+// Checks of the services and utilities that need no DLL or hardware
+import assert from "assert";
+import Module from "module";
+import { performance } from "perf_hooks";
+import { decodeBlock, encodeBlock, readBlockHeader } from "./src/utils/columnCodec";
+import { DownsamplePyramid } from "./src/utils/downsamplePyramid";
+import { LIMITS } from "./src/utils/constants";
+import { PortProgram, RuleDefinition, RuleType, TRANSITION_NAMES } from "./src/utils/ruleProgram";
+import logger from "./src/utils/logger";
+
+let failures = 0;
+const checks: Array<{ name: string; body: () => void | Promise<void> }> = [];
+
+function check(name: string, body: () => void | Promise<void>): void {
+  checks.push({ name, body });
+}
+
+/**
+ * Serve `exports` for a module instead of loading it (used for the DLL
+ * binding, which does not load off Windows)
+ */
+function stubModule(request: string, exports: any): void {
+  const id = require.resolve(request);
+  const stub = new Module(id);
+  stub.filename = id;
+  stub.loaded = true;
+  stub.exports = exports;
+  require.cache[id] = stub;
+}
+
+// ============================================================================
+// DOWNSAMPLE PYRAMID
+// ============================================================================
+
+// Five minutes of 1 kHz data ending at `end`
+const start = Date.UTC(2024, 0, 1);
+const end = start + 5 * 60 * 1000;
+const pyramid = new DownsamplePyramid();
+for (let t = start; t < end; t++) {
+  pyramid.add(t, Math.sin(t / 1000));
+}
+
+check("range inside the capture reads a fine level", () => {
+  const result = pyramid.query(end - 5 * 60 * 1000, end, 1000);
+  assert.strictEqual(result.bucketMs, 512);
+  assert.ok(result.timestamps.length > 500, `${result.timestamps.length} points`);
+});
+
+check("range starting before the capture is not pushed to the coarsest level", () => {
+  const result = pyramid.query(end - 60 * 60 * 1000, end, 1000);
+  assert.strictEqual(result.bucketMs, 4096);
+  assert.ok(result.timestamps.length >= 70, `${result.timestamps.length} points`);
+  assert.strictEqual(result.count.reduce((a, b) => a + b, 0), 5 * 60 * 1000);
+});
+
+check("wrapped levels are skipped when they no longer reach from", () => {
+  // The 1 ms level holds the last ~8 s only
+  const result = pyramid.query(end - 20 * 1000, end, 20 * 1000);
+  assert.ok(result.bucketMs > 1, `level ${result.level}`);
+  assert.ok(result.timestamps[0] <= end - 20 * 1000, "first bucket after from");
+});
+
+// ============================================================================
+// COLUMN CODEC
+// ============================================================================
+
+interface CodecSample {
+  timestamp: number;
+  sampleIndex: number;
+  flags: number;
+  value: number;
+  inputs: number[];
+}
+
+/**
+ * Encode the samples as one block, decode it and compare every column
+ */
+function assertRoundTrip(samples: CodecSample[], lanes: number): void {
+  const count = samples.length;
+  const inputs = new Uint8Array(count * lanes);
+  samples.forEach((sample, i) => inputs.set(sample.inputs, i * lanes));
+  const block = encodeBlock(
+    count,
+    Float64Array.from(samples, (s) => s.timestamp),
+    Float64Array.from(samples, (s) => s.sampleIndex),
+    Uint8Array.from(samples, (s) => s.flags),
+    Float64Array.from(samples, (s) => s.value),
+    lanes,
+    inputs
+  );
+
+  const header = readBlockHeader(block)!;
+  assert.strictEqual(header.count, count);
+  assert.strictEqual(header.lanes, lanes);
+  assert.strictEqual(header.byteLength, block.length);
+
+  const decoded = decodeBlock(block);
+  assert.strictEqual(decoded.count, count);
+  assert.deepStrictEqual(Array.from(decoded.timestamps), samples.map((s) => s.timestamp));
+  assert.deepStrictEqual(Array.from(decoded.sampleIndexes), samples.map((s) => s.sampleIndex));
+  assert.deepStrictEqual(Array.from(decoded.flags), samples.map((s) => s.flags));
+  assert.deepStrictEqual(Array.from(decoded.inputs), Array.from(inputs));
+  samples.forEach((sample, i) =>
+    assert.ok(Object.is(decoded.values[i], sample.value), `value ${i}: ${decoded.values[i]} !== ${sample.value}`)
+  );
+}
+
+check("empty block round-trips", () => {
+  assertRoundTrip([], 0);
+  assertRoundTrip([], 4);
+});
+
+check("single-sample block round-trips", () => {
+  assertRoundTrip([{ timestamp: start + 0.123, sampleIndex: 7, flags: 1, value: 21.5, inputs: [0x12, 0x34] }], 2);
+  assertRoundTrip([{ timestamp: 0, sampleIndex: 0, flags: 0, value: 0, inputs: [] }], 0);
+});
+
+check("zero and maximum width columns round-trip", () => {
+  const samples: CodecSample[] = [];
+  // Constant frames (width 0), then full-range bytes and 40-bit index jumps
+  for (let i = 0; i < 300; i++) {
+    const wide = i >= 128 && i % 2 === 1;
+    samples.push({
+      timestamp: start + i,
+      sampleIndex: wide ? 2 ** 40 + i : i,
+      flags: i < 128 ? 0 : wide ? 0xff : 0,
+      value: i < 128 ? 1 : wide ? Number.MAX_VALUE : -Number.MIN_VALUE,
+      inputs: i < 128 ? [0, 0] : wide ? [0xff, 0] : [0, 0xff],
+    });
+  }
+  assertRoundTrip(samples, 2);
+});
+
+check("negative deltas round-trip", () => {
+  const samples: CodecSample[] = [];
+  for (let i = 0; i < 200; i++) {
+    // Clock stepped back and sample counter restarted half-way
+    const restarted = i >= 100;
+    samples.push({
+      timestamp: restarted ? start - 5000 + i * 0.25 : start + i * 2,
+      sampleIndex: restarted ? i - 100 : 1000 - i * 3,
+      flags: (i * 7) % 5,
+      value: -i * 0.5,
+      inputs: [255 - i, i % 3 === 0 ? 200 : 1],
+    });
+  }
+  assertRoundTrip(samples, 2);
+});
+
+check("NaN and invalid samples round-trip", () => {
+  const values = [NaN, 1.5, NaN, NaN, -0, 0, Infinity, -Infinity, NaN, 3];
+  const samples = values.map((value, i) => ({
+    timestamp: start + i,
+    sampleIndex: i,
+    // Samples without valid input carry NaN and flag 0
+    flags: Number.isNaN(value) ? 0 : 1,
+    value,
+    inputs: Number.isNaN(value) ? [0] : [i],
+  }));
+  assertRoundTrip(samples, 1);
+});
+
+// ============================================================================
+// RULE PROGRAM
+// ============================================================================
+
+function rule(id: string, type: RuleType, options: Partial<RuleDefinition>): RuleDefinition {
+  return {
+    id,
+    name: id,
+    masterHandle: 0,
+    port: 1,
+    type,
+    decoding: { dataType: "int8", offset: 0, scale: 1, bias: 0 },
+    ...options,
+  };
+}
+
+/**
+ * Feed [value, timestamp] pairs (value as one int8 byte) and list the
+ * transitions as "id:transition@timestamp"
+ */
+function evaluateAll(program: PortProgram, samples: Array<[number, number]>): string[] {
+  const transitions: string[] = [];
+  for (const [value, timestamp] of samples) {
+    program.evaluate(Buffer.from([value & 0xff]), timestamp, (r, transition, _value, at) =>
+      transitions.push(`${program.rules[r].id}:${TRANSITION_NAMES[transition]}@${at}`)
+    );
+  }
+  return transitions;
+}
+
+check("threshold rules raise beyond the limit and clear past the hysteresis", () => {
+  const program = new PortProgram(0, 1, [
+    rule("high", "threshold", { direction: "above", limit: 50, hysteresis: 10 }),
+    rule("low", "threshold", { direction: "below", limit: -50, hysteresis: 10 }),
+  ]);
+  const transitions = evaluateAll(program, [
+    [50, 0], // at the limit: not beyond it
+    [51, 1],
+    [41, 2], // inside the hysteresis band
+    [39, 3],
+    [-51, 4],
+    [-41, 5],
+    [-39, 6],
+  ]);
+  assert.deepStrictEqual(transitions, [
+    "high:raised@1",
+    "high:cleared@3",
+    "low:raised@4",
+    "low:cleared@6",
+  ]);
+});
+
+check("edge rules report the selected crossings of the level", () => {
+  const program = new PortProgram(0, 1, [
+    rule("rising", "edge", { edge: "rising", level: 10 }),
+    rule("falling", "edge", { edge: "falling", level: 10 }),
+    rule("both", "edge", { edge: "both", level: 10 }),
+  ]);
+  const transitions = evaluateAll(program, [
+    [20, 0], // first sample has nothing to cross from
+    [10, 1],
+    [11, 2],
+    [12, 3],
+    [0, 4],
+  ]);
+  assert.deepStrictEqual(transitions, [
+    "falling:falling@1",
+    "both:falling@1",
+    "rising:rising@2",
+    "both:rising@2",
+    "falling:falling@4",
+    "both:falling@4",
+  ]);
+});
+
+check("rate rules measure over the window and restart when time goes backwards", () => {
+  const program = new PortProgram(0, 1, [rule("rate", "rate", { windowMs: 1000, limit: 50, hysteresis: 10 })]);
+  const transitions = evaluateAll(program, [
+    [0, 0],
+    [100, 500], // inside the window
+    [100, 1000], // 100/s
+    [100, 400], // time went backwards: new reference, no rate
+    [60, 1400], // 40/s: inside the hysteresis band
+    [60, 2400], // 0/s
+  ]);
+  assert.deepStrictEqual(transitions, ["rate:raised@1000", "rate:cleared@2400"]);
+});
+
+check("stuck rules raise after the duration and clear on movement", () => {
+  const program = new PortProgram(0, 1, [rule("stuck", "stuck", { durationMs: 1000, tolerance: 2 })]);
+  const transitions = evaluateAll(program, [
+    [10, 0],
+    [12, 500],
+    [8, 999],
+    [10, 1000],
+    [11, 2000], // already raised
+    [13, 2500], // moved beyond the tolerance
+    [13, 3000],
+    [13, 3500],
+  ]);
+  assert.deepStrictEqual(transitions, ["stuck:raised@1000", "stuck:cleared@2500", "stuck:raised@3500"]);
+});
+
+check("resetHistory hides the jump across a gap", () => {
+  const rules = [rule("edge", "edge", { edge: "both", level: 10 }), rule("rate", "rate", { windowMs: 100, limit: 50 })];
+  const reset = new PortProgram(0, 1, rules);
+  evaluateAll(reset, [[0, 0], [0, 100]]);
+  reset.resetHistory();
+  assert.deepStrictEqual(evaluateAll(reset, [[100, 200], [100, 300]]), []);
+
+  // The same samples without the reset are an edge and a rate
+  const kept = new PortProgram(0, 1, rules);
+  evaluateAll(kept, [[0, 0], [0, 100]]);
+  assert.deepStrictEqual(evaluateAll(kept, [[100, 200]]), ["edge:rising@200", "rate:raised@200"]);
+});
+
+check("rebuilt program keeps the state of the rules that stay", () => {
+  const high = rule("high", "threshold", { limit: 50, hysteresis: 10 });
+  const first = new PortProgram(0, 1, [high]);
+  assert.deepStrictEqual(evaluateAll(first, [[60, 0]]), ["high:raised@0"]);
+
+  const added = rule("added", "threshold", { limit: 50 });
+  const rebuilt = new PortProgram(0, 1, [added, high], first);
+  assert.ok(rebuilt.isActive(1), "carried alarm");
+  assert.ok(!rebuilt.isActive(0), "new rule starts inactive");
+  assert.strictEqual(rebuilt.getLastValue(1), 60);
+  assert.strictEqual(rebuilt.samples, 1);
+  // Still above the limit: only the new rule raises
+  assert.deepStrictEqual(evaluateAll(rebuilt, [[60, 1], [30, 2]]), [
+    "added:raised@1",
+    "added:cleared@2",
+    "high:cleared@2",
+  ]);
+});
+
+// ============================================================================
+// PROCESS DATA PERIOD
+// ============================================================================
+
+// Cycle time octet 0x14: time base 0.1 ms, multiplier 20 = 2 ms
+const CYCLE_TIME_2MS = 0x14;
+
+class FakeIOLinkService {
+  reads: string[] = [];
+
+  async readParameter(handle: number, port: number, index: number, subIndex: number) {
+    this.reads.push(`${index}.${subIndex}`);
+    // Only Direct Parameter Page 1 octet 2 carries MinCycleTime
+    if (index !== 0 || subIndex !== 3) {
+      const error: any = new Error(`ISDU ${index}.${subIndex} not readable`);
+      error.code = -1;
+      throw error;
+    }
+    return { data: Buffer.from([CYCLE_TIME_2MS]), timestamp: new Date() };
+  }
+}
+
+stubModule("./src/services/IOLinkService", { __esModule: true, default: FakeIOLinkService });
+const DeviceManager = require("./src/services/DeviceManager").default;
+const Device = require("./src/models/Device").default;
+
+function managerWithDevice(): any {
+  const manager: any = new DeviceManager();
+  const device = new Device({
+    port: 1,
+    vendorId: 1,
+    deviceId: 1,
+    functionId: 0,
+    revisionId: 0x11,
+    vendorName: "Test",
+    deviceName: "Test",
+    masterHandle: 0,
+  });
+  device.connected = true;
+  device.connectionState = "OPERATE";
+  manager.devices.set("0:1", device);
+  manager.masterThreads.set(0, { configure: () => undefined, getSchedule: () => null });
+  return manager;
+}
+
+check("MinCycleTime is read from the Direct Parameter Page", async () => {
+  const manager = managerWithDevice();
+  assert.strictEqual(await manager.getMinCycleTime(0, 1), 2);
+  assert.deepStrictEqual(manager.iolinkService.reads, ["0.3"]);
+});
+
+check("period below the device minimum cycle time is rejected", async () => {
+  const manager = managerWithDevice();
+  await assert.rejects(manager.setProcessDataPeriod(0, 1, 1), (error: any) => {
+    assert.strictEqual(error.statusCode, 400);
+    return true;
+  });
+  assert.strictEqual(manager.getProcessDataPeriod(0, 1), LIMITS.PROCESS_DATA_PERIOD_DEFAULT);
+});
+
+check("period at or above the device minimum cycle time is applied", async () => {
+  const manager = managerWithDevice();
+  assert.strictEqual(await manager.setProcessDataPeriod(0, 1, 2), 2);
+  assert.strictEqual(manager.getProcessDataPeriod(0, 1), 2);
+});
+
+// ============================================================================
+// MASTER CLOCK
+// ============================================================================
+
+const MasterClockService = require("./src/services/MasterClockService").default;
+
+check("master clock reads the nominal cycle and reports drift", async () => {
+  const reads: string[] = [];
+  const deviceManager = {
+    getProcessDataPorts: () => [{ masterHandle: 0, port: 1 }],
+    readDeviceParameter: async (deviceKey: string, index: number, subIndex: number) => {
+      reads.push(`${index}.${subIndex}`);
+      // MasterCycleTime is Direct Parameter Page 1 octet 1
+      if (index !== 0 || subIndex !== 2) throw new Error("not readable");
+      return { data: Buffer.from([CYCLE_TIME_2MS]) };
+    },
+    getIOLinkService: () => ({
+      // A master running 100 ppm slow on its 2 ms cycle
+      getStatisticCounters: async () => ({ cycles: Math.floor(performance.now() / 2.0002) }),
+    }),
+  };
+  const service = new MasterClockService(deviceManager);
+  for (let i = 0; i < 5; i++) {
+    await service.sample();
+    await new Promise((resolve) => setTimeout(resolve, 20));
+  }
+  const [clock] = service.getClocks();
+  assert.deepStrictEqual(reads, ["0.2"]);
+  assert.strictEqual(clock.nominalCycleUs, 2000);
+  assert.strictEqual(typeof clock.driftPpm, "number");
+});
+
+// ============================================================================
+// LINK QUALITY
+// ============================================================================
+
+const LinkQualityService = require("./src/services/LinkQualityService").default;
+
+check("a failing port does not stop sampling of the other ports", async () => {
+  let cycles = 0;
+  const deviceManager = {
+    getConnectedMasters: () => [{ handle: 0, deviceName: "Master" }],
+    getIOLinkService: () => ({
+      getHardwareInfo: async () => ({ externalPower: true, powerLevelMv: 24000 }),
+      getStatisticCounters: async (handle: number, port: number) => {
+        if (port === 1) {
+          const error: any = new Error("port 1 timed out");
+          error.code = -1;
+          throw error;
+        }
+        cycles += 1000;
+        return { cycles, retries: 0, aborts: 0 };
+      },
+    }),
+  };
+  const service = new LinkQualityService(deviceManager, { capacity: 8 });
+  await service.sample();
+  await service.sample();
+  assert.strictEqual(service.getPortHistory(0, 1), null);
+  assert.strictEqual(service.getPortHistory(0, 2).length, 1);
+  assert.deepStrictEqual(service.getSummary()[0].portErrors, { 1: 2 });
+});
+
+// ============================================================================
+// DATA LOGGING
+// ============================================================================
+
+const DataLoggingService = require("./src/services/DataLoggingService").default;
+
+check("stopping ports that are not logged leaves logging running", async () => {
+  const calls: string[] = [];
+  const iolinkService = {
+    startDataLogging: (handle: number, port: number, memory: number, mode: number, sampleTimeUs: number) => {
+      calls.push(`start ${port}`);
+      return sampleTimeUs;
+    },
+    stopDataLogging: () => calls.push("stop"),
+    readLoggingBuffer: async () => ({ status: 0, bytesRead: 0, readAt: performance.now() }),
+  };
+  const service = new DataLoggingService({
+    getConnectedMasters: () => [{ handle: 0 }],
+    getIOLinkService: () => iolinkService,
+    getDevice: () => {
+      throw new Error("no device");
+    },
+  });
+  const stopped: number[] = [];
+  service.on("stopped", (event: any) => stopped.push(event.port));
+
+  await service.start(0, [1]);
+  await service.stop(0, [2]);
+  assert.deepStrictEqual(calls, ["start 1"], "master restarted");
+  assert.ok(service.isLogging(0, 1));
+
+  await service.stop(0);
+  assert.deepStrictEqual(calls, ["start 1", "stop"]);
+  assert.deepStrictEqual(stopped, [1]);
+});
+
+// ============================================================================
+// LOGGER
+// ============================================================================
+
+check("records dropped on a full ring are reported", () => {
+  // Start from an empty ring
+  logger.flush();
+  const { ringSize } = logger.getStats();
+  const droppedBefore = logger.getStats().dropped;
+  const written: string[] = [];
+  const write = process.stderr.write;
+  process.stderr.write = ((chunk: any) => {
+    written.push(String(chunk));
+    return true;
+  }) as any;
+  try {
+    for (let i = 0; i < ringSize + 5; i++) {
+      logger.warn(`record ${i}`);
+    }
+    logger.flush();
+  } finally {
+    process.stderr.write = write;
+  }
+  const output = written.join("");
+  assert.strictEqual(logger.getStats().dropped - droppedBefore, 5);
+  assert.ok(output.includes(`record ${ringSize - 1}`), "last record that fit");
+  assert.ok(output.includes("5 log records dropped (ring full)"), "drop notice");
+});
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+(async () => {
+  for (const { name, body } of checks) {
+    try {
+      await body();
+      console.log(`✅ ${name}`);
+    } catch (error: any) {
+      failures++;
+      console.log(`❌ ${name}: ${error.message}`);
+    }
+  }
+  console.log(failures === 0 ? "\nAll checks passed" : `\n${failures} check(s) failed`);
+  process.exit(failures === 0 ? 0 : 1);
+})();